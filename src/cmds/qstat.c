@@ -107,6 +107,8 @@ char *cnvt_est_start_time(char *start_time, int shortform);
 
 #define DISPLAY_TRUNC_CHAR '*'
 
+#define QSTAT_PAGE_SIZE 1000 /* jobs fetched per page when listing a queue or server */
+
 #define NUML    5
 
 static struct attrl basic_attribs[] = {
@@ -2341,6 +2343,37 @@ tcl_run(int f_opt)
 #endif /* localmod 071 */
 #endif	/* TCL_QSTAT */
 
+/**
+ * @brief
+ *	Fetch the next non-empty page of job status from the server.
+ *
+ * @par
+ *	A page can come back empty while more jobs remain, e.g. when it only
+ *	held history jobs that were not asked for, so keep going until there
+ *	is something to show or the cursor runs out.
+ *
+ * @param[in] conn - connection to the server
+ * @param[in] dest - queue name or "" for all jobs at the server
+ * @param[in] attribs - attributes to status
+ * @param[in] extend - extend string for the request
+ * @param[in,out] cursor - paging cursor, 0 for the first page
+ *
+ * @return struct batch_status *
+ * @retval page of job status
+ * @retval NULL - no more jobs or error (see pbs_errno)
+ */
+static struct batch_status *
+statjob_next_page(int conn, char *dest, struct attrl *attribs, char *extend, int *cursor)
+{
+	struct batch_status *bs;
+
+	do {
+		bs = pbs_statjob_page(conn, dest, attribs, extend, QSTAT_PAGE_SIZE, cursor);
+	} while (bs == NULL && pbs_errno == PBSE_NONE && *cursor != 0);
+
+	return bs;
+}
+
 int
 main(int argc, char **argv, char **envp) /* qstat */
 {
@@ -2378,6 +2411,8 @@ main(int argc, char **argv, char **envp) /* qstat */
 	int f_opt, B_opt, Q_opt, how_opt, E_opt;
 	int p_header = TRUE;
 	int stat_single_job = 0;
+	int page_jobs = 0;
+	int page_cursor = 0;
 	int new_remote_server = 0;
 	enum { JOBS, QUEUES, SERVERS } mode;
 	struct batch_status *p_status;
@@ -2961,10 +2996,38 @@ job_no_args:
 					}
 				}
 
+				/*
+				 * Listing a whole queue or server with the standard
+				 * display is done a page at a time so that output starts
+				 * at once and memory use does not grow with the number
+				 * of jobs.  JSON output is built in memory anyway.
+				 */
+#ifdef NAS /* localmod 071 */
+				page_jobs = 0;
+#else
+				page_jobs = (stat_single_job == 0) && (new_atropl == 0) &&
+					((alt_opt & ~ALT_DISPLAY_w) == 0) && (output_format != FORMAT_JSON);
+#endif /* localmod 071 */
+				page_cursor = 0;
+
 				if ((stat_single_job == 1) || (new_atropl == 0)) {
 					if (E_opt == 1)
 						p_status = pbs_statjob(conn, query_job_list, display_attribs, extend);
-					else
+					else if (page_jobs) {
+						p_status = statjob_next_page(conn, job_id_out, display_attribs, extend, &page_cursor);
+						if (p_status == NULL && pbs_errno == PBSE_UNKREQ) {
+							/*
+							 * server does not know paged status; it did not
+							 * read the body of the request and drops the
+							 * connection, so ask again on a new one
+							 */
+							page_cursor = 0;
+							pbs_disconnect(conn);
+							conn = cnt2server(server_out);
+							if (conn > 0)
+								p_status = pbs_statjob(conn, job_id_out, display_attribs, extend);
+						}
+					} else
 						p_status = pbs_statjob(conn, job_id_out, display_attribs, extend);
 				} else {
 					p_status = pbs_selstat(conn, new_atropl, NULL, extend);
@@ -3051,6 +3114,24 @@ job_no_args:
 #endif /* localmod 071 */
 					p_header = FALSE;
 					pbs_statfree(p_status);
+
+#ifndef NAS /* localmod 071 */
+					/* show the remaining pages, without the header */
+					while (page_cursor != 0) {
+						p_status = statjob_next_page(conn, job_id_out, display_attribs, extend, &page_cursor);
+						if (p_status == NULL) {
+							if (pbs_errno != PBSE_NONE) {
+								prt_job_err("qstat", conn, job_id_out);
+								any_failed = pbs_errno;
+							}
+							break;
+						}
+						if (f_opt == 0 || tcl_stat("job", p_status, f_opt))
+							if (display_statjob(p_status, NULL, f_opt, how_opt, alt_opt, wide))
+								exit_qstat("out of memory");
+						pbs_statfree(p_status);
+					}
+#endif /* localmod 071 */
 				}
 				pbs_statfree(p_server);
 				p_server = NULL;
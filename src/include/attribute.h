@@ -125,6 +125,26 @@ typedef struct svrattrl svrattrl;
 #define al_value al_atopl.value
 #define al_op	 al_atopl.op
 
+/*
+ * svrattrl_blob holds the svrattrl entries of one attribute already encoded
+ * as sent in a status reply.  The Data-is-Strings form is built once per
+ * attribute value and access view; the DIS_WIRE_BIN form is only built from
+ * it the first time the blob goes out on a binary connection.  The blob is
+ * shared by reference between the attribute and every reply that includes it.
+ */
+
+struct svrattrl_blob {
+	struct svrattrl_blob *sb_next;	/* blob for the other access view */
+	int		sb_refct;	/* reference count */
+	int		sb_priv;	/* encoded with PRIV_READ access */
+	int		sb_count;	/* number of svrattrl entries encoded */
+	size_t		sb_len;		/* number of DIS bytes in sb_data */
+	char		*sb_bin;	/* DIS_WIRE_BIN form, NULL until needed */
+	size_t		sb_bin_len;	/* number of bytes in sb_bin */
+	char		sb_data[1];	/* DIS encoded entries follow */
+};
+typedef struct svrattrl_blob svrattrl_blob;
+
 /*
  * The value of an attribute is contained in the following structure.
  *
@@ -181,10 +201,27 @@ struct attribute {
 	unsigned int at_type:ATRVTYPE;	/* type of attribute    */
 	svrattrl    *at_user_encoded;	/* encoded svrattrl form for users*/
 	svrattrl    *at_priv_encoded;	/* encoded svrattrl form for mgr/op*/
+	svrattrl_blob *at_blob;		/* DIS encoded form for status */
 	union  attr_val at_val;		/* the attribute value	*/
 };
 typedef struct attribute attribute;
 
+/*
+ * Sparse storage for the attributes of an object, see attr_sparse.c.
+ * Only the attributes in use have a slot; the slots are allocated
+ * ATTR_SPARSE_CHUNK at a time and do not move once allocated.
+ */
+#define ATTR_SPARSE_MAX		256	/* highest number of attributes */
+#define ATTR_SPARSE_CHUNK	8	/* slots allocated at a time */
+
+struct attr_sparse {
+	unsigned long long as_used[ATTR_SPARSE_MAX / 64]; /* attributes in use */
+	unsigned char	   *as_slot;	/* slot of each one in use, by index */
+	attribute	  **as_chunk;	/* slot storage */
+	unsigned short	    as_nused;	/* number of attributes in use */
+};
+typedef struct attr_sparse attr_sparse;
+
 /*
  * The following structure is used to define an attribute for any parent
  * object.  The structure declares the attribute's name, value type, and
@@ -315,7 +352,7 @@ void free_attrl_list(struct attrl *at_list);
 extern void clear_attr(attribute *pattr, attribute_def *pdef);
 extern int  find_attr  (void *attrdef_idx, attribute_def *attr_def, char *name);
 extern int  recov_attr_fs(int fd, void *parent, void *padef_idx, attribute_def *padef,
-	attribute *pattr, int limit, int unknown);
+	attr_sparse *ps, int limit, int unknown);
 extern void free_null  (attribute *attr);
 extern void free_none  (attribute *attr);
 extern svrattrl *attrlist_alloc(int szname, int szresc, int szval);
@@ -323,6 +360,7 @@ extern svrattrl *attrlist_create(char *aname, char *rname, int szval);
 extern void free_svrattrl(svrattrl *pal);
 extern void free_attrlist(pbs_list_head *attrhead);
 extern void free_svrcache(attribute *attr);
+extern void free_svrattrl_blob(svrattrl_blob *pblob);
 extern int  attr_atomic_set(svrattrl *plist, attribute *old,
 	attribute *nattr, void *adef_idx, attribute_def *pdef, int limit,
 	int unkn, int privil, int *badattr);
@@ -476,7 +514,7 @@ extern int   check_duplicates(struct array_strings *strarr);
 
 extern char *arst_string(char *str, attribute *pattr);
 extern void  attrl_fixlink(pbs_list_head *svrattrl);
-extern int   save_attr_fs(attribute_def *, attribute *, int);
+extern int   save_attr_fs(attribute_def *, attr_sparse *);
 
 extern int      encode_state(const attribute *, pbs_list_head *, char *,
 	char *, int, svrattrl **rtnl);
@@ -601,6 +639,9 @@ extern int encode_single_attr_db(attribute_def *padef, attribute *pattr, pbs_db_
 extern int encode_attr_db(attribute_def *padef, attribute *pattr, int numattr,  pbs_db_attr_list_t *db_attr_list, int all);
 extern int decode_attr_db(void *parent, pbs_list_head *attr_list,
 	void *padef_idx, attribute_def *padef, attribute *pattr, int limit, int unknown);
+extern int encode_attr_db_sparse(attribute_def *padef, attr_sparse *ps, pbs_db_attr_list_t *db_attr_list, int all);
+extern int decode_attr_db_sparse(void *parent, pbs_list_head *attr_list,
+	void *padef_idx, attribute_def *padef, attr_sparse *ps, int limit, int unknown);
 
 extern int is_attr(int, char *, int);
 
@@ -633,6 +674,16 @@ attribute *_get_attr_by_idx(attribute *list, int attr_idx);
 pbs_list_head get_attr_list(const attribute *pattr);
 void free_attr(attribute_def *attr_def, attribute *pattr, int attr_idx);
 
+/* Sparse attribute storage */
+void attr_sparse_init(attr_sparse *ps);
+attribute *attr_sparse_find(const attr_sparse *ps, int idx);
+attribute *attr_sparse_get(attr_sparse *ps, attribute_def *padef, int idx);
+int attr_sparse_next(const attr_sparse *ps, int idx);
+void attr_sparse_free(attr_sparse *ps, attribute_def *padef);
+size_t attr_sparse_size(const attr_sparse *ps);
+void attr_sparse_copy_in(attr_sparse *to, attribute *from, attribute_def *pdef, int limit);
+void attr_sparse_copy_out(attribute *to, const attr_sparse *from, attribute_def *pdef, int limit);
+
 /* "type" to pass to acl_check() */
 #define ACL_Host  1
 #define ACL_User  2
@@ -75,6 +75,10 @@ typedef struct {
 #define AVL_IX_FAIL 0
 #define AVL_EOIX    -2
 
+/* flags to avl_search_key() */
+#define AVL_SRCH_EQUAL 0x01 /* the key itself */
+#define AVL_SRCH_GREAT 0x04 /* the next greater key */
+
 /* default behavior is no-dup-keys and case-sensitive search */
 #define AVL_DUP_KEYS_OK 0x01 /* repeated key & rec cause an error message */
 #define AVL_CASE_CMP    0x02 /* case insensitive search */
@@ -89,6 +93,7 @@ extern int avl_add_key(AVL_IX_REC *pe, AVL_IX_DESC *pix);
 extern int avl_delete_key(AVL_IX_REC *pe, AVL_IX_DESC *pix);
 extern void avl_first_key(AVL_IX_DESC *pix);
 extern int avl_next_key(AVL_IX_REC *pe, AVL_IX_DESC *pix);
+extern AVL_IX_REC *avl_search_key(AVL_IX_REC *pe, AVL_IX_DESC *pix, int flags);
 
 /* Added by Altair */
 AVL_IX_REC *avlkey_create(AVL_IX_DESC *tree, void *key);
@@ -51,6 +51,10 @@ extern "C" {
 #define PBS_SIGNAMESZ 16
 #define MAX_JOBS_PER_REPLY 500
 
+/* paginated job status (PBS_BATCH_StatusJobPage) cursors */
+#define STAT_CURSOR_MAX	    256 /* max cursors kept by the server */
+#define STAT_CURSOR_TIMEOUT 600 /* drop a cursor unused for this many seconds */
+
 /* QueueJob */
 struct rq_queuejob {
 	char rq_destin[PBS_MAXSVRRESVID + 1];
@@ -185,6 +189,8 @@ struct rq_signal {
 struct rq_status {
 	char *rq_id; /* allow mulitple (job) ids */
 	pbs_list_head rq_attr;
+	int rq_cursor; /* StatusJobPage: cursor of previous page, 0 for first */
+	int rq_limit;  /* StatusJobPage: max jobs in this page */
 };
 
 /* Select Job  and selstat */
@@ -421,6 +427,7 @@ extern int decode_DIS_Run(int, struct batch_request *);
 extern int decode_DIS_ShutDown(int, struct batch_request *);
 extern int decode_DIS_SignalJob(int, struct batch_request *);
 extern int decode_DIS_Status(int, struct batch_request *);
+extern int decode_DIS_StatusPage(int, struct batch_request *);
 extern int decode_DIS_TrackJob(int, struct batch_request *);
 extern int decode_DIS_replySvr(int, struct batch_reply *);
 extern int decode_DIS_svrattrl(int, pbs_list_head *);
@@ -434,6 +441,8 @@ extern int encode_DIS_TrackJob(int, struct batch_request *);
 extern int encode_DIS_reply(int, struct batch_reply *);
 extern int encode_DIS_replyTPP(int, char *, struct batch_reply *);
 extern int encode_DIS_svrattrl(int, svrattrl *);
+extern int encode_DIS_svrattrl_blobs(int, svrattrl *, svrattrl_blob **, int);
+extern svrattrl_blob *encode_svrattrl_blob(svrattrl *, int);
 extern int encode_DIS_Cred(int, char *, char *, int, char *, size_t, long);
 extern int dis_request_read(int, struct batch_request *);
 extern int dis_reply_read(int, struct batch_reply *, int);
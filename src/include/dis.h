@@ -208,11 +208,24 @@ extern void DIS_tcp_funcs();
 #define DIS_WRITE_BUF 0
 #define DIS_READ_BUF 1
 
+/*
+ * Wire encodings of a packet.  DIS_WIRE_ASCII is Data-is-Strings.
+ * DIS_WIRE_BIN sends integers as variable length binary numbers and
+ * counted strings as such a number followed by the bytes, and is only
+ * written to a peer which asked for it (see dis_set_wire()).
+ */
+#define DIS_WIRE_ASCII	0
+#define DIS_WIRE_BIN	1
+
+/* longest binary encoding of an integer: sign bit and 64 bit magnitude */
+#define DIS_BIN_MAXNUM	10
+
 typedef struct pbs_dis_buf {
 	size_t tdis_bufsize;
 	size_t tdis_len;
 	char *tdis_pos;
 	char *tdis_data;
+	int tdis_wire; /* encoding of the packet in the buffer (DIS_WIRE_*) */
 } pbs_dis_buf_t;
 
 typedef struct pbs_tcp_auth_data {
@@ -225,6 +238,7 @@ typedef struct pbs_tcp_chan {
 	pbs_dis_buf_t readbuf;
 	pbs_dis_buf_t writebuf;
 	int is_old_client; /* This is just for backward compatibility */
+	int wire; /* encoding of packets written from now on (DIS_WIRE_*) */
 	pbs_tcp_auth_data_t auths[2];
 } pbs_tcp_chan_t;
 
@@ -235,8 +249,15 @@ int dis_getc(int);
 int dis_gets(int, char *, size_t);
 int dis_puts(int, const char *, size_t);
 int dis_flush(int);
+int dis_flush_to(int, pbs_dis_buf_t *);
 void dis_setup_chan(int, pbs_tcp_chan_t * (*)(int));
 void dis_destroy_chan(int);
+void dis_set_wire(int, int);
+int dis_get_read_wire(int);
+int dis_get_write_wire(int);
+char *dis_bin_encode(char *, int, u_Long);
+pbs_tcp_chan_t *dis_get_chan(int);
+void dis_set_thread_chan(int, pbs_tcp_chan_t *);
 
 void transport_chan_set_ctx_status(int, int, int);
 int transport_chan_get_ctx_status(int, int);
@@ -254,7 +275,7 @@ extern int (*pfn_transport_send)(int, void *, int);
 
 #define transport_recv(x, y, z) (*pfn_transport_recv)(x, y, z)
 #define transport_send(x, y, z) (*pfn_transport_send)(x, y, z)
-#define transport_get_chan(x) (*pfn_transport_get_chan)(x)
+#define transport_get_chan(x) dis_get_chan(x)
 #define transport_set_chan(x, y) (*pfn_transport_set_chan)(x, y)
 
 #ifdef	__cplusplus
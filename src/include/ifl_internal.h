@@ -105,6 +105,8 @@ struct batch_status *__pbs_statrsc(int, char *, struct attrl *, char *);
 
 struct batch_status *__pbs_statjob(int, char *, struct attrl *, char *);
 
+struct batch_status *__pbs_statjob_page(int, char *, struct attrl *, char *, int, int *);
+
 struct batch_status *__pbs_selstat(int, struct attropl *, struct attrl *, char *);
 
 struct batch_status *__pbs_statque(int, char *, struct attrl *, char *);
@@ -498,6 +498,7 @@ struct job {
 	struct batch_request *ji_prunreq;  /* outstanding runjob request */
 	pbs_list_head ji_svrtask;	   /* links to svr work_task list */
 	struct pbs_queue *ji_qhdr;	   /* current queue header */
+	long long ji_qrank_key;		   /* qrank the job is filed under in the qrank indices */
 	struct resc_resv *ji_myResv;	   /* !=0 job belongs to a reservation, see also, attribute JOB_ATR_myResv */
 
 	int ji_lastdest;	     /* last destin tried by route */
@@ -530,6 +531,7 @@ struct job {
 	struct preempt_ordering *preempt_order;
 	int preempt_order_index;
 	struct work_task *ji_prov_startjob_task;
+	pbs_list_link ji_saveq;		/* link in the pending job save journal */
 
 #endif /* END SERVER ONLY */
 
@@ -602,11 +604,12 @@ struct job {
 	} ji_extended;
 
 	/*
-	 * The following array holds the decode	 format of the attributes.
-	 * Its presence is for rapid acces to the attributes.
+	 * The following holds the decode format of the attributes the job
+	 * uses, in sparse storage.  Use the get_jattr*() and set_jattr*()
+	 * accessors to reach them.
 	 */
 
-	attribute ji_wattr[JOB_ATR_LAST]; /* decoded attributes  */
+	attr_sparse ji_wattr; /* decoded attributes  */
 
 	short newobj; /* newly created job? */
 };
@@ -1015,6 +1018,7 @@ extern int   site_check_user_map(void *, int, char *);
 extern int   site_allow_u(char *user, char *host);
 extern void  svr_dequejob(job *);
 extern int   svr_enquejob(job *, char *);
+extern void  update_job_qrank(job *);
 extern void  svr_evaljobstate(job *, char *, int *, int);
 extern int   svr_setjobstate(job *, char, int);
 extern int   state_char2int(char);
@@ -1052,6 +1056,8 @@ void free_jattr(job *pjob, int attr_idx);
 void mark_jattr_not_set(job *pjob, int attr_idx);
 void mark_jattr_set(job *pjob, int attr_idx);
 attribute *get_jattr(const job *pjob, int attr_idx);
+int next_jattr(const job *pjob, int attr_idx);
+void free_jattrs(job *pjob);
 
 /*
  *	The filesystem related recovery/save routines are renamed
@@ -1076,6 +1082,8 @@ extern int job_save_fs(job *);
 
 extern job *job_recov_db(char *, job *pjob);
 extern int job_save_db(job *);
+extern int job_save_flush(void);
+extern void job_save_forget(job *);
 
 #define job_save  job_save_db
 #define job_recov job_recov_db
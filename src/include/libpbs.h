@@ -171,6 +171,8 @@ struct brp_status {
 	int brp_objtype;
 	char brp_objname[(PBS_MAXSVRJOBID > PBS_MAXDEST ? PBS_MAXSVRJOBID : PBS_MAXDEST) + 1];
 	pbs_list_head brp_attr; /* head of svrattrlist */
+	struct svrattrl_blob **brp_blobs; /* shared pre-encoded attributes */
+	int brp_nblobs; /* number of entries used in brp_blobs */
 };
 
 /* reply to Resource Query Request */
@@ -310,6 +312,7 @@ struct batch_reply
 #define PBS_BATCH_ModifyVnode    	99
 #define PBS_BATCH_DeleteJobList  	100
 #define PBS_BATCH_ServerReady    	101
+#define PBS_BATCH_StatusJobPage  	102
 
 #define PBS_BATCH_FileOpt_Default	0
 #define PBS_BATCH_FileOpt_OFlg		1
@@ -335,6 +338,7 @@ struct batch_reply
 #define EXTEND_OPT_IMPLICIT_COMMIT ":C:" /* option added to pbs_submit() extend parameter to request implicit commit */
 #define EXTEND_OPT_NEXT_MSG_TYPE "next_msg_type"
 #define EXTEND_OPT_NEXT_MSG_PARAM "next_msg_param"
+#define EXTEND_OPT_DIS_WIRE_BIN "dis_wire_bin" /* RegisterSched extend: peer accepts DIS_WIRE_BIN */
 
 int is_compose(int, int);
 int ps_compose(int, int);
@@ -389,6 +393,7 @@ int encode_DIS_Run(int, char *, char *, unsigned long);
 int encode_DIS_ShutDown(int, int);
 int encode_DIS_SignalJob(int, char *, char *);
 int encode_DIS_Status(int, char *, struct attrl *);
+int encode_DIS_StatusPage(int, char *, struct attrl *, int, int);
 int encode_DIS_attrl(int, struct attrl *);
 int encode_DIS_attropl(int, struct attropl *);
 int encode_DIS_CopyHookFile(int, int, char *, int, char *);
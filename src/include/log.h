@@ -135,6 +135,11 @@ extern struct log_net_info *get_if_info(char *msg);
 extern void free_if_info(struct log_net_info *ni);
 
 extern void log_close(int close_msg);
+#ifndef WIN32
+extern int log_async_start(void);
+extern int log_async_queue_fd(int fd, char *rec, int len);
+extern void log_async_flush(void);
+#endif
 extern void log_err(int err, const char *func, const char *text);
 extern void log_errf(int errnum, const char *routine, const char *fmt, ...);
 extern void log_joberr(int err, const char *func, const char *text, const char *pjid);
@@ -191,6 +191,8 @@ typedef enum conn_origin {
 
 conn_t *add_conn(int sock, enum conn_type, pbs_net_t, unsigned int port, int (*ready_func)(conn_t *), void (*func)(int));
 int set_conn_as_priority(conn_t *);
+int hold_conn(int sock); /* stop polling the connection */
+int release_conn(int sock); /* resume polling the connection */
 int add_conn_data(int sock, void *data); /* Adds the data to the connection */
 void *get_conn_data(int sock); /* Gets the pointer to the data present with the connection */
 int  client_to_svr(pbs_net_t, unsigned int port, int);
@@ -230,6 +232,8 @@ struct connection {
 	void		(*cn_func)(int); /* read function when data rdy */
 	void		(*cn_oncl)(int); /* func to call on close */
 	unsigned short	cn_prio_flag;	/* flag for a priority socket */
+	unsigned short	cn_hold_flag;	/* out of the poll set, reply in flight */
+	unsigned short	cn_close_pending; /* closed while held, see close_conn() */
 	pbs_list_link   cn_link;  /* link to the next connection in the linked list */
 	/* following attributes are for */
 	/* credential checking */
@@ -332,6 +332,33 @@ int pbs_db_connect(void **conn, char *host, int port, int timeout);
  */
 int pbs_db_disconnect(void *conn);
 
+/**
+ * @brief
+ *	Start a (possibly nested) transaction on the database connection
+ *
+ * @param[in]   conn - Connected database handle
+ *
+ * @return      Error code
+ * @retval      -1 - Failure
+ * @retval       0 - Success
+ *
+ */
+int pbs_db_begin_trx(void *conn);
+
+/**
+ * @brief
+ *	End a transaction started with pbs_db_begin_trx
+ *
+ * @param[in]   conn   - Connected database handle
+ * @param[in]   commit - 1 to commit, 0 to roll back
+ *
+ * @return      Error code
+ * @retval      -1 - Failure or rolled back
+ * @retval       0 - Success
+ *
+ */
+int pbs_db_end_trx(void *conn, int commit);
+
 /**
  * @brief
  *	Insert a new object into the database
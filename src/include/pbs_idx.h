@@ -45,6 +45,12 @@ extern "C" {
 
 #define PBS_IDX_DUPS_OK     0x01 /* duplicate key allowed in index */
 #define PBS_IDX_ICASE_CMP   0x02 /* set case-insensitive compare */
+/*
+ * index may be searched and iterated by any number of threads while another
+ * modifies it.  Inserts and deletes still mark the tree, so they must come
+ * from threads counted by avl_set_maxthreads().
+ */
+#define PBS_IDX_CONCURRENT  0x04
 
 #define PBS_IDX_RET_OK    0 /* index op succeed */
 #define PBS_IDX_RET_FAIL -1 /* index op failed */
@@ -142,6 +148,22 @@ extern int pbs_idx_delete_byctx(void *ctx);
  */
 extern int pbs_idx_find(void *idx, void **key, void **data, void **ctx);
 
+/**
+ * @brief
+ *	find the first entry in index whose key is
+ *	greater than or equal to given key
+ *
+ * @param[in]  - idx  - pointer to index
+ * @param[in]  - key  - key to search for
+ * @param[out] - data - data of the entry found
+ *
+ * @return int
+ * @retval PBS_IDX_RET_OK   - success
+ * @retval PBS_IDX_RET_FAIL - failure or no such entry
+ *
+ */
+extern int pbs_idx_find_ge(void *idx, void *key, void **data);
+
 /**
  * @brief
  *	free given iteration context
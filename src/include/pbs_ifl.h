@@ -651,6 +651,8 @@ DECLDIR struct batch_status *pbs_statrsc(int, char *, struct attrl *, char *);
 
 DECLDIR struct batch_status *pbs_statjob(int, char *, struct attrl *, char *);
 
+DECLDIR struct batch_status *pbs_statjob_page(int, char *, struct attrl *, char *, int, int *);
+
 DECLDIR struct batch_status *pbs_selstat(int, struct attropl *, struct attrl *, char *);
 
 DECLDIR struct batch_status *pbs_statque(int, char *, struct attrl *, char *);
@@ -755,6 +757,8 @@ extern struct batch_status *pbs_statrsc(int, char *, struct attrl *, char *);
 
 extern struct batch_status *pbs_statjob(int, char *, struct attrl *, char *);
 
+extern struct batch_status *pbs_statjob_page(int, char *, struct attrl *, char *, int, int *);
+
 extern struct batch_status *pbs_selstat(int, struct attropl *, struct attrl *, char *);
 
 extern struct batch_status *pbs_statque(int, char *, struct attrl *, char *);
@@ -817,6 +821,7 @@ extern void (*pfn_pbs_statfree)(struct batch_status *);
 extern void (*pfn_pbs_delstatfree)(struct batch_deljob_status *);
 extern struct batch_status *(*pfn_pbs_statrsc)(int, char *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_statjob)(int, char *, struct attrl *, char *);
+extern struct batch_status *(*pfn_pbs_statjob_page)(int, char *, struct attrl *, char *, int, int *);
 extern struct batch_status *(*pfn_pbs_selstat)(int, struct attropl *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_statque)(int, char *, struct attrl *, char *);
 extern struct batch_status *(*pfn_pbs_statserver)(int, struct attrl *, char *);
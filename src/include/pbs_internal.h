@@ -255,6 +255,9 @@ struct pbs_config
 	char *pbs_lr_save_path;		/* path to store undo live recordings */
 	unsigned int pbs_log_highres_timestamp; /* high resolution logging */
 	unsigned int pbs_sched_threads;	/* number of threads for scheduler */
+	unsigned int pbs_server_reply_threads; /* number of server threads writing status replies */
+	unsigned int pbs_log_async;	/* write daemon logs from a writer thread */
+	unsigned int pbs_server_helpers; /* number of helper processes the server starts at boot */
 	char *pbs_daemon_service_user; /* user the scheduler runs as */
 	char current_user[PBS_MAXUSER+1]; /* current running user */
 #ifdef WIN32
@@ -321,6 +324,9 @@ extern struct pbs_config pbs_conf;
 #define PBS_CONF_LR_SAVE_PATH	"PBS_LR_SAVE_PATH"
 #define PBS_CONF_LOG_HIGHRES_TIMESTAMP	"PBS_LOG_HIGHRES_TIMESTAMP"
 #define PBS_CONF_SCHED_THREADS	"PBS_SCHED_THREADS"
+#define PBS_CONF_SERVER_REPLY_THREADS	"PBS_SERVER_REPLY_THREADS"
+#define PBS_CONF_LOG_ASYNC	"PBS_LOG_ASYNC"
+#define PBS_CONF_SERVER_HELPERS	"PBS_SERVER_HELPERS"
 #define PBS_CONF_DAEMON_SERVICE_USER "PBS_DAEMON_SERVICE_USER"
 #ifdef WIN32
 #define PBS_CONF_REMOTE_VIEWER "PBS_REMOTE_VIEWER"	/* Executable for remote viewer application alongwith its launch options, for PBS GUI jobs */
@@ -423,6 +423,7 @@ extern int get_py_progname(char **);
 #define	EVENT_VNODELIST_OBJECT	EVENT_OBJECT ".vnode_list"
 #define	EVENT_VNODELIST_FAIL_OBJECT	EVENT_OBJECT ".vnode_list_fail"
 #define	EVENT_JOBLIST_OBJECT	EVENT_OBJECT ".job_list"
+#define	EVENT_RESVLIST_OBJECT	EVENT_OBJECT ".resv_list"
 #define	EVENT_AOE_OBJECT	EVENT_OBJECT ".aoe"
 #define	EVENT_ACCEPT_OBJECT	EVENT_OBJECT ".accept"
 #define	EVENT_REJECT_OBJECT	EVENT_OBJECT ".reject"
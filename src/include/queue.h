@@ -72,6 +72,7 @@ extern attribute_def que_attr_def[];
 struct pbs_queue {
 	pbs_list_link qu_link; /* forward/backward links */
 	pbs_list_head qu_jobs; /* jobs in this queue */
+	void *qu_qrank_idx;    /* index of qu_jobs ordered by qrank */
 	resc_resv *qu_resvp;   /* != NULL if que established */
 	/* to support a reservation */
 	int qu_nseldft;		   /* number of elm in qu_seldft */
@@ -93,6 +94,9 @@ struct pbs_queue {
 };
 typedef struct pbs_queue pbs_queue;
 
+/* key of the qrank indices is the queue rank followed by the job pointer */
+#define QRANK_IDX_KEYLEN (sizeof(long long) + sizeof(void *))
+
 extern void *queues_idx;
 
 extern pbs_queue *find_queuebyname(char *);
@@ -57,6 +57,14 @@ extern "C" {
 extern int check_num_cpus(void);
 extern int chk_hold_priv(long, int);
 extern void close_client(int);
+extern void child_exited(long, int);
+extern int helper_pool_init(void);
+extern int helper_exec(char **, char **, char *, size_t, long *);
+extern int helper_call(int (*)(char *, size_t), char *, size_t, long *);
+extern int reply_pool_init(void);
+extern void reply_pool_drain(int);
+struct timespec;
+extern void req_latency_note(int, struct timespec *);
 extern void scheduler_close(int);
 extern int send_sched_cmd(pbs_sched *, int, char *);
 extern void count_node_cpus(void);
@@ -144,6 +152,7 @@ extern int find_prov_vnode_list(job *, exec_vnode_listtype *, char **);
 #endif /* _PROVISION_H */
 
 extern void *jobs_idx;
+extern void *alljobs_qrank_idx;
 
 #ifdef _RESERVATION_H
 extern int set_nodes(void *, int, char *, char **, char **, char **, int, int);
@@ -193,6 +202,7 @@ extern void complete_running(job *);
 extern void am_jobs_add(job *);
 extern int was_job_alteredmoved(job *);
 extern void check_failed_attempts(job *);
+extern void advance_stat_cursors(job *);
 #endif
 #ifdef _QUEUE_H
 extern int check_entity_ct_limit_max(job *, pbs_queue *);
@@ -205,6 +215,7 @@ extern int set_entity_resc_sum_max(job *, pbs_queue *, attribute *, enum batch_o
 extern int set_entity_resc_sum_queued(job *, pbs_queue *, attribute *, enum batch_op);
 extern int account_entity_limit_usages(job *, pbs_queue *, attribute *, enum batch_op, int);
 extern void eval_chkpnt(job *pjob, attribute *queckp);
+extern void drop_stat_cursors(pbs_queue *);
 #endif /* _QUEUE_H */
 
 #ifdef _BATCH_REQUEST_H
@@ -265,6 +276,9 @@ extern void req_reservationOccurrenceEnd(struct batch_request *);
 extern void req_failover(struct batch_request *);
 extern int put_failover(int, struct batch_request *);
 extern void set_last_used_time_node(void *, int);
+extern int reply_pool_part(struct batch_request *);
+extern int reply_pool_send(struct batch_request *);
+extern void reply_pool_forget(struct batch_request *);
 
 #endif /* _BATCH_REQUEST_H */
 
@@ -312,6 +326,7 @@ extern int svr_connect(pbs_net_t, unsigned int, void (*)(int), enum conn_type, i
 #endif /* PBS_NET_H */
 #ifdef _WORK_TASK_H
 extern void release_req(struct work_task *);
+extern void req_latency_log(struct work_task *);
 #ifdef _BATCH_REQUEST_H
 extern int issue_Drequest(int, struct batch_request *, void (*)(), struct work_task **, int);
 #endif /* _BATCH_REQUEST_H */
@@ -89,6 +89,8 @@ struct work_task  {
 	void		*wt_parm3;	/* used to store reply for deferred cmds TPP */
 	int		 wt_aux;	/* optional info: e.g. child status */
 	int		 wt_aux2;	/* optional info 2: e.g. *real* child pid (windows), tpp msgid etc */
+	int		 wt_heapind;	/* WORK_Timed: index in the timed task heap, -1 if not on it */
+	unsigned long	 wt_seq;	/* WORK_Timed: order of insertion, breaks ties on wt_event */
 };
 
 extern struct work_task *set_task(enum work_type, long event, void (*func)(), void *param);
@@ -100,6 +102,7 @@ extern void delete_task_by_parm1_func(void *parm1, void (*func)(struct work_task
 extern int  has_task_by_parm1(void *parm1);
 extern time_t default_next_task(void);
 extern struct work_task *find_work_task(enum work_type, void *, void *);
+extern int set_task_time(struct work_task *ptask, long when);
 
 #ifdef	__cplusplus
 }
@@ -583,6 +583,7 @@ add_resource_entry(attribute *pattr, resource_def *prdef)
 	new->rs_value.at_flags = 0;
 	new->rs_value.at_user_encoded = 0;
 	new->rs_value.at_priv_encoded = 0;
+	new->rs_value.at_blob = NULL;
 	prdef->rs_free(&new->rs_value);
 
 	if (pr != NULL) {
@@ -156,7 +156,8 @@ find_attr(void *attrdef_idx, attribute_def *attr_def, char *name)
 
 /**
  * @brief
- * 	free_svrcache - free the cached svrattrl entries associated with an attribute
+ * 	free_svrcache - free the cached svrattrl entries and encoded blobs
+ *	associated with an attribute
  *
  * @param[in] attr - pointer to attribute structure
  *
@@ -191,6 +192,34 @@ free_svrcache(attribute *attr)
 		}
 	}
 	attr->at_priv_encoded = NULL;
+
+	while (attr->at_blob != NULL) {
+		svrattrl_blob *pblob = attr->at_blob;
+
+		attr->at_blob = pblob->sb_next;
+		pblob->sb_next = NULL;
+		free_svrattrl_blob(pblob);
+	}
+}
+
+/**
+ * @brief
+ * 	free_svrattrl_blob - drop one reference to a pre-encoded attribute
+ *	blob, freeing it when the last reference goes away.
+ *
+ * @param[in] pblob - pointer to the blob
+ *
+ * @return	Void
+ *
+ */
+
+void
+free_svrattrl_blob(svrattrl_blob *pblob)
+{
+	if ((pblob != NULL) && (--pblob->sb_refct <= 0)) {
+		free(pblob->sb_bin);
+		free(pblob);
+	}
 }
 
 /**
@@ -211,7 +240,8 @@ free_null(attribute *attr)
 	if (attr->at_type == ATR_TYPE_SIZE)
 		attr->at_val.at_size.atsv_shift = 10;
 	attr->at_flags &= ~(ATR_VFLAG_SET|ATR_VFLAG_INDIRECT|ATR_VFLAG_TARGET);
-	if (attr->at_user_encoded != NULL || attr->at_priv_encoded != NULL)
+	if (attr->at_user_encoded != NULL || attr->at_priv_encoded != NULL ||
+		attr->at_blob != NULL)
 		free_svrcache(attr);
 }
 
@@ -576,7 +606,8 @@ free_none(attribute *attr)
 {
 	/* do nothing */
 	/* to be used for accrue_type attribute of job */
-	if (attr->at_user_encoded != NULL || attr->at_priv_encoded != NULL) {
+	if (attr->at_user_encoded != NULL || attr->at_priv_encoded != NULL ||
+		attr->at_blob != NULL) {
 		free_svrcache(attr);
 	}
 }
@@ -1902,7 +1933,8 @@ free_attr(attribute_def *attr_def, attribute *pattr, int attr_idx)
 pbs_list_head
 get_attr_list(const attribute *pattr)
 {
-	const pbs_list_head dummy = {(pbs_list_link *)&dummy, (pbs_list_link *)&dummy, NULL};
+	/* static, so the links of the copy returned still point at it */
+	static const pbs_list_head dummy = {(pbs_list_link *)&dummy, (pbs_list_link *)&dummy, NULL};
 	if (pattr)
 		return pattr->at_val.at_list;
 	else
@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdlib.h>
+#include <string.h>
+#include "pbs_ifl.h"
+#include "list_link.h"
+#include "attribute.h"
+
+
+/**
+ * @file	attr_sparse.c
+ * @brief
+ * 	Sparse storage for the attributes of an object.
+ *
+ *	Only the attributes an object uses are given a slot.  A bitmap marks
+ *	the attributes in use and a packed array, in attribute index order,
+ *	holds the slot number of each of them, so an attribute's slot is found
+ *	by counting the bits below it.  Slots are allocated ATTR_SPARSE_CHUNK
+ *	at a time and are never moved, a pointer to an attribute stays valid
+ *	until the storage is freed.
+ *
+ * @par	Included is:
+ *	attr_sparse_init()
+ *	attr_sparse_find()
+ *	attr_sparse_get()
+ *	attr_sparse_next()
+ *	attr_sparse_free()
+ *	attr_sparse_size()
+ *	attr_sparse_copy_in()
+ *	attr_sparse_copy_out()
+ */
+
+#define AS_WORD_BITS	64
+#define AS_SLOT_GROW	16	/* slot numbers allocated at a time */
+
+/**
+ * @brief
+ *	Return the number of attributes in use with an index below idx,
+ *	which is where idx is or would be in the packed slot array.
+ *
+ * @param[in] ps - pointer to the sparse storage
+ * @param[in] idx - attribute index
+ *
+ * @return	int
+ */
+static int
+attr_sparse_rank(const attr_sparse *ps, int idx)
+{
+	int w = idx / AS_WORD_BITS;
+	int i;
+	int rank = 0;
+
+	for (i = 0; i < w; i++)
+		rank += __builtin_popcountll(ps->as_used[i]);
+	return rank + __builtin_popcountll(ps->as_used[w] & ((1ULL << (idx % AS_WORD_BITS)) - 1));
+}
+
+/**
+ * @brief
+ *	Return the attribute held in a slot
+ *
+ * @param[in] ps - pointer to the sparse storage
+ * @param[in] slot - slot number
+ *
+ * @return	attribute *
+ */
+static attribute *
+attr_sparse_slot(const attr_sparse *ps, int slot)
+{
+	return ps->as_chunk[slot / ATTR_SPARSE_CHUNK] + (slot % ATTR_SPARSE_CHUNK);
+}
+
+/**
+ * @brief
+ *	Initialize an empty sparse attribute storage
+ *
+ * @param[out] ps - pointer to the sparse storage
+ *
+ * @return	void
+ */
+void
+attr_sparse_init(attr_sparse *ps)
+{
+	memset(ps, 0, sizeof(attr_sparse));
+}
+
+/**
+ * @brief
+ *	Find an attribute in use in a sparse storage
+ *
+ * @param[in] ps - pointer to the sparse storage
+ * @param[in] idx - attribute index
+ *
+ * @return	attribute *
+ * @retval	NULL  - the attribute is not in use, so it is not set
+ * @retval	!NULL - pointer to the attribute
+ */
+attribute *
+attr_sparse_find(const attr_sparse *ps, int idx)
+{
+	if ((idx < 0) || (idx >= ATTR_SPARSE_MAX))
+		return NULL;
+	if ((ps->as_used[idx / AS_WORD_BITS] & (1ULL << (idx % AS_WORD_BITS))) == 0)
+		return NULL;
+	return attr_sparse_slot(ps, ps->as_slot[attr_sparse_rank(ps, idx)]);
+}
+
+/**
+ * @brief
+ *	Get an attribute of a sparse storage, giving it a slot and clearing
+ *	it if it was not in use.
+ *
+ * @param[in,out] ps - pointer to the sparse storage
+ * @param[in] padef - the object's attribute definition array
+ * @param[in] idx - attribute index
+ *
+ * @return	attribute *
+ * @retval	NULL  - bad index or no memory
+ * @retval	!NULL - pointer to the attribute
+ */
+attribute *
+attr_sparse_get(attr_sparse *ps, attribute_def *padef, int idx)
+{
+	attribute *pattr;
+	unsigned char *slots;
+	attribute **chunks;
+	int slot;
+	int rank;
+
+	if ((pattr = attr_sparse_find(ps, idx)) != NULL)
+		return pattr;
+	if ((idx < 0) || (idx >= ATTR_SPARSE_MAX))
+		return NULL;
+
+	slot = ps->as_nused;
+	if ((slot % AS_SLOT_GROW) == 0) {
+		if ((slots = realloc(ps->as_slot, slot + AS_SLOT_GROW)) == NULL)
+			return NULL;
+		ps->as_slot = slots;
+	}
+	if ((slot % ATTR_SPARSE_CHUNK) == 0) {
+		chunks = realloc(ps->as_chunk, (slot / ATTR_SPARSE_CHUNK + 1) * sizeof(attribute *));
+		if (chunks == NULL)
+			return NULL;
+		ps->as_chunk = chunks;
+		if ((chunks[slot / ATTR_SPARSE_CHUNK] = malloc(ATTR_SPARSE_CHUNK * sizeof(attribute))) == NULL)
+			return NULL;
+	}
+
+	rank = attr_sparse_rank(ps, idx);
+	memmove(ps->as_slot + rank + 1, ps->as_slot + rank, slot - rank);
+	ps->as_slot[rank] = (unsigned char) slot;
+	ps->as_used[idx / AS_WORD_BITS] |= 1ULL << (idx % AS_WORD_BITS);
+	ps->as_nused++;
+
+	pattr = attr_sparse_slot(ps, slot);
+	clear_attr(pattr, padef + idx);
+	return pattr;
+}
+
+/**
+ * @brief
+ *	Return the next attribute in use after an index, to walk the
+ *	attributes in use in index order starting from an index of -1.
+ *
+ * @param[in] ps - pointer to the sparse storage
+ * @param[in] idx - attribute index to start after
+ *
+ * @return	int
+ * @retval	-1 - no more attributes in use
+ * @retval	>= 0 - index of the next attribute in use
+ */
+int
+attr_sparse_next(const attr_sparse *ps, int idx)
+{
+	unsigned long long bits;
+	int w;
+
+	if (++idx >= ATTR_SPARSE_MAX)
+		return -1;
+	w = idx / AS_WORD_BITS;
+	bits = ps->as_used[w] & ~((1ULL << (idx % AS_WORD_BITS)) - 1);
+	while (bits == 0) {
+		if (++w >= ATTR_SPARSE_MAX / AS_WORD_BITS)
+			return -1;
+		bits = ps->as_used[w];
+	}
+	return w * AS_WORD_BITS + __builtin_ctzll(bits);
+}
+
+/**
+ * @brief
+ *	Free the values of all attributes in a sparse storage and the
+ *	storage itself, leaving it empty.
+ *
+ * @param[in,out] ps - pointer to the sparse storage
+ * @param[in] padef - the object's attribute definition array
+ *
+ * @return	void
+ */
+void
+attr_sparse_free(attr_sparse *ps, attribute_def *padef)
+{
+	int i;
+
+	for (i = attr_sparse_next(ps, -1); i >= 0; i = attr_sparse_next(ps, i))
+		free_attr(padef, attr_sparse_find(ps, i), i);
+	for (i = 0; i < (ps->as_nused + ATTR_SPARSE_CHUNK - 1) / ATTR_SPARSE_CHUNK; i++)
+		free(ps->as_chunk[i]);
+	free(ps->as_chunk);
+	free(ps->as_slot);
+	attr_sparse_init(ps);
+}
+
+/**
+ * @brief
+ *	Return the heap memory held by a sparse storage, not counting the
+ *	values of the attributes.
+ *
+ * @param[in] ps - pointer to the sparse storage
+ *
+ * @return	size_t
+ */
+size_t
+attr_sparse_size(const attr_sparse *ps)
+{
+	size_t nchunks = (ps->as_nused + ATTR_SPARSE_CHUNK - 1) / ATTR_SPARSE_CHUNK;
+	size_t nslots = (ps->as_nused + AS_SLOT_GROW - 1) / AS_SLOT_GROW * AS_SLOT_GROW;
+
+	return nchunks * (ATTR_SPARSE_CHUNK * sizeof(attribute) + sizeof(attribute *)) + nslots;
+}
+
+/**
+ * @brief
+ *	Copy an attribute array into a sparse storage, as attr_atomic_copy()
+ *	does between two arrays.  Only the attributes that are in use in
+ *	'to' or set in 'from' are touched.
+ *
+ * @param[in,out] to - sparse storage copied into
+ * @param[in] from - attribute array copied from
+ * @param[in] pdef - pointer to attribute_def structure
+ * @param[in] limit - Last attribute in the list
+ *
+ * @return	void
+ */
+void
+attr_sparse_copy_in(attr_sparse *to, attribute *from, attribute_def *pdef, int limit)
+{
+	attribute *pto;
+	int i;
+
+	for (i = 0; i < limit; i++) {
+		if ((from + i)->at_flags & ATR_VFLAG_SET)
+			pto = attr_sparse_get(to, pdef, i);
+		else
+			pto = attr_sparse_find(to, i);
+		if (pto == NULL)
+			continue;
+
+		if ((pto->at_flags & ATR_VFLAG_SET) && (pdef + i)->at_set != set_null)
+			(pdef + i)->at_free(pto);
+
+		if ((pdef + i)->at_set != set_null)
+			clear_attr(pto, pdef + i);
+		if ((from + i)->at_flags & ATR_VFLAG_SET) {
+			(pdef + i)->at_set(pto, from + i, SET);
+			pto->at_flags = (from + i)->at_flags;
+		}
+	}
+}
+
+/**
+ * @brief
+ *	Copy the attributes of a sparse storage into an attribute array, as
+ *	attr_atomic_copy() does between two arrays.  'to' must be preallocated.
+ *
+ * @param[out] to - attribute array copied into
+ * @param[in] from - sparse storage copied from
+ * @param[in] pdef - pointer to attribute_def structure
+ * @param[in] limit - Last attribute in the list
+ *
+ * @return	void
+ */
+void
+attr_sparse_copy_out(attribute *to, const attr_sparse *from, attribute_def *pdef, int limit)
+{
+	attribute *pfrom;
+	int i;
+
+	for (i = 0; i < limit; i++) {
+		if (((to + i)->at_flags & ATR_VFLAG_SET) && (pdef + i)->at_set != set_null)
+			(pdef + i)->at_free(to + i);
+
+		if ((pdef + i)->at_set != set_null)
+			clear_attr(to + i, pdef + i);
+		pfrom = attr_sparse_find(from, i);
+		if ((pfrom != NULL) && (pfrom->at_flags & ATR_VFLAG_SET)) {
+			(pdef + i)->at_set((to + i), pfrom, SET);
+			(to + i)->at_flags = pfrom->at_flags;
+		}
+	}
+}
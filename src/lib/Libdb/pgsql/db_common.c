@@ -869,6 +869,78 @@ pbs_db_disconnect(void *conn)
 	return 0;
 }
 
+/**
+ * @brief
+ *	Start a transaction on the database connection. Transactions may be
+ *	nested; only the outermost begin issues the BEGIN statement.
+ *
+ * @param[in]   conn - Connected database handle
+ *
+ * @return      Error code
+ * @retval      -1  - Failure
+ * @retval       0  - Success
+ *
+ */
+int
+pbs_db_begin_trx(void *conn)
+{
+	if (!conn || !conn_trx)
+		return -1;
+
+	if (conn_trx->conn_trx_nest == 0) {
+		if (db_execute_str(conn, "BEGIN") == -1)
+			return -1;
+		conn_trx->conn_trx_rollback = 0;
+	}
+	conn_trx->conn_trx_nest++;
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	End a transaction started with pbs_db_begin_trx. A rollback request at
+ *	any nesting level marks the whole transaction to be rolled back when
+ *	the outermost level ends.
+ *
+ * @param[in]   conn   - Connected database handle
+ * @param[in]   commit - 1 to commit, 0 to roll back
+ *
+ * @return      Error code
+ * @retval      -1  - Failure, or the transaction was rolled back
+ * @retval       0  - Success
+ *
+ */
+int
+pbs_db_end_trx(void *conn, int commit)
+{
+	int rc;
+
+	if (!conn || !conn_trx || conn_trx->conn_trx_nest == 0)
+		return -1;
+
+	if (!commit)
+		conn_trx->conn_trx_rollback = 1;
+
+	if (--conn_trx->conn_trx_nest > 0)
+		return 0;
+
+	if (conn_trx->conn_trx_rollback) {
+		(void) db_execute_str(conn, "ROLLBACK");
+		conn_trx->conn_trx_rollback = 0;
+		return -1;
+	}
+
+	rc = db_execute_str(conn, "COMMIT");
+	if (rc == -1) {
+		/* a failed commit leaves the transaction aborted; clear it */
+		(void) db_execute_str(conn, "ROLLBACK");
+		return -1;
+	}
+
+	return 0;
+}
+
 /**
  * @brief
  *	Saves a new object into the database
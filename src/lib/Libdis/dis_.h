@@ -67,6 +67,12 @@ disrsl_(int stream, int *negate, unsigned long *value,
 int disrsll_(int stream,  int  *negate,  u_Long *value, unsigned long count, int recursv);
 int diswui_(int stream, unsigned value);
 
+/* returned by disr_bin_num() when the packet being read is Data-is-Strings */
+#define DIS_NOTBIN (-1)
+
+int disr_bin_num(int stream, int *negate, u_Long *value);
+int disw_num(int stream, int negate, u_Long value);
+
 extern unsigned dis_dmx10;
 extern double *dis_dp10;
 extern double *dis_dn10;
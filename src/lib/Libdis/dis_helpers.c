@@ -43,10 +43,12 @@
 #include <stdlib.h>
 #include "auth.h"
 #include "dis.h"
+#include "dis_.h"
 #include "pbs_error.h"
 #include "pbs_internal.h"
 
 #define PKT_MAGIC    "PKTV1"
+#define PKT_MAGIC_BIN "PKTB1" /* packet in the DIS_WIRE_BIN encoding */
 #define PKT_MAGIC_SZ sizeof(PKT_MAGIC)
 #define PKT_HDR_SZ   (PKT_MAGIC_SZ + 1 + sizeof(int))
 
@@ -55,6 +57,60 @@ static pbs_dis_buf_t *dis_get_writebuf(int);
 static int dis_resize_buf(pbs_dis_buf_t *, size_t);
 static int transport_chan_is_encrypted(int);
 
+/* channel the calling thread encodes into instead of fd's, see dis_set_thread_chan() */
+static __thread pbs_tcp_chan_t *thread_chan = NULL;
+static __thread int thread_chan_fd = -1;
+
+/**
+ * @brief
+ * 	dis_get_chan - get the channel of a connection, as transport_get_chan()
+ *
+ * @par	The channel set by dis_set_thread_chan() for fd is returned in
+ *	place of the one the transport keeps for it.
+ *
+ * @param[in] fd - file descriptor
+ *
+ * @return pbs_tcp_chan_t *
+ * @retval !NULL - the channel
+ * @retval NULL - no channel for fd
+ *
+ * @par MT-safe: Yes
+ *
+ */
+pbs_tcp_chan_t *
+dis_get_chan(int fd)
+{
+	if (thread_chan != NULL && fd == thread_chan_fd)
+		return thread_chan;
+	return (*pfn_transport_get_chan)(fd);
+}
+
+/**
+ * @brief
+ * 	dis_set_thread_chan - make the calling thread encode and decode fd
+ * 	through a channel of its own
+ *
+ * @par	The transport functions are global and the main loop of a daemon
+ *	switches them between TCP and TPP, so a thread other than the main
+ *	one cannot look up a connection's channel through them.  With a
+ *	private channel it can encode a message into memory, e.g. to be
+ *	sealed with dis_flush_to(), without touching them.
+ *
+ * @param[in] fd - file descriptor the channel stands for
+ * @param[in] chan - the channel, NULL to go back to the transport's
+ *
+ * @return void
+ *
+ * @par MT-safe: Yes
+ *
+ */
+void
+dis_set_thread_chan(int fd, pbs_tcp_chan_t *chan)
+{
+	thread_chan = chan;
+	thread_chan_fd = (chan != NULL) ? fd : -1;
+}
+
 /**
  * @brief
  * 	transport_chan_set_ctx_status - set auth context status tcp chan assosiated with given fd
@@ -246,10 +302,9 @@ transport_chan_is_encrypted(int fd)
 
 /**
  * @brief
- * 	send pkt from given DIS buffer over network
- * 	after patching pkt header for data size and
- * 	if not encrypted already and chan is encrypted
- * 	then encrypt data before send
+ * 	finish the pkt in given DIS buffer so that it is ready to go
+ * 	over the network: if not encrypted already and chan is encrypted
+ * 	then encrypt data, then patch pkt header for data size
  *
  * @param[in] fd - file descriptor
  * @param[in] tp - pointer to DIS buffer
@@ -257,7 +312,7 @@ transport_chan_is_encrypted(int fd)
  *
  * @return int
  *
- * @retval >= 0  - success
+ * @retval 0 - success
  * @retval -1 - failure
  *
  * @par Side Effects:
@@ -267,7 +322,7 @@ transport_chan_is_encrypted(int fd)
  *
  */
 static int
-__send_pkt(int fd, pbs_dis_buf_t *tp, int encrypt_done)
+__seal_pkt(int fd, pbs_dis_buf_t *tp, int encrypt_done)
 {
 	int i;
 
@@ -291,6 +346,36 @@ __send_pkt(int fd, pbs_dis_buf_t *tp, int encrypt_done)
 
 	i = htonl(tp->tdis_len - PKT_HDR_SZ);
 	memcpy((void *) (tp->tdis_data + PKT_HDR_SZ - sizeof(int)), &i, sizeof(int));
+	return 0;
+}
+
+/**
+ * @brief
+ * 	send pkt from given DIS buffer over network
+ * 	after sealing it, see __seal_pkt()
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] tp - pointer to DIS buffer
+ * @param[in] encrypt_done - is data already encrypted
+ *
+ * @return int
+ *
+ * @retval >= 0  - success
+ * @retval -1 - failure
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static int
+__send_pkt(int fd, pbs_dis_buf_t *tp, int encrypt_done)
+{
+	int i;
+
+	if (__seal_pkt(fd, tp, encrypt_done) != 0)
+		return -1;
 
 	i = transport_send(fd, (void *) tp->tdis_data, tp->tdis_len);
 	if (i < 0)
@@ -335,6 +420,7 @@ transport_send_pkt(int fd, int type, void *data_in, size_t len_in)
 	dis_clear_buf(tp);
 	dis_resize_buf(tp, len_in + PKT_HDR_SZ);
 	strcpy(tp->tdis_data, PKT_MAGIC);
+	tp->tdis_wire = DIS_WIRE_ASCII;
 	*(tp->tdis_data + PKT_MAGIC_SZ) = (char) type;
 	tp->tdis_pos = tp->tdis_data + PKT_HDR_SZ;
 
@@ -388,6 +474,7 @@ static int
 __recv_pkt(int fd, int *type, pbs_dis_buf_t *tp)
 {
 	int i;
+	int wire;
 	size_t datasz;
 	char pkthdr[PKT_HDR_SZ];
 
@@ -395,7 +482,11 @@ __recv_pkt(int fd, int *type, pbs_dis_buf_t *tp)
 	i = transport_recv(fd, (void *) &pkthdr, PKT_HDR_SZ);
 	if (i != PKT_HDR_SZ)
 		return (i < 0 ? i : -1);
-	if (strncmp(pkthdr, PKT_MAGIC, PKT_MAGIC_SZ) != 0) {
+	if (strncmp(pkthdr, PKT_MAGIC, PKT_MAGIC_SZ) == 0)
+		wire = DIS_WIRE_ASCII;
+	else if (strncmp(pkthdr, PKT_MAGIC_BIN, PKT_MAGIC_SZ) == 0)
+		wire = DIS_WIRE_BIN;
+	else {
 		/* no pkt magic match, reject data/connection */
 		return -1;
 	}
@@ -427,6 +518,7 @@ __recv_pkt(int fd, int *type, pbs_dis_buf_t *tp)
 	}
 	tp->tdis_pos = tp->tdis_data;
 	tp->tdis_len = datasz;
+	tp->tdis_wire = wire;
 	return datasz;
 }
 
@@ -733,15 +825,15 @@ dis_gets(int fd, char *str, size_t ct)
 
 /**
  * @brief
- * 	dis_puts - dis support routine to put a counted string of characters
- *	into the write buffer.
+ * 	__dis_puts - put a counted string of characters into the write buffer
+ * 	of a channel.  An empty buffer starts a new packet in the channel's
+ * 	current wire encoding.
  *
- * @param[in] fd - file descriptor
+ * @param[in] chan - the channel
  * @param[in] str - string to be written
  * @param[in] ct - count
  *
  * @return	int
- *
  * @retval	>= 0	the number of characters placed
  * @retval	-1 	if error
  *
@@ -751,17 +843,16 @@ dis_gets(int fd, char *str, size_t ct)
  * @par MT-safe: Yes
  *
  */
-int
-dis_puts(int fd, const char *str, size_t ct)
+static int
+__dis_puts(pbs_tcp_chan_t *chan, const char *str, size_t ct)
 {
-	pbs_dis_buf_t *tp = dis_get_writebuf(fd);
+	pbs_dis_buf_t *tp = &(chan->writebuf);
 
-	if (tp == NULL)
-		return -1;
 	if (tp->tdis_len <= 0) {
 		if (dis_resize_buf(tp, ct + PKT_HDR_SZ) != 0)
 			return -1;
-		strcpy(tp->tdis_data, PKT_MAGIC);
+		strcpy(tp->tdis_data, chan->wire == DIS_WIRE_BIN ? PKT_MAGIC_BIN : PKT_MAGIC);
+		tp->tdis_wire = chan->wire;
 		tp->tdis_pos = tp->tdis_data + PKT_HDR_SZ;
 		tp->tdis_len = PKT_HDR_SZ;
 	} else {
@@ -774,6 +865,250 @@ dis_puts(int fd, const char *str, size_t ct)
 	return ct;
 }
 
+/**
+ * @brief
+ * 	dis_puts - dis support routine to put a counted string of characters
+ *	into the write buffer.
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] str - string to be written
+ * @param[in] ct - count
+ *
+ * @return	int
+ * @retval	>= 0	the number of characters placed
+ * @retval	-1 	if error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_puts(int fd, const char *str, size_t ct)
+{
+	pbs_tcp_chan_t *chan = transport_get_chan(fd);
+
+	if (chan == NULL)
+		return -1;
+	return __dis_puts(chan, str, ct);
+}
+
+/**
+ * @brief
+ * 	dis_set_wire - set the wire encoding of the packets written to a
+ * 	connection from the next packet on.  Only select DIS_WIRE_BIN once
+ * 	the peer has said it reads it; every peer reads DIS_WIRE_ASCII.
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] wire - DIS_WIRE_ASCII or DIS_WIRE_BIN
+ *
+ * @return void
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+void
+dis_set_wire(int fd, int wire)
+{
+	pbs_tcp_chan_t *chan = transport_get_chan(fd);
+
+	if (chan == NULL)
+		return;
+	chan->wire = wire;
+}
+
+/**
+ * @brief
+ * 	dis_get_read_wire - get the wire encoding of the last packet read
+ * 	from a connection
+ *
+ * @param[in] fd - file descriptor
+ *
+ * @return int
+ * @retval DIS_WIRE_ASCII or DIS_WIRE_BIN
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_get_read_wire(int fd)
+{
+	pbs_dis_buf_t *tp = dis_get_readbuf(fd);
+
+	if (tp == NULL)
+		return DIS_WIRE_ASCII;
+	return tp->tdis_wire;
+}
+
+/**
+ * @brief
+ * 	dis_get_write_wire - get the wire encoding of the packet being written
+ * 	to a connection, or of the next one if none is started
+ *
+ * @param[in] fd - file descriptor
+ *
+ * @return int
+ * @retval DIS_WIRE_ASCII or DIS_WIRE_BIN
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_get_write_wire(int fd)
+{
+	pbs_tcp_chan_t *chan = transport_get_chan(fd);
+
+	if (chan == NULL)
+		return DIS_WIRE_ASCII;
+	return (chan->writebuf.tdis_len > 0 ? chan->writebuf.tdis_wire : chan->wire);
+}
+
+/**
+ * @brief
+ * 	dis_bin_encode - write the DIS_WIRE_BIN form of an integer to memory
+ *
+ * @par	The first byte holds the sign in its low bit and the low six bits
+ *	of the magnitude above it, each following byte seven more bits of the
+ *	magnitude.  The high bit of a byte is set when another byte follows.
+ *
+ * @param[in] cp - where to write, room for DIS_BIN_MAXNUM bytes
+ * @param[in] negate - non-zero if the value is negative
+ * @param[in] value - magnitude of the value
+ *
+ * @return	char *
+ * @retval	pointer just past the bytes written
+ *
+ * @par MT-safe: Yes
+ *
+ */
+char *
+dis_bin_encode(char *cp, int negate, u_Long value)
+{
+	unsigned int c;
+
+	c = (negate ? 1 : 0) | (unsigned int) ((value & 0x3f) << 1);
+	value >>= 6;
+	while (value) {
+		*cp++ = (char) (c | 0x80);
+		c = (unsigned int) (value & 0x7f);
+		value >>= 7;
+	}
+	*cp++ = (char) c;
+	return cp;
+}
+
+/**
+ * @brief
+ * 	disw_num - write an integer in the wire encoding of the packet being
+ * 	written, as diswul() and friends would.
+ *
+ * @param[in] fd - file descriptor
+ * @param[in] negate - non-zero if the value is negative
+ * @param[in] value - magnitude of the value
+ *
+ * @return	int
+ * @retval	DIS_SUCCESS	success
+ * @retval	DIS_PROTO	error
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+disw_num(int fd, int negate, u_Long value)
+{
+	pbs_tcp_chan_t *chan = transport_get_chan(fd);
+	pbs_dis_buf_t *tp;
+	char buf[DIS_BUFSIZ];
+	char *end = &buf[DIS_BUFSIZ];
+	char *cp;
+	unsigned ndigs;
+	int wire;
+
+	if (chan == NULL)
+		return DIS_PROTO;
+
+	tp = &(chan->writebuf);
+	wire = tp->tdis_len > 0 ? tp->tdis_wire : chan->wire;
+	if (wire == DIS_WIRE_BIN) {
+		cp = dis_bin_encode(buf, negate, value);
+		return __dis_puts(chan, buf, cp - buf) < 0 ? DIS_PROTO : DIS_SUCCESS;
+	}
+
+	cp = discull_(end, value, &ndigs);
+	*--cp = negate ? '-' : '+';
+	while (ndigs > 1)
+		cp = discui_(cp, ndigs, &ndigs);
+	return __dis_puts(chan, cp, end - cp) < 0 ? DIS_PROTO : DIS_SUCCESS;
+}
+
+/**
+ * @brief
+ * 	disr_bin_num - read an integer if the packet being read is in the
+ * 	DIS_WIRE_BIN encoding.  The bytes are taken straight from the read
+ * 	buffer.
+ *
+ * @param[in] fd - file descriptor
+ * @param[out] negate - set if the value is negative
+ * @param[out] value - magnitude of the value
+ *
+ * @return	int
+ * @retval	DIS_NOTBIN	the packet is Data-is-Strings, nothing was read
+ * @retval	DIS_SUCCESS	success
+ * @retval	!DIS_SUCCESS	error (see dis.h)
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+disr_bin_num(int fd, int *negate, u_Long *value)
+{
+	pbs_dis_buf_t *tp = dis_get_readbuf(fd);
+	u_Long locval;
+	unsigned int c;
+	int shift;
+	int unused;
+	int i;
+
+	if (tp == NULL)
+		return DIS_NOTBIN;
+	if (tp->tdis_len <= 0) {
+		/* not enough data, try to get more */
+		dis_clear_buf(tp);
+		if ((i = __recv_pkt(fd, &unused, tp)) <= 0) {
+			dis_clear_buf(tp);
+			return (i == -2 ? DIS_EOF : DIS_EOD);
+		}
+	}
+	if (tp->tdis_wire != DIS_WIRE_BIN)
+		return DIS_NOTBIN;
+
+	c = (unsigned char) *tp->tdis_pos++;
+	tp->tdis_len--;
+	*negate = c & 1;
+	locval = (c >> 1) & 0x3f;
+	for (shift = 6; c & 0x80; shift += 7) {
+		if (tp->tdis_len <= 0)
+			return (DIS_EOD);
+		c = (unsigned char) *tp->tdis_pos++;
+		tp->tdis_len--;
+		if (shift >= 64 || (shift > 57 && ((u_Long) (c & 0x7f) >> (64 - shift)) != 0))
+			return (DIS_OVERFLOW);
+		locval |= (u_Long) (c & 0x7f) << shift;
+	}
+	*value = locval;
+	return (DIS_SUCCESS);
+}
+
 /**
  * @brief
  *	flush dis write buffer
@@ -808,6 +1143,52 @@ dis_flush(int fd)
 	return 0;
 }
 
+/**
+ * @brief
+ *	flush dis write buffer into memory instead of the network
+ *
+ *	The pending pkt is sealed exactly as dis_flush() would send it and
+ *	appended to the caller's buffer, so the bytes in out can later be
+ *	written to fd as is, by any thread, without touching the channel.
+ *	The write buffer of fd is left empty.
+ *
+ * @param[in] - fd - file descriptor
+ * @param[in,out] - out - buffer to append the sealed pkt to,
+ *			  tdis_len is the number of bytes in it
+ *
+ * @return int
+ *
+ * @retval  0 on success
+ * @retval -1 on error
+ *
+ * @par Side Effects:
+ *	None
+ *
+ * @par MT-safe: Yes
+ *
+ */
+int
+dis_flush_to(int fd, pbs_dis_buf_t *out)
+{
+	pbs_dis_buf_t *tp = dis_get_writebuf(fd);
+
+	if (tp == NULL || out == NULL)
+		return -1;
+	if (tp->tdis_len == 0)
+		return 0;
+	if (__seal_pkt(fd, tp, 0) != 0)
+		return -1;
+	if (out->tdis_len == 0)
+		out->tdis_pos = out->tdis_data;
+	if (dis_resize_buf(out, tp->tdis_len) != 0)
+		return -1;
+	memcpy(out->tdis_data + out->tdis_len, tp->tdis_data, tp->tdis_len);
+	out->tdis_len += tp->tdis_len;
+	out->tdis_pos = out->tdis_data + out->tdis_len;
+	dis_clear_buf(tp);
+	return 0;
+}
+
 /**
  * @brief
  * 	dis_destroy_chan - release structures associated with fd
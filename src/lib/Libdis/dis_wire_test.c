@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	dis_wire_test.c
+ * @brief
+ *	Unit test of the DIS wire encodings.
+ *
+ *	Writes integers, strings, floats and doubles, zero among them, to one
+ *	end of a socket pair in Data-is-Strings and then in DIS_WIRE_BIN, and
+ *	checks that the other end reads back the same values in the same
+ *	order.  Exits 0 on success, 1 on failure.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "libpbs.h"
+#include "dis.h"
+
+extern void dis_init_tables(void);
+
+static double values[] = {0.0, 1.5, -2.25, 0.0, 1.0e30, -3.0e-20, 0.0};
+#define NUM_VALUES	(sizeof(values) / sizeof(values[0]))
+
+/**
+ * @brief
+ *	write every value as a float, a double, an integer and a string, then
+ *	read them all back in the same order
+ *
+ * @param[in]	wfd - end to write
+ * @param[in]	rfd - end to read
+ * @param[in]	wire - DIS_WIRE_ASCII or DIS_WIRE_BIN
+ *
+ * @return int
+ * @retval	0 - success
+ * @retval	1 - failure
+ */
+static int
+round_trip(int wfd, int rfd, int wire)
+{
+	unsigned int i;
+	int rc;
+	float fval;
+	double dval;
+	int ival;
+	char *sval;
+
+	dis_set_wire(wfd, wire);
+	for (i = 0; i < NUM_VALUES; i++) {
+		if (diswf(wfd, values[i]) != DIS_SUCCESS ||
+		    diswd(wfd, values[i]) != DIS_SUCCESS ||
+		    diswsi(wfd, -(int)i) != DIS_SUCCESS ||
+		    diswst(wfd, "after") != DIS_SUCCESS) {
+			fprintf(stderr, "wire %d: write of value %u failed\n", wire, i);
+			return 1;
+		}
+	}
+	if (dis_flush(wfd) != 0) {
+		fprintf(stderr, "wire %d: flush failed\n", wire);
+		return 1;
+	}
+
+	for (i = 0; i < NUM_VALUES; i++) {
+		fval = disrf(rfd, &rc);
+		if (rc != DIS_SUCCESS || fval != (float)values[i]) {
+			fprintf(stderr, "wire %d: float %g read as %g, rc %d\n", wire, values[i], fval, rc);
+			return 1;
+		}
+		dval = disrd(rfd, &rc);
+		if (rc != DIS_SUCCESS || (float)dval != (float)values[i]) {
+			fprintf(stderr, "wire %d: double %g read as %g, rc %d\n", wire, values[i], dval, rc);
+			return 1;
+		}
+		ival = disrsi(rfd, &rc);
+		if (rc != DIS_SUCCESS || ival != -(int)i) {
+			fprintf(stderr, "wire %d: integer after %g read as %d, rc %d\n", wire, values[i], ival, rc);
+			return 1;
+		}
+		sval = disrst(rfd, &rc);
+		if (rc != DIS_SUCCESS || sval == NULL || strcmp(sval, "after") != 0) {
+			fprintf(stderr, "wire %d: string after %g misread, rc %d\n", wire, values[i], rc);
+			free(sval);
+			return 1;
+		}
+		free(sval);
+	}
+	if (dis_get_read_wire(rfd) != wire) {
+		fprintf(stderr, "wire %d: packets read as wire %d\n", wire, dis_get_read_wire(rfd));
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	run the round trip in both wire encodings
+ *
+ * @return int
+ * @retval	0 - success
+ * @retval	1 - failure
+ */
+int
+main(int argc, char *argv[])
+{
+	int sv[2];
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1) {
+		perror("socketpair");
+		return 1;
+	}
+	DIS_tcp_funcs();
+	dis_init_tables();
+
+	if (round_trip(sv[0], sv[1], DIS_WIRE_ASCII) || round_trip(sv[0], sv[1], DIS_WIRE_BIN)) {
+		fprintf(stderr, "dis_wire_test failed\n");
+		return 1;
+	}
+	close(sv[0]);
+	close(sv[1]);
+	printf("dis_wire_test passed\n");
+	return 0;
+}
@@ -73,6 +73,25 @@ disrsi_(int stream, int *negate, unsigned *value, unsigned count, int recursv)
 	assert(count);
 	assert(stream >= 0);
 
+	/* a binary packet holds the number itself, without counts */
+	if (recursv == 0) {
+		u_Long binval;
+
+		switch (c = disr_bin_num(stream, negate, &binval)) {
+			case DIS_NOTBIN:
+				break;
+			case DIS_SUCCESS:
+				if (binval > UINT_MAX)
+					goto overflow;
+				*value = (unsigned) binval;
+				return (DIS_SUCCESS);
+			case DIS_OVERFLOW:
+				goto overflow;
+			default:
+				return (c);
+		}
+	}
+
 	if (++recursv > DIS_RECURSIVE_LIMIT)
 		return (DIS_PROTO);
 	/* dis_umaxd would be initialized by prior call to dis_init_tables */
@@ -75,6 +75,25 @@ disrsl_(int stream, int *negate, unsigned long *value, unsigned long count, int
 	assert(count);
 	assert(stream >= 0);
 
+	/* a binary packet holds the number itself, without counts */
+	if (recursv == 0) {
+		u_Long binval;
+
+		switch (c = disr_bin_num(stream, negate, &binval)) {
+			case DIS_NOTBIN:
+				break;
+			case DIS_SUCCESS:
+				if (binval > ULONG_MAX)
+					goto overflow;
+				*value = (unsigned long) binval;
+				return (DIS_SUCCESS);
+			case DIS_OVERFLOW:
+				goto overflow;
+			default:
+				return (c);
+		}
+	}
+
 	if (++recursv > DIS_RECURSIVE_LIMIT)
 		return (DIS_PROTO);
 
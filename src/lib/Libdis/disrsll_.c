@@ -92,6 +92,23 @@ disrsll_(int stream, int *negate, u_Long *value, unsigned long count, int recurs
 	assert(count);
 	assert(stream >= 0);
 
+	/* a binary packet holds the number itself, without counts */
+	if (recursv == 0) {
+		u_Long binval;
+
+		switch (c = disr_bin_num(stream, negate, &binval)) {
+			case DIS_NOTBIN:
+				break;
+			case DIS_SUCCESS:
+				*value = binval;
+				return (DIS_SUCCESS);
+			case DIS_OVERFLOW:
+				goto overflow;
+			default:
+				return (c);
+		}
+	}
+
 	if (++recursv > DIS_RECURSIVE_LIMIT)
 		return (DIS_PROTO);
 
@@ -88,27 +88,9 @@
 int
 diswsi(int stream, int value)
 {
-	int		retval;
-	unsigned	ndigs;
-	unsigned	uval;
-	char		c;
-	char		*cp;
-
 	assert(stream >= 0);
 
-	if (value < 0) {
-		uval = (unsigned)-(value + 1) + 1;
-		c = '-';
-	} else {
-		uval = value;
-		c = '+';
-	}
-	cp = discui_(&dis_buffer[DIS_BUFSIZ], uval, &ndigs);
-	*--cp = c;
-	while (ndigs > 1)
-		cp = discui_(cp, ndigs, &ndigs);
-	retval = dis_puts(stream, cp,
-		(size_t)(&dis_buffer[DIS_BUFSIZ] - cp)) < 0 ?
-		DIS_PROTO : DIS_SUCCESS;
-	return retval;
+	if (value < 0)
+		return (disw_num(stream, 1, (u_Long) -(value + 1) + 1));
+	return (disw_num(stream, 0, (u_Long) value));
 }
@@ -88,27 +88,9 @@
 int
 diswsl(int stream, long value)
 {
-	int		retval;
-	unsigned	ndigs;
-	unsigned long	ulval;
-	char		c;
-	char		*cp;
-
 	assert(stream >= 0);
 
-	if (value < 0) {
-		ulval = (unsigned long)-(value + 1) + 1;
-		c = '-';
-	} else {
-		ulval = value;
-		c = '+';
-	}
-	cp = discul_(&dis_buffer[DIS_BUFSIZ], ulval, &ndigs);
-	*--cp = c;
-	while (ndigs > 1)
-		cp = discui_(cp, ndigs, &ndigs);
-	retval = dis_puts(stream, cp,
-		(size_t)(&dis_buffer[DIS_BUFSIZ] - cp)) < 0 ?
-		DIS_PROTO : DIS_SUCCESS;
-	return retval;
+	if (value < 0)
+		return (disw_num(stream, 1, (u_Long) -(value + 1) + 1));
+	return (disw_num(stream, 0, (u_Long) value));
 }
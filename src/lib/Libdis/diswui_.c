@@ -64,16 +64,7 @@
 int
 diswui_(int stream, unsigned value)
 {
-	unsigned	ndigs;
-	char		*cp;
-
 	assert(stream >= 0);
 
-	cp = discui_(&dis_buffer[DIS_BUFSIZ], value, &ndigs);
-	*--cp = '+';
-	while (ndigs > 1)
-		cp = discui_(cp, ndigs, &ndigs);
-	if (dis_puts(stream, cp, (size_t)(&dis_buffer[DIS_BUFSIZ] - cp)) < 0)
-		return (DIS_PROTO);
-	return (DIS_SUCCESS);
+	return (disw_num(stream, 0, (u_Long) value));
 }
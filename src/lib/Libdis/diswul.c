@@ -88,17 +88,7 @@
 int
 diswul(int stream, unsigned long value)
 {
-	int		retval;
-	unsigned	ndigs;
-	char		*cp;
-
 	assert(stream >= 0);
-	cp = discul_(&dis_buffer[DIS_BUFSIZ], value, &ndigs);
-	*--cp = '+';
-	while (ndigs > 1)
-		cp = discui_(cp, ndigs, &ndigs);
-	retval = dis_puts(stream, cp,
-		(size_t)(&dis_buffer[DIS_BUFSIZ] - cp)) < 0 ?
-		DIS_PROTO : DIS_SUCCESS;
-	return retval;
+
+	return (disw_num(stream, 0, (u_Long) value));
 }
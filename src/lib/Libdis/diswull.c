@@ -90,19 +90,7 @@
 int
 diswull(int stream, u_Long value)
 {
-	int		retval;
-	unsigned	ndigs;
-	char		*cp;
-
 	assert(stream >= 0);
 
-
-	cp = discull_(&dis_buffer[DIS_BUFSIZ], value, &ndigs);
-	*--cp = '+';
-	while (ndigs > 1)
-		cp = discui_(cp, ndigs, &ndigs);
-	retval = dis_puts(stream, cp,
-		(size_t)(&dis_buffer[DIS_BUFSIZ] - cp)) < 0 ?
-		DIS_PROTO : DIS_SUCCESS;
-	return retval;
+	return (disw_num(stream, 0, value));
 }
@@ -79,6 +79,8 @@ decode_DIS_Status(int sock, struct batch_request *preq)
 	size_t nchars = 0;
 
 	preq->rq_ind.rq_status.rq_id = NULL;
+	preq->rq_ind.rq_status.rq_cursor = 0;
+	preq->rq_ind.rq_status.rq_limit = 0;
 
 	CLEAR_HEAD(preq->rq_ind.rq_status.rq_attr);
 
@@ -92,3 +94,35 @@ decode_DIS_Status(int sock, struct batch_request *preq)
 	rc = decode_DIS_svrattrl(sock, &preq->rq_ind.rq_status.rq_attr);
 	return rc;
 }
+
+/**
+ * @brief
+ *	Decode a paginated Status Job batch request
+ *
+ * @par
+ *	Same as decode_DIS_Status() followed by the cursor and page size.
+ *
+ * @param[in]     sock - socket handle from which to read.
+ * @param[in,out] preq - pointer to the batch request structure. In addition
+ *		to the elements set by decode_DIS_Status(), updates:
+ *		rq_cursor - cursor returned with the previous page, 0 for the first
+ *		rq_limit  - maximum number of jobs in the page
+ *
+ * @return int
+ * @retval 0 - request read and decoded successfully.
+ * @retval non-zero - DIS decode error.
+ */
+int
+decode_DIS_StatusPage(int sock, struct batch_request *preq)
+{
+	int rc;
+
+	if ((rc = decode_DIS_Status(sock, preq)) != 0)
+		return rc;
+
+	preq->rq_ind.rq_status.rq_cursor = disrui(sock, &rc);
+	if (rc) return rc;
+
+	preq->rq_ind.rq_status.rq_limit = disrui(sock, &rc);
+	return rc;
+}
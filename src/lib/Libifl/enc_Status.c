@@ -43,10 +43,13 @@
  * @file	enc_Status.c
  * @brief
  * encode_DIS_Status() - encode a Status Job Batch Request
+ * encode_DIS_StatusPage() - encode a paginated Status Job Batch Request
  *
  * @par Data items are:
  * 			string		object id
  *			list of		attrl
+ *			unsigned int	cursor (StatusJobPage only)
+ *			unsigned int	page size (StatusJobPage only)
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -80,3 +83,32 @@ encode_DIS_Status(int sock, char *objid, struct attrl *pattrl)
 
 	return 0;
 }
+
+/**
+ * @brief
+ *	-encode a paginated Status Job Batch Request
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] objid - object id
+ * @param[in] pattrl - pointer to attrl struct(list)
+ * @param[in] cursor - cursor returned with the previous page, 0 for the first
+ * @param[in] limit - maximum number of jobs in the page
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+encode_DIS_StatusPage(int sock, char *objid, struct attrl *pattrl, int cursor, int limit)
+{
+	int   rc;
+
+	if ((rc = encode_DIS_Status(sock, objid, pattrl)) != 0 ||
+		(rc = diswui(sock, cursor)) != 0 ||
+		(rc = diswui(sock, limit)) != 0)
+			return rc;
+
+	return 0;
+}
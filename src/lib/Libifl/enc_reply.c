@@ -56,7 +56,7 @@
 #include "dis.h"
 #include "net_connect.h"
 
-int encode_DIS_svrattrl(int sock, svrattrl *psattl);
+int encode_DIS_svrattrl_blobs(int sock, svrattrl *psattl, svrattrl_blob **pblobs, int nblobs);
 
 
 /**
@@ -140,7 +140,7 @@ encode_DIS_reply_inner(int sock, struct batch_reply *reply)
 					return rc;
 
 				psvrl = (svrattrl *) GET_NEXT(pstat->brp_attr);
-				if ((rc = encode_DIS_svrattrl(sock, psvrl)) != 0)
+				if ((rc = encode_DIS_svrattrl_blobs(sock, psvrl, pstat->brp_blobs, pstat->brp_nblobs)) != 0)
 					return rc;
 				pstat = (struct brp_status *) GET_NEXT(pstat->brp_stlink);
 			}
@@ -43,6 +43,10 @@
  * @file	enc_svrattrl.c
  * @brief
  * encode_DIS_svrattrl() - encode a list of server "svrattrl" structures
+ * encode_DIS_svrattrl_blobs() - encode a svrattrl list followed by
+ *	pre-encoded attribute blobs
+ * encode_svrattrl_blob() - build the pre-encoded blob for a svrattrl list
+ * blob_bin_encode() - build the DIS_WIRE_BIN form of a blob on first use
  *
  *	The first item encoded is a unsigned integer, a count of the
  *	number of svrattrl entries in the linked list.  This is encoded
@@ -66,11 +70,20 @@
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include "libpbs.h"
 #include "list_link.h"
 #include "attribute.h"
 #include "dis.h"
 
+int encode_DIS_svrattrl_blobs(int sock, svrattrl *psattl, svrattrl_blob **pblobs, int nblobs);
+static char *blob_bin_encode(svrattrl_blob *pblob);
+
+/* serializes building the binary form of a blob shared between threads */
+static pthread_mutex_t blob_bin_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * @brief
  *	-encode a list of server "svrattrl" structures
@@ -100,10 +113,39 @@
 
 int
 encode_DIS_svrattrl(int sock, svrattrl *psattl)
+{
+	return (encode_DIS_svrattrl_blobs(sock, psattl, NULL, 0));
+}
+
+/**
+ * @brief
+ *	encode a list of server "svrattrl" structures followed by the
+ *	entries held in pre-encoded attribute blobs
+ *
+ * @par	Functionality:
+ *		The count sent first covers both the svrattrl entries and the
+ *		entries in the blobs, so the result is decoded exactly as if
+ *		all of the entries had been in the svrattrl list.  The blob
+ *		contents are copied to the stream as they are.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] psattl - pointer to svr attr list
+ * @param[in] pblobs - array of pre-encoded blobs, may be NULL
+ * @param[in] nblobs - number of entries in pblobs
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+encode_DIS_svrattrl_blobs(int sock, svrattrl *psattl, svrattrl_blob **pblobs, int nblobs)
 {
 	unsigned int ct = 0;
 	unsigned int name_len;
 	svrattrl *ps;
+	int i;
 	int rc;
 
 	/* count how many */
@@ -111,6 +153,8 @@ encode_DIS_svrattrl(int sock, svrattrl *psattl)
 	for (ps = psattl; ps; ps = (svrattrl *)GET_NEXT(ps->al_link)) {
 		++ct;
 	}
+	for (i = 0; i < nblobs; i++)
+		ct += pblobs[i]->sb_count;
 
 	if ((rc = diswui(sock, ct)) != 0)
 		return rc;
@@ -139,5 +183,295 @@ encode_DIS_svrattrl(int sock, svrattrl *psattl)
 			(rc = diswui(sock, (unsigned int)ps->al_op)))
 				break;
 	}
-	return rc;
+	if (rc != 0)
+		return rc;
+
+	if (nblobs > 0 && dis_get_write_wire(sock) == DIS_WIRE_BIN) {
+		for (i = 0; i < nblobs; i++) {
+			char *bin;
+
+			if (pblobs[i]->sb_len == 0)
+				continue;
+			if ((bin = blob_bin_encode(pblobs[i])) == NULL)
+				return DIS_NOMALLOC;
+			if (dis_puts(sock, bin, pblobs[i]->sb_bin_len) != pblobs[i]->sb_bin_len)
+				return DIS_PROTO;
+		}
+		return DIS_SUCCESS;
+	}
+
+	for (i = 0; i < nblobs; i++) {
+		if (pblobs[i]->sb_len == 0)
+			continue;
+		if (dis_puts(sock, pblobs[i]->sb_data, pblobs[i]->sb_len) != pblobs[i]->sb_len)
+			return DIS_PROTO;
+	}
+	return DIS_SUCCESS;
+}
+
+/*
+ * longest DIS unsigned integer: the value, its sign and the chain of
+ * digit counts in front of it
+ */
+#define DIS_MEM_UINT_MAX 64
+
+/**
+ * @brief
+ *	mem_diswul - append the Data-is-Strings form of an unsigned integer
+ *	to a memory buffer, as diswul() would write it to a stream.
+ *
+ * @param[in] cp - where to write
+ * @param[in] value - value to write
+ *
+ * @return	char *
+ * @retval	pointer just past the characters written
+ */
+
+static char *
+mem_diswul(char *cp, unsigned long value)
+{
+	char buf[DIS_MEM_UINT_MAX];
+	char *end = &buf[DIS_MEM_UINT_MAX];
+	char *start;
+	char *bp = end;
+	unsigned long ndigs;
+
+	do {
+		*--bp = '0' + (char)(value % 10);
+		value /= 10;
+	} while (value);
+	ndigs = end - bp;
+	*--bp = '+';
+	while (ndigs > 1) {
+		start = bp;
+		do {
+			*--bp = '0' + (char)(ndigs % 10);
+			ndigs /= 10;
+		} while (ndigs);
+		ndigs = start - bp;
+	}
+	memcpy(cp, bp, end - bp);
+	return (cp + (end - bp));
+}
+
+/**
+ * @brief
+ *	mem_disrul - read an unsigned integer in the Data-is-Strings form
+ *	written by mem_diswul() back from a memory buffer.
+ *
+ * @param[in,out] cpp - where to read, moved past the characters read
+ *
+ * @return	unsigned long
+ * @retval	the value read
+ */
+
+static unsigned long
+mem_disrul(const char **cpp)
+{
+	const char *cp = *cpp;
+	unsigned long count = 1;
+	unsigned long value;
+	int is_value;
+
+	for (;;) {
+		if ((is_value = (*cp == '+')))
+			cp++;
+		for (value = 0; count > 0; count--)
+			value = value * 10 + (unsigned long)(*cp++ - '0');
+		if (is_value)
+			break;
+		count = value;
+	}
+	*cpp = cp;
+	return value;
+}
+
+/**
+ * @brief
+ *	mem_diswcs - append the Data-is-Strings form of a counted string
+ *	to a memory buffer, as diswcs() would write it to a stream.
+ *
+ * @param[in] cp - where to write
+ * @param[in] value - string to write
+ * @param[in] nchars - length of value
+ *
+ * @return	char *
+ * @retval	pointer just past the characters written
+ */
+
+static char *
+mem_diswcs(char *cp, const char *value, size_t nchars)
+{
+	cp = mem_diswul(cp, (unsigned long)nchars);
+	if (nchars > 0) {
+		memcpy(cp, value, nchars);
+		cp += nchars;
+	}
+	return cp;
+}
+
+/**
+ * @brief
+ *	mem_bin_cs - append the DIS_WIRE_BIN form of a counted string to a
+ *	memory buffer, as diswcs() would write it to a binary stream.
+ *
+ * @param[in] cp - where to write
+ * @param[in] value - string to write
+ * @param[in] nchars - length of value
+ *
+ * @return	char *
+ * @retval	pointer just past the bytes written
+ */
+
+static char *
+mem_bin_cs(char *cp, const char *value, size_t nchars)
+{
+	cp = dis_bin_encode(cp, 0, (u_Long)nchars);
+	if (nchars > 0) {
+		memcpy(cp, value, nchars);
+		cp += nchars;
+	}
+	return cp;
+}
+
+/**
+ * @brief
+ *	encode_svrattrl_blob - encode a list of svrattrl entries, in the
+ *	form used by encode_DIS_svrattrl() but without the leading count,
+ *	into a newly allocated blob.  The blob holds the entries as
+ *	Data-is-Strings; the DIS_WIRE_BIN encoding is added by
+ *	blob_bin_encode() when a binary connection first needs it.
+ *
+ * @par	The blob is returned with a reference count of one, owned by the
+ *	caller.  It is meant to be built once for an attribute value and then
+ *	sent by reference in any number of status replies.
+ *
+ * @param[in] psattl - first entry of the svrattrl list, linked by al_link
+ * @param[in] priv - non-zero if the list was encoded with PRIV_READ access
+ *
+ * @return	svrattrl_blob *
+ * @retval	pointer to the new blob
+ * @retval	NULL	on memory allocation failure
+ */
+
+svrattrl_blob *
+encode_svrattrl_blob(svrattrl *psattl, int priv)
+{
+	svrattrl_blob *pblob;
+	svrattrl *ps;
+	size_t bound = 0;
+	size_t name_len;
+	size_t resc_len;
+	size_t val_len;
+	int ct = 0;
+	char *cp;
+
+	/* each entry is three strings and three unsigned integers */
+	for (ps = psattl; ps; ps = (svrattrl *)GET_NEXT(ps->al_link)) {
+		bound += strlen(ps->al_atopl.name) + strlen(ps->al_atopl.value) +
+			6 * DIS_MEM_UINT_MAX;
+		if (ps->al_rescln)
+			bound += strlen(ps->al_atopl.resource);
+		++ct;
+	}
+
+	pblob = malloc(sizeof(svrattrl_blob) + bound);
+	if (pblob == NULL)
+		return NULL;
+	pblob->sb_next = NULL;
+	pblob->sb_refct = 1;
+	pblob->sb_priv = priv;
+	pblob->sb_count = ct;
+	pblob->sb_bin = NULL;
+	pblob->sb_bin_len = 0;
+
+	cp = pblob->sb_data;
+	for (ps = psattl; ps; ps = (svrattrl *)GET_NEXT(ps->al_link)) {
+		name_len = strlen(ps->al_atopl.name);
+		val_len = strlen(ps->al_atopl.value);
+		resc_len = ps->al_atopl.resource ? strlen(ps->al_atopl.resource) : 0;
+
+		/* length of three strings, including the terminating nulls */
+		cp = mem_diswul(cp, name_len + val_len + 2 + (ps->al_atopl.resource ? resc_len + 1 : 0));
+		cp = mem_diswcs(cp, ps->al_atopl.name, name_len);
+		if (ps->al_rescln) {
+			cp = mem_diswul(cp, 1);
+			cp = mem_diswcs(cp, ps->al_atopl.resource, resc_len);
+		} else
+			cp = mem_diswul(cp, 0);
+		cp = mem_diswcs(cp, ps->al_atopl.value, val_len);
+		cp = mem_diswul(cp, (unsigned int)ps->al_op);
+	}
+	pblob->sb_len = cp - pblob->sb_data;
+
+	return pblob;
+}
+
+/**
+ * @brief
+ *	blob_bin_encode - return the DIS_WIRE_BIN form of a blob, building it
+ *	from the Data-is-Strings form the first time it is asked for.
+ *
+ * @par	Most status replies go to clients that never negotiate the binary
+ *	encoding, so a blob does not pay for that form until it is sent on a
+ *	binary connection.  A blob may be sent by several reply threads at
+ *	once, so the form is built and published under blob_bin_mutex.
+ *
+ * @param[in] pblob - the blob
+ *
+ * @return	char *
+ * @retval	the binary form, pblob->sb_bin_len bytes long
+ * @retval	NULL	on memory allocation failure
+ */
+
+static char *
+blob_bin_encode(svrattrl_blob *pblob)
+{
+	const char *in;
+	const char *end;
+	char *bin;
+	char *cp;
+	unsigned long len;
+	unsigned long has_resc;
+
+	pthread_mutex_lock(&blob_bin_mutex);
+	if ((bin = pblob->sb_bin) != NULL) {
+		pthread_mutex_unlock(&blob_bin_mutex);
+		return bin;
+	}
+
+	/* an integer is never longer in binary than as a string */
+	if ((bin = malloc(pblob->sb_len)) == NULL) {
+		pthread_mutex_unlock(&blob_bin_mutex);
+		return NULL;
+	}
+
+	in = pblob->sb_data;
+	end = pblob->sb_data + pblob->sb_len;
+	cp = bin;
+	while (in < end) {
+		/* length of the three strings, then the attribute name */
+		cp = dis_bin_encode(cp, 0, mem_disrul(&in));
+		len = mem_disrul(&in);
+		cp = mem_bin_cs(cp, in, len);
+		in += len;
+		/* resource name, if one */
+		has_resc = mem_disrul(&in);
+		cp = dis_bin_encode(cp, 0, has_resc);
+		if (has_resc) {
+			len = mem_disrul(&in);
+			cp = mem_bin_cs(cp, in, len);
+			in += len;
+		}
+		/* value and op */
+		len = mem_disrul(&in);
+		cp = mem_bin_cs(cp, in, len);
+		in += len;
+		cp = dis_bin_encode(cp, 0, mem_disrul(&in));
+	}
+	pblob->sb_bin_len = cp - bin;
+	pblob->sb_bin = bin;
+	pthread_mutex_unlock(&blob_bin_mutex);
+
+	return bin;
 }
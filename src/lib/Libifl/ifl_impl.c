@@ -604,6 +604,27 @@ pbs_statjob(int c, char *id, struct attrl *attrib, char *extend) {
 	return (*pfn_pbs_statjob)(c, id, attrib, extend);
 }
 
+/**
+ * @brief
+ *	-Pass-through call to get one page of the status of jobs.
+ *
+ * @param[in] c - communication handle
+ * @param[in] id - queue name, or NULL/"" for all jobs at the server
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for req
+ * @param[in] limit - maximum number of jobs in the page
+ * @param[in,out] cursor - position to continue from, updated for next page
+ *
+ * @return	structure handle
+ * @retval	pointer to batch_status struct		success
+ * @retval	NULL					error or empty page
+ *
+ */
+struct batch_status *
+pbs_statjob_page(int c, char *id, struct attrl *attrib, char *extend, int limit, int *cursor) {
+	return (*pfn_pbs_statjob_page)(c, id, attrib, extend, limit, cursor);
+}
+
 /**
  * @brief
  *	-Pass-through call to SelectJob request
@@ -1222,7 +1222,7 @@ send_register_sched(int sock, const char *sched_id)
 	rc = diswst(sock, sched_id);
 	if (rc != DIS_SUCCESS)
 		goto rerr;
-	rc = encode_DIS_ReqExtend(sock, NULL);
+	rc = encode_DIS_ReqExtend(sock, EXTEND_OPT_DIS_WIRE_BIN);
 	if (rc != DIS_SUCCESS)
 		goto rerr;
 	if (dis_flush(sock) != 0)
@@ -1236,6 +1236,13 @@ send_register_sched(int sock, const char *sched_id)
 	if (pbs_errno != 0)
 		goto rerr;
 
+	/*
+	 * A server which accepted the binary encoding answered in it;
+	 * an older one ignored the extend field and answered in DIS.
+	 */
+	if (dis_get_read_wire(sock) == DIS_WIRE_BIN)
+		dis_set_wire(sock, DIS_WIRE_BIN);
+
 	PBSD_FreeReply(reply);
 	return 0;
 
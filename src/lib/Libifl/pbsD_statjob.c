@@ -46,6 +46,7 @@
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include "libpbs.h"
+#include "dis.h"
 #include "pbs_ecl.h"
 
 
@@ -68,3 +69,111 @@ __pbs_statjob(int c, char *id, struct attrl *attrib, char *extend)
 {
 	return PBSD_status_aggregate(c, PBS_BATCH_StatusJob, id, attrib, extend, MGR_OBJ_JOB, NULL);
 }
+
+/**
+ * @brief
+ *	-Return one page of the status of the jobs in a queue or the server.
+ *
+ * @par
+ *	Pass *cursor as 0 to get the first page.  On return *cursor is set to
+ *	the value to pass for the next page, or to 0 once there are no more
+ *	jobs.  An empty page is returned as NULL with pbs_errno == PBSE_NONE.
+ *	If the request names jobs rather than a queue or the server, all of
+ *	them come back in the first page.  Connections to more than one server
+ *	instance also return everything in one page, since their jobs are
+ *	spread over the instances.
+ *
+ * @param[in] c - communication handle
+ * @param[in] id - queue name, or NULL/"" for all jobs at the server
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for req
+ * @param[in] limit - maximum number of jobs in the page, 0 for the default
+ * @param[in,out] cursor - position to continue from, updated for next page
+ *
+ * @return	structure handle
+ * @retval	pointer to batch_status struct		success
+ * @retval	NULL					error or empty page
+ *
+ */
+struct batch_status *
+__pbs_statjob_page(int c, char *id, struct attrl *attrib, char *extend, int limit, int *cursor)
+{
+	struct batch_status *ret = NULL;
+	struct batch_reply *reply;
+	svr_conn_t **svr_conns;
+	int rc;
+
+	if (cursor == NULL || limit < 0) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+
+	if (get_num_servers() > 1) {
+		*cursor = 0;
+		return __pbs_statjob(c, id, attrib, extend);
+	}
+
+	if ((svr_conns = get_conn_svr_instances(c)) == NULL)
+		return NULL;
+
+	if ((c = random_srv_conn(c, svr_conns)) < 0)
+		return NULL;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	/* first verify the attributes, if verification is enabled */
+	if (pbs_verify_attributes(c, PBS_BATCH_StatusJob, MGR_OBJ_JOB, MGR_CMD_NONE, (struct attropl *) attrib))
+		return NULL;
+
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	if (id == NULL)
+		id = "";
+
+	DIS_tcp_funcs();
+
+	if ((rc = encode_DIS_ReqHdr(c, PBS_BATCH_StatusJobPage, pbs_current_user)) ||
+		(rc = encode_DIS_StatusPage(c, id, attrib, *cursor, limit)) ||
+		(rc = encode_DIS_ReqExtend(c, extend))) {
+		if (set_conn_errtxt(c, dis_emsg[rc]) != 0)
+			pbs_errno = PBSE_SYSTEM;
+		else
+			pbs_errno = PBSE_PROTOCOL;
+		(void)pbs_client_thread_unlock_connection(c);
+		return NULL;
+	}
+	if (dis_flush(c)) {
+		pbs_errno = PBSE_PROTOCOL;
+		(void)pbs_client_thread_unlock_connection(c);
+		return NULL;
+	}
+
+	reply = PBSD_rdrpy(c);
+	if (reply == NULL) {
+		if (pbs_errno == PBSE_NONE)
+			pbs_errno = PBSE_PROTOCOL;
+	} else if (reply->brp_choice != BATCH_REPLY_CHOICE_NULL &&
+		reply->brp_choice != BATCH_REPLY_CHOICE_Text &&
+		reply->brp_choice != BATCH_REPLY_CHOICE_Status) {
+		if (pbs_errno == PBSE_NONE)
+			pbs_errno = PBSE_PROTOCOL;
+	} else if (get_conn_errno(c) == 0) {
+		if (reply->brp_choice == BATCH_REPLY_CHOICE_Status) {
+			ret = reply->brp_un.brp_statc;
+			reply->brp_un.brp_statc = NULL;
+		}
+		*cursor = reply->brp_auxcode;
+	}
+	PBSD_FreeReply(reply);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0) {
+		pbs_statfree(ret);
+		return NULL;
+	}
+
+	return ret;
+}
@@ -131,6 +131,9 @@ struct pbs_config pbs_conf = {
 	NULL,					/* pbs_lr_save_path */
 	0,					/* high resolution timestamp logging */
 	0,					/* number of scheduler threads */
+	0,					/* number of server reply threads, none */
+	0,					/* asynchronous logging, off */
+	0,					/* number of server helper processes, none */
 	NULL,					/* default scheduler user */
 	{'\0'}					/* current running user */
 #ifdef WIN32
@@ -676,6 +679,18 @@ __pbs_loadconf(int reload)
 				if (sscanf(conf_value, "%u", &uvalue) == 1)
 					pbs_conf.pbs_sched_threads = uvalue;
 			}
+			else if (!strcmp(conf_name, PBS_CONF_SERVER_REPLY_THREADS)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_server_reply_threads = uvalue;
+			}
+			else if (!strcmp(conf_name, PBS_CONF_LOG_ASYNC)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_log_async = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_SERVER_HELPERS)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_server_helpers = uvalue;
+			}
 #ifdef WIN32
 			else if (!strcmp(conf_name, PBS_CONF_REMOTE_VIEWER)) {
 				free(pbs_conf.pbs_conf_remote_viewer);
@@ -924,6 +939,18 @@ __pbs_loadconf(int reload)
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
 			pbs_conf.pbs_sched_threads = uvalue;
 	}
+	if ((gvalue = getenv(PBS_CONF_SERVER_REPLY_THREADS)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_server_reply_threads = uvalue;
+	}
+	if ((gvalue = getenv(PBS_CONF_LOG_ASYNC)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_log_async = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_SERVER_HELPERS)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_server_helpers = uvalue;
+	}
 
 	if ((gvalue = getenv(PBS_CONF_DAEMON_SERVICE_USER)) != NULL) {
 		free(pbs_conf.pbs_daemon_service_user);
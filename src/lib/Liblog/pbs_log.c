@@ -67,6 +67,9 @@
 #include <signal.h>
 #include <stddef.h>
 #include <stdarg.h>
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
 
 #include "log.h"
 #include "pbs_ifl.h"
@@ -141,6 +144,52 @@ static void get_timestamp(ms_time *mst);
 static void log_record_inner(int eventtype, int objclass, int sev, const char *objname, const char *text, ms_time *mst);
 static void log_console_error(char *);
 
+#ifndef WIN32
+/*
+ * Asynchronous logging, see log_async_start().  log_record() formats the
+ * record on the calling thread and queues it on a bounded lock-free ring;
+ * a writer thread takes records off the ring and writes them out in
+ * batches with writev().  The ring follows the usual sequence-numbered
+ * slot design, so it takes any number of producers and consumers: the
+ * writer is the consumer, and a crash handler can drain it too.  Records
+ * for other files of the daemon, e.g. the server's accounting log, go
+ * through the same ring, see log_async_queue_fd().
+ */
+#define LOG_ASYNC_SLOTS		8192	/* ring size, must be a power of 2 */
+#define LOG_ASYNC_BATCH		64	/* records per writev() */
+#define LOG_ASYNC_WAIT_MS	100	/* producer wait for room before dropping */
+#define LOG_ASYNC_DRAIN_MS	5000	/* longest wait to drain on log_close() */
+
+typedef struct {
+	unsigned long la_seq;	/* slot sequence, see log_async_put() */
+	char *la_rec;		/* formatted record, malloc'ed */
+	int la_len;		/* length of la_rec */
+	int la_yday;		/* day of the record, for the log switch */
+	int la_fd;		/* file to write to, -1 for the daemon log */
+} log_async_slot;
+
+static log_async_slot *log_async_ring;
+static unsigned long log_async_tail;	/* next slot to fill */
+static unsigned long log_async_head;	/* next slot to write */
+static int log_async_on = 0;		/* async mode active in this process */
+static int log_async_stop = 0;		/* writer must not take more records */
+static int log_async_busy = 0;		/* writer is working on a batch */
+static int log_async_idle = 0;		/* writer waits on log_async_cond */
+static unsigned long log_async_dropped = 0;	/* records dropped, ring full */
+static unsigned long log_async_stalls = 0;	/* producers that found the ring full */
+static pthread_t log_async_tid;
+static pthread_mutex_t log_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_async_cond = PTHREAD_COND_INITIALIZER;
+
+/* per thread cache of the formatted time stamp for the current second */
+static __thread time_t log_stamp_sec = (time_t) -1;
+static __thread int log_stamp_yday;
+static __thread char log_stamp_buf[72];	/* room for six ints of any value */
+
+static void log_async_record(int eventtype, int objclass, const char *objname, const char *text);
+static void log_async_drain(void);
+#endif
+
 void
 set_log_conf(char *leafname, char *nodename,
 		unsigned int islocallog, unsigned int sl_fac, unsigned int sl_svr,
@@ -357,6 +406,8 @@ log_parent_post_fork_handler()
 static void
 log_child_post_fork_handler()
 {
+	/* the writer thread is not copied, log synchronously in the child */
+	log_async_on = 0;
 	log_mutex_unlock();
 }
 #endif
@@ -1019,6 +1070,13 @@ log_record(int eventtype, int objclass, int sev, const char *objname, const char
 	if ((text == NULL) || (objname == NULL))
 		goto sigunblock;
 
+#ifndef WIN32
+	if (__atomic_load_n(&log_async_on, __ATOMIC_ACQUIRE)) {
+		log_async_record(eventtype, objclass, objname, text);
+		goto sigunblock;
+	}
+#endif
+
 	/* lock the file mutex */
 	if (log_mutex_lock() == 0) {
 		get_timestamp(&mst);
@@ -1095,6 +1153,20 @@ log_record_inner(int eventtype, int objclass, int sev, const char *objname, cons
 void
 log_close(int msg)
 {
+#ifndef WIN32
+	int locked = 0;
+
+	/*
+	 * In async mode, write out what is queued to the file being closed,
+	 * and keep the writer off the file while it is closed.  The writer
+	 * itself gets here with the mutex held, when it switches the log.
+	 */
+	if (__atomic_load_n(&log_async_on, __ATOMIC_ACQUIRE) &&
+		!pthread_equal(pthread_self(), log_async_tid)) {
+		log_async_drain();
+		locked = (log_mutex_lock() == 0);
+	}
+#endif
 	if (log_opened == 1) {
 		log_auto_switch = 0;
 		if (msg) {
@@ -1111,8 +1183,570 @@ log_close(int msg)
 		syslogopen = 0;
 	}
 #endif	/* SYSLOG */
+#ifndef WIN32
+	if (locked)
+		log_mutex_unlock();
+#endif
+}
+
+#ifndef WIN32
+/**
+ * @brief
+ *	Format the time stamp of a log record.  The text is cached per
+ *	thread and only rebuilt when the second changes.
+ *
+ * @param[in]  sec  - time of the record
+ * @param[out] yday - day of the year of the record
+ *
+ * @return	the formatted time stamp, valid until the next call
+ *
+ */
+static const char *
+log_async_stamp(time_t sec, int *yday)
+{
+	struct tm ltm;
+
+	if (sec != log_stamp_sec) {
+		if (localtime_r(&sec, &ltm) == NULL)
+			memset(&ltm, 0, sizeof(ltm));
+		snprintf(log_stamp_buf, sizeof(log_stamp_buf), "%02d/%02d/%04d %02d:%02d:%02d",
+			ltm.tm_mon + 1, ltm.tm_mday, ltm.tm_year + 1900,
+			ltm.tm_hour, ltm.tm_min, ltm.tm_sec);
+		log_stamp_yday = ltm.tm_yday;
+		log_stamp_sec = sec;
+	}
+	*yday = log_stamp_yday;
+	return log_stamp_buf;
+}
+
+/**
+ * @brief
+ *	Queue a formatted record on the async log ring
+ *
+ * @param[in] rec  - the record, ownership passes to the ring
+ * @param[in] len  - length of the record
+ * @param[in] yday - day of the year of the record
+ * @param[in] fd   - file to write to, -1 for the daemon log
+ *
+ * @return int
+ * @retval 0  - queued
+ * @retval -1 - the ring is full
+ *
+ */
+static int
+log_async_put(char *rec, int len, int yday, int fd)
+{
+	log_async_slot *slot;
+	unsigned long pos;
+	long diff;
+
+	pos = __atomic_load_n(&log_async_tail, __ATOMIC_RELAXED);
+	for (;;) {
+		slot = &log_async_ring[pos & (LOG_ASYNC_SLOTS - 1)];
+		diff = (long) (__atomic_load_n(&slot->la_seq, __ATOMIC_ACQUIRE) - pos);
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n(&log_async_tail, &pos, pos + 1, 1,
+							__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		} else if (diff < 0)
+			return -1;
+		else
+			pos = __atomic_load_n(&log_async_tail, __ATOMIC_RELAXED);
+	}
+	slot->la_rec = rec;
+	slot->la_len = len;
+	slot->la_yday = yday;
+	slot->la_fd = fd;
+	__atomic_store_n(&slot->la_seq, pos + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Take the oldest record off the async log ring
+ *
+ * @param[out] rec  - the record, to be freed by the caller
+ * @param[out] len  - length of the record
+ * @param[out] yday - day of the year of the record
+ * @param[out] fd   - file to write to, -1 for the daemon log
+ *
+ * @return int
+ * @retval 0  - a record was taken
+ * @retval -1 - the ring is empty
+ *
+ */
+static int
+log_async_get(char **rec, int *len, int *yday, int *fd)
+{
+	log_async_slot *slot;
+	unsigned long pos;
+	long diff;
+
+	pos = __atomic_load_n(&log_async_head, __ATOMIC_RELAXED);
+	for (;;) {
+		slot = &log_async_ring[pos & (LOG_ASYNC_SLOTS - 1)];
+		diff = (long) (__atomic_load_n(&slot->la_seq, __ATOMIC_ACQUIRE) - (pos + 1));
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n(&log_async_head, &pos, pos + 1, 1,
+							__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		} else if (diff < 0)
+			return -1;
+		else
+			pos = __atomic_load_n(&log_async_head, __ATOMIC_RELAXED);
+	}
+	*rec = slot->la_rec;
+	*len = slot->la_len;
+	*yday = slot->la_yday;
+	*fd = slot->la_fd;
+	__atomic_store_n(&slot->la_seq, pos + LOG_ASYNC_SLOTS, __ATOMIC_RELEASE);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Check whether a record is ready to be taken off the async log ring
+ *
+ * @return int
+ * @retval 1 - a record is ready
+ * @retval 0 - the ring is empty
+ *
+ */
+static int
+log_async_ready(void)
+{
+	unsigned long pos = __atomic_load_n(&log_async_head, __ATOMIC_RELAXED);
+	log_async_slot *slot = &log_async_ring[pos & (LOG_ASYNC_SLOTS - 1)];
+
+	return (__atomic_load_n(&slot->la_seq, __ATOMIC_ACQUIRE) == pos + 1);
+}
+
+/**
+ * @brief
+ *	Wake the writer thread if it is waiting for records
+ *
+ */
+static void
+log_async_wake(void)
+{
+	if (__atomic_load_n(&log_async_idle, __ATOMIC_SEQ_CST)) {
+		pthread_mutex_lock(&log_async_mutex);
+		pthread_cond_signal(&log_async_cond);
+		pthread_mutex_unlock(&log_async_mutex);
+	}
+}
+
+/**
+ * @brief
+ *	Queue a record for the writer thread, waiting for room if the ring
+ *	is full.  A record for the daemon log is dropped and counted if the
+ *	ring stays full for LOG_ASYNC_WAIT_MS; one for another file is never
+ *	dropped, as the writer always makes progress.
+ *
+ * @param[in] rec  - the record, ownership passes to the ring
+ * @param[in] len  - length of the record
+ * @param[in] yday - day of the year of the record
+ * @param[in] fd   - file to write to, -1 for the daemon log
+ *
+ */
+static void
+log_async_queue(char *rec, int len, int yday, int fd)
+{
+	struct timespec ts = {0, 1000000};
+	int waited;
+
+	for (waited = 0; log_async_put(rec, len, yday, fd) != 0; waited++) {
+		if (waited == 0)
+			__atomic_add_fetch(&log_async_stalls, 1, __ATOMIC_RELAXED);
+		if (fd == -1 && waited >= LOG_ASYNC_WAIT_MS) {
+			__atomic_add_fetch(&log_async_dropped, 1, __ATOMIC_RELAXED);
+			free(rec);
+			return;
+		}
+		log_async_wake();
+		nanosleep(&ts, NULL);
+	}
+	log_async_wake();
+}
+
+/**
+ * @brief
+ *	Format a log record and queue it for the writer thread.
+ *
+ * @param[in] eventtype - event type
+ * @param[in] objclass - event object class
+ * @param[in] objname - object name stating log msg related to which object
+ * @param[in] text - log msg to be logged
+ *
+ */
+static void
+log_async_record(int eventtype, int objclass, const char *objname, const char *text)
+{
+	struct timeval tv = {0, 0};
+	const char *stamp;
+	const char *dname = msg_daemonname ? msg_daemonname : "";
+	char usec[8] = "";
+	char *rec;
+	size_t sz;
+	int len;
+	int yday;
+
+	(void) gettimeofday(&tv, NULL);
+	stamp = log_async_stamp(tv.tv_sec, &yday);
+	if (pbs_log_highres_timestamp)
+		snprintf(usec, sizeof(usec), ".%06ld", (long) tv.tv_usec);
+
+	sz = strlen(stamp) + sizeof(usec) + strlen(dname) + strlen(class_names[objclass]) +
+	     strlen(objname) + strlen(text) + 24;
+	if ((rec = malloc(sz)) == NULL) {
+		__atomic_add_fetch(&log_async_dropped, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	len = snprintf(rec, sz, "%s%s;%04x;%s;%s;%s;%s\n", stamp, usec,
+		       eventtype & ~PBSEVENT_FORCE, dname,
+		       class_names[objclass], objname, text);
+
+	log_async_queue(rec, len, yday, -1);
+}
+
+/**
+ * @brief
+ *	Have the log writer thread append a record to a file of the daemon
+ *	other than its log, in order with everything else queued.  The file
+ *	must stay open until log_async_flush() returns.
+ *
+ * @param[in] fd  - file to write to
+ * @param[in] rec - the record, ownership passes to the writer on success
+ * @param[in] len - length of the record
+ *
+ * @return int
+ * @retval 0  - queued
+ * @retval -1 - async logging is off, the caller writes the record itself
+ *
+ */
+int
+log_async_queue_fd(int fd, char *rec, int len)
+{
+	if (!__atomic_load_n(&log_async_on, __ATOMIC_ACQUIRE) ||
+		pthread_equal(pthread_self(), log_async_tid))
+		return -1;
+	log_async_queue(rec, len, 0, fd);
+	return 0;
+}
+
+/**
+ * @brief
+ *	Wait for the log writer thread to write out everything queued so
+ *	far, e.g. before a file given to log_async_queue_fd() is closed.
+ *
+ */
+void
+log_async_flush(void)
+{
+	log_async_drain();
+}
+
+/**
+ * @brief
+ *	Write out a set of iovecs, picking up after partial writes
+ *
+ * @param[in] fd  - file to write to
+ * @param[in] iov - the records
+ * @param[in] cnt - number of records
+ *
+ */
+static void
+log_async_writev(int fd, struct iovec *iov, int cnt)
+{
+	ssize_t n;
+
+	while (cnt > 0) {
+		n = writev(fd, iov, cnt);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			log_console_error("PBS cannot write to its log");
+			return;
+		}
+		while (cnt > 0 && n >= (ssize_t) iov->iov_len) {
+			n -= iov->iov_len;
+			iov++;
+			cnt--;
+		}
+		if (cnt > 0) {
+			iov->iov_base = (char *) iov->iov_base + n;
+			iov->iov_len -= n;
+		}
+	}
+}
+
+/**
+ * @brief
+ *	Write a batch of records to the log file, switching to a new log
+ *	file where the day of the records changes, or to the other files
+ *	they are for.
+ *
+ * @param[in] iov   - the records
+ * @param[in] ydays - day of the year of each record
+ * @param[in] fds   - file of each record, -1 for the daemon log
+ * @param[in] n     - number of records
+ *
+ */
+static void
+log_async_write(struct iovec *iov, int *ydays, int *fds, int n)
+{
+	int start = 0;
+	int i;
+
+	if (log_mutex_lock() != 0)
+		return;
+
+	for (i = 1; i <= n; i++) {
+		if (i < n && fds[i] == fds[start] && ydays[i] == ydays[start])
+			continue;
+
+		if (fds[start] != -1) {
+			log_async_writev(fds[start], &iov[start], i - start);
+			start = i;
+			continue;
+		}
+
+		/* Do we need to switch the log? */
+		if (log_auto_switch && log_opened == 1 && ydays[start] != log_open_day) {
+			log_close(1);
+			log_open(NULL, log_directory);
+			if (log_opened < 1)
+				log_console_error("PBS cannot open its log");
+		}
+		if (log_opened == 1 && (locallog != 0 || syslogfac == 0))
+			log_async_writev(fileno(logfile), &iov[start], i - start);
+		start = i;
+	}
+
+	log_mutex_unlock();
+}
+
+/**
+ * @brief
+ *	The log writer thread.  Takes records off the ring in batches and
+ *	writes them out, and reports records dropped because the ring was
+ *	full.
+ *
+ * @param[in] arg - unused
+ *
+ * @return NULL
+ *
+ */
+static void *
+log_async_writer(void *arg)
+{
+	char *recs[LOG_ASYNC_BATCH];
+	struct iovec iov[LOG_ASYNC_BATCH];
+	int ydays[LOG_ASYNC_BATCH];
+	int fds[LOG_ASYNC_BATCH];
+	unsigned long dropped;
+	unsigned long reported = 0;
+	struct timespec ts;
+	ms_time mst;
+	char msg[128];
+	int len;
+	int n;
+	int i;
+
+	for (;;) {
+		__atomic_store_n(&log_async_busy, 1, __ATOMIC_SEQ_CST);
+		n = 0;
+		if (!__atomic_load_n(&log_async_stop, __ATOMIC_SEQ_CST)) {
+			while (n < LOG_ASYNC_BATCH && log_async_get(&recs[n], &len, &ydays[n], &fds[n]) == 0) {
+				iov[n].iov_base = recs[n];
+				iov[n].iov_len = len;
+				n++;
+			}
+		}
+		if (n > 0) {
+			log_async_write(iov, ydays, fds, n);
+			for (i = 0; i < n; i++)
+				free(recs[i]);
+		}
+
+		dropped = __atomic_load_n(&log_async_dropped, __ATOMIC_RELAXED);
+		if (dropped != reported && log_mutex_lock() == 0) {
+			snprintf(msg, sizeof(msg), "%lu log records dropped, log writer fell behind %lu times",
+				 dropped - reported, __atomic_load_n(&log_async_stalls, __ATOMIC_RELAXED));
+			get_timestamp(&mst);
+			if (log_opened == 1)
+				log_record_inner(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_WARNING, "Log", msg, &mst);
+			log_mutex_unlock();
+			reported = dropped;
+		}
+		__atomic_store_n(&log_async_busy, 0, __ATOMIC_SEQ_CST);
+
+		if (n == LOG_ASYNC_BATCH)
+			continue;
+
+		/* caught up, wait for the next record */
+		pthread_mutex_lock(&log_async_mutex);
+		__atomic_store_n(&log_async_idle, 1, __ATOMIC_SEQ_CST);
+		if (!log_async_ready() || __atomic_load_n(&log_async_stop, __ATOMIC_SEQ_CST)) {
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_sec += 1;
+			pthread_cond_timedwait(&log_async_cond, &log_async_mutex, &ts);
+		}
+		__atomic_store_n(&log_async_idle, 0, __ATOMIC_SEQ_CST);
+		pthread_mutex_unlock(&log_async_mutex);
+	}
+
+	return NULL;
 }
 
+/**
+ * @brief
+ *	Wait for the writer thread to write out everything queued so far
+ *
+ */
+static void
+log_async_drain(void)
+{
+	struct timespec ts = {0, 1000000};
+	sigset_t block_mask;
+	sigset_t old_mask;
+	int i;
+
+	if (!__atomic_load_n(&log_async_on, __ATOMIC_ACQUIRE) ||
+		pthread_equal(pthread_self(), log_async_tid))
+		return;
+
+	sigfillset(&block_mask);
+	sigprocmask(SIG_BLOCK, &block_mask, &old_mask);
+	for (i = 0; i < LOG_ASYNC_DRAIN_MS; i++) {
+		if (!log_async_ready() && !__atomic_load_n(&log_async_busy, __ATOMIC_SEQ_CST))
+			break;
+		log_async_wake();
+		nanosleep(&ts, NULL);
+	}
+	sigprocmask(SIG_SETMASK, &old_mask, NULL);
+}
+
+/**
+ * @brief
+ *	atexit handler, write out what is still queued
+ *
+ */
+static void
+log_async_atexit(void)
+{
+	log_async_drain();
+}
+
+/**
+ * @brief
+ *	Crash signal handler.  Stops the writer, writes out everything
+ *	still queued with plain write() calls and lets the signal take its
+ *	default action.
+ *
+ * @param[in] sig - the signal
+ *
+ */
+static void
+log_async_crash(int sig)
+{
+	struct timespec ts = {0, 1000000};
+	char *rec;
+	int len;
+	int yday;
+	int fd;
+	int i;
+
+	if (__atomic_load_n(&log_async_on, __ATOMIC_ACQUIRE)) {
+		__atomic_store_n(&log_async_stop, 1, __ATOMIC_SEQ_CST);
+		/* let the writer finish its batch, unless it is the one crashing */
+		for (i = 0; i < 1000 && __atomic_load_n(&log_async_busy, __ATOMIC_SEQ_CST); i++)
+			nanosleep(&ts, NULL);
+		while (log_async_get(&rec, &len, &yday, &fd) == 0) {
+			if (fd != -1)
+				(void) write(fd, rec, len);
+			else if (log_opened == 1)
+				(void) write(fileno(logfile), rec, len);
+		}
+	}
+	raise(sig);
+}
+
+/**
+ * @brief
+ *	Switch this process to asynchronous logging.  From now on, records
+ *	logged with log_record() are written by a dedicated writer thread.
+ *	Records still queued are written out by log_close(), at exit, and
+ *	on crash signals which have no handler of their own.  A child
+ *	process forked later logs synchronously.
+ *
+ * @return int
+ * @retval 0  - success, or async logging was already on
+ * @retval -1 - failure, logging stays synchronous
+ *
+ * @par MT-safe: No
+ *
+ */
+int
+log_async_start(void)
+{
+	static int crash_sigs[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+	static int atexit_done = 0;
+	struct sigaction act;
+	struct sigaction cur;
+	sigset_t block_mask;
+	sigset_t old_mask;
+	unsigned long i;
+	int rc;
+
+	pthread_once(&log_once_ctl, log_init); /* initialize mutex once */
+
+	if (log_async_on)
+		return 0;
+
+	if (log_async_ring == NULL) {
+		log_async_ring = malloc(LOG_ASYNC_SLOTS * sizeof(log_async_slot));
+		if (log_async_ring == NULL)
+			return -1;
+		for (i = 0; i < LOG_ASYNC_SLOTS; i++) {
+			log_async_ring[i].la_seq = i;
+			log_async_ring[i].la_rec = NULL;
+		}
+		log_async_head = 0;
+		log_async_tail = 0;
+	}
+	log_async_stop = 0;
+
+	/* the writer takes no signals, they belong to the main thread */
+	sigfillset(&block_mask);
+	pthread_sigmask(SIG_BLOCK, &block_mask, &old_mask);
+	rc = pthread_create(&log_async_tid, NULL, log_async_writer, NULL);
+	pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+	if (rc != 0)
+		return -1;
+	pthread_detach(log_async_tid);
+
+	__atomic_store_n(&log_async_on, 1, __ATOMIC_RELEASE);
+
+	if (!atexit_done) {
+		atexit(log_async_atexit);
+		atexit_done = 1;
+	}
+
+	memset(&act, 0, sizeof(act));
+	act.sa_handler = log_async_crash;
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = SA_RESETHAND;
+	for (i = 0; i < sizeof(crash_sigs) / sizeof(crash_sigs[0]); i++) {
+		if (sigaction(crash_sigs[i], NULL, &cur) == 0 &&
+			!(cur.sa_flags & SA_SIGINFO) && cur.sa_handler == SIG_DFL)
+			sigaction(crash_sigs[i], &act, NULL);
+	}
+
+	return 0;
+}
+#endif
+
 /**
  * @brief
  *	Function to set the comm related log levels to event types
@@ -402,6 +402,8 @@ connection_idlecheck(void)
 			continue;
 		if (cp->cn_authen & PBS_NET_CONN_NOTIMEOUT)
 			continue; /* do not time-out this connection */
+		if (cp->cn_hold_flag)
+			continue; /* reply still being written out */
 
 		ipaddr = cp->cn_addr;
 		snprintf(logbuf, sizeof(logbuf),
@@ -740,6 +742,8 @@ add_conn(int sd, enum conn_type type, pbs_net_t addr, unsigned int port, int (*r
 	conn->cn_oncl = 0;
 	conn->cn_authen = 0;
 	conn->cn_prio_flag = 0;
+	conn->cn_hold_flag = 0;
+	conn->cn_close_pending = 0;
 	conn->cn_auth_config = NULL;
 
 	num_connections++;
@@ -792,6 +796,79 @@ set_conn_as_priority(conn_t *conn)
 	return 1;
 }
 
+/**
+ * @brief
+ *	hold_conn - take a connection out of the poll set(s) while something
+ *	other than the main loop owns the socket, e.g. a reply being written
+ *	out by a worker thread.  No request is read from a held connection
+ *	and it is never timed out as idle.
+ *
+ * @param[in]	sd - socket descriptor
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - failure, the connection is unknown or could not be removed
+ */
+int
+hold_conn(int sd)
+{
+	int idx = conn_find_actual_index(sd);
+
+	if (idx < 0)
+		return -1;
+	if (svr_conn[idx]->cn_hold_flag)
+		return 0;
+
+	if (tpp_em_del_fd(poll_context, sd) < 0) {
+		log_errf(errno, __func__, "could not remove socket %d from the poll list", sd);
+		return -1;
+	}
+	if (svr_conn[idx]->cn_prio_flag)
+		(void) tpp_em_del_fd(priority_context, sd);
+	svr_conn[idx]->cn_hold_flag = 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	release_conn - put a connection held by hold_conn() back in the
+ *	poll set(s).
+ *
+ * @param[in]	sd - socket descriptor
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - failure, or the connection was closed while held; the
+ *		caller should close the connection
+ */
+int
+release_conn(int sd)
+{
+	int idx = conn_find_actual_index(sd);
+
+	if (idx < 0)
+		return -1;
+	if (!svr_conn[idx]->cn_hold_flag)
+		return 0;
+	if (svr_conn[idx]->cn_close_pending) {
+		svr_conn[idx]->cn_hold_flag = 0;
+		return -1;
+	}
+
+	if (tpp_em_add_fd(poll_context, sd, EM_IN | EM_HUP | EM_ERR) < 0) {
+		log_errf(errno, __func__, "could not add socket %d back to the poll list", sd);
+		return -1;
+	}
+	svr_conn[idx]->cn_hold_flag = 0;
+	svr_conn[idx]->cn_lasttime = time(NULL);
+	if (svr_conn[idx]->cn_prio_flag &&
+		tpp_em_add_fd(priority_context, sd, EM_IN | EM_HUP | EM_ERR) < 0) {
+		log_errf(errno, __func__, "could not add socket %d back to the priority poll list", sd);
+		svr_conn[idx]->cn_prio_flag = 0;
+	}
+	return 0;
+}
+
 /**
  * @brief
  *	add_conn_data - add some data to a connection
@@ -864,6 +941,9 @@ get_conn_data(int sd)
  *	function is called.
  *	The table entry is cleared and marked "Idle" meaning it is free for
  *	reuse.
+ *	A connection held by hold_conn() is not closed until it is released,
+ *	as the descriptor must not be reused while a worker still writes to
+ *	it; the owner closes it then, see release_conn().
  *
  * @param[in]	sock: socket or file descriptor
  *
@@ -884,6 +964,11 @@ close_conn(int sd)
 	if (idx == -1)
 		return;
 
+	if (svr_conn[idx]->cn_hold_flag) {
+		svr_conn[idx]->cn_close_pending = 1;
+		return;
+	}
+
 	if (svr_conn[idx]->cn_active != ChildPipe) {
 		dis_destroy_chan(sd);
 	}
@@ -934,13 +1019,16 @@ close_conn(int sd)
 static void
 cleanup_conn(int idx)
 {
-	if (tpp_em_del_fd(poll_context, svr_conn[idx]->cn_sock) < 0) {
+	if (svr_conn[idx]->cn_hold_flag || svr_conn[idx]->cn_close_pending) {
+		/* already out of the poll set(s), see hold_conn() */
+	} else if (tpp_em_del_fd(poll_context, svr_conn[idx]->cn_sock) < 0) {
 		int err = errno;
 		snprintf(logbuf, sizeof(logbuf),
 			"could not remove socket %d from poll list", svr_conn[idx]->cn_sock);
 		log_err(err, __func__, logbuf);
 	}
-	if (svr_conn[idx]->cn_prio_flag)
+	if (svr_conn[idx]->cn_prio_flag && !svr_conn[idx]->cn_hold_flag &&
+		!svr_conn[idx]->cn_close_pending)
 	{
 		if (tpp_em_del_fd(priority_context, svr_conn[idx]->cn_sock) < 0) {
 			int err = errno;
@@ -1000,6 +1088,11 @@ net_close(int but)
 		cp = GET_NEXT(cp->cn_link);
 		if(sock != but) {
 			svr_conn[sock]->cn_oncl = NULL;
+			/* no reply is waited for on shutdown or in a child */
+			if (svr_conn[sock]->cn_hold_flag) {
+				svr_conn[sock]->cn_hold_flag = 0;
+				svr_conn[sock]->cn_close_pending = 1;
+			}
 			close_conn(sock);
 			destroy_connection(sock);
 		}
@@ -1981,6 +1981,8 @@ py_resource_string_value(pbs_resource_value *resc_val)
  * @param[in] py_instance -  a Python object/class to populate
  * @param[in] attr_py_array - list of Python types to map attributes with
  * @param[in] attr_data_array - array of actual attribute names/resources/values
+ * @param[in] attr_sparse_data - sparse storage holding the attributes instead,
+ *				 when attr_data_array is NULL
  * @param[in] attr_def_array - array of attribute definitions (ex. job_attr_def)
  * @param[in] attr_def_array_size - size of attr_def_array.
  * @param[in]	perf_label - passed on to hook_perf_stat* call.
@@ -2005,6 +2007,7 @@ int
 pbs_python_populate_attributes_to_python_class(PyObject *py_instance,
 	PyObject **attr_py_array,
 	attribute *attr_data_array,
+	attr_sparse *attr_sparse_data,
 	attribute_def *attr_def_array,
 	int attr_def_array_size, char *perf_label, char *perf_action)
 {
@@ -2024,7 +2027,10 @@ pbs_python_populate_attributes_to_python_class(PyObject *py_instance,
 
 	hook_perf_stat_start(perf_label, perf_action, 0);
 	for (i = 0; i < attr_def_array_size; i++) {
-		attr_p = attr_data_array + i;
+		if (attr_data_array != NULL)
+			attr_p = attr_data_array + i;
+		else if ((attr_p = attr_sparse_find(attr_sparse_data, i)) == NULL)
+			continue;	/* not set */
 		attr_def_p = attr_def_array + i;
 
 		memset(&pheadp, 0, sizeof(pheadp));
@@ -3359,7 +3365,7 @@ _pps_helper_get_queue(pbs_queue *pque, const char *que_name, char *perf_label)
 	snprintf(perf_action, sizeof(perf_action), "%s:%s", HOOK_PERF_POPULATE, hook_debug.objname);
 	tmp_rc = pbs_python_populate_attributes_to_python_class(py_que,
 		py_que_attr_types,
-		que->qu_attr,
+		que->qu_attr, NULL,
 		que_attr_def,
 		QA_ATR_LAST, perf_label, perf_action);
 	if (tmp_rc == -1) {
@@ -3503,7 +3509,7 @@ _pps_helper_get_server(char *perf_label)
 	snprintf(perf_action, sizeof(perf_action), "%s:%s", HOOK_PERF_POPULATE, hook_debug.objname);
 	tmp_rc = pbs_python_populate_attributes_to_python_class(py_svr,
 		py_svr_attr_types,
-		server.sv_attr,
+		server.sv_attr, NULL,
 		svr_attr_def,
 		SVR_ATR_LAST, perf_label, perf_action);
 
@@ -3629,7 +3635,7 @@ _pps_helper_get_job(job *pjob_o, const char *jobid, const char *qname, char *per
 	snprintf(perf_action, sizeof(perf_action), "%s:%s", HOOK_PERF_POPULATE, hook_debug.objname);
 	tmp_rc = pbs_python_populate_attributes_to_python_class(py_job,
 		py_job_attr_types,
-		pjob->ji_wattr,
+		NULL, &pjob->ji_wattr,
 		job_attr_def,
 		JOB_ATR_LAST, perf_label, perf_action);
 
@@ -3765,7 +3771,7 @@ _pps_helper_get_resv(resc_resv *presv_o, const char *resvid, char *perf_label)
 	snprintf(perf_action, sizeof(perf_action), "%s:%s", HOOK_PERF_POPULATE, hook_debug.objname);
 	tmp_rc = pbs_python_populate_attributes_to_python_class(py_resv,
 		py_resv_attr_types,
-		presv->ri_wattr,
+		presv->ri_wattr, NULL,
 		resv_attr_def,
 		RESV_ATR_LAST, perf_label, perf_action);
 
@@ -3889,7 +3895,7 @@ _pps_helper_get_vnode(struct pbsnode *pvnode_o, const char *vname, char *perf_la
 	snprintf(perf_action, sizeof(perf_action), "%s:%s", HOOK_PERF_POPULATE, hook_debug.objname);
 	tmp_rc = pbs_python_populate_attributes_to_python_class(py_vnode,
 		py_vnode_attr_types,
-		pvnode->nd_attr,
+		pvnode->nd_attr, NULL,
 		node_attr_def,
 		ND_ATR_LAST, perf_label, perf_action);
 
@@ -48,6 +48,9 @@ extern "C" {
 #include <time.h>
 #include <pthread.h>
 #include <sys/socket.h>
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
 #include <netinet/in.h>
 #include "log.h"
 #include "list_link.h"
@@ -69,6 +72,7 @@ extern "C" {
 #define tpp_sock_connect(a, b, c)      connect(a, b, c)
 #define tpp_sock_recv(a, b, c, d)       recv(a, b, c, d)
 #define tpp_sock_send(a, b, c, d)       send(a, b, c, d)
+#define tpp_sock_writev(a, b, c)        writev(a, b, c)
 #define tpp_sock_select(a, b, c, d, e)   select(a, b, c, d, e)
 #define tpp_sock_close(a)            close(a)
 #define tpp_sock_getsockopt(a, b, c, d, e)   getsockopt(a, b, c, d, e)
@@ -91,6 +95,11 @@ int tpp_sock_bind(int, const struct sockaddr *, int);
 int tpp_sock_connect(int, const struct sockaddr *, int);
 int tpp_sock_recv(int, char *, int, int);
 int tpp_sock_send(int, const char *, int, int);
+struct iovec {
+	void *iov_base;
+	size_t iov_len;
+};
+int tpp_sock_writev(int, const struct iovec *, int);
 int tpp_sock_select(int, fd_set *, fd_set *, fd_set *, const struct timeval *);
 int tpp_sock_close(int);
 int tpp_sock_getsockopt(int, int, int, int *, int *);
@@ -370,6 +370,22 @@ tpp_sock_send(int s, const char *buf, int len, int flags)
 	return ret;
 }
 
+/*
+ * writev() replacement for windows. Sends the first non-empty buffer
+ * only; like writev() the caller must handle a short write
+ */
+int
+tpp_sock_writev(int s, const struct iovec *iov, int iovcnt)
+{
+	int i;
+
+	for (i = 0; i < iovcnt; i++) {
+		if (iov[i].iov_len > 0)
+			return tpp_sock_send(s, iov[i].iov_base, (int) iov[i].iov_len, 0);
+	}
+	return 0;
+}
+
 /*
  * wrapper to call windows select() and map windows
  * error code to errno and massage the return value
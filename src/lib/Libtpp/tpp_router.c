@@ -92,8 +92,26 @@ pthread_mutex_t lj_lock;
 /* index of routers connected to this router */
 void *routers_idx = NULL;
 
-/* index of all leaves in the cluster */
-void *cluster_leaves_idx = NULL;
+/*
+ * Index of all leaves in the cluster, split into shards by a hash of the
+ * leaf address. The data path looks up the destination leaf of every packet,
+ * so it takes only the read lock of the shard holding that address and never
+ * touches router_lock.
+ *
+ * Anything that changes the leaves or routers (join, leave, connection loss)
+ * does so under router_write_lock(), which takes router_lock and then every
+ * shard lock for write. Holding router_lock, for read or write, is therefore
+ * enough to search any shard.
+ */
+#define TPP_LEAF_SHARDS 64	/* must be a power of 2 */
+
+typedef struct {
+	pthread_rwlock_t lock;	/* guards idx and the leaves in it */
+	void *idx;		/* leaves whose address hashes to this shard */
+	char pad[64];		/* keep shard locks on separate cache lines */
+} tpp_leaf_shard_t;
+
+static tpp_leaf_shard_t leaf_shards[TPP_LEAF_SHARDS];
 
 /* index of special routers who need to be notified for join updates */
 void *my_leaves_notify_idx = NULL;
@@ -117,6 +135,92 @@ static int router_post_connect_handler(int tfd, void *data, void *c, void *extra
 /* structure identifying this router */
 static tpp_router_t *this_router = NULL;
 
+/**
+ * @brief
+ *	Find the leaf shard that holds the given address
+ *
+ * @param[in] - addr - leaf address
+ *
+ * @return	Pointer to the shard
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static tpp_leaf_shard_t *
+leaf_shard(tpp_addr_t *addr)
+{
+	unsigned int h = 2166136261U;
+	int i;
+
+	for (i = 0; i < 4; i++)
+		h = (h ^ (unsigned int) addr->ip[i]) * 16777619U;
+	h = (h ^ (unsigned short) addr->port) * 16777619U;
+	h ^= h >> 15;
+
+	return &leaf_shards[h & (TPP_LEAF_SHARDS - 1)];
+}
+
+/**
+ * @brief
+ *	Find a leaf in the cluster by one of its addresses
+ *
+ * @param[in] - addr - leaf address
+ *
+ * @return	The leaf
+ * @retval	NULL - no leaf with this address
+ *
+ * @par MT-safe: No, caller holds router_lock or the read lock of
+ *	the shard of addr
+ *
+ */
+static tpp_leaf_t *
+find_leaf(tpp_addr_t *addr)
+{
+	tpp_leaf_t *l = NULL;
+
+	pbs_idx_find(leaf_shard(addr)->idx, (void **) &addr, (void **) &l, NULL);
+	return l;
+}
+
+/**
+ * @brief
+ *	Lock the router and leaf indexes for changing them
+ *
+ * @par Functionality
+ *	Takes router_lock for write and then the lock of every leaf shard,
+ *	always in the same order, so that packets being routed by other
+ *	threads see either the old or the new state of a leaf.
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static void
+router_write_lock(void)
+{
+	int i;
+
+	tpp_write_lock(&router_lock);
+	for (i = 0; i < TPP_LEAF_SHARDS; i++)
+		tpp_write_lock(&leaf_shards[i].lock);
+}
+
+/**
+ * @brief
+ *	Release the locks taken by router_write_lock
+ *
+ * @par MT-safe: Yes
+ *
+ */
+static void
+router_write_unlock(void)
+{
+	int i;
+
+	for (i = TPP_LEAF_SHARDS - 1; i >= 0; i--)
+		tpp_unlock_rwlock(&leaf_shards[i].lock);
+	tpp_unlock_rwlock(&router_lock);
+}
+
 static tpp_router_t *
 alloc_router(char *name, tpp_addr_t *address)
 {
@@ -665,24 +769,24 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 			tpp_log(LOG_CRIT, NULL, "tfd=%d, Connection from leaf %s down", tfd, tpp_netaddr(&l->leaf_addrs[0]));
 		}
 
-		tpp_write_lock(&router_lock);
+		router_write_lock();
 
 		if ((r = del_router_from_leaf(l, tfd)) == NULL) {
 			tpp_log(LOG_CRIT, __func__, "tfd=%d, Failed to clear pbs_comm from leaf %s's list", tfd, tpp_netaddr(&l->leaf_addrs[0]));
-			tpp_unlock_rwlock(&router_lock);
+			router_write_unlock();
 			return -1;
 		}
 
 		/* we had only the first address record stored in the my_leaves tree */
 		if (pbs_idx_delete(r->my_leaves_idx, &l->leaf_addrs[0]) != PBS_IDX_RET_OK) {
 			tpp_log(LOG_CRIT, __func__, "tfd=%d, Failed to delete address from my_leaves %s", tfd, tpp_netaddr(&l->leaf_addrs[0]));
-			tpp_unlock_rwlock(&router_lock);
+			router_write_unlock();
 			return -1;
 		}
 
 		if (l->num_routers > 0) {
 			TPP_DBPRT("tfd=%d, Other pbs_comms for leaf %s present", tfd, tpp_netaddr(&l->leaf_addrs[0]));
-			tpp_unlock_rwlock(&router_lock);
+			router_write_unlock();
 			return 0;
 		}
 
@@ -690,9 +794,9 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 
 		/* delete all of this leaf's addresses from the search tree */
 		for (i = 0; i < l->num_addrs; i++) {
-			if (pbs_idx_delete(cluster_leaves_idx, &l->leaf_addrs[i]) != PBS_IDX_RET_OK) {
+			if (pbs_idx_delete(leaf_shard(&l->leaf_addrs[i])->idx, &l->leaf_addrs[i]) != PBS_IDX_RET_OK) {
 				tpp_log(LOG_CRIT, __func__, "tfd=%d, Failed to delete address %s from cluster leaves", tfd, tpp_netaddr(&l->leaf_addrs[i]));
-				tpp_unlock_rwlock(&router_lock);
+				router_write_unlock();
 				return -1;
 			}
 		}
@@ -710,7 +814,7 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 
 		free_leaf(l);
 
-		tpp_unlock_rwlock(&router_lock);
+		router_write_unlock();
 
 		return 0;
 
@@ -728,7 +832,7 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 			/* do any logging or leaf processing only if it was connected earlier */
 			tpp_log(LOG_CRIT, NULL, "tfd=%d, Connection %s pbs_comm %s down", tfd, (r->initiator == 1) ? "to" : "from", r->router_name);
 
-			tpp_write_lock(&router_lock);
+			router_write_lock();
 			TPP_QUE_CLEAR(&deleted_leaves);
 
 			while (pbs_idx_find(r->my_leaves_idx, NULL, (void **)&l, &idx_ctx) == PBS_IDX_RET_OK) {
@@ -742,7 +846,7 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 						TPP_DBPRT("All routers to leaf %s down, deleting leaf", tpp_netaddr(&l->leaf_addrs[0]));
 
 						if (tpp_enque(&deleted_leaves, l) == NULL) {
-							tpp_unlock_rwlock(&router_lock);
+							router_write_unlock();
 							tpp_log(LOG_CRIT, __func__, "Out of memory enqueuing deleted leaves");
 							return -1;
 						}
@@ -762,9 +866,9 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 				}
 
 				for (i = 0; i < l->num_addrs; i++) {
-					if (pbs_idx_delete(cluster_leaves_idx, &l->leaf_addrs[i]) != PBS_IDX_RET_OK) {
+					if (pbs_idx_delete(leaf_shard(&l->leaf_addrs[i])->idx, &l->leaf_addrs[i]) != PBS_IDX_RET_OK) {
 						tpp_log(LOG_CRIT, __func__, "tfd=%d, Failed to delete address %s", tfd, tpp_netaddr(&l->leaf_addrs[i]));
-						tpp_unlock_rwlock(&router_lock);
+						router_write_unlock();
 
 						return -1;
 					}
@@ -783,7 +887,7 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 				if (r->my_leaves_idx == NULL) {
 					tpp_log(LOG_CRIT, __func__, "Failed to create index for my leaves");
 					free_router(r);
-					tpp_unlock_rwlock(&router_lock);
+					router_write_unlock();
 					return -1;
 				}
 			}
@@ -814,7 +918,7 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 				free_leaf(l);
 			}
 
-			tpp_unlock_rwlock(&router_lock);
+			router_write_unlock();
 		}
 
 		if (r->initiator == 1) {
@@ -855,7 +959,7 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 			 * remove this router from our list of registered routers
 			 * ie, remove from routers_idx tree
 			 **/
-			tpp_write_lock(&router_lock);
+			router_write_lock();
 			
 			pbs_idx_delete(routers_idx, &r->router_addr);
 			/*
@@ -864,7 +968,7 @@ router_close_handler_inner(int tfd, int error, void *c, int hop)
 			 */
 			free_router(r);
 
-			tpp_unlock_rwlock(&router_lock);
+			router_write_unlock();
 
 		}
 
@@ -1266,7 +1370,7 @@ again:
 
 				TPP_DBPRT("Recvd TPP_CTL_JOIN from pbs_comm node %s, len=%d", tpp_netaddr(&connected_host), len);
 
-				tpp_write_lock(&router_lock);
+				router_write_lock();
 
 				/* find associated router */
 				pbs_idx_find(routers_idx, &pconn_host, (void **)&r, NULL);
@@ -1278,13 +1382,13 @@ again:
 						tpp_log(LOG_CRIT, NULL, "tfd=%d, pbs_comm %s is still connected while "
 							 "another connect arrived, dropping existing connection %d", tfd, r->router_name, r->conn_fd);
 						tpp_transport_close(r->conn_fd);
-						tpp_unlock_rwlock(&router_lock);
+						router_write_unlock();
 						return -1;
 					}
 				} else {
 					r = alloc_router(strdup(tpp_netaddr(&connected_host)), &connected_host);
 					if (!r) {
-						tpp_unlock_rwlock(&router_lock);
+						router_write_unlock();
 						return -1;
 					}
 				}
@@ -1297,7 +1401,7 @@ again:
 				if (ctx == NULL) {
 					if ((ctx = (tpp_context_t *) malloc(sizeof(tpp_context_t))) == NULL) {
 						tpp_log(LOG_CRIT, __func__, "Out of memory allocating tpp context");
-						tpp_unlock_rwlock(&router_lock);
+						router_write_unlock();
 						return -1;
 					}
 				}
@@ -1313,7 +1417,7 @@ again:
 				/* now send new router info about all leaves I have */
 				send_leaves_to_router(this_router, r);
 
-				tpp_unlock_rwlock(&router_lock);
+				router_write_unlock();
 				return 0;
 
 			} else if (node_type == TPP_LEAF_NODE || node_type == TPP_LEAF_NODE_LISTEN) {
@@ -1323,7 +1427,6 @@ again:
 				int i;
 				int index = (int) hdr->index;
 				tpp_addr_t *addrs;
-				void *paddr;
 
 				TPP_DBPRT("Recvd TPP_CTL_JOIN FOR LEAF from pbs_comm node %s, len=%d, hop=%d", tpp_netaddr(&connected_host), len, hop);
 
@@ -1334,7 +1437,7 @@ again:
 				}
 				addrs = (tpp_addr_t *) (((char *) dhdr) + sizeof(tpp_join_pkt_hdr_t));
 
-				tpp_write_lock(&router_lock);
+				router_write_lock();
 
 				if (ctx == NULL || ctx->ptr == NULL) {
 					/* router is myself */
@@ -1350,15 +1453,14 @@ again:
 
 						strcpy(rname, tpp_netaddr(&connected_host));
 						tpp_log(LOG_CRIT, NULL, "tfd=%d, Failed to find pbs_comm %s in join for leaf %s", tfd, rname, tpp_netaddr(&addrs[0]));
-						tpp_unlock_rwlock(&router_lock);
+						router_write_unlock();
 						return -1;
 					}
 				}
 
 				/* find the leaf */
 				found = 1;
-				paddr = &addrs[0];
-				pbs_idx_find(cluster_leaves_idx, &paddr, (void **)&l, NULL);
+				l = find_leaf(&addrs[0]);
 				if (!l) {
 					found = 0;
 					l = (tpp_leaf_t *) calloc(1, sizeof(tpp_leaf_t));
@@ -1368,7 +1470,7 @@ again:
 					if (!l || !l->leaf_addrs) {
 						free_leaf(l);
 						tpp_log(LOG_CRIT, __func__, "Out of memory allocating leaf");
-						tpp_unlock_rwlock(&router_lock);
+						router_write_unlock();
 						return -1;
 					}
 
@@ -1393,7 +1495,7 @@ again:
 							 "another leaf connect arrived, dropping existing connection %d",
 							 tfd, tpp_netaddr(&l->leaf_addrs[0]), l->conn_fd);
 						tpp_transport_close(l->conn_fd);
-						tpp_unlock_rwlock(&router_lock);
+						router_write_unlock();
 						return -1;
 					}
 					l->conn_fd = tfd;
@@ -1407,7 +1509,7 @@ again:
 					if (ctx == NULL) {
 						if ((ctx = (tpp_context_t *) malloc(sizeof(tpp_context_t))) == NULL) {
 							tpp_log(LOG_CRIT, __func__, "Out of memory allocating tpp context");
-							tpp_unlock_rwlock(&router_lock);
+							router_write_unlock();
 							return -1;
 						}
 					}
@@ -1425,26 +1527,24 @@ again:
 				i = add_route_to_leaf(l, r, index);
 				if (i == -1) {
 					tpp_log(LOG_CRIT, NULL, "tfd=%d, Leaf %s exists!", tfd, tpp_netaddr(&l->leaf_addrs[0]));
-					tpp_unlock_rwlock(&router_lock);
+					router_write_unlock();
 					return 0;
 				}
 
 				if (pbs_idx_insert(r->my_leaves_idx, &l->leaf_addrs[0], l) != PBS_IDX_RET_OK) {
 					tpp_log(LOG_CRIT, __func__, "tfd=%d, Failed to add address %s to index of my leaves", tfd, tpp_netaddr(&l->leaf_addrs[0]));
-					tpp_unlock_rwlock(&router_lock);
+					router_write_unlock();
 					return -1;
 				}
 
 				if (found == 0) {
 					int fatal = 0;
-					/* add each address to the cluster_leaves_idx tree
+					/* add each address to the cluster leaves index
 					 * since this is the primary "routing table"
 					 */
 					for (i = 0; i < l->num_addrs; i++) {
-						if (pbs_idx_insert(cluster_leaves_idx, &l->leaf_addrs[i], l) != PBS_IDX_RET_OK) {
-							void *unused;
-							void *pleaf_addr = &l->leaf_addrs[i];
-							if (pbs_idx_find(cluster_leaves_idx, &pleaf_addr, &unused, NULL) == PBS_IDX_RET_OK) {
+						if (pbs_idx_insert(leaf_shard(&l->leaf_addrs[i])->idx, &l->leaf_addrs[i], l) != PBS_IDX_RET_OK) {
+							if (find_leaf(&l->leaf_addrs[i]) != NULL) {
 								int k;
 								tpp_log(LOG_CRIT, __func__, "tfd=%d, Failed to add address %s to cluster-leaves index "
 										"since address already exists, dropping duplicate", tfd, tpp_netaddr(&l->leaf_addrs[i]));
@@ -1464,7 +1564,7 @@ again:
 					if (fatal > 0 || l->num_addrs == 0) {
 						tpp_log(LOG_CRIT, NULL, "tfd=%d, Leaf %s had %s problem adding addresses, rejecting connection",
 								 tfd, tpp_netaddr(&l->leaf_addrs[0]), (fatal > 0)? "fatal" : "all duplicates");
-						tpp_unlock_rwlock(&router_lock);
+						router_write_unlock();
 						return -1;
 					}
 				}
@@ -1473,7 +1573,7 @@ again:
 					if (l->leaf_type == TPP_LEAF_NODE_LISTEN) {
 						if (pbs_idx_insert(my_leaves_notify_idx, &l->leaf_addrs[0], l) != PBS_IDX_RET_OK) {
 							tpp_log(LOG_CRIT, __func__, "tfd=%d, Failed to add address %s to notify-leaves index", tfd, tpp_netaddr(&l->leaf_addrs[0]));
-							tpp_unlock_rwlock(&router_lock);
+							router_write_unlock();
 							return -1;
 						}
 					}
@@ -1510,7 +1610,7 @@ again:
 					broadcast_to_my_routers(chunks, 1, tfd);
 				}
 				
-				tpp_unlock_rwlock(&router_lock);
+				router_write_unlock();
 				return 0;
 			}
 			return 0;
@@ -1542,10 +1642,10 @@ again:
 				tpp_leaf_t *l = NULL;
 				tpp_addr_t *src_addr = (tpp_addr_t *) (((char *) dhdr) + sizeof(tpp_leave_pkt_hdr_t));
 
-				tpp_write_lock(&router_lock);
+				tpp_read_lock(&router_lock);
 
 				/* find the leaf context to pass to close handler */
-				pbs_idx_find(cluster_leaves_idx, (void **)&src_addr, (void **)&l, NULL);
+				l = find_leaf(src_addr);
 				if (!l) {
 					TPP_DBPRT("No leaf %s found", tpp_netaddr(src_addr));
 					tpp_unlock_rwlock(&router_lock);
@@ -1635,6 +1735,7 @@ again:
 				tpp_addr_t *dest_host;
 				unsigned int src_sd;
 				tpp_leaf_t *l = NULL;
+				tpp_leaf_shard_t *shard;
 
 				minfo = (tpp_mcast_pkt_info_t *)(((char *) minfo_base) + k * sizeof(tpp_mcast_pkt_info_t));
 
@@ -1643,10 +1744,11 @@ again:
 
 				TPP_DBPRT("MCAST data on fd=%u", src_sd);
 
-				tpp_read_lock(&router_lock);
-				pbs_idx_find(cluster_leaves_idx, (void **)&dest_host, (void **)&l, NULL);
+				shard = leaf_shard(dest_host);
+				tpp_read_lock(&shard->lock);
+				l = find_leaf(dest_host);
 				if (l == NULL) {
-					tpp_unlock_rwlock(&router_lock);
+					tpp_unlock_rwlock(&shard->lock);
 					snprintf(msg, sizeof(msg), "pbs_comm:%s: Dest not found at pbs_comm", tpp_netaddr(&this_router->router_addr));
 					log_noroute(src_host, dest_host, src_sd, msg);
 					tpp_send_ctl_msg(tfd, TPP_MSG_NOROUTE, src_host, dest_host, src_sd, 0, msg);
@@ -1655,7 +1757,7 @@ again:
 
 				/* find a router that is still connected */
 				target_router = get_preferred_router(l, this_router, &target_fd);
-				tpp_unlock_rwlock(&router_lock);
+				tpp_unlock_rwlock(&shard->lock);
 
 				if (target_router == NULL) {
 					snprintf(msg, sizeof(msg), "pbs_comm:%s: No target pbs_comm found", tpp_netaddr(&this_router->router_addr));
@@ -1822,6 +1924,7 @@ mcast_err:
 		case TPP_DATA:
 		case TPP_CLOSE_STRM: {
 			tpp_leaf_t *l = NULL;
+			tpp_leaf_shard_t *shard;
 			tpp_addr_t *src_host, *dest_host;
 			tpp_packet_t *pkt = NULL;
 			unsigned int src_sd;
@@ -1830,11 +1933,12 @@ mcast_err:
 			dest_host = &dhdr->dest_addr;
 			src_sd = ntohl(dhdr->src_sd);
 
-			tpp_read_lock(&router_lock);
+			shard = leaf_shard(dest_host);
+			tpp_read_lock(&shard->lock);
 
-			pbs_idx_find(cluster_leaves_idx, (void **)&dest_host, (void **)&l, NULL);
+			l = find_leaf(dest_host);
 			if (l == NULL) {
-				tpp_unlock_rwlock(&router_lock);
+				tpp_unlock_rwlock(&shard->lock);
 				snprintf(msg, sizeof(msg), "tfd=%d, pbs_comm:%s: Dest not found", tfd, tpp_netaddr(&this_router->router_addr));
 				log_noroute(src_host, dest_host, src_sd, msg);
 				tpp_send_ctl_msg(tfd, TPP_MSG_NOROUTE, src_host, dest_host, src_sd, 0, msg);
@@ -1843,7 +1947,7 @@ mcast_err:
 
 			/* find a router that is still connected */
 			target_router = get_preferred_router(l, this_router, &target_fd);
-			tpp_unlock_rwlock(&router_lock);
+			tpp_unlock_rwlock(&shard->lock);
 
 			if (target_router == NULL) {
 				snprintf(msg, sizeof(msg), "tfd=%d, pbs_comm:%s: No target pbs_comm found", tfd, tpp_netaddr(&this_router->router_addr));
@@ -1877,6 +1981,7 @@ mcast_err:
 				char lbuf[TPP_MAXADDRLEN + 1];
 				tpp_packet_t *pkt = NULL;
 				tpp_addr_t *dest_host = &ehdr->dest_addr;
+				tpp_leaf_shard_t *shard;
 				char *msg = ((char *) ehdr) + sizeof(tpp_ctl_pkt_hdr_t);
 
 				strcpy(lbuf, tpp_netaddr(&ehdr->dest_addr));
@@ -1884,17 +1989,18 @@ mcast_err:
 							tfd, lbuf, ntohl(ehdr->src_sd), tpp_netaddr(&ehdr->src_addr), msg);
 
 				/* find the fd to forward to via the associated router */
-				tpp_read_lock(&router_lock);
+				shard = leaf_shard(dest_host);
+				tpp_read_lock(&shard->lock);
 
-				pbs_idx_find(cluster_leaves_idx, (void **)&dest_host, (void **)&l, NULL);
+				l = find_leaf(dest_host);
 				if (l == NULL) {
-					tpp_unlock_rwlock(&router_lock);
+					tpp_unlock_rwlock(&shard->lock);
 					return 0;
 				}
 				/* find a router that is still connected */
 				target_router = get_preferred_router(l, this_router, &target_fd);
 
-				tpp_unlock_rwlock(&router_lock);
+				tpp_unlock_rwlock(&shard->lock);
 				if (target_router == NULL) {
 					tpp_log(LOG_WARNING, NULL, "tfd=%d, No connections to send TPP_CTL_NOROUTE", tfd);
 					return 0;
@@ -2137,6 +2243,7 @@ leaf_get_router_index(tpp_leaf_t *l, tpp_router_t *r)
 int
 tpp_init_router(struct tpp_config *cnf)
 {
+	int i;
 	int j;
 	tpp_router_t *r;
 	tpp_context_t *ctx = NULL;
@@ -2159,10 +2266,13 @@ tpp_init_router(struct tpp_config *cnf)
 		return -1;
 	}
 
-	cluster_leaves_idx = pbs_idx_create(0, sizeof(tpp_addr_t));
-	if (cluster_leaves_idx == NULL) {
-		tpp_log(LOG_CRIT, __func__, "Failed to create index for cluster leaves");
-		return -1;
+	for (i = 0; i < TPP_LEAF_SHARDS; i++) {
+		tpp_init_rwlock(&leaf_shards[i].lock);
+		leaf_shards[i].idx = pbs_idx_create(0, sizeof(tpp_addr_t));
+		if (leaf_shards[i].idx == NULL) {
+			tpp_log(LOG_CRIT, __func__, "Failed to create index for cluster leaves");
+			return -1;
+		}
 	}
 
 	my_leaves_notify_idx = pbs_idx_create(0, sizeof(tpp_addr_t));
@@ -2185,20 +2295,20 @@ tpp_init_router(struct tpp_config *cnf)
 
 	/* initiate connections to sister routers */
 	j = 0;
-	tpp_write_lock(&router_lock);
+	router_write_lock();
 	while (tpp_conf->routers && tpp_conf->routers[j]) {
 		/* add to connection table */
 
 		r = alloc_router(tpp_conf->routers[j], NULL);
 		if (!r) {
-			tpp_unlock_rwlock(&router_lock);
+			router_write_unlock();
 			return -1; /* error already logged */
 		}
 		r->initiator = 1;
 
 		/* since we connected we should add a context */
 		if ((ctx = (tpp_context_t *) malloc(sizeof(tpp_context_t))) == NULL) {
-			tpp_unlock_rwlock(&router_lock);
+			router_write_unlock();
 			tpp_log(LOG_CRIT, __func__, "Out of memory allocating tpp context");
 			return -1;
 		}
@@ -2208,13 +2318,13 @@ tpp_init_router(struct tpp_config *cnf)
 		tpp_log(LOG_INFO, NULL, "Connecting to pbs_comm %s", tpp_conf->routers[j]);
 
 		if (tpp_transport_connect(tpp_conf->routers[j], 0, ctx, &r->conn_fd) == -1) {
-			tpp_unlock_rwlock(&router_lock);
+			router_write_unlock();
 			return -1;
 		}
 
 		j++;
 	}
-	tpp_unlock_rwlock(&router_lock);
+	router_write_unlock();
 
 	sleep(1);
 	return 0;
@@ -176,6 +176,10 @@ typedef struct {
  * such physical connections. We refer to the indexes to the physical
  * connections as "transport fd" or tfd.
  */
+#define TPP_SEND_BATCH	64	/* max packets gathered into one writev */
+#define TPP_SEND_IOV	128	/* max chunks gathered into one writev */
+#define TPP_PKT_ALIGN	8	/* alignment packets are handed up with */
+
 typedef struct {
 	int sock_fd;             /* socket fd (TCP) for this physical connection*/
 	int lasterr;             /* last error that was captured on this socket */
@@ -186,9 +190,18 @@ typedef struct {
 
 	tpp_mbox_t send_mbox;     /* mbox of pkts to send */
 	tpp_chunk_t scratch;      /* scratch to work on incoming data */
-	tpp_packet_t *curr_send_pkt; /* current packet dequed from send_mbox to be sent out  */
+	char *pkt_copy;           /* aligned copy of a packet received unaligned in scratch */
+	int pkt_copy_len;         /* size of pkt_copy */
+	tpp_packet_t *send_batch[TPP_SEND_BATCH]; /* pkts dequed from send_mbox being sent out, oldest first */
+	int send_batch_cnt;       /* number of pkts in send_batch */
 	thrd_data_t *td;          /* connections controller thread */
 
+	/* syscall counts, logged when the connection goes away */
+	unsigned long send_calls; /* writev calls */
+	unsigned long send_bufs;  /* chunks those calls carried */
+	unsigned long recv_calls; /* recv calls that returned data */
+	unsigned long recv_pkts;  /* packets those calls carried */
+
 	tpp_context_t *ctx;       /* upper layers context information */
 
 	void *extra;              /* extra data structure */
@@ -1716,6 +1729,11 @@ handle_disconnect(phy_conn_t *conn)
 
 	tfd = conn->sock_fd; /* store this since close_handler could unset this */
 
+	if (conn->send_calls > 0 || conn->recv_calls > 0)
+		tpp_log(LOG_INFO, __func__, "tfd=%d, sent %lu chunks in %lu writes, received %lu packets in %lu reads, %ld syscalls saved",
+			tfd, conn->send_bufs, conn->send_calls, conn->recv_pkts, conn->recv_calls,
+			(long) (conn->send_bufs - conn->send_calls) + (long) (2 * conn->recv_pkts) - (long) conn->recv_calls);
+
 	if (the_close_handler)
 		the_close_handler(conn->sock_fd, error, conn->ctx, conn->extra);
 
@@ -1751,9 +1769,9 @@ handle_disconnect(phy_conn_t *conn)
  *	handle incoming data using the scratch space which is part of each
  *	connection structure. Resize the scratch space if required.
  *
- *	Receive data as much as available, check if a packet can be formed, if
- *	so, then call app_pkts to form packets and send to the upper layer to
- *	be processed.
+ *	Receive as much data as the scratch space holds with each recv, and
+ *	hand every complete packet in it to the upper layer, so a burst of
+ *	small packets costs one recv instead of two per packet.
  *
  * @param[in] conn - The physical connection
  *
@@ -1766,11 +1784,8 @@ handle_disconnect(phy_conn_t *conn)
 static void
 handle_incoming_data(phy_conn_t *conn)
 {
-	int torecv = 0;
 	int space_left;
 	int offset;
-	int closed;
-	int pkt_len;
 	char *p;
 	ssize_t rc;
 
@@ -1795,64 +1810,40 @@ handle_incoming_data(phy_conn_t *conn)
 			space_left = conn->scratch.len - offset;
 		}
 
-		if (offset > sizeof(int)) {
-			pkt_len = ntohl(*((int *) conn->scratch.data));
-			torecv = pkt_len - offset; /* offset amount of data already received */
-			TPP_DBPRT("tfd=%d, Need to receive: pkt_len=%d, torecv=%d, space_left=%d bytes", conn->sock_fd, pkt_len, torecv, space_left);
-			if (torecv > space_left)
-				torecv = space_left;
-		} else {
-			/*
-			 * we are starting to read a new packet now
-			 * so we try to read the length part only first
-			 * so we know how much more to read this is to
-			 * avoid reading more than one packet, to eliminate memmoves
-			 */
-			torecv = sizeof(int) + sizeof(char) - offset; /* also read the type character */
-			pkt_len = 0;
-		}
-
 		/* receive as much as we can */
-		closed = 0;
-		while (torecv > 0) {
-			rc = tpp_sock_recv(conn->sock_fd, conn->scratch.pos, torecv, 0);
-			if (rc == 0) {
-				closed = 1; /* received close */
-				break;
-			}
-			if (rc < 0) {
-				if (errno != EWOULDBLOCK && errno != EAGAIN) {
-					handle_disconnect(conn);
-					return; /* error case - don't even process data */
-				}
-				break;
-			}
-			torecv -= rc;
-			conn->scratch.pos += rc;
+		rc = tpp_sock_recv(conn->sock_fd, conn->scratch.pos, space_left, 0);
+		if (rc == 0) {
+			handle_disconnect(conn); /* received close */
+			return;
 		}
-
-		if (closed == 1) {
-			handle_disconnect(conn);
+		if (rc < 0) {
+			if (errno != EWOULDBLOCK && errno != EAGAIN)
+				handle_disconnect(conn); /* error case - don't even process data */
 			return;
 		}
-		if (torecv > 0) /* did not receive full data, do not try any more */
-			break;
+		TPP_DBPRT("tfd=%d, received %d bytes", conn->sock_fd, (int) rc);
+		conn->scratch.pos += rc;
+		conn->recv_calls++;
 
 		if (add_pkt(conn) != 0)
 			return;
+
+		if (rc < space_left) /* socket drained, do not try any more */
+			break;
 	}
 }
 
 /**
  * @brief
- *	Add a packet to the receivers buffer or if buffer is full
- *  add a deffered action, so that it can be checked later
+ *	Hand every complete packet in the receive scratch to the upper
+ *	layer, and move any partial packet left over to the start of the
+ *	scratch.
  *
  * @param[in] conn - The physical connection
  * 
  * @return Error code
  * @retval 0 - Success
- * @retval -1 - Failure
+ * @retval -1 - Failure, the connection was dropped
  *
  * @par Side Effects:
  *	None
@@ -1863,42 +1854,65 @@ handle_incoming_data(phy_conn_t *conn)
 static short
 add_pkt(phy_conn_t *conn)
 {
+	char *start = conn->scratch.data;
+	char *buf;
 	int avl_len;
 	int pkt_len;
 
-	avl_len = conn->scratch.pos - conn->scratch.data;
-	if (avl_len >= sizeof(int)) {
-		pkt_len = ntohl(*((int *) conn->scratch.data));
-		if (pkt_len < avl_len) {
+	avl_len = conn->scratch.pos - start;
+	while (avl_len >= (int) (sizeof(int) + sizeof(char))) {
+		pkt_len = ntohl(*((int *) start));
+		if (pkt_len < (int) (sizeof(int) + sizeof(char))) {
 			/* some data corruption has happened, or sombody trying DOS */
 			tpp_log(LOG_CRIT, __func__, "tfd=%d, Critical error in protocol header, pkt_len=%d, avl_len=%d, dropping connection",conn->sock_fd, pkt_len, avl_len);
 			handle_disconnect(conn);
 			return -1; /* treat as bad data rejected by upper layer */
 		}
-		if (avl_len == pkt_len) {
-			/* we got a full packet */
-			if (the_pkt_handler) {
-				if (the_pkt_handler(conn->sock_fd, conn->scratch.data, pkt_len, conn->ctx, conn->extra) != 0) {
-					/* upper layer rejected data, disconnect */
+		if (avl_len < pkt_len)
+			break; /* rest of this packet is still to come */
+
+		/* packet headers are read through structs, keep them aligned */
+		buf = start;
+		if ((start - conn->scratch.data) % TPP_PKT_ALIGN) {
+			if (conn->pkt_copy_len < pkt_len) {
+				buf = realloc(conn->pkt_copy, pkt_len);
+				if (!buf) {
+					tpp_log(LOG_CRIT, __func__, "Out of memory copying packet");
 					handle_disconnect(conn);
 					return -1;
 				}
+				conn->pkt_copy = buf;
+				conn->pkt_copy_len = pkt_len;
 			}
+			buf = conn->pkt_copy;
+			memcpy(buf, start, pkt_len);
+		}
 
-			/*
-			* no need to memmove or coalesce the data, since we would have read
-			* just enough for a packet, so, just reset pointers
-			*/
-			conn->scratch.pos = conn->scratch.data;
+		if (the_pkt_handler) {
+			if (the_pkt_handler(conn->sock_fd, buf, pkt_len, conn->ctx, conn->extra) != 0) {
+				/* upper layer rejected data, disconnect */
+				handle_disconnect(conn);
+				return -1;
+			}
 		}
+		conn->recv_pkts++;
+		start += pkt_len;
+		avl_len -= pkt_len;
+	}
+
+	if (start != conn->scratch.data) {
+		if (avl_len > 0)
+			memmove(conn->scratch.data, start, avl_len);
+		conn->scratch.pos = conn->scratch.data + avl_len;
 	}
 	return 0;
 }
 
 /**
  * @brief
- *	Loop over the list of queued data and send out packet by packet
- *	Stop if sending would block.
+ *	Send out the data queued on a connection. Packets are taken off the
+ *	send_mbox into a batch, and the unsent chunks of all packets in the
+ *	batch are written with a single writev. Stop if sending would block.
  *
  * @param[in] conn - The physical connection
  *
@@ -1911,11 +1925,13 @@ add_pkt(phy_conn_t *conn)
 static void
 send_data(phy_conn_t *conn)
 {
+	struct iovec iov[TPP_SEND_IOV];
 	tpp_chunk_t *p = NULL;
 	tpp_packet_t *pkt = NULL;
 	ssize_t rc;
-	int curr_pkt_done = 0;
-	size_t tosend;
+	size_t len;
+	int niov;
+	int i;
 
 	/*
 	 * if a socket is still connecting, we will wait to send out data,
@@ -1925,70 +1941,81 @@ send_data(phy_conn_t *conn)
 		return;
 
 	while ((conn->ev_mask & EM_OUT) == 0) {
-		rc = 0;
-		curr_pkt_done = 0;
-
-		pkt = conn->curr_send_pkt;
-		if (!pkt) {
-			/* get the next packet from send_mbox */
-			if (tpp_mbox_read(&conn->send_mbox, NULL, NULL, (void **) &conn->curr_send_pkt) != 0) {
+		/* top up the batch with packets from send_mbox */
+		while (conn->send_batch_cnt < TPP_SEND_BATCH) {
+			if (tpp_mbox_read(&conn->send_mbox, NULL, NULL, (void **) &pkt) != 0) {
 				if (!(errno == EAGAIN || errno == EWOULDBLOCK))
 					tpp_log(LOG_ERR, __func__, "tpp_mbox_read failed");
-				return;
+				break;
+			}
+			/* no data of this packet sent yet, presend handler could change pkt contents */
+			if (the_pkt_presend_handler && the_pkt_presend_handler(conn->sock_fd, pkt, conn->ctx, conn->extra) != 0) {
+				tpp_free_pkt(pkt);
+				continue;
 			}
-			pkt = conn->curr_send_pkt;
+			conn->send_batch[conn->send_batch_cnt++] = pkt;
 		}
-		p = pkt->curr_chunk;
+		if (conn->send_batch_cnt == 0)
+			return;
 
-		/* data available, first byte, presend handler present, call handler */
-		if ((p == GET_NEXT(pkt->chunks)) && (p->pos == p->data) && the_pkt_presend_handler) {
-			if ((rc = the_pkt_presend_handler(conn->sock_fd, pkt, conn->ctx, conn->extra)) == 0) {
-				p = pkt->curr_chunk; /* presend handler could change pkt contents */
+		/* gather the unsent chunks of the batch */
+		niov = 0;
+		for (i = 0; i < conn->send_batch_cnt && niov < TPP_SEND_IOV; i++) {
+			for (p = conn->send_batch[i]->curr_chunk; p && niov < TPP_SEND_IOV; p = GET_NEXT(p->chunk_link)) {
+				len = p->len - (p->pos - p->data);
+				if (len > 0) {
+					iov[niov].iov_base = p->pos;
+					iov[niov].iov_len = len;
+					niov++;
+				}
 			}
 		}
 
-		if (p && (rc == 0)) {
-			tosend = p->len - (p->pos - p->data);
-			while (tosend > 0) {
-				rc = tpp_sock_send(conn->sock_fd, p->pos, tosend, 0);
-				if (rc < 0) {
-					if (errno == EWOULDBLOCK || errno == EAGAIN) {
-						/* set this socket in POLLOUT */
-						conn->ev_mask |= EM_OUT;
-						TPP_DBPRT("EWOULDBLOCK, added EM_OUT to ev_mask, now=%x", conn->ev_mask);
-						if (tpp_em_mod_fd(conn->td->em_context, conn->sock_fd, conn->ev_mask)	== -1) {
-							tpp_log(LOG_ERR, __func__, "Multiplexing failed");
-							return;
-						}
-					} else {
-						handle_disconnect(conn);
-						return;
-					}
-					break;
-				}
-				TPP_DBPRT("tfd=%d, tosend=%d, sent=%d bytes", conn->sock_fd, tosend, rc);
-				p->pos += rc;
-				tosend -= rc;
+		rc = 0;
+		if (niov > 0) {
+			rc = tpp_sock_writev(conn->sock_fd, iov, niov);
+			if (rc < 0) {
+				if (errno == EWOULDBLOCK || errno == EAGAIN) {
+					/* set this socket in POLLOUT */
+					conn->ev_mask |= EM_OUT;
+					TPP_DBPRT("EWOULDBLOCK, added EM_OUT to ev_mask, now=%x", conn->ev_mask);
+					if (tpp_em_mod_fd(conn->td->em_context, conn->sock_fd, conn->ev_mask)	== -1)
+						tpp_log(LOG_ERR, __func__, "Multiplexing failed");
+				} else
+					handle_disconnect(conn);
+				return;
 			}
+			TPP_DBPRT("tfd=%d, chunks=%d, sent=%d bytes", conn->sock_fd, niov, (int) rc);
+			conn->send_calls++;
+			conn->send_bufs += niov;
+		}
 
-			if (tosend == 0) {
+		/*
+		 * move past the data sent; packets sent in full or done with
+		 * are freed, the first one not sent in full stays at the front
+		 */
+		for (i = 0; i < conn->send_batch_cnt; i++) {
+			pkt = conn->send_batch[i];
+			p = pkt->curr_chunk;
+			while (p) {
+				len = p->len - (p->pos - p->data);
+				if (len > (size_t) rc) {
+					p->pos += rc;
+					break;
+				}
+				p->pos += len;
+				rc -= len;
 				p = GET_NEXT(p->chunk_link);
 				if (p)
 					pkt->curr_chunk = p;
-				else
-					curr_pkt_done = 1;
 			}
-		} else
-			curr_pkt_done = 1;
-
-		if (pkt && curr_pkt_done) {
-			/*
-			* all data in this packet has been sent or done with.
-			* delete this node and get next node in queue
-			*/
+			if (p)
+				break;
 			tpp_free_pkt(pkt);
-			conn->curr_send_pkt = NULL;
 		}
+		conn->send_batch_cnt -= i;
+		if (i > 0 && conn->send_batch_cnt > 0)
+			memmove(&conn->send_batch[0], &conn->send_batch[i], conn->send_batch_cnt * sizeof(tpp_packet_t *));
 	}
 }
 
@@ -2010,6 +2037,7 @@ free_phy_conn(phy_conn_t *conn)
 	tpp_que_elem_t *n = NULL;
 	tpp_packet_t *pkt;
 	short cmd;
+	int i;
 
 	if (!conn)
 		return;
@@ -2027,8 +2055,12 @@ free_phy_conn(phy_conn_t *conn)
 
 	tpp_mbox_destroy(&conn->send_mbox);
 
+	for (i = 0; i < conn->send_batch_cnt; i++)
+		tpp_free_pkt(conn->send_batch[i]);
+
 	free(conn->ctx);
 	free(conn->scratch.data);
+	free(conn->pkt_copy);
 	free(conn);
 }
 
@@ -737,6 +737,52 @@ avl_find_key(AVL_IX_REC *pe, AVL_IX_DESC *pix)
 	return AVL_IX_OK;
 }
 
+/**
+ * @brief
+ *	find a record in tree without marking the search path.
+ *	Marks are per thread slots in every node, so a search which
+ *	doesn't set them can run in any number of threads at once,
+ *	as long as no thread modifies the tree meanwhile.
+ *
+ * @param[in] pe - key to search for.  With AVL_SRCH_EQUAL alone, the
+ *		   record pointer is ignored like in avl_find_key().
+ * @param[in] pix - pointer to tree
+ * @param[in] flags - AVL_SRCH_EQUAL to match the key, AVL_SRCH_GREAT
+ *		      to return the next greater record (both may be set)
+ *
+ * @return	AVL_IX_REC *
+ * @retval	record in the tree, valid until the tree is modified
+ * @retval	NULL	not found
+ *
+ */
+AVL_IX_REC *
+avl_search_key(AVL_IX_REC *pe, AVL_IX_DESC *pix, int flags)
+{
+	rectype *ptr;
+	AVL_RECPOS recptr;
+	int n;
+
+	ix_keylength = pix->keylength;
+	ix_flags = pix->flags;
+
+	if (flags & AVL_SRCH_GREAT)
+		return avltree_search((node **) &(pix->root), pe,
+				      flags & (SRF_FINDEQUAL | SRF_FINDGREAT));
+
+	/* with duplicates the first record of the key sorts after a NULL record pointer */
+	recptr = pe->recptr;
+	pe->recptr = NULL;
+	ptr = avltree_search((node **) &(pix->root), pe, SRF_FINDEQUAL | SRF_FINDGREAT);
+	if (ptr != NULL) {
+		pe->recptr = ptr->recptr;
+		n = compkey(pe, ptr);
+	} else
+		n = 1;
+	pe->recptr = recptr;
+
+	return n == 0 ? ptr : NULL;
+}
+
 /**
  * @brief
  *	add a key to the tree
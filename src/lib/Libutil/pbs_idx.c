@@ -39,6 +39,7 @@
 
 #include "pbs_idx.h"
 #include "avltree.h"
+#include <pthread.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
@@ -47,8 +48,154 @@
 typedef struct _iter_ctx {
 	AVL_IX_DESC *idx; /* pointer to idx */
 	AVL_IX_REC *pkey; /* pointer to key used while iteration */
+	size_t keysize;	  /* allocated size of pkey (PBS_IDX_CONCURRENT only) */
 } iter_ctx;
 
+/*
+ * A PBS_IDX_CONCURRENT index.  Readers search without marking the tree
+ * (see avl_search_key()) under a shared lock, so they run in parallel with
+ * each other and only wait for a writer.  An iteration remembers its last
+ * key and searches for the next greater one, so it survives changes made
+ * to the index between two steps.
+ */
+typedef struct _mt_idx {
+	AVL_IX_DESC ix; /* must be first, the index is used as an AVL_IX_DESC */
+	pthread_rwlock_t lock;
+} mt_idx;
+
+#define IS_MT_IDX(idx) (((AVL_IX_DESC *) (idx))->flags & PBS_IDX_CONCURRENT)
+#define MT_RDLOCK(idx) pthread_rwlock_rdlock(&((mt_idx *) (idx))->lock)
+#define MT_WRLOCK(idx) pthread_rwlock_wrlock(&((mt_idx *) (idx))->lock)
+#define MT_UNLOCK(idx) pthread_rwlock_unlock(&((mt_idx *) (idx))->lock)
+
+/**
+ * @brief
+ *	copy a record found in a concurrent index into a key
+ *	owned by the caller, growing the key if needed
+ *
+ * @param[in]     - idx     - pointer to index
+ * @param[in/out] - pkey    - key to copy into
+ * @param[in/out] - keysize - allocated size of *pkey
+ * @param[in]     - rec     - record to copy
+ *
+ * @return int
+ * @retval PBS_IDX_RET_OK   - success
+ * @retval PBS_IDX_RET_FAIL - failure
+ *
+ * @note
+ *	must be called with the index locked
+ *
+ */
+static int
+mt_copy_rec(AVL_IX_DESC *idx, AVL_IX_REC **pkey, size_t *keysize, AVL_IX_REC *rec)
+{
+	size_t klen;
+	size_t need;
+
+	klen = idx->keylength ? (size_t) idx->keylength : strlen(rec->key) + 1;
+	need = offsetof(AVL_IX_REC, key) + klen;
+	if (need < sizeof(AVL_IX_REC))
+		need = sizeof(AVL_IX_REC);
+	if (need > *keysize) {
+		AVL_IX_REC *tmp;
+
+		tmp = realloc(*pkey, need);
+		if (tmp == NULL)
+			return PBS_IDX_RET_FAIL;
+		*pkey = tmp;
+		*keysize = need;
+	}
+	(*pkey)->recptr = rec->recptr;
+	(*pkey)->count = rec->count;
+	memcpy((*pkey)->key, rec->key, klen);
+
+	return PBS_IDX_RET_OK;
+}
+
+/**
+ * @brief
+ *	find or iterate entry in a concurrent index
+ *
+ * @see pbs_idx_find()
+ *
+ */
+static int
+mt_idx_find(void *idx, void **key, void **data, void **ctx)
+{
+	iter_ctx *pctx;
+	AVL_IX_REC *pkey;
+	AVL_IX_REC *rec;
+	size_t keysize;
+	int rc = PBS_IDX_RET_FAIL;
+
+	*data = NULL;
+	if (ctx != NULL && *ctx != NULL) {
+		pctx = (iter_ctx *) *ctx;
+
+		if (key)
+			*key = NULL;
+
+		if (pctx->idx != idx || pctx->pkey == NULL)
+			return PBS_IDX_RET_FAIL;
+
+		MT_RDLOCK(idx);
+		rec = avl_search_key(pctx->pkey, idx, AVL_SRCH_GREAT);
+		if (rec != NULL) {
+			*data = rec->recptr;
+			rc = mt_copy_rec(idx, &pctx->pkey, &pctx->keysize, rec);
+		}
+		MT_UNLOCK(idx);
+
+		if (rc == PBS_IDX_RET_OK && key)
+			*key = &pctx->pkey->key;
+
+		return rc;
+	}
+
+	/* an empty key sorts before every other key, so it finds the first entry */
+	pkey = avlkey_create(idx, key ? *key : NULL);
+	if (pkey == NULL)
+		return PBS_IDX_RET_FAIL;
+	keysize = offsetof(AVL_IX_REC, key) + strlen(pkey->key) + 1;
+	if (((AVL_IX_DESC *) idx)->keylength)
+		keysize = offsetof(AVL_IX_REC, key) + ((AVL_IX_DESC *) idx)->keylength;
+
+	MT_RDLOCK(idx);
+	if (key != NULL && *key != NULL)
+		rec = avl_search_key(pkey, idx, AVL_SRCH_EQUAL);
+	else
+		rec = avl_search_key(pkey, idx, AVL_SRCH_EQUAL | AVL_SRCH_GREAT);
+	if (rec != NULL) {
+		*data = rec->recptr;
+		rc = PBS_IDX_RET_OK;
+		if (ctx != NULL)
+			rc = mt_copy_rec(idx, &pkey, &keysize, rec);
+	}
+	MT_UNLOCK(idx);
+
+	if (rc == PBS_IDX_RET_OK && ctx != NULL) {
+		pctx = (iter_ctx *) malloc(sizeof(iter_ctx));
+		if (pctx == NULL) {
+			free(pkey);
+			*data = NULL;
+			return PBS_IDX_RET_FAIL;
+		}
+		pctx->idx = idx;
+		pctx->pkey = pkey;
+		pctx->keysize = keysize;
+		*ctx = (void *) pctx;
+		if (key != NULL && *key == NULL)
+			*key = &pkey->key;
+
+		return PBS_IDX_RET_OK;
+	}
+	if (rc != PBS_IDX_RET_OK)
+		*data = NULL;
+	free(pkey);
+
+	return rc;
+}
+
 /**
  * @brief
  *	Create an empty index
@@ -66,7 +213,10 @@ pbs_idx_create(int flags, int keylen)
 {
 	void *idx = NULL;
 
-	idx = malloc(sizeof(AVL_IX_DESC));
+	if (flags & PBS_IDX_CONCURRENT)
+		idx = malloc(sizeof(mt_idx));
+	else
+		idx = malloc(sizeof(AVL_IX_DESC));
 	if (idx == NULL)
 		return NULL;
 
@@ -75,6 +225,24 @@ pbs_idx_create(int flags, int keylen)
 		return NULL;
 	}
 
+	if (flags & PBS_IDX_CONCURRENT) {
+		pthread_rwlockattr_t attr;
+		int rc;
+
+		/* a stream of readers must not hold off the thread changing the index */
+		pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+		pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+		rc = pthread_rwlock_init(&((mt_idx *) idx)->lock, &attr);
+		pthread_rwlockattr_destroy(&attr);
+		if (rc != 0) {
+			avl_destroy_index(idx);
+			free(idx);
+			return NULL;
+		}
+	}
+
 	return idx;
 }
 
@@ -92,6 +260,8 @@ pbs_idx_destroy(void *idx)
 {
 	if (idx != NULL) {
 		avl_destroy_index(idx);
+		if (IS_MT_IDX(idx))
+			pthread_rwlock_destroy(&((mt_idx *) idx)->lock);
 		free(idx);
 		idx = NULL;
 	}
@@ -123,6 +293,15 @@ pbs_idx_insert(void *idx, void *key, void *data)
 		return PBS_IDX_RET_FAIL;
 
 	pkey->recptr = data;
+	if (IS_MT_IDX(idx)) {
+		int rc;
+
+		MT_WRLOCK(idx);
+		rc = avl_add_key(pkey, idx);
+		MT_UNLOCK(idx);
+		free(pkey);
+		return rc == AVL_IX_OK ? PBS_IDX_RET_OK : PBS_IDX_RET_FAIL;
+	}
 	if (avl_add_key(pkey, idx) != AVL_IX_OK) {
 		free(pkey);
 		return PBS_IDX_RET_FAIL;
@@ -156,7 +335,12 @@ pbs_idx_delete(void *idx, void *key)
 		return PBS_IDX_RET_FAIL;
 
 	pkey->recptr = NULL;
-	avl_delete_key(pkey, idx);
+	if (IS_MT_IDX(idx)) {
+		MT_WRLOCK(idx);
+		avl_delete_key(pkey, idx);
+		MT_UNLOCK(idx);
+	} else
+		avl_delete_key(pkey, idx);
 	free(pkey);
 	return PBS_IDX_RET_OK;
 }
@@ -181,7 +365,12 @@ pbs_idx_delete_byctx(void *ctx)
 	if (pctx == NULL || pctx->idx == NULL || pctx->pkey == NULL)
 		return PBS_IDX_RET_FAIL;
 
-	avl_delete_key(pctx->pkey, pctx->idx);
+	if (IS_MT_IDX(pctx->idx)) {
+		MT_WRLOCK(pctx->idx);
+		avl_delete_key(pctx->pkey, pctx->idx);
+		MT_UNLOCK(pctx->idx);
+	} else
+		avl_delete_key(pctx->pkey, pctx->idx);
 	return PBS_IDX_RET_OK;
 }
 
@@ -218,6 +407,9 @@ pbs_idx_find(void *idx, void **key, void **data, void **ctx)
 	if (idx == NULL || data == NULL)
 		return PBS_IDX_RET_FAIL;
 
+	if (IS_MT_IDX(idx))
+		return mt_idx_find(idx, key, data, ctx);
+
 	if (ctx != NULL && *ctx != NULL) {
 		pctx = (iter_ctx *) *ctx;
 
@@ -261,6 +453,7 @@ pbs_idx_find(void *idx, void **key, void **data, void **ctx)
 				}
 				pctx->idx = idx;
 				pctx->pkey = pkey;
+				pctx->keysize = 0;
 				*ctx = (void *) pctx;
 
 				return PBS_IDX_RET_OK;
@@ -272,6 +465,60 @@ pbs_idx_find(void *idx, void **key, void **data, void **ctx)
 	return rc == AVL_IX_OK ? PBS_IDX_RET_OK : PBS_IDX_RET_FAIL;
 }
 
+/**
+ * @brief
+ *	find the first entry in index whose key is
+ *	greater than or equal to given key
+ *
+ * @param[in]  - idx  - pointer to index
+ * @param[in]  - key  - key to search for
+ * @param[out] - data - data of the entry found
+ *
+ * @return int
+ * @retval PBS_IDX_RET_OK   - success
+ * @retval PBS_IDX_RET_FAIL - failure or no such entry
+ *
+ * @note
+ *	only meaningful for indexes created with a fixed key length
+ *	and without PBS_IDX_DUPS_OK
+ *
+ */
+int
+pbs_idx_find_ge(void *idx, void *key, void **data)
+{
+	AVL_IX_REC *pkey;
+
+	if (idx == NULL || key == NULL || data == NULL)
+		return PBS_IDX_RET_FAIL;
+
+	*data = NULL;
+	pkey = avlkey_create(idx, key);
+	if (pkey == NULL)
+		return PBS_IDX_RET_FAIL;
+
+	if (IS_MT_IDX(idx)) {
+		AVL_IX_REC *rec;
+
+		MT_RDLOCK(idx);
+		rec = avl_search_key(pkey, idx, AVL_SRCH_EQUAL | AVL_SRCH_GREAT);
+		if (rec != NULL)
+			*data = rec->recptr;
+		MT_UNLOCK(idx);
+		free(pkey);
+		return *data != NULL ? PBS_IDX_RET_OK : PBS_IDX_RET_FAIL;
+	}
+
+	/*
+	 * avl_find_key() leaves the nearest greater record in recptr
+	 * even when it does not find an exact match
+	 */
+	(void) avl_find_key(pkey, idx);
+	*data = pkey->recptr;
+	free(pkey);
+
+	return *data != NULL ? PBS_IDX_RET_OK : PBS_IDX_RET_FAIL;
+}
+
 /**
  * @brief
  *	free given iteration context
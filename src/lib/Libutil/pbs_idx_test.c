@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	pbs_idx_test.c
+ * @brief
+ *	Unit test of the PBS_IDX_CONCURRENT index flavor.
+ *
+ *	Checks that an iteration of a concurrent index survives keys being
+ *	inserted and deleted between its steps, including the key it stands
+ *	on, and that reader threads iterating and searching the index while
+ *	the main thread changes it always see the keys in order and never
+ *	miss a key which was not touched.  Exits 0 on success, 1 on failure.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "pbs_idx.h"
+
+#define NUM_KEYS	20000
+#define NUM_READERS	4
+#define NUM_CHANGES	200000
+
+static char keys[NUM_KEYS][16];	/* "<n>.svr", zero padded so they sort as n */
+static int vals[NUM_KEYS];	/* data of key n is &vals[n], vals[n] == n */
+static int present[NUM_KEYS];	/* key n is in the index */
+static volatile int writer_done;
+
+/**
+ * @brief
+ *	insert key n into the index
+ *
+ * @param[in]	idx - the index
+ * @param[in]	n - key number
+ *
+ * @return int
+ * @retval	0 - success
+ * @retval	1 - failure
+ */
+static int
+add_key(void *idx, int n)
+{
+	if (pbs_idx_insert(idx, keys[n], &vals[n]) != PBS_IDX_RET_OK) {
+		fprintf(stderr, "insert of %s failed\n", keys[n]);
+		return 1;
+	}
+	present[n] = 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	delete key n from the index
+ *
+ * @param[in]	idx - the index
+ * @param[in]	n - key number
+ *
+ * @return int
+ * @retval	0 - success
+ * @retval	1 - failure
+ */
+static int
+del_key(void *idx, int n)
+{
+	if (pbs_idx_delete(idx, keys[n]) != PBS_IDX_RET_OK) {
+		fprintf(stderr, "delete of %s failed\n", keys[n]);
+		return 1;
+	}
+	present[n] = 0;
+	return 0;
+}
+
+/**
+ * @brief
+ *	iterate an index holding the even keys while changing it between
+ *	the steps.  At each key the iteration deletes the key it stands on
+ *	now and then, deletes a key ahead of it, and inserts one key just
+ *	behind it and one just ahead of it.
+ *
+ * @par	The iteration must return keys in increasing order, each once,
+ *	never a key deleted before it was reached or inserted behind the
+ *	iteration, and every other key that is in the index when it ends.
+ *
+ * @return int
+ * @retval	0 - success
+ * @retval	1 - failure
+ */
+static int
+iterate_while_changing(void)
+{
+	static int seen[NUM_KEYS];
+	void *idx;
+	void *ctx = NULL;
+	void *data;
+	int last = -1;
+	int n;
+	int rc;
+
+	if ((idx = pbs_idx_create(PBS_IDX_CONCURRENT, 0)) == NULL) {
+		fprintf(stderr, "pbs_idx_create failed\n");
+		return 1;
+	}
+	for (n = 0; n < NUM_KEYS; n++) {
+		present[n] = 0;
+		seen[n] = 0;
+	}
+	for (n = 0; n < NUM_KEYS; n += 2)
+		if (add_key(idx, n))
+			return 1;
+
+	rc = pbs_idx_find(idx, NULL, &data, &ctx);
+	while (rc == PBS_IDX_RET_OK) {
+		n = *(int *) data;
+		if (n <= last) {
+			fprintf(stderr, "iteration went from %d back to %d\n", last, n);
+			return 1;
+		}
+		if (!present[n]) {
+			fprintf(stderr, "iteration returned deleted key %d\n", n);
+			return 1;
+		}
+		seen[n] = 1;
+		last = n;
+
+		if (n % 3 == 0 && del_key(idx, n))
+			return 1;
+		if (n % 10 == 0 && n + 2 < NUM_KEYS && present[n + 2] && del_key(idx, n + 2))
+			return 1;
+		if (n % 4 == 0 && n > 0 && add_key(idx, n - 1))
+			return 1;
+		if (n % 4 == 0 && n + 1 < NUM_KEYS && add_key(idx, n + 1))
+			return 1;
+
+		rc = pbs_idx_find(idx, NULL, &data, &ctx);
+	}
+	pbs_idx_free_ctx(ctx);
+
+	for (n = 0; n < NUM_KEYS; n++) {
+		if (present[n] && !seen[n] && n % 4 != 3) {
+			fprintf(stderr, "iteration missed key %d\n", n);
+			return 1;
+		}
+		if (seen[n] && n % 4 == 3) {
+			fprintf(stderr, "iteration returned key %d inserted behind it\n", n);
+			return 1;
+		}
+	}
+	pbs_idx_destroy(idx);
+	return 0;
+}
+
+/**
+ * @brief
+ *	reader thread: until the writer is done, iterate the whole index
+ *	checking the order and that no key of the untouched set (multiples
+ *	of 3) is missing, and look up keys of that set directly
+ *
+ * @param[in]	arg - the index
+ *
+ * @return void *
+ * @retval	NULL - success
+ * @retval	arg - failure
+ */
+static void *
+reader(void *arg)
+{
+	void *idx = arg;
+	void *ctx;
+	void *data;
+	void *key;
+	int expect;
+	int last;
+	int n;
+	int rc;
+
+	do {
+		ctx = NULL;
+		last = -1;
+		expect = 0;
+		rc = pbs_idx_find(idx, NULL, &data, &ctx);
+		while (rc == PBS_IDX_RET_OK) {
+			n = *(int *) data;
+			if (n <= last) {
+				fprintf(stderr, "reader went from %d back to %d\n", last, n);
+				return arg;
+			}
+			if (n > expect) {
+				fprintf(stderr, "reader missed untouched key %d\n", expect);
+				return arg;
+			}
+			if (n == expect)
+				expect += 3;
+			last = n;
+			rc = pbs_idx_find(idx, NULL, &data, &ctx);
+		}
+		pbs_idx_free_ctx(ctx);
+		if (expect < NUM_KEYS) {
+			fprintf(stderr, "reader stopped before untouched key %d\n", expect);
+			return arg;
+		}
+
+		for (n = 0; n < NUM_KEYS; n += 3 * 97) {
+			key = keys[n];
+			if (pbs_idx_find(idx, &key, &data, NULL) != PBS_IDX_RET_OK || *(int *) data != n) {
+				fprintf(stderr, "reader did not find untouched key %d\n", n);
+				return arg;
+			}
+		}
+	} while (!writer_done);
+
+	return NULL;
+}
+
+/**
+ * @brief
+ *	run reader threads against the main thread deleting and inserting
+ *	every key which is not a multiple of 3
+ *
+ * @return int
+ * @retval	0 - success
+ * @retval	1 - failure
+ */
+static int
+read_while_writing(void)
+{
+	pthread_t tids[NUM_READERS];
+	void *idx;
+	void *ret;
+	int failed = 0;
+	int i;
+	int n;
+
+	if ((idx = pbs_idx_create(PBS_IDX_CONCURRENT, 0)) == NULL) {
+		fprintf(stderr, "pbs_idx_create failed\n");
+		return 1;
+	}
+	for (n = 0; n < NUM_KEYS; n++)
+		if (add_key(idx, n))
+			return 1;
+
+	writer_done = 0;
+	for (i = 0; i < NUM_READERS; i++) {
+		if (pthread_create(&tids[i], NULL, reader, idx) != 0) {
+			fprintf(stderr, "pthread_create failed\n");
+			return 1;
+		}
+	}
+
+	srand(1);
+	for (i = 0; i < NUM_CHANGES && !failed; i++) {
+		n = rand() % NUM_KEYS;
+		if (n % 3 == 0)
+			continue;
+		failed = present[n] ? del_key(idx, n) : add_key(idx, n);
+	}
+	writer_done = 1;
+
+	for (i = 0; i < NUM_READERS; i++) {
+		pthread_join(tids[i], &ret);
+		if (ret != NULL)
+			failed = 1;
+	}
+	pbs_idx_destroy(idx);
+	return failed;
+}
+
+/**
+ * @brief
+ *	run the tests
+ *
+ * @return int
+ * @retval	0 - success
+ * @retval	1 - failure
+ */
+int
+main(int argc, char *argv[])
+{
+	int n;
+
+	for (n = 0; n < NUM_KEYS; n++) {
+		snprintf(keys[n], sizeof(keys[n]), "%06d.svr", n);
+		vals[n] = n;
+	}
+
+	if (iterate_while_changing() || read_while_writing()) {
+		fprintf(stderr, "pbs_idx_test failed\n");
+		return 1;
+	}
+	printf("pbs_idx_test passed\n");
+	return 0;
+}
@@ -59,11 +59,160 @@
 
 extern pbs_list_head task_list_immed; /* list of tasks that can execute now */
 extern pbs_list_head task_list_interleave; /* list of tasks that can execute after interleaving other tasks */
-extern pbs_list_head task_list_timed; /* list of tasks that have set start times */
 extern pbs_list_head task_list_event; /* list of tasks responding to an event */
 extern int svr_delay_entry;
 extern time_t	time_now;
 
+/*
+ * WORK_Timed tasks are kept on a binary min-heap ordered by (wt_event, wt_seq)
+ * rather than on a sorted list, so adding, removing and finding the
+ * next task to run are O(log n) instead of a walk of every pending timer.
+ * Each task records its heap position in wt_heapind.
+ */
+static struct work_task **timed_heap = NULL;
+static int timed_heap_len = 0;
+static int timed_heap_size = 0;
+static unsigned long timed_seq = 0;
+
+#define TIMED_HEAP_INIT_SIZE 1024
+
+/**
+ * @brief
+ *	Does timed task 'a' run before timed task 'b'?
+ *
+ * @return int
+ * @retval 1 if 'a' runs first
+ * @retval 0 otherwise
+ */
+static int
+timed_before(struct work_task *a, struct work_task *b)
+{
+	if (a->wt_event != b->wt_event)
+		return (a->wt_event < b->wt_event);
+	return (a->wt_seq < b->wt_seq);
+}
+
+/**
+ * @brief
+ *	Place a task at a position in the timed heap
+ *
+ * @param[in]	ptask	- the task
+ * @param[in]	ind	- its new position
+ */
+static void
+timed_heap_set(struct work_task *ptask, int ind)
+{
+	timed_heap[ind] = ptask;
+	ptask->wt_heapind = ind;
+}
+
+/**
+ * @brief
+ *	Move the task at position 'ind' up the heap until it is in order
+ *
+ * @param[in]	ind	- position of the task
+ */
+static void
+timed_heap_up(int ind)
+{
+	struct work_task *ptask = timed_heap[ind];
+
+	while (ind > 0) {
+		int parent = (ind - 1) / 2;
+
+		if (!timed_before(ptask, timed_heap[parent]))
+			break;
+		timed_heap_set(timed_heap[parent], ind);
+		ind = parent;
+	}
+	timed_heap_set(ptask, ind);
+}
+
+/**
+ * @brief
+ *	Move the task at position 'ind' down the heap until it is in order
+ *
+ * @param[in]	ind	- position of the task
+ */
+static void
+timed_heap_down(int ind)
+{
+	struct work_task *ptask = timed_heap[ind];
+
+	for (;;) {
+		int child = 2 * ind + 1;
+
+		if (child >= timed_heap_len)
+			break;
+		if (child + 1 < timed_heap_len && timed_before(timed_heap[child + 1], timed_heap[child]))
+			child++;
+		if (!timed_before(timed_heap[child], ptask))
+			break;
+		timed_heap_set(timed_heap[child], ind);
+		ind = child;
+	}
+	timed_heap_set(ptask, ind);
+}
+
+/**
+ * @brief
+ *	Add a task to the timed heap
+ *
+ * @param[in]	ptask	- the task, wt_event is the time it should run
+ *
+ * @return int
+ * @retval 0	- success
+ * @retval -1	- out of memory
+ */
+static int
+timed_heap_add(struct work_task *ptask)
+{
+	if (timed_heap_len == timed_heap_size) {
+		struct work_task **tmp;
+		int new_size;
+
+		new_size = (timed_heap_size == 0) ? TIMED_HEAP_INIT_SIZE : timed_heap_size * 2;
+		tmp = (struct work_task **)realloc(timed_heap, new_size * sizeof(struct work_task *));
+		if (tmp == NULL)
+			return -1;
+		timed_heap = tmp;
+		timed_heap_size = new_size;
+	}
+
+	ptask->wt_seq = timed_seq++;
+	timed_heap_set(ptask, timed_heap_len++);
+	timed_heap_up(ptask->wt_heapind);
+
+	return 0;
+}
+
+/**
+ * @brief
+ *	Remove a task from the timed heap, if it is on it
+ *
+ * @param[in]	ptask	- the task
+ */
+static void
+timed_heap_remove(struct work_task *ptask)
+{
+	int ind = ptask->wt_heapind;
+	struct work_task *plast;
+
+	if (ind < 0 || ind >= timed_heap_len || timed_heap[ind] != ptask)
+		return;
+
+	ptask->wt_heapind = -1;
+	plast = timed_heap[--timed_heap_len];
+	if (plast == ptask)
+		return;
+
+	timed_heap_set(plast, ind);
+	if (ind > 0 && timed_before(plast, timed_heap[(ind - 1) / 2]))
+		timed_heap_up(ind);
+	else
+		timed_heap_down(ind);
+}
+
 /**
  *
  * @brief
@@ -85,7 +234,6 @@ extern time_t	time_now;
 struct work_task *set_task(enum work_type type, long event_id, void (*func)(struct work_task *) , void *parm)
 {
 	struct work_task *pnew;
-	struct work_task *pold;
 
 	pnew = (struct work_task *)malloc(sizeof(struct work_task));
 	if (pnew == NULL)
@@ -102,23 +250,18 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 	pnew->wt_parm3 = NULL;
 	pnew->wt_aux   = 0;
 	pnew->wt_aux2  = 0;
+	pnew->wt_heapind = -1;
+	pnew->wt_seq = 0;
 
 	if (type == WORK_Immed)
 		append_link(&task_list_immed, &pnew->wt_linkevent, pnew);
 	else if (type == WORK_Interleave)
 		append_link(&task_list_interleave, &pnew->wt_linkevent, pnew);
 	else if (type == WORK_Timed) {
-		pold = (struct work_task *)GET_NEXT(task_list_timed);
-		while (pold) {
-			if (pold->wt_event > pnew->wt_event)
-				break;
-			pold = (struct work_task *)GET_NEXT(pold->wt_linkevent);
+		if (timed_heap_add(pnew) != 0) {
+			free(pnew);
+			return NULL;
 		}
-		if (pold)
-			insert_link(&pold->wt_linkevent, &pnew->wt_linkevent, pnew,
-				LINK_INSET_BEFORE);
-		else
-			append_link(&task_list_timed, &pnew->wt_linkevent, pnew);
 	} else
 		append_link(&task_list_event, &pnew->wt_linkevent, pnew);
 	return (pnew);
@@ -144,23 +287,48 @@ convert_work_task(struct work_task *ptask, enum work_type wtype)
 	if (!ptask)
 		return -1;
 
+	timed_heap_remove(ptask);
+	delete_link(&ptask->wt_linkevent);
+
 	switch (wtype) {
 	case WORK_Immed:
 		list = &task_list_immed;
 		break;
 	case WORK_Timed:
-		list = &task_list_timed;
-		break;
+		return timed_heap_add(ptask);
 	default:
 		list = &task_list_event;
 	}
 
-	delete_link(&ptask->wt_linkevent);
 	append_link(list, &ptask->wt_linkevent, ptask);
 
 	return 0;
 }
 
+/**
+ *
+ * @brief
+ * 	Change the time a WORK_Timed task will run at.
+ *
+ * @param[in]	ptask	- the timed task
+ * @param[in]	when	- the new time
+ *
+ * @return int
+ * @retval 0: success
+ * @retval -1: failure
+ */
+int
+set_task_time(struct work_task *ptask, long when)
+{
+	if (ptask == NULL || ptask->wt_heapind < 0)
+		return -1;
+
+	timed_heap_remove(ptask);
+	ptask->wt_event = when;
+
+	return timed_heap_add(ptask);
+}
+
 /**
  *
  * @brief
@@ -177,6 +345,7 @@ convert_work_task(struct work_task *ptask, enum work_type wtype)
 void
 dispatch_task(struct work_task *ptask)
 {
+	timed_heap_remove(ptask);
 	delete_link(&ptask->wt_linkevent);
 	delete_link(&ptask->wt_linkobj);
 	delete_link(&ptask->wt_linkobj2);
@@ -196,6 +365,7 @@ dispatch_task(struct work_task *ptask)
 void
 delete_task(struct work_task *ptask)
 {
+	timed_heap_remove(ptask);
 	delete_link(&ptask->wt_linkobj);
 	delete_link(&ptask->wt_linkobj2);
 	delete_link(&ptask->wt_linkevent);
@@ -236,10 +406,42 @@ find_worktask_by_parm_func(pbs_list_head task_list, void *parm1, void *func)
 	return NULL;
 }
 
+/**
+ * @brief
+ *	Check if some task on the timed task heap
+ *	has a wt_parm1 matching 'parm1'
+ *	and wt_func matching 'func'
+ *
+ * @param[in]	parm1	- parameter being matched.
+ * @param[in]	func	- function being matched.
+ *
+ * @return work task
+ * @retval	!NULL if 'parm1' and 'func' was matched
+ * @retval	NULL otherwise
+ */
+static struct work_task *
+find_timed_task_by_parm_func(void *parm1, void *func)
+{
+	int i;
+
+	for (i = 0; i < timed_heap_len; i++) {
+		struct work_task *ptask = timed_heap[i];
+
+		if (parm1 && (ptask->wt_parm1 != parm1))
+			continue;
+		if (func && (ptask->wt_func != func))
+			continue;
+
+		return ptask;
+	}
+
+	return NULL;
+}
+
 /**
  * @brief
  *	Check if some task in in any of the task lists (task_list_event,
- *	task_list_timed, task_list_immed)
+ *	timed tasks, task_list_immed)
  *	has a wt_parm1 matching 'parm1'
  *	and wt_func matching 'func'
  *
@@ -263,7 +465,7 @@ find_work_task(enum work_type wtype, void *parm1, void *func)
 	}
 
 	if (wtype == -1 || wtype == WORK_Timed) {
-		ptask = find_worktask_by_parm_func(task_list_timed, parm1, func);
+		ptask = find_timed_task_by_parm_func(parm1, func);
 		if (ptask)
 			return ptask;
 	}
@@ -282,7 +484,7 @@ find_work_task(enum work_type wtype, void *parm1, void *func)
  *
  * @brief
  *	Delete task found in task_list_event, task_list_immed, or
- *	task_list_timed by either its function pointer, parm1, or both.
+ *	the timed tasks by either its function pointer, parm1, or both.
  * 	At least one of the function pointer or parm1 must not be NULL.
  *
  * @param[in]	parm1	- wt->parm1 parameter to match (can be NULL)
@@ -298,13 +500,13 @@ delete_task_by_parm1_func(void *parm1, void (*func)(struct work_task *), enum wt
 {
 	struct work_task  *ptask;
 	struct work_task  *ptask_next;
-	pbs_list_head task_lists[] = {task_list_event, task_list_timed, task_list_immed};
+	pbs_list_head task_lists[] = {task_list_event, task_list_immed};
 	int i;
 
 	if (parm1 == NULL && func == NULL)
 		return;
 
-	for (i = 0; i < 3; i++) {
+	for (i = 0; i < 2; i++) {
 		for (ptask = (struct work_task *) GET_NEXT(task_lists[i]); ptask; ptask = ptask_next) {
 			ptask_next = (struct work_task *) GET_NEXT(ptask->wt_linkevent);
 
@@ -317,6 +519,37 @@ delete_task_by_parm1_func(void *parm1, void (*func)(struct work_task *), enum wt
 			if (option == DELETE_ONE)
 				return;
 		}
+
+		if (i == 0) {
+			/* timed tasks are searched between the event and immediate lists */
+			int j;
+
+			/*
+			 * Deleting moves the last task of the heap into slot j and
+			 * sifts it up or down.  Tasks sifted down into slot j and
+			 * below are still ahead of the scan, so slot j is checked
+			 * again.  If the moved task went up past the scan it is the
+			 * only unchecked one behind it, so resume from where it is.
+			 */
+			for (j = 0; j < timed_heap_len;) {
+				struct work_task *plast;
+
+				ptask = timed_heap[j];
+
+				if (((parm1 != NULL) && (ptask->wt_parm1 != parm1)) ||
+					((func != NULL) && (ptask->wt_func != func))) {
+					j++;
+					continue;
+				}
+
+				plast = timed_heap[timed_heap_len - 1];
+				delete_task(ptask);
+				if (option == DELETE_ONE)
+					return;
+				if ((plast != ptask) && (plast->wt_heapind < j))
+					j = plast->wt_heapind;
+			}
+		}
 	}
 }
 
@@ -324,7 +557,7 @@ delete_task_by_parm1_func(void *parm1, void (*func)(struct work_task *), enum wt
  *
  * @brief
  *	Check if some task in any of the task lists (task_list_event,
- *	task_list_timed, task_list_immed) has a wt_parm1 matching 'parm1'.
+ *	timed tasks, task_list_immed) has a wt_parm1 matching 'parm1'.
  *
  * @param[in]	parm1	- parameter being matched.
  *
@@ -402,7 +635,8 @@ default_next_task(void)
 	}
 
 
-	while ((ptask=(struct work_task *)GET_NEXT(task_list_timed))!=NULL) {
+	while (timed_heap_len > 0) {
+		ptask = timed_heap[0];
 		if ((delay = ptask->wt_event - time_now) > 0) {
 			if (tilwhen > delay)
 				tilwhen = delay;
@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	work_task_test.c
+ * @brief
+ *	Unit test of the timed work task heap.
+ *
+ *	Fills the heap with timed tasks of several objects, deletes all the
+ *	tasks of some objects with delete_task_by_parm1_func() and checks that
+ *	none of them is left behind and that the others still run in time
+ *	order.  Exits 0 on success, 1 on failure.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "list_link.h"
+#include "work_task.h"
+
+#define NUM_OBJS	8
+#define NUM_TASKS	2000
+#define NUM_ROUNDS	50
+#define NUM_TIES	100
+
+pbs_list_head task_list_immed;
+pbs_list_head task_list_interleave;
+pbs_list_head task_list_event;
+int svr_delay_entry = 0;
+time_t time_now;
+
+static int objs[NUM_OBJS];	/* the objects, tasks point at these */
+static int deleted[NUM_OBJS];	/* tasks of this object were deleted */
+static int ran;			/* tasks dispatched */
+static long last_event;		/* event time of the last dispatched task */
+static int failed;
+
+static int ties[NUM_TIES];	/* tasks of run_ties() point at these */
+static int tie_order[NUM_TIES];	/* order the tie tasks ran in */
+static int num_tie_ran;
+
+/**
+ * @brief
+ *	work task function, checks the task was not deleted and runs in order
+ *
+ * @param[in]	ptask - the task
+ */
+static void
+task_func(struct work_task *ptask)
+{
+	int obj = (int *)ptask->wt_parm1 - objs;
+
+	if (deleted[obj]) {
+		fprintf(stderr, "task of deleted object %d was left on the heap\n", obj);
+		failed = 1;
+	}
+	if (ptask->wt_event < last_event) {
+		fprintf(stderr, "task at %ld ran after task at %ld\n", ptask->wt_event, last_event);
+		failed = 1;
+	}
+	last_event = ptask->wt_event;
+	ran++;
+}
+
+/**
+ * @brief
+ *	run one round: add tasks, delete the tasks of half the objects and
+ *	dispatch the rest
+ *
+ * @param[in]	round - round number, seeds the random times
+ *
+ * @return int
+ * @retval	0 - success
+ * @retval	1 - failure
+ */
+static int
+run_round(int round)
+{
+	int count[NUM_OBJS] = {0};
+	int expected = 0;
+	int i;
+
+	srand(round);
+	for (i = 0; i < NUM_OBJS; i++)
+		deleted[i] = 0;
+
+	for (i = 0; i < NUM_TASKS; i++) {
+		int obj = rand() % NUM_OBJS;
+
+		/* times in the past, so default_next_task() dispatches them all */
+		if (set_task(WORK_Timed, 1 + rand() % 1000, task_func, &objs[obj]) == NULL) {
+			fprintf(stderr, "set_task failed\n");
+			return 1;
+		}
+		count[obj]++;
+	}
+
+	for (i = 0; i < NUM_OBJS; i++) {
+		if ((i + round) % 2) {
+			delete_task_by_parm1_func(&objs[i], NULL, DELETE_ALL);
+			deleted[i] = 1;
+			if (has_task_by_parm1(&objs[i])) {
+				fprintf(stderr, "round %d: task of object %d not deleted\n", round, i);
+				return 1;
+			}
+		} else
+			expected += count[i];
+	}
+
+	ran = 0;
+	last_event = 0;
+	(void)default_next_task();
+	if (ran != expected) {
+		fprintf(stderr, "round %d: %d tasks ran, expected %d\n", round, ran, expected);
+		return 1;
+	}
+	return failed;
+}
+
+/**
+ * @brief
+ *	work task function for run_ties(), records the order tasks ran in
+ *
+ * @param[in]	ptask - the task
+ */
+static void
+tie_func(struct work_task *ptask)
+{
+	if (num_tie_ran < NUM_TIES)
+		tie_order[num_tie_ran] = (int *)ptask->wt_parm1 - ties;
+	num_tie_ran++;
+}
+
+/**
+ * @brief
+ *	work task function for tasks which must never run
+ *
+ * @param[in]	ptask - the task
+ */
+static void
+future_func(struct work_task *ptask)
+{
+	fprintf(stderr, "future task ran\n");
+	failed = 1;
+}
+
+/**
+ * @brief
+ *	check that timed tasks due at the same time run in the order they
+ *	were added, including tasks moved with set_task_time(), that
+ *	DELETE_ONE deletes one task and that future tasks are left alone
+ *
+ * @return int
+ * @retval	0 - success
+ * @retval	1 - failure
+ */
+static int
+run_ties(void)
+{
+	struct work_task *moved[NUM_TIES];
+	static int spare;
+	int i;
+
+	/* even tasks are added at time 5, odd tasks at time 1 and then moved
+	 * to time 5, so they go behind all of the even ones
+	 */
+	for (i = 0; i < NUM_TIES; i++) {
+		moved[i] = set_task(WORK_Timed, (i % 2) ? 1 : 5, tie_func, &ties[i]);
+		if (moved[i] == NULL) {
+			fprintf(stderr, "set_task failed\n");
+			return 1;
+		}
+	}
+	for (i = 1; i < NUM_TIES; i += 2) {
+		if (set_task_time(moved[i], 5) != 0) {
+			fprintf(stderr, "set_task_time failed\n");
+			return 1;
+		}
+	}
+
+	/* two future tasks of one object, and one of an object with a past task */
+	for (i = 0; i < 2; i++) {
+		if (set_task(WORK_Timed, time(NULL) + 1000, future_func, &spare) == NULL) {
+			fprintf(stderr, "set_task failed\n");
+			return 1;
+		}
+	}
+	if (set_task(WORK_Timed, time(NULL) + 1000, future_func, &ties[0]) == NULL) {
+		fprintf(stderr, "set_task failed\n");
+		return 1;
+	}
+
+	delete_task_by_parm1_func(&spare, NULL, DELETE_ONE);
+	if (!has_task_by_parm1(&spare)) {
+		fprintf(stderr, "DELETE_ONE deleted both tasks of the object\n");
+		return 1;
+	}
+
+	num_tie_ran = 0;
+	(void)default_next_task();
+	if (num_tie_ran != NUM_TIES || failed) {
+		fprintf(stderr, "%d tie tasks ran, expected %d\n", num_tie_ran, NUM_TIES);
+		return 1;
+	}
+	for (i = 0; i < NUM_TIES; i++) {
+		int want = (i < NUM_TIES / 2) ? i * 2 : (i - NUM_TIES / 2) * 2 + 1;
+
+		if (tie_order[i] != want) {
+			fprintf(stderr, "tie task %d ran at position %d\n", tie_order[i], i);
+			return 1;
+		}
+	}
+
+	/* only the future tasks are left; the func filter must pick ours */
+	delete_task_by_parm1_func(&ties[0], tie_func, DELETE_ALL);
+	if (!has_task_by_parm1(&ties[0])) {
+		fprintf(stderr, "task deleted by the wrong function\n");
+		return 1;
+	}
+	delete_task_by_parm1_func(&ties[0], future_func, DELETE_ALL);
+	delete_task_by_parm1_func(&spare, NULL, DELETE_ONE);
+	if (has_task_by_parm1(&ties[0]) || has_task_by_parm1(&spare)) {
+		fprintf(stderr, "future tasks not deleted\n");
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	run the rounds of the test
+ *
+ * @return int
+ * @retval	0 - success
+ * @retval	1 - failure
+ */
+int
+main(int argc, char *argv[])
+{
+	int round;
+
+	CLEAR_HEAD(task_list_immed);
+	CLEAR_HEAD(task_list_interleave);
+	CLEAR_HEAD(task_list_event);
+
+	for (round = 0; round < NUM_ROUNDS; round++) {
+		if (run_round(round)) {
+			fprintf(stderr, "work_task_test failed\n");
+			return 1;
+		}
+	}
+	if (run_ties()) {
+		fprintf(stderr, "work_task_test failed\n");
+		return 1;
+	}
+	printf("work_task_test passed\n");
+	return 0;
+}
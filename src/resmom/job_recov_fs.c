@@ -158,7 +158,7 @@ job_save_fs(job *pjob)
 		quick = 0;
 	}
 
-	for (i = 0; i < JOB_ATR_LAST; i++) {
+	for (i = next_jattr(pjob, -1); i >= 0; i = next_jattr(pjob, i)) {
 		if ((get_jattr(pjob, i))->at_flags & ATR_VFLAG_MODIFY) {
 			quick = 0;
 			break;
@@ -238,8 +238,7 @@ job_save_fs(job *pjob)
 			} else if (save_struct((char *)&pjob->ji_extended,
 				extndsize) != 0) {
 				redo++;
-			} else if (save_attr_fs(job_attr_def, pjob->ji_wattr,
-				(int)JOB_ATR_LAST) != 0) {
+			} else if (save_attr_fs(job_attr_def, &pjob->ji_wattr) != 0) {
 				redo++;
 			} else if (save_flush() != 0) {
 				redo++;
@@ -434,7 +433,7 @@ job_recov_fs(char *filename)
 
 	/* read in working attributes */
 
-	if (recov_attr_fs(fds, pj, job_attr_idx, job_attr_def, pj->ji_wattr, (int)JOB_ATR_LAST,
+	if (recov_attr_fs(fds, pj, job_attr_idx, job_attr_def, &pj->ji_wattr, (int)JOB_ATR_LAST,
 		(int)JOB_ATR_UNKN) != 0) {
 		sprintf(log_buffer, "error reading attributes portion of %s",
 			pbs_recov_filename);
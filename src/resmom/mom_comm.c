@@ -2093,7 +2093,7 @@ node_bailout(job *pjob, hnodent *np)
 					np->hn_sister = SISTER_OKAY;
 					/* encode job attributes to send to sister */
 					CLEAR_HEAD(phead);
-					for (i=0; i< (int)JOB_ATR_LAST; i++) {
+					for (i = next_jattr(pjob, -1); i >= 0; i = next_jattr(pjob, i)) {
 						(void)(job_attr_def+i)->at_encode(
 							get_jattr(pjob, i),
 							&phead,
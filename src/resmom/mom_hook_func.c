@@ -124,7 +124,6 @@ extern pbs_list_head	svr_hook_job_actions;
 extern pbs_list_head	svr_hook_vnl_actions;
 
 extern	pbs_list_head       task_list_immed;
-extern	pbs_list_head       task_list_timed;
 extern	pbs_list_head       task_list_event;
 extern	pbs_list_head	svr_alljobs;
 
@@ -177,7 +176,7 @@ fprintf_job_struct(FILE *fp, job *pjob)
 
 	/* Now print job attributes and resources */
 	CLEAR_HEAD(phead);
-	for (i=0; i < (int)JOB_ATR_LAST; i++) {
+	for (i = next_jattr(pjob, -1); i >= 0; i = next_jattr(pjob, i)) {
 		(void)(job_attr_def+i)->at_encode(get_jattr(pjob, i), &phead,
 			(job_attr_def+i)->at_name, NULL,
 			ATR_ENCODE_MOM, NULL);
@@ -316,7 +315,7 @@ fprint_joblist(FILE *fp, char *head_str, pbs_list_head *joblist)
 		jobid = pjob->ji_qs.ji_jobid;
 		/* Now print job attributes and resources */
 		CLEAR_HEAD(phead);
-		for (i=0; i < (int)JOB_ATR_LAST; i++) {
+		for (i = next_jattr(pjob, -1); i >= 0; i = next_jattr(pjob, i)) {
 			(void)(job_attr_def+i)->at_encode(get_jattr(pjob, i), &phead,
 				(job_attr_def+i)->at_name, NULL,
 				ATR_ENCODE_MOM, NULL);
@@ -365,7 +365,6 @@ pbs_list_head	svr_execjob_preresume_hooks;
 /* the task lists */
 pbs_list_head	task_list_immed;
 pbs_list_head	task_list_interleave;
-pbs_list_head	task_list_timed;
 pbs_list_head	task_list_event;
 
 #ifdef WIN32
@@ -7905,7 +7904,6 @@ main(int argc, char *argv[])
 	CLEAR_HEAD(svr_execjob_preresume_hooks);
 
 	CLEAR_HEAD(task_list_immed);
-	CLEAR_HEAD(task_list_timed);
 	CLEAR_HEAD(task_list_event);
 	CLEAR_HEAD(task_list_interleave);
 
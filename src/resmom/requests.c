@@ -996,6 +996,7 @@ req_modifyjob(struct batch_request *preq)
 	int		 bad = 0;
 	int		 i;
 	attribute	 newattr[(int)JOB_ATR_LAST];
+	attribute	 oldattr[(int)JOB_ATR_LAST];
 	attribute	*pattr;
 	job		*pjob;
 	svrattrl	*plist;
@@ -1018,11 +1019,19 @@ req_modifyjob(struct batch_request *preq)
 	/* modify the jobs attributes */
 
 	bad = 0;
-	pattr = pjob->ji_wattr;
+
+	/* the job's attributes are held in sparse storage, decode against
+	 * a full copy of them
+	 */
+
+	memset(oldattr, 0, sizeof(oldattr));
+	attr_sparse_copy_out(oldattr, &pjob->ji_wattr, job_attr_def, JOB_ATR_LAST);
 
 	/* call attr_atomic_set to decode and set a copy of the attributes */
 
-	rc = attr_atomic_set(plist, pattr, newattr, job_attr_idx, job_attr_def, JOB_ATR_LAST, -1, ATR_DFLAG_MGWR | ATR_DFLAG_MOM, &bad);
+	rc = attr_atomic_set(plist, oldattr, newattr, job_attr_idx, job_attr_def, JOB_ATR_LAST, -1, ATR_DFLAG_MGWR | ATR_DFLAG_MOM, &bad);
+	for (i=0; i<JOB_ATR_LAST; i++)
+		free_attr(job_attr_def, &oldattr[i], i);
 	if (rc) {
 		/* leave old values, free the new ones */
 		for (i=0; i<JOB_ATR_LAST; i++)
@@ -1039,15 +1048,16 @@ req_modifyjob(struct batch_request *preq)
 			if (job_attr_def[i].at_action)
 				(void)job_attr_def[i].at_action(&newattr[i],
 					pjob, ATR_ACTION_ALTER);
-			free_attr(job_attr_def, &pattr[i], i);
+			pattr = get_jattr(pjob, i);
+			free_attr(job_attr_def, pattr, i);
 			if ((newattr[i].at_type == ATR_TYPE_LIST) ||
 				(newattr[i].at_type == ATR_TYPE_RESC)) {
 				list_move(&newattr[i].at_val.at_list,
-					&(pattr+i)->at_val.at_list);
+					&pattr->at_val.at_list);
 			} else {
-				*(pattr+i) = newattr[i];
+				*pattr = newattr[i];
 			}
-			(pattr+i)->at_flags = newattr[i].at_flags;
+			pattr->at_flags = newattr[i].at_flags;
 			if ((i == JOB_ATR_exec_vnode) ||
 			    (i == JOB_ATR_exec_host)  ||
 			    (i == JOB_ATR_exec_host2) ||
@@ -6068,7 +6068,7 @@ start_exec(job *pjob)
 		 * This is why pjob->ji_numnodes = pjob->numrescs + 1.
 		 */
 		CLEAR_HEAD(phead);
-		for (i=0; i < (int)JOB_ATR_LAST; i++) {
+		for (i = next_jattr(pjob, -1); i >= 0; i = next_jattr(pjob, i)) {
 			(void)(job_attr_def+i)->at_encode(get_jattr(pjob, i), &phead,
 				(job_attr_def+i)->at_name, NULL,
 				ATR_ENCODE_MOM, NULL);
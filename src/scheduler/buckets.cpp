@@ -399,6 +399,10 @@ create_node_buckets(status *policy, node_info **nodes, queue_info **queues, unsi
 	node_bucket **buckets = NULL;
 	node_bucket **tmp;
 	int node_ct;
+	int num_bucketed = 0;
+	int num_sig_hits = 0;
+	/* bucket of the last node seen with a given signature/queue/priority */
+	std::unordered_map<std::string, int> sig_bkts;
 
 	if (policy == NULL || nodes == NULL)
 		return NULL;
@@ -416,6 +420,7 @@ create_node_buckets(status *policy, node_info **nodes, queue_info **queues, unsi
 		node_bucket *nb = NULL;
 		int bkt_ind;
 		queue_info *qinfo = NULL;
+		std::string sig_key;
 		int node_ind = nodes[i]->node_ind;
 
 		if (nodes[i]->is_down || nodes[i]->is_offline || node_ind == -1 || nodes[i]->lic_lock == 0)
@@ -424,7 +429,27 @@ create_node_buckets(status *policy, node_info **nodes, queue_info **queues, unsi
 		if (queues != NULL && !nodes[i]->queue_name.empty())
 			qinfo = find_queue_info(queues, nodes[i]->queue_name);
 
-		bkt_ind = find_node_bucket_ind(buckets, nodes[i]->res, qinfo, nodes[i]->priority);
+		/* Nodes with the same resource signature nearly always end up in the same
+		 * bucket.  Try the bucket of the last such node before searching them all.
+		 */
+		bkt_ind = -1;
+		if (nodes[i]->nodesig != NULL) {
+			sig_key = nodes[i]->nodesig;
+			sig_key += ":" + std::to_string(nodes[i]->priority);
+			if (qinfo != NULL)
+				sig_key += ":" + qinfo->name;
+			auto sb = sig_bkts.find(sig_key);
+			if (sb != sig_bkts.end() && compare_resource_avail_list(buckets[sb->second]->res_spec, nodes[i]->res)) {
+				bkt_ind = sb->second;
+				num_sig_hits++;
+			}
+		}
+		num_bucketed++;
+
+		if (bkt_ind == -1)
+			bkt_ind = find_node_bucket_ind(buckets, nodes[i]->res, qinfo, nodes[i]->priority);
+		if (!sig_key.empty())
+			sig_bkts[sig_key] = (bkt_ind == -1) ? j : bkt_ind;
 		if (flags & UPDATE_BUCKET_IND) {
 			if (bkt_ind == -1)
 				nodes[i]->bucket_ind = j;
@@ -496,6 +521,10 @@ create_node_buckets(status *policy, node_info **nodes, queue_info **queues, unsi
 		}
 	}
 
+	if (!(flags & NO_PRINT_BUCKETS))
+		log_eventf(PBSEVENT_DEBUG4, PBS_EVENTCLASS_NODE, LOG_DEBUG, __func__,
+			"%d of %d nodes found their bucket by signature", num_sig_hits, num_bucketed);
+
 	if (j == 0) {
 		free(buckets);
 		return NULL;
@@ -1399,7 +1399,7 @@ find_counts_elm(counts *cts_list, const char *name, resdef *rdef, counts **cnt,
 			*cnt = cts;
 		if (rdef == NULL)
 			return cts->running;
-		else if ((res_lim = find_resource_count(cts->rescts, rdef)) != NULL) {
+		else if ((res_lim = find_counts_rescount(cts, rdef)) != NULL) {
 			if (rcount != NULL)
 				*rcount = res_lim;
 			return res_lim->amount;
@@ -1867,12 +1867,12 @@ check_prime_boundary(status *policy, resource_resv  *resresv, struct schd_error
  *
  * @return	schd_resource * (set to False)
  *
- * @par MT-safe: No
+ * @par MT-safe: Yes - each thread has its own resource
  */
 schd_resource *
 false_res()
 {
-	static schd_resource *res = NULL;
+	static thread_local schd_resource *res = NULL;
 
 	if (res == NULL) {
 		res = new_resource();
@@ -1900,12 +1900,12 @@ false_res()
  * @return	schd_resource *
  * @retval	NULL	: fail
  *
- * @par MT-safe: No
+ * @par MT-safe: Yes - each thread has its own resource
  */
 schd_resource *
 unset_str_res()
 {
-	static schd_resource *res = NULL;
+	static thread_local schd_resource *res = NULL;
 
 	if (res == NULL) {
 		res = new_resource();
@@ -1944,7 +1944,7 @@ unset_str_res()
 schd_resource *
 zero_res()
 {
-	static schd_resource *res = NULL;
+	static thread_local schd_resource *res = NULL;
 
 	if (res == NULL) {
 		res = new_resource();
@@ -1971,15 +1971,15 @@ zero_res()
  * @param[out] **spec output select specification
  * @param[out] **pl  output placement specification
  *
- * @par MT-Safe: No
+ * @par MT-Safe: Yes - each thread has its own place_spec
  * @return void
  */
 void get_resresv_spec(resource_resv *resresv, selspec **spec, place **pl)
 {
-	static place place_spec;
+	static thread_local place place_spec;
 	if (resresv->is_job && resresv->job != NULL) {
 		if (resresv->execselect != NULL) {
-			*spec = resresv->execselect;
+			*spec = resresv->execselect.get();
 			place_spec = *resresv->place_spec;
 
 			/* Placement was handled the first time.  Don't let it get in the way */
@@ -1988,7 +1988,7 @@ void get_resresv_spec(resource_resv *resresv, selspec **spec, place **pl)
 			*pl = &place_spec;
 		} else {
 			*pl = resresv->place_spec;
-			*spec = resresv->select;
+			*spec = resresv->select.get();
 		}
 	} else if (resresv->is_resv && resresv->resv != NULL) {
 		/* The execselect should be used when the resv is running.  We can't
@@ -1997,9 +1997,9 @@ void get_resresv_spec(resource_resv *resresv, selspec **spec, place **pl)
 		 */
 		if (resresv->resv->is_running)
 
-			*spec = resresv->execselect;
+			*spec = resresv->execselect.get();
 		else
-			*spec = resresv->select;
+			*spec = resresv->select.get();
 		place_spec = *resresv->place_spec;
 		*pl = &place_spec;
 	}
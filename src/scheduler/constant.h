@@ -120,6 +120,9 @@ enum select_job_status
 #define START_WITH_JOB 0
 #define START_AFTER_JOB 1
 
+/* initial value of a 64 bit FNV-1a hash (see sig_add_str()) */
+#define SIG_INIT 14695981039346656037ULL
+
 /* Error message when we fail to allocate memory */
 #define MEM_ERR_MSG "Unable to allocate memory (malloc error)"
 
@@ -142,6 +145,12 @@ enum update_accruetype_mode
 #define RES_DEFAULT_AVAIL SCHD_INFINITY_RES
 #define RES_DEFAULT_ASSN 0
 
+/* resource lists at least this long get a lookup index (see index_resource_list()) */
+#define RES_IDX_MIN 16
+
+/* counts lists at least this long get a lookup index (see find_alloc_counts()) */
+#define COUNTS_IDX_MIN 8
+
 #define PREEMPT_QUEUE_SERVER_SOFTLIMIT (1 << (PREEMPT_OVER_QUEUE_LIMIT) | 1 << (PREEMPT_OVER_SERVER_LIMIT) )
 
 /* strings for prime and non-prime */
@@ -170,7 +179,7 @@ enum resval_cmpflag
 
 enum thread_task_type
 {
-	TS_IS_ND_ELIGIBLE,
+	TS_FUNC,	/* generic task: call func(thread_data), see queue_func_for_threads() */
 	TS_DUP_ND_INFO,
 	TS_QUERY_ND_INFO,
 	TS_FREE_ND_INFO,
@@ -637,4 +646,21 @@ enum nscr_vals {
 	NSCR_CYCLE_INELIGIBLE = 8
 };
 
+/* per-node state bits kept in the node_soa table (see build_node_soa()) */
+enum node_soa_flags {
+	NSOA_NONE = 0,
+	NSOA_FREE = 1,			/* node is free */
+	NSOA_RESV_ENABLE = 2,		/* node accepts reservations */
+	NSOA_NO_MULTINODE = 4,		/* node refuses multi-node jobs */
+	NSOA_ENT_LIMIT = 8,		/* node has max_user_run/max_group_run set */
+	NSOA_CYCLE_INELIGIBLE = 16	/* nscr has NSCR_CYCLE_INELIGIBLE set */
+};
+
+/* what a node_soa row says about a node's eligibility for a request */
+enum node_soa_row {
+	NSOA_ROW_OK,			/* the node is eligible */
+	NSOA_ROW_DETAIL,		/* the node needs is_vnode_eligible() */
+	NSOA_ROW_SKIP			/* the node is ineligible for the cycle */
+};
+
 #endif	/* _CONSTANT_H */
@@ -52,12 +52,15 @@
 #ifndef	_DATA_TYPES_H
 #define	_DATA_TYPES_H
 
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include <time.h>
+#include <pthread.h>
 #include <pbs_ifl.h>
 #include <libutil.h>
 #include "constant.h"
@@ -79,6 +82,7 @@ struct prev_job_info;
 class group_info;
 struct usage_info;
 struct counts;
+struct counts_idx;
 struct nspec;
 struct node_partition;
 struct range;
@@ -89,6 +93,7 @@ struct chunk;
 class selspec;
 class resdef;
 struct event_list;
+struct event_list_idx;
 struct status;
 class fairshare_head;
 struct node_scratch;
@@ -103,17 +108,20 @@ struct sort_info;
 class resource_resv;
 class node_info;
 class queue_info;
+class compiled_formula;
 
 
 typedef struct state_count state_count;
 typedef struct server_info server_info;
 typedef struct job_info job_info;
 typedef struct schd_resource schd_resource;
+typedef struct schd_resource_idx schd_resource_idx;
 typedef struct resource_req resource_req;
 typedef struct resource_count resource_count;
 typedef struct usage_info usage_info;
 typedef struct resv_info resv_info;
 typedef struct counts counts;
+typedef struct counts_idx counts_idx;
 typedef struct nspec nspec;
 typedef struct node_partition node_partition;
 typedef struct place place;
@@ -122,6 +130,7 @@ typedef struct np_cache np_cache;
 typedef struct chunk chunk;
 typedef struct timed_event timed_event;
 typedef struct event_list event_list;
+typedef struct event_list_idx event_list_idx;
 typedef struct node_scratch node_scratch;
 typedef struct resresv_set resresv_set;
 typedef struct te_list te_list;
@@ -131,6 +140,7 @@ typedef struct chunk_map chunk_map;
 typedef struct node_bucket_count node_bucket_count;
 typedef struct preempt_job_st preempt_job_st;
 typedef struct th_task_info th_task_info;
+typedef struct th_task_group th_task_group;
 typedef struct th_data_nd_eligible th_data_nd_eligible;
 typedef struct th_data_dup_nd_info th_data_dup_nd_info;
 typedef struct th_data_query_ninfo th_data_query_ninfo;
@@ -138,6 +148,11 @@ typedef struct th_data_free_ninfo th_data_free_ninfo;
 typedef struct th_data_dup_resresv th_data_dup_resresv;
 typedef struct th_data_query_jinfo th_data_query_jinfo;
 typedef struct th_data_free_resresv th_data_free_resresv;
+typedef struct th_data_np_fit th_data_np_fit;
+typedef struct th_data_formula th_data_formula;
+typedef struct job_sort_key job_sort_key;
+typedef struct th_data_sort_keys th_data_sort_keys;
+typedef struct node_cache_ent node_cache_ent;
 
 
 #ifdef NAS
@@ -169,11 +184,23 @@ typedef sch_resource_t usage_t;
 typedef void event_ptr_t;
 typedef int (*event_func_t)(event_ptr_t*, void *);
 
+typedef void (*th_task_func)(void *);
+
 struct th_task_info
 {
 	int task_id;							/* task id, should be set by main thread */
 	enum thread_task_type task_type;		/* task type */
 	void *thread_data;					/* data for the worker thread to execute the task */
+	th_task_func func;					/* TS_FUNC: function to call on thread_data */
+	th_task_group *group;				/* TS_FUNC: group to report completion to */
+};
+
+/* a set of TS_FUNC tasks the main thread can wait on (see wait_th_task_group()) */
+struct th_task_group
+{
+	pthread_mutex_t lock;
+	pthread_cond_t done_cond;
+	int pending;						/* number of queued tasks not yet finished */
 };
 
 struct th_data_nd_eligible
@@ -184,6 +211,10 @@ struct th_data_nd_eligible
 	node_info **ninfo_arr;
 	int sidx;
 	int eidx;
+	bool by_row;		/* sidx/eidx are rows of the server's node_soa table */
+	int num_ok;		/* nodes the node_soa table showed to be eligible */
+	int num_detail;		/* nodes given the detailed check */
+	int num_skip;		/* nodes already marked ineligible */
 };
 
 struct th_data_dup_nd_info
@@ -203,10 +234,20 @@ struct th_data_query_ninfo
 	struct batch_status *nodes;
 	server_info *sinfo;
 	node_info **oarr;
+	node_cache_ent **new_ents;	/* node cache entries created for this chunk */
+	unsigned long long sig_sum;	/* sum of the fingerprints of the chunk's nodes */
+	bool sig_unknown:1;		/* a node of the chunk has no fingerprint */
 	int sidx;
 	int eidx;
 };
 
+/* an entry of the cross-cycle node cache (see query_nodes()) */
+struct node_cache_ent
+{
+	unsigned long long sig;		/* fingerprint of the node's batch_status */
+	node_info *ninfo;		/* node as query_node_info() created it */
+};
+
 struct th_data_free_ninfo
 {
 	node_info **ninfo_arr;
@@ -238,6 +279,52 @@ struct th_data_query_jinfo
 	int eidx;
 };
 
+struct th_data_np_fit
+{
+	status *policy;
+	node_partition **nodepart;
+	resource_resv *resresv;
+	unsigned int flags;
+	int *fits;			/* out: resresv_can_fit_nodepart() per placement set */
+	schd_error **errs;		/* out: why a placement set can't fit */
+	int sidx;
+	int eidx;
+};
+
+struct th_data_formula
+{
+	const compiled_formula *cf;
+	resource_resv **jobs;
+	int sidx;
+	int eidx;
+};
+
+/* the cmp_sort() keys of one job, read once per sort */
+struct job_sort_key
+{
+	resource_resv *resresv;
+	bool runnable;
+	unsigned int preempt;
+	time_t time_preempted;
+	float formula_value;
+	int fs_rank;			/* fairshare order of the job's group, -1 if not used */
+	long long qrank;
+	int rank;
+	const sch_resource_t *res;	/* one amount per job_sort_key, negated for DESC */
+};
+
+struct th_data_sort_keys
+{
+	resource_resv **jobs;
+	job_sort_key *keys;
+	sch_resource_t *res;		/* storage for the keys' amounts */
+	int nres;			/* amounts per key */
+	const std::unordered_map<group_info *, int> *fs_ranks;
+	int sidx;
+	int midx;			/* merge: first index of the second run */
+	int eidx;
+};
+
 struct th_data_free_resresv
 {
 	resource_resv **resresv_arr;
@@ -381,6 +468,21 @@ struct schedattrs
 	long server_dyn_res_alarm;
 };
 
+/* Structure-of-arrays view of the node state the first pass of
+ * check_node_array_eligibility() looks at.  Rows are indexed by
+ * node_info::node_ind, so the table only covers the server's own nodes.
+ * Reservation universes are not in it and always take the detailed path.
+ */
+struct node_soa
+{
+	std::vector<node_info *> node;		/* node owning each row */
+	std::vector<unsigned char> flags;	/* NSOA_* bits */
+	std::vector<unsigned char> sharing;	/* enum vnode_sharing of the node */
+	std::vector<int> num_jobs;		/* running jobs on the node */
+	std::vector<int> num_run_resv;		/* running reservations on the node */
+	std::vector<int> max_running;		/* max_running, SCHD_INFINITY if unset */
+};
+
 struct server_info
 {
 	bool has_soft_limit:1;	/* server has a soft user/grp limit set */
@@ -468,8 +570,10 @@ struct server_info
 	status *policy;
 	fairshare_head *fstree;	/* root of fairshare tree */
 	resresv_set **equiv_classes;
+	unsigned long long ec_state_sig;	/* fingerprint of the queried universe, 0 if unknown */
 	node_bucket **buckets;		/* node bucket array */
 	node_info **unordered_nodes;
+	node_soa nsoa;			/* state of unordered_nodes in columns */
 	std::unordered_map<std::string, node_partition *> svr_to_psets;
 #ifdef NAS
 	/* localmod 034 */
@@ -711,6 +815,7 @@ struct node_info
 	char *current_aoe;		/* AOE name instantiated on node */
 	char *current_eoe;		/* EOE name instantiated on node */
 	char *nodesig;			/* resource signature */
+	unsigned long long nodesig_defs;	/* resdef_set_sig() of the resources nodesig covers */
 	int nodesig_ind;		/* resource signature index in server array */
 	node_info *svr_node;		/* ptr to svr's node if we're a resv node */
 	node_partition *hostset;	/* other vnodes on on the same host */
@@ -793,8 +898,11 @@ class resource_resv
 	time_t min_duration;		/* minimum duration of STF job */
 
 	resource_req *resreq;		/* list of resources requested */
-	selspec *select;		/* select spec */
-	selspec *execselect;		/* select spec from exec_vnode and resv_nodes */
+	/* select specs are never modified once created, so duplicated
+	 * res resvs share them with the res resv they were duplicated from
+	 */
+	std::shared_ptr<selspec> select;	/* select spec */
+	std::shared_ptr<selspec> execselect;	/* select spec from exec_vnode and resv_nodes */
 	place *place_spec;		/* placement spec */
 
 	server_info *server;		/* pointer to server which owns res resv */
@@ -855,9 +963,21 @@ struct schd_resource
 
 	resdef *def;			/* resource definition */
 
+	schd_resource_idx *idx;		/* head of list only: lookup index (see index_resource_list()) */
+
 	struct schd_resource *next;	/* next resource in list */
 };
 
+/* Index of a resource list by resdef::id.  Resource lists are only ever
+ * appended to, so resources added after the index was built are found by
+ * walking the list from 'last'.
+ */
+struct schd_resource_idx
+{
+	std::vector<schd_resource *> by_def;	/* resources indexed by resdef::id */
+	schd_resource *last;			/* last resource in the list when indexed */
+};
+
 struct resource_req
 {
 	const char *name;			/* name of the resource - reference to the definition name */
@@ -875,7 +995,8 @@ class resdef
 	const std::string name;	/* name of resource */
 	resource_type type;	/* resource type */
 	unsigned int flags;	/* resource flags (see pbs_ifl.h) */
-	resdef(char *rname, unsigned int rflags, resource_type rtype) : name(rname), type(rtype), flags(rflags) {}
+	const int id;		/* dense index of the definition, used to index resource lists */
+	resdef(char *rname, unsigned int rflags, resource_type rtype, int rid) : name(rname), type(rtype), flags(rflags), id(rid) {}
 };
 
 class prev_job_info
@@ -897,9 +1018,21 @@ struct counts
 	int running;			/* count of running jobs in object */
 	int soft_limit_preempt_bit;	/* Place to store preempt bit if entity is over limits */
 	resource_count *rescts;		/* resources used */
+	std::vector<resource_count *> res_by_def;	/* rescts indexed by resdef::id */
+	counts_idx *idx;		/* head of list only: lookup index (see find_alloc_counts()) */
 	counts *next;
 };
 
+/* Index of a counts list by entity name.  Counts lists are only ever
+ * appended to, and every append goes through the head so the index
+ * is kept up to date.
+ */
+struct counts_idx
+{
+	std::unordered_map<std::string, counts *> by_name;	/* counts indexed by entity name */
+	counts *last;			/* last counts in the list */
+};
+
 struct resource_count
 {
 	const char *name;		    /* resource name */
@@ -1202,6 +1335,18 @@ struct event_list
 	timed_event *next_event;	/* the next event to be performed */
 	timed_event *first_run_event;	/* The first run event in the calendar */
 	time_t *current_time;		/* [reference] current time in the calendar */
+	event_list_idx *idx;		/* lookup index of the events (see add_timed_event()) */
+};
+
+/* Index of a calendar's events.  Events are ordered by (event_time, seq):
+ * seq orders events with the same time the way they are in the list.
+ */
+struct event_list_idx
+{
+	std::map<time_t, timed_event *> by_time;		/* first event at each time */
+	std::unordered_multimap<std::string, timed_event *> by_name;	/* events by name */
+	std::map<std::pair<time_t, long>, timed_event *> run_events;	/* run events in calendar order */
+	timed_event *last;				/* last event in the list */
 };
 
 struct timed_event
@@ -1213,6 +1358,7 @@ struct timed_event
 	event_ptr_t *event_ptr;
 	event_func_t event_func;
 	void *event_func_arg;		/* optional argument to function - not freed */
+	long seq;			/* order among events at the same time (see event_list_idx) */
 	timed_event *next;
 	timed_event *prev;
 };
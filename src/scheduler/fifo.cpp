@@ -412,6 +412,8 @@ init_scheduling_cycle(status *policy, int pbs_sd, server_info *sinfo)
 		}
 	}
 	if (sinfo->jobs != NULL) {
+		if (sinfo->job_sort_formula != NULL)
+			formula_evaluate_jobs(sinfo->job_sort_formula, sinfo->jobs);
 		for (int i = 0; sinfo->jobs[i] != NULL; i++) {
 			resource_resv *resresv = sinfo->jobs[i];
 			if (resresv->job != NULL) {
@@ -425,7 +427,6 @@ init_scheduling_cycle(status *policy, int pbs_sd, server_info *sinfo)
 				}
 				if (sinfo->job_sort_formula != NULL) {
 					double threshold = sc_attrs.job_sort_formula_threshold;
-					resresv->job->formula_value = formula_evaluate(sinfo->job_sort_formula, resresv, resresv->resreq);
 					log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name, "Formula Evaluation = %.*f",
 						   float_digits(resresv->job->formula_value, FLOAT_NUM_DIGITS), resresv->job->formula_value);
 
@@ -657,6 +658,10 @@ scheduling_cycle(int sd, const sched_cmd *cmd)
 	}
 
 
+	/* a qrun is for a single job, and must be tried no matter what */
+	if (sinfo->qrun_job == NULL)
+		apply_resresv_set_cache(sinfo);
+
 	if (sinfo->qrun_job != NULL) {
 		sinfo->qrun_job->can_not_run = 0;
 		if (sinfo->qrun_job->job != NULL) {
@@ -671,6 +676,13 @@ scheduling_cycle(int sd, const sched_cmd *cmd)
 	if (error == 0)
 		rc = main_sched_loop(policy, sd, sinfo, &err);
 
+	if (sinfo->qrun_job == NULL) {
+		if (error == 0 && rc != -1)
+			save_resresv_set_cache(sinfo);
+		else
+			free_resresv_set_cache();
+	}
+
 	if (cmd->jid != NULL) {
 		int def_rc = -1;
 		int i;
@@ -1864,7 +1876,7 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 		 * Note: We only ever look from now into the future
 		 */
 		auto nexte = get_next_event(sinfo->calendar);
-		if (find_timed_event(nexte, topjob->name, IGNORE_DISABLED_EVENTS, TIMED_NOEVENT, 0) != NULL)
+		if (find_timed_event(sinfo->calendar, nexte, topjob->name, IGNORE_DISABLED_EVENTS, TIMED_NOEVENT, 0) != NULL)
 			return 1;
 	}
 	if ((nsinfo = dup_server_info(sinfo)) == NULL)
@@ -1942,8 +1954,7 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 					create_node_array_from_nspec(bjob->nspec_arr);
 				selectspec = create_select_from_nspec(bjob->nspec_arr);
 				if (!selectspec.empty()) {
-					delete bjob->execselect;
-					bjob->execselect = parse_selspec(selectspec);
+					bjob->execselect.reset(parse_selspec(selectspec));
 				}
 			} else {
 				free_server(nsinfo);
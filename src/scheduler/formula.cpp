@@ -0,0 +1,751 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+
+/**
+ * @file    formula.cpp
+ *
+ * @brief
+ * 		formula.cpp - native evaluation of job_sort_formula
+ *
+ *	The formula is a Python expression.  The subset of Python that
+ *	formulas are written in (numbers, resource and job keywords,
+ *	arithmetic, comparisons, and/or/not, conditional expressions and
+ *	min()/max()/abs()) is parsed once into an expression tree and
+ *	evaluated here with Python's semantics.  Anything else is left to
+ *	the embedded interpreter by formula_evaluate().
+ *
+ * Functions included are:
+ * 	compiled_formula::compiled_formula()
+ * 	compiled_formula::evaluate()
+ * 	compiled_formula::eval_node()
+ * 	get_compiled_formula()
+ * 	free_formula_cache()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <log.h>
+#include <libutil.h>
+#include <pbs_share.h>
+#include "data_types.h"
+#include "formula.h"
+#include "globals.h"
+#include "resource_resv.h"
+#include "constant.h"
+
+
+/* compiled formulas, by formula text */
+static std::unordered_map<std::string, compiled_formula *> formula_cache;
+
+/*
+ * recursive descent parser for the formula grammar, a subset of Python's:
+ *
+ *	expr	:= or_test ['if' or_test 'else' expr]
+ *	or_test	:= and_test ('or' and_test)*
+ *	and_test := not_test ('and' not_test)*
+ *	not_test := 'not' not_test | comparison
+ *	comparison := arith (compop arith)*
+ *	arith	:= term (('+'|'-') term)*
+ *	term	:= factor (('*'|'/'|'//'|'%') factor)*
+ *	factor	:= ('+'|'-') factor | power
+ *	power	:= atom ['**' factor]
+ *	atom	:= number | name | name '(' expr (',' expr)* ')' | '(' expr ')'
+ *
+ * Each parse function returns the index of the node it built or -1 if
+ * the text is not in the subset.
+ */
+class formula_parser {
+    public:
+	formula_parser(const std::string& text, std::vector<formula_node>& nodes) : s(text), pos(0), nodes(nodes) {}
+
+	int parse()
+	{
+		int idx = expr();
+		skip_space();
+		if (pos != s.size())
+			return -1;
+		return idx;
+	}
+
+    private:
+	const std::string& s;
+	size_t pos;
+	std::vector<formula_node>& nodes;
+
+	void skip_space()
+	{
+		while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t'))
+			pos++;
+	}
+
+	int add(enum formula_op op, std::vector<int> args)
+	{
+		formula_node n;
+
+		n.op = op;
+		n.val = 0;
+		n.def = NULL;
+		n.args = args;
+		nodes.push_back(n);
+		return nodes.size() - 1;
+	}
+
+	int add_const(double val)
+	{
+		int idx = add(FOP_CONST, {});
+		nodes[idx].val = val;
+		return idx;
+	}
+
+	/* match an operator; longer operators must be tried first */
+	bool accept(const char *tok)
+	{
+		size_t len = strlen(tok);
+
+		skip_space();
+		if (s.compare(pos, len, tok) != 0)
+			return false;
+		pos += len;
+		return true;
+	}
+
+	/* match a keyword, which must not run into the following name */
+	bool accept_word(const char *word)
+	{
+		size_t len = strlen(word);
+
+		skip_space();
+		if (s.compare(pos, len, word) != 0)
+			return false;
+		if (pos + len < s.size() && (isalnum(s[pos + len]) || s[pos + len] == '_'))
+			return false;
+		pos += len;
+		return true;
+	}
+
+	int expr()
+	{
+		int a = or_test();
+		if (a < 0)
+			return -1;
+		if (accept_word("if")) {
+			int c = or_test();
+			if (c < 0 || !accept_word("else"))
+				return -1;
+			int b = expr();
+			if (b < 0)
+				return -1;
+			return add(FOP_IFELSE, {c, a, b});
+		}
+		return a;
+	}
+
+	int or_test()
+	{
+		int a = and_test();
+		while (a >= 0 && accept_word("or")) {
+			int b = and_test();
+			if (b < 0)
+				return -1;
+			a = add(FOP_OR, {a, b});
+		}
+		return a;
+	}
+
+	int and_test()
+	{
+		int a = not_test();
+		while (a >= 0 && accept_word("and")) {
+			int b = not_test();
+			if (b < 0)
+				return -1;
+			a = add(FOP_AND, {a, b});
+		}
+		return a;
+	}
+
+	int not_test()
+	{
+		if (accept_word("not")) {
+			int a = not_test();
+			if (a < 0)
+				return -1;
+			return add(FOP_NOT, {a});
+		}
+		return comparison();
+	}
+
+	int comparison()
+	{
+		int a = arith();
+		int result = a;
+
+		/* a < b < c is (a < b) and (b < c) with b evaluated once */
+		while (a >= 0) {
+			enum formula_op op;
+			if (accept("<="))
+				op = FOP_LE;
+			else if (accept(">="))
+				op = FOP_GE;
+			else if (accept("=="))
+				op = FOP_EQ;
+			else if (accept("!="))
+				op = FOP_NE;
+			else if (accept("<>"))
+				return -1;
+			else if (accept("<<") || accept(">>"))
+				return -1;
+			else if (accept("<"))
+				op = FOP_LT;
+			else if (accept(">"))
+				op = FOP_GT;
+			else
+				break;
+			int b = arith();
+			if (b < 0)
+				return -1;
+			int cmp = add(op, {a, b});
+			result = (result == a) ? cmp : add(FOP_AND, {result, cmp});
+			a = b;
+		}
+		return (a < 0) ? -1 : result;
+	}
+
+	int arith()
+	{
+		int a = term();
+		while (a >= 0) {
+			enum formula_op op;
+			if (accept("+"))
+				op = FOP_ADD;
+			else if (accept("-"))
+				op = FOP_SUB;
+			else
+				break;
+			int b = term();
+			if (b < 0)
+				return -1;
+			a = add(op, {a, b});
+		}
+		return a;
+	}
+
+	int term()
+	{
+		int a = factor();
+		while (a >= 0) {
+			enum formula_op op;
+			if (accept("*"))
+				op = FOP_MUL;
+			else if (accept("//"))
+				op = FOP_FLOORDIV;
+			else if (accept("/"))
+				op = FOP_DIV;
+			else if (accept("%"))
+				op = FOP_MOD;
+			else
+				break;
+			int b = factor();
+			if (b < 0)
+				return -1;
+			a = add(op, {a, b});
+		}
+		return a;
+	}
+
+	int factor()
+	{
+		if (accept("+"))
+			return factor();
+		if (accept("-")) {
+			int a = factor();
+			if (a < 0)
+				return -1;
+			return add(FOP_NEG, {a});
+		}
+		return power();
+	}
+
+	int power()
+	{
+		int a = atom();
+		if (a >= 0 && accept("**")) {
+			int b = factor();
+			if (b < 0)
+				return -1;
+			return add(FOP_POW, {a, b});
+		}
+		return a;
+	}
+
+	int number()
+	{
+		size_t start = pos;
+		size_t ndig = 0;
+
+		while (pos < s.size() && isdigit(s[pos])) {
+			pos++;
+			ndig++;
+		}
+		bool is_int = true;
+		if (pos < s.size() && s[pos] == '.') {
+			is_int = false;
+			pos++;
+			while (pos < s.size() && isdigit(s[pos])) {
+				pos++;
+				ndig++;
+			}
+		}
+		if (ndig == 0)
+			return -1;
+		if (pos < s.size() && (s[pos] == 'e' || s[pos] == 'E')) {
+			is_int = false;
+			pos++;
+			if (pos < s.size() && (s[pos] == '+' || s[pos] == '-'))
+				pos++;
+			if (pos >= s.size() || !isdigit(s[pos]))
+				return -1;
+			while (pos < s.size() && isdigit(s[pos]))
+				pos++;
+		}
+		/* hex, octal, complex, underscores and such are left to Python */
+		if (pos < s.size() && (isalnum(s[pos]) || s[pos] == '_' || s[pos] == '.'))
+			return -1;
+		std::string lit = s.substr(start, pos - start);
+		if (is_int && lit.size() > 1 && lit[0] == '0' && lit.find_first_not_of('0') != std::string::npos)
+			return -1;
+		return add_const(strtod(lit.c_str(), NULL));
+	}
+
+	int name_ref(const std::string& name)
+	{
+		if (name == FORMULA_ELIGIBLE_TIME)
+			return add(FOP_ELIGIBLE_TIME, {});
+		if (name == FORMULA_QUEUE_PRIO)
+			return add(FOP_QUEUE_PRIO, {});
+		if (name == FORMULA_JOB_PRIO)
+			return add(FOP_JOB_PRIO, {});
+		if (name == FORMULA_FSPERC || name == FORMULA_FSPERC_DEP)
+			return add(FOP_FSPERC, {});
+		if (name == FORMULA_TREE_USAGE)
+			return add(FOP_TREE_USAGE, {});
+		if (name == FORMULA_FSFACTOR)
+			return add(FOP_FSFACTOR, {});
+		if (name == FORMULA_ACCRUE_TYPE)
+			return add(FOP_ACCRUE_TYPE, {});
+
+		for (const auto& cr : consres) {
+			if (cr->name == name) {
+				int idx = add(FOP_RES, {});
+				nodes[idx].def = cr;
+				return idx;
+			}
+		}
+
+		if (name == "True")
+			return add_const(1);
+		if (name == "False")
+			return add_const(0);
+
+		return -1;
+	}
+
+	int call(const std::string& name)
+	{
+		std::vector<int> args;
+		enum formula_op op;
+
+		if (name == "min")
+			op = FOP_MIN;
+		else if (name == "max")
+			op = FOP_MAX;
+		else if (name == "abs")
+			op = FOP_ABS;
+		else
+			return -1;
+
+		if (!accept(")")) {
+			do {
+				int a = expr();
+				if (a < 0)
+					return -1;
+				args.push_back(a);
+			} while (accept(","));
+			if (!accept(")"))
+				return -1;
+		}
+		if (op == FOP_ABS ? args.size() != 1 : args.size() < 2)
+			return -1;
+		return add(op, args);
+	}
+
+	int atom()
+	{
+		skip_space();
+		if (pos >= s.size())
+			return -1;
+
+		if (accept("(")) {
+			int a = expr();
+			if (a < 0 || !accept(")"))
+				return -1;
+			return a;
+		}
+
+		if (isdigit(s[pos]) || s[pos] == '.')
+			return number();
+
+		if (isalpha(s[pos]) || s[pos] == '_') {
+			size_t start = pos;
+			while (pos < s.size() && (isalnum(s[pos]) || s[pos] == '_'))
+				pos++;
+			std::string name = s.substr(start, pos - start);
+
+			if (accept("(")) {
+				/* a keyword or resource of the same name shadows the builtin */
+				int shadow = name_ref(name);
+				if (shadow >= 0)
+					return -1;
+				return call(name);
+			}
+			if (name == "and" || name == "or" || name == "not" ||
+				name == "if" || name == "else")
+				return -1;
+			return name_ref(name);
+		}
+
+		return -1;
+	}
+};
+
+/**
+ * @brief
+ * 		round a value the way formula_evaluate() used to print it into
+ *		the Python globals dictionary
+ *
+ * @param[in]	val	-	value to round
+ * @param[in]	digits	-	digits after the decimal point
+ *
+ * @return	rounded value
+ */
+static double
+formula_round(double val, int digits)
+{
+	char buf[64];
+
+	/* doubles this large have no fractional part left to round */
+	if (fabs(val) >= 4503599627370496.0)
+		return val;
+
+	snprintf(buf, sizeof(buf), "%.*f", digits, val);
+	return strtod(buf, NULL);
+}
+
+/**
+ * @brief
+ * 		parse a formula into its compiled form
+ *
+ * @param[in]	text	-	the formula
+ *
+ * @note
+ * 		If the formula uses anything outside of the supported subset,
+ *		is_native() will return false.
+ */
+compiled_formula::compiled_formula(const std::string& text) : root(-1)
+{
+	formula_parser parser(text, nodes);
+
+	root = parser.parse();
+	if (root < 0)
+		nodes.clear();
+}
+
+/**
+ * @brief
+ * 		evaluate one node of the formula for a job
+ *
+ * @param[in]	idx	-	index of the node
+ * @param[in]	resresv	-	job for special case key words
+ * @param[in]	resreq	-	resources to use when evaluating
+ * @param[out]	ok	-	set to false if Python would not have produced
+ *				a number for this (sub)expression
+ *
+ * @return	value of the node
+ */
+double
+compiled_formula::eval_node(int idx, const resource_resv *resresv, resource_req *resreq, bool *ok) const
+{
+	const formula_node& n = nodes[idx];
+	const job_info *job = resresv->job;
+	double a;
+	double b;
+	double mod;
+	double div;
+	double floordiv;
+	double r;
+
+	if (!*ok)
+		return 0;
+
+	switch (n.op) {
+		case FOP_CONST:
+			return n.val;
+		case FOP_RES: {
+			resource_req *req = find_resource_req(resreq, n.def);
+			if (req == NULL)
+				return 0;
+			return formula_round(req->amount, float_digits(req->amount, FLOAT_NUM_DIGITS));
+		}
+		case FOP_ELIGIBLE_TIME:
+			return (long) job->eligible_time;
+		case FOP_QUEUE_PRIO:
+			return job->queue->priority;
+		case FOP_JOB_PRIO:
+			return job->priority;
+		case FOP_FSPERC:
+			return formula_round(job->ginfo->tree_percentage, 6);
+		case FOP_TREE_USAGE:
+			return formula_round(job->ginfo->usage_factor, 6);
+		case FOP_FSFACTOR:
+			return formula_round(job->ginfo->tree_percentage == 0 ? 0 :
+				pow(2, -(job->ginfo->usage_factor / job->ginfo->tree_percentage)), 6);
+		case FOP_ACCRUE_TYPE:
+			return job->accrue_type;
+		case FOP_NEG:
+			return -eval_node(n.args[0], resresv, resreq, ok);
+		case FOP_NOT:
+			return eval_node(n.args[0], resresv, resreq, ok) == 0;
+		case FOP_AND:
+			a = eval_node(n.args[0], resresv, resreq, ok);
+			return (a == 0) ? a : eval_node(n.args[1], resresv, resreq, ok);
+		case FOP_OR:
+			a = eval_node(n.args[0], resresv, resreq, ok);
+			return (a != 0) ? a : eval_node(n.args[1], resresv, resreq, ok);
+		case FOP_IFELSE:
+			if (eval_node(n.args[0], resresv, resreq, ok) != 0)
+				return eval_node(n.args[1], resresv, resreq, ok);
+			return eval_node(n.args[2], resresv, resreq, ok);
+		case FOP_MIN:
+		case FOP_MAX:
+			a = eval_node(n.args[0], resresv, resreq, ok);
+			for (size_t i = 1; i < n.args.size(); i++) {
+				b = eval_node(n.args[i], resresv, resreq, ok);
+				if ((n.op == FOP_MIN) ? (b < a) : (b > a))
+					a = b;
+			}
+			return a;
+		case FOP_ABS:
+			return fabs(eval_node(n.args[0], resresv, resreq, ok));
+		default:
+			break;
+	}
+
+	a = eval_node(n.args[0], resresv, resreq, ok);
+	b = eval_node(n.args[1], resresv, resreq, ok);
+
+	switch (n.op) {
+		case FOP_ADD:
+			r = a + b;
+			break;
+		case FOP_SUB:
+			r = a - b;
+			break;
+		case FOP_MUL:
+			r = a * b;
+			break;
+		case FOP_DIV:
+			if (b == 0) {
+				*ok = false;
+				return 0;
+			}
+			r = a / b;
+			break;
+		case FOP_FLOORDIV:
+		case FOP_MOD:
+			if (b == 0) {
+				*ok = false;
+				return 0;
+			}
+			/* same as Python's float divmod() */
+			mod = fmod(a, b);
+			div = (a - mod) / b;
+			if (mod != 0) {
+				if ((b < 0) != (mod < 0)) {
+					mod += b;
+					div -= 1.0;
+				}
+			} else
+				mod = copysign(0.0, b);
+			if (n.op == FOP_MOD)
+				return mod;
+			if (div != 0) {
+				floordiv = floor(div);
+				if (div - floordiv > 0.5)
+					floordiv += 1.0;
+			} else
+				floordiv = copysign(0.0, a / b);
+			return floordiv;
+		case FOP_POW:
+			/* Python raises or goes complex for these */
+			if ((a == 0 && b < 0) || (a < 0 && b != floor(b))) {
+				*ok = false;
+				return 0;
+			}
+			r = pow(a, b);
+			break;
+		case FOP_LT:
+			return a < b;
+		case FOP_LE:
+			return a <= b;
+		case FOP_GT:
+			return a > b;
+		case FOP_GE:
+			return a >= b;
+		case FOP_EQ:
+			return a == b;
+		case FOP_NE:
+			return a != b;
+		default:
+			*ok = false;
+			return 0;
+	}
+
+	/* Python's integers don't overflow and its floats raise OverflowError,
+	 * let Python decide what an out of range intermediate value means
+	 */
+	if (!std::isfinite(r))
+		*ok = false;
+	return r;
+}
+
+/**
+ * @brief
+ * 		evaluate the formula for a job
+ *
+ * @param[in]	resresv	-	job for special case key words
+ * @param[in]	resreq	-	resources to use when evaluating
+ * @param[out]	ans	-	the formula's value
+ *
+ * @return	bool
+ * @retval	true	- *ans holds the value
+ * @retval	false	- the formula can't be evaluated natively for this job,
+ *			  Python must be used to get its value (or error)
+ *
+ * @par MT-safe: Yes
+ */
+bool
+compiled_formula::evaluate(const resource_resv *resresv, resource_req *resreq, sch_resource_t *ans) const
+{
+	bool ok = true;
+	double val;
+
+	if (root < 0 || resresv == NULL || resresv->job == NULL)
+		return false;
+
+	val = eval_node(root, resresv, resreq, &ok);
+	if (!ok || !std::isfinite(val))
+		return false;
+
+	*ans = val;
+	return true;
+}
+
+/**
+ * @brief
+ * 		return the compiled form of a formula, compiling it the first
+ *		time the formula is seen
+ *
+ * @param[in]	formula	-	formula text
+ *
+ * @return	const compiled_formula *
+ * @retval	compiled formula (check is_native())
+ * @retval	NULL	- no formula or out of memory
+ *
+ * @par MT-safe: No
+ */
+const compiled_formula *
+get_compiled_formula(const char *formula)
+{
+	if (formula == NULL)
+		return NULL;
+
+	auto f = formula_cache.find(formula);
+	if (f != formula_cache.end())
+		return f->second;
+
+	/* formulas only change with the configuration, keep the cache small */
+	if (formula_cache.size() >= 16)
+		free_formula_cache();
+
+	try {
+		auto cf = new compiled_formula(formula);
+		formula_cache[formula] = cf;
+		if (!cf->is_native())
+			log_eventf(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+				"Formula \"%s\" will be evaluated by Python", formula);
+		return cf;
+	} catch (std::bad_alloc &e) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+}
+
+/**
+ * @brief
+ * 		forget all compiled formulas.  Resource nodes point at resource
+ *		definitions, so this must be called when they are freed.
+ *
+ * @return void
+ */
+void
+free_formula_cache(void)
+{
+	for (auto& f : formula_cache)
+		delete f.second;
+	formula_cache.clear();
+}
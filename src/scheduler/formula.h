@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+#ifndef	_FORMULA_H
+#define	_FORMULA_H
+
+#include <string>
+#include <vector>
+#include "data_types.h"
+
+/* kinds of nodes in a compiled formula */
+enum formula_op {
+	FOP_CONST,		/* numeric literal */
+	FOP_RES,		/* consumable resource requested by the job */
+	FOP_ELIGIBLE_TIME,
+	FOP_QUEUE_PRIO,
+	FOP_JOB_PRIO,
+	FOP_FSPERC,
+	FOP_TREE_USAGE,
+	FOP_FSFACTOR,
+	FOP_ACCRUE_TYPE,
+	FOP_NEG,
+	FOP_NOT,
+	FOP_ADD,
+	FOP_SUB,
+	FOP_MUL,
+	FOP_DIV,
+	FOP_FLOORDIV,
+	FOP_MOD,
+	FOP_POW,
+	FOP_LT,
+	FOP_LE,
+	FOP_GT,
+	FOP_GE,
+	FOP_EQ,
+	FOP_NE,
+	FOP_AND,
+	FOP_OR,
+	FOP_IFELSE,		/* a if b else c */
+	FOP_MIN,
+	FOP_MAX,
+	FOP_ABS
+};
+
+/* one node of a compiled formula; children are indices into the node array */
+struct formula_node {
+	enum formula_op op;
+	double val;		/* FOP_CONST */
+	resdef *def;		/* FOP_RES */
+	std::vector<int> args;	/* operands, in evaluation order */
+};
+
+/*
+ * A job_sort_formula (or fairshare_usage_res formula) parsed once into an
+ * expression tree over resource and job slots and evaluated natively.
+ * Formulas using Python constructs the parser does not know are left to
+ * the embedded interpreter (see formula_evaluate()).
+ */
+class compiled_formula {
+    public:
+	explicit compiled_formula(const std::string& text);
+
+	/* true if the whole formula can be evaluated natively */
+	bool is_native() const { return root >= 0; }
+
+	/*
+	 * evaluate for a job; returns false if the value could not be
+	 * computed natively (e.g. division by zero) and Python must decide
+	 */
+	bool evaluate(const resource_resv *resresv, resource_req *resreq, sch_resource_t *ans) const;
+
+    private:
+	std::vector<formula_node> nodes;
+	int root;
+
+	double eval_node(int idx, const resource_resv *resresv, resource_req *resreq, bool *ok) const;
+};
+
+/*
+ *	get_compiled_formula - return the compiled form of a formula,
+ *				compiling it the first time it is seen
+ */
+const compiled_formula *get_compiled_formula(const char *formula);
+
+/*
+ *	free_formula_cache - forget all compiled formulas
+ *		(they point at resource definitions)
+ */
+void free_formula_cache(void);
+
+#endif	/* _FORMULA_H */
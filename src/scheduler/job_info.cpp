@@ -71,7 +71,10 @@
  * 	is_job_array()
  * 	modify_job_array_for_qrun()
  * 	queue_subjob()
+ * 	formula_evaluate_python()
  * 	formula_evaluate()
+ * 	formula_evaluate_chunk()
+ * 	formula_evaluate_jobs()
  * 	make_eligible()
  * 	make_ineligible()
  * 	update_accruetype()
@@ -81,9 +84,17 @@
  * 	is_finished_job()
  * 	preemption_similarity()
  * 	geteoename()
+ * 	apply_resresv_set_cache()
+ * 	save_resresv_set_cache()
+ * 	free_resresv_set_cache()
  *
  */
 
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <pbs_config.h>
 
 #ifdef PYTHON
@@ -125,6 +136,7 @@
 #include "attribute.h"
 #include "multi_threading.h"
 #include "libpbs.h"
+#include "formula.h"
 
 #ifdef NAS
 #include "site_code.h"
@@ -608,9 +620,9 @@ query_jobs_chunk(th_data_query_jinfo *data)
 			resresv->job->nodect = 999999;
 #endif /* localmod 040 */
 
-		if ((resresv->aoename = getaoename(resresv->select)) != NULL)
+		if ((resresv->aoename = getaoename(resresv->select.get())) != NULL)
 			resresv->is_prov_needed = 1;
-		if ((resresv->eoename = geteoename(resresv->select)) != NULL) {
+		if ((resresv->eoename = geteoename(resresv->select.get())) != NULL) {
 			/* job with a power profile can't be checkpointed or suspended */
 			resresv->job->can_checkpoint = 0;
 			resresv->job->can_suspend = 0;
@@ -656,7 +668,7 @@ query_jobs_chunk(th_data_query_jinfo *data)
 			selectspec = create_select_from_nspec(resresv->nspec_arr);
 
 		if (resresv->nspec_arr != NULL)
-			resresv->execselect = parse_selspec(selectspec);
+			resresv->execselect.reset(parse_selspec(selectspec));
 
 		/* Find out if it is a shrink-to-fit job.
 		 * If yes, set the duration to max walltime.
@@ -1072,10 +1084,7 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 			task->task_type = TS_QUERY_JOB_INFO;
 			task->thread_data = (void*) tdata;
 
-			pthread_mutex_lock(&work_lock);
-			ds_enqueue(work_queue, (void*) task);
-			pthread_cond_signal(&work_cond);
-			pthread_mutex_unlock(&work_lock);
+			queue_work_for_threads(task);
 		}
 		jinfo_arrs_tasks = static_cast<resource_resv ***>(malloc(num_tasks * sizeof(resource_resv**)));
 		if (jinfo_arrs_tasks == NULL) {
@@ -1280,7 +1289,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 			resresv->job->schedsel = string_dup(attrp->value);
 #endif /* localmod 031 */
 
-			resresv->select = parse_selspec(attrp->value);
+			resresv->select.reset(parse_selspec(attrp->value));
 #ifdef NAS /* localmod 031 */
 		}
 #endif /* localmod 031 */
@@ -2451,9 +2460,9 @@ resresv_set_which_selspec(resource_resv *resresv)
 		return NULL;
 
 	if (resresv->job != NULL && !resresv->job->is_running && resresv->execselect != NULL)
-		return resresv->execselect;
+		return resresv->execselect.get();
 
-	return resresv->select;
+	return resresv->select.get();
 }
 
 /**
@@ -2695,6 +2704,303 @@ create_resresv_sets(status *policy, server_info *sinfo)
 	return rsets;
 }
 
+/*
+ * Equivalence classes which could not run, carried over to the next cycle.
+ * The entries are only valid for the universe fingerprint they were made in.
+ * @see apply_resresv_set_cache()
+ */
+static std::unordered_map<std::string, schd_error *> ec_cache;
+static unsigned long long ec_cache_stamp;	/* fingerprint ec_cache was made in */
+static unsigned long long ec_cycle_stamp;	/* fingerprint of this cycle */
+static unsigned long long ec_cycle_running;	/* running jobs when this cycle started */
+
+/**
+ * @brief	create a key which identifies a resresv_set across cycles
+ *
+ * @param[in]	rset	-	the resresv_set
+ *
+ * @return	the key
+ */
+static std::string
+resresv_set_key(resresv_set *rset)
+{
+	std::string key;
+	std::vector<std::string> reqs;
+	resource_req *req;
+	place *pl;
+	int i;
+
+	if (rset->qinfo != NULL)
+		key += rset->qinfo->name;
+	key += '\n';
+	if (rset->user != NULL)
+		key += rset->user;
+	key += '\n';
+	if (rset->group != NULL)
+		key += rset->group;
+	key += '\n';
+	if (rset->project != NULL)
+		key += rset->project;
+	key += '\n';
+
+	for (i = 0; rset->select_spec->chunks[i] != NULL; i++) {
+		key += rset->select_spec->chunks[i]->str_chunk;
+		key += '+';
+	}
+	key += '\n';
+
+	pl = rset->place_spec;
+	key += pl->free ? 'f' : '-';
+	key += pl->pack ? 'p' : '-';
+	key += pl->scatter ? 's' : '-';
+	key += pl->vscatter ? 'v' : '-';
+	key += pl->excl ? 'e' : '-';
+	key += pl->exclhost ? 'h' : '-';
+	key += pl->share ? 'S' : '-';
+	if (pl->group != NULL)
+		key += pl->group;
+	key += '\n';
+
+	/* the order of the list depends on the job the set was created from */
+	for (req = rset->req; req != NULL; req = req->next)
+		reqs.push_back(std::string(req->name) + "=" + (req->res_str != NULL ? req->res_str : ""));
+	std::sort(reqs.begin(), reqs.end());
+	for (const auto& r : reqs) {
+		key += r;
+		key += ',';
+	}
+
+	return key;
+}
+
+/**
+ * @brief	fingerprint the set of running jobs.  The fingerprint does not
+ *		depend on the order of the jobs.
+ *
+ * @param[in]	rjobs	-	running jobs
+ *
+ * @return	unsigned long long
+ */
+static unsigned long long
+running_jobs_sig(resource_resv **rjobs)
+{
+	unsigned long long sig = 0;
+	int i;
+
+	if (rjobs == NULL)
+		return 0;
+
+	for (i = 0; rjobs[i] != NULL; i++) {
+		unsigned long long jsig;
+
+		jsig = sig_add_str(SIG_INIT, rjobs[i]->name.c_str());
+		jsig = sig_add_str(jsig, rjobs[i]->user);
+		jsig = sig_add_str(jsig, rjobs[i]->group);
+		jsig = sig_add_str(jsig, rjobs[i]->project);
+		sig += jsig;
+	}
+
+	return sig;
+}
+
+/**
+ * @brief	can a reason a resresv_set could not run be carried over to
+ *		the next cycle.  The reason must only depend on the state of the
+ *		universe and not on the time the check was made.
+ *
+ * @param[in]	err	-	the reason the set could not run
+ * @param[in]	time_dep	-	node availability depends on the time (i.e.,
+ *					the calendar has jobs or reservations to run)
+ *
+ * @return	int
+ * @retval	1	: reason can be cached
+ * @retval	0	: reason can not be cached
+ */
+static int
+is_cacheable_ec_err(schd_error *err, int time_dep)
+{
+	if (err == NULL)
+		return 0;
+
+	switch (err->error_code) {
+		case QUEUE_JOB_LIMIT_REACHED:
+		case SERVER_JOB_LIMIT_REACHED:
+		case SERVER_USER_LIMIT_REACHED:
+		case QUEUE_USER_LIMIT_REACHED:
+		case SERVER_GROUP_LIMIT_REACHED:
+		case QUEUE_GROUP_LIMIT_REACHED:
+		case QUEUE_USER_RES_LIMIT_REACHED:
+		case SERVER_USER_RES_LIMIT_REACHED:
+		case QUEUE_GROUP_RES_LIMIT_REACHED:
+		case SERVER_GROUP_RES_LIMIT_REACHED:
+		case QUEUE_BYGROUP_JOB_LIMIT_REACHED:
+		case QUEUE_BYUSER_JOB_LIMIT_REACHED:
+		case SERVER_BYGROUP_JOB_LIMIT_REACHED:
+		case SERVER_BYUSER_JOB_LIMIT_REACHED:
+		case SERVER_BYGROUP_RES_LIMIT_REACHED:
+		case SERVER_BYUSER_RES_LIMIT_REACHED:
+		case QUEUE_BYGROUP_RES_LIMIT_REACHED:
+		case QUEUE_BYUSER_RES_LIMIT_REACHED:
+		case QUEUE_RESOURCE_LIMIT_REACHED:
+		case SERVER_RESOURCE_LIMIT_REACHED:
+		case SERVER_PROJECT_LIMIT_REACHED:
+		case SERVER_PROJECT_RES_LIMIT_REACHED:
+		case SERVER_BYPROJECT_RES_LIMIT_REACHED:
+		case SERVER_BYPROJECT_JOB_LIMIT_REACHED:
+		case QUEUE_PROJECT_LIMIT_REACHED:
+		case QUEUE_PROJECT_RES_LIMIT_REACHED:
+		case QUEUE_BYPROJECT_RES_LIMIT_REACHED:
+		case QUEUE_BYPROJECT_JOB_LIMIT_REACHED:
+			return 1;
+
+		case NOT_ENOUGH_NODES_AVAIL:
+		case NO_NODE_RESOURCES:
+		case INSUFFICIENT_RESOURCE:
+		case INSUFFICIENT_QUEUE_RESOURCE:
+		case INSUFFICIENT_SERVER_RESOURCE:
+		case NO_FREE_NODES:
+		case NO_TOTAL_NODES:
+		case SET_TOO_SMALL:
+		case CANT_SPAN_PSET:
+			return !time_dep;
+
+		default:
+			return 0;
+	}
+}
+
+/**
+ * @brief	free the cross-cycle equivalence class cache.  The cached errors
+ *		point at resource definitions, so this must be called when they are freed.
+ *
+ * @return	void
+ */
+void
+free_resresv_set_cache(void)
+{
+	for (auto& ce : ec_cache)
+		free_schd_error(ce.second);
+	ec_cache.clear();
+	ec_cache_stamp = 0;
+}
+
+/**
+ * @brief	mark the equivalence classes which could not run last cycle as
+ *		not able to run this cycle, if nothing they depend on has changed.
+ *		The jobs in these classes are then skipped in O(1) and the reason
+ *		from last cycle is reused for their comment.
+ *
+ * @par	Nothing has changed if the fingerprint of the server, nodes, queues,
+ *	reservations and running jobs (see server_info.ec_state_sig) along with the
+ *	prime and dedicated time status is the same as last cycle.
+ *
+ * @param[in]	sinfo	-	server universe of this cycle
+ *
+ * @return	int
+ * @retval	number of equivalence classes marked
+ */
+int
+apply_resresv_set_cache(server_info *sinfo)
+{
+	unsigned long long stamp = 0;
+	int num_marked = 0;
+	int i;
+
+	ec_cycle_stamp = 0;
+	if (sinfo == NULL || sinfo->equiv_classes == NULL)
+		return 0;
+
+	ec_cycle_running = running_jobs_sig(sinfo->running_jobs);
+	if (sinfo->ec_state_sig != 0) {
+		stamp = sig_add_num(sinfo->ec_state_sig, ec_cycle_running);
+		stamp = sig_add_num(stamp, (sinfo->policy->is_prime << 1) | sinfo->policy->is_ded_time);
+		if (stamp == 0)
+			stamp = 1;
+	}
+	ec_cycle_stamp = stamp;
+
+	if (stamp == 0 || stamp != ec_cache_stamp) {
+		free_resresv_set_cache();
+		return 0;
+	}
+	if (ec_cache.empty())
+		return 0;
+
+	for (i = 0; sinfo->equiv_classes[i] != NULL; i++) {
+		resresv_set *rset = sinfo->equiv_classes[i];
+
+		if (rset->can_not_run)
+			continue;
+		auto ce = ec_cache.find(resresv_set_key(rset));
+		if (ce == ec_cache.end())
+			continue;
+		if ((rset->err = dup_schd_error(ce->second)) == NULL)
+			continue;
+		rset->can_not_run = 1;
+		num_marked++;
+	}
+
+	if (num_marked > 0)
+		log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"%d equivalence classes could not run last cycle and nothing has changed", num_marked);
+
+	return num_marked;
+}
+
+/**
+ * @brief	remember the equivalence classes which could not run this cycle
+ *		for apply_resresv_set_cache() to use next cycle.  Nothing is kept if
+ *		a job was run or preempted this cycle, since the reasons were
+ *		found against a universe the next cycle won't start with.
+ *
+ * @param[in]	sinfo	-	server universe of this cycle
+ *
+ * @return	void
+ */
+void
+save_resresv_set_cache(server_info *sinfo)
+{
+	std::vector<bool> skip;
+	int time_dep;
+	int i;
+
+	free_resresv_set_cache();
+
+	if (sinfo == NULL || sinfo->equiv_classes == NULL || ec_cycle_stamp == 0)
+		return;
+
+	if (running_jobs_sig(sinfo->running_jobs) != ec_cycle_running)
+		return;
+
+	/* Once something is in the calendar to run, node availability depends on when we look */
+	time_dep = exists_run_event(sinfo->calendar, sinfo->server_time + JOB_INFINITY);
+
+	/* A shrink-to-fit job's walltime and a reservation job's window depend on the time */
+	skip.resize(count_array(sinfo->equiv_classes), false);
+	for (i = 0; sinfo->jobs[i] != NULL; i++) {
+		resource_resv *job = sinfo->jobs[i];
+
+		if (job->ec_index != UNSPECIFIED &&
+		    (job->is_shrink_to_fit || (job->job != NULL && job->job->resv != NULL)))
+			skip[job->ec_index] = true;
+	}
+
+	for (i = 0; sinfo->equiv_classes[i] != NULL; i++) {
+		resresv_set *rset = sinfo->equiv_classes[i];
+		schd_error *err;
+
+		if (!rset->can_not_run || skip[i] || !is_cacheable_ec_err(rset->err, time_dep))
+			continue;
+		if ((err = dup_schd_error(rset->err)) == NULL)
+			continue;
+		auto ret = ec_cache.emplace(resresv_set_key(rset), err);
+		if (!ret.second)
+			free_schd_error(err);
+	}
+
+	ec_cache_stamp = ec_cycle_stamp;
+}
+
 /**
  * @brief
  * 		job_info copy constructor
@@ -4175,7 +4481,7 @@ queue_subjob(resource_resv *array, server_info *sinfo,
 /**
  * @brief
  * 		evaluate a math formula for jobs based on their resources
- *		NOTE: currently done through embedded python interpreter
+ *		through the embedded python interpreter
  *
  * @param[in]	formula	-	formula to evaluate
  * @param[in]	resresv	-	job for special case key words
@@ -4186,8 +4492,8 @@ queue_subjob(resource_resv *array, server_info *sinfo,
  */
 
 #ifdef PYTHON
-sch_resource_t
-formula_evaluate(const char *formula, resource_resv *resresv, resource_req *resreq)
+static sch_resource_t
+formula_evaluate_python(const char *formula, resource_resv *resresv, resource_req *resreq)
 {
 	char buf[1024];
 	char *globals;
@@ -4301,13 +4607,139 @@ formula_evaluate(const char *formula, resource_resv *resresv, resource_req *resr
 
 	return ans;
 }
-#else
+#endif
+
+/**
+ * @brief
+ * 		evaluate a math formula for jobs based on their resources
+ *
+ * @par
+ *		The formula is compiled once (see formula.cpp) and evaluated
+ *		natively.  Formulas (or values) the native evaluator can't handle
+ *		go through the embedded python interpreter.
+ *
+ * @param[in]	formula	-	formula to evaluate
+ * @param[in]	resresv	-	job for special case key words
+ * @param[in]	resreq	-	resources to use when evaluating
+ *
+ * @return	evaluated formula answer or 0 on exception
+ *
+ * @par MT-safe: No
+ */
 sch_resource_t
-formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
+formula_evaluate(const char *formula, resource_resv *resresv, resource_req *resreq)
 {
+	const compiled_formula *cf;
+	sch_resource_t ans = 0;
+
+	if (formula == NULL || resresv == NULL ||
+		resresv->job == NULL)
+		return 0;
+
+	cf = get_compiled_formula(formula);
+	if (cf != NULL && cf->evaluate(resresv, resreq, &ans))
+		return ans;
+
+#ifdef PYTHON
+	return formula_evaluate_python(formula, resresv, resreq);
+#else
 	return 0;
-}
 #endif
+}
+
+/**
+ * @brief
+ * 		evaluate a compiled formula for a chunk of jobs.  Jobs the native
+ *		evaluator can't handle get a NaN formula_value, to be filled in
+ *		by the main thread.
+ *
+ * @param[in,out]	data	-	th_data_formula for the chunk
+ *
+ * @return void
+ */
+static void
+formula_evaluate_chunk(void *data)
+{
+	th_data_formula *tdata = static_cast<th_data_formula *>(data);
+
+	for (int i = tdata->sidx; i <= tdata->eidx && tdata->jobs[i] != NULL; i++) {
+		resource_resv *resresv = tdata->jobs[i];
+		sch_resource_t ans;
+
+		if (resresv->job == NULL)
+			continue;
+		if (tdata->cf->evaluate(resresv, resresv->resreq, &ans))
+			resresv->job->formula_value = ans;
+		else
+			resresv->job->formula_value = NAN;
+	}
+}
+
+/**
+ * @brief
+ * 		set the formula_value of every job in an array.  The formula is
+ *		compiled once; if it can be evaluated natively, the jobs are
+ *		split among the worker threads.
+ *
+ * @param[in]		formula	-	formula to evaluate
+ * @param[in,out]	jobs	-	jobs to evaluate the formula for
+ *
+ * @return void
+ */
+void
+formula_evaluate_jobs(const char *formula, resource_resv **jobs)
+{
+	const compiled_formula *cf;
+	int num_jobs;
+	int tid;
+
+	if (formula == NULL || jobs == NULL)
+		return;
+
+	num_jobs = count_array(jobs);
+	cf = get_compiled_formula(formula);
+
+	if (cf != NULL && cf->is_native()) {
+		tid = *((int *) pthread_getspecific(th_id_key));
+		if (tid != 0 || num_threads <= 1 || num_jobs <= MT_CHUNK_SIZE_MIN) {
+			th_data_formula tdata = {cf, jobs, 0, num_jobs - 1};
+			formula_evaluate_chunk(&tdata);
+		} else {
+			th_task_group *grp;
+			std::vector<th_data_formula> tdatas;
+			int chunk_size = num_jobs / num_threads;
+			int j;
+
+			chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN) ? chunk_size : MT_CHUNK_SIZE_MIN;
+			chunk_size = (chunk_size < MT_CHUNK_SIZE_MAX) ? chunk_size : MT_CHUNK_SIZE_MAX;
+			for (j = 0; j < num_jobs; j += chunk_size)
+				tdatas.push_back({cf, jobs, j, std::min(j + chunk_size, num_jobs) - 1});
+
+			grp = new_th_task_group();
+			if (grp == NULL) {
+				for (auto& td : tdatas)
+					formula_evaluate_chunk(&td);
+			} else {
+				for (auto& td : tdatas) {
+					if (!queue_func_for_threads(grp, formula_evaluate_chunk, &td))
+						formula_evaluate_chunk(&td);
+				}
+				wait_th_task_group(grp);
+				free_th_task_group(grp);
+			}
+		}
+	}
+
+	/* everything the native evaluator couldn't do */
+	for (int i = 0; i < num_jobs; i++) {
+		resource_resv *resresv = jobs[i];
+
+		if (resresv->job == NULL)
+			continue;
+		if (cf == NULL || !cf->is_native() || std::isnan(resresv->job->formula_value))
+			resresv->job->formula_value = formula_evaluate(formula, resresv, resresv->resreq);
+	}
+}
 
 /**
  * @brief
@@ -4835,8 +5267,7 @@ void create_res_released(status *policy, resource_resv *pjob)
 		pjob->job->resreq_rel = create_resreq_rel_list(policy, pjob);
 	}
 	selectspec = create_select_from_nspec(pjob->job->resreleased);
-	delete pjob->execselect;
-	pjob->execselect = parse_selspec(selectspec);
+	pjob->execselect.reset(parse_selspec(selectspec));
 	return;
 }
 
@@ -246,11 +246,17 @@ queue_subjob(resource_resv *array, server_info *sinfo,
 	queue_info *qinfo);
 /*
  *	formula_evaluate - evaluate a math formula for jobs based on their resources
- *		NOTE: currently done through embedded python interpreter
+ *		NOTE: natively if possible, otherwise through embedded python interpreter
  */
 
 sch_resource_t formula_evaluate(const char *formula, resource_resv *resresv, resource_req *resreq);
 
+/*
+ *	formula_evaluate_jobs - set formula_value of every job in an array,
+ *				natively and multi-threaded where possible
+ */
+void formula_evaluate_jobs(const char *formula, resource_resv **jobs);
+
 /*
  *
  *      update_accruetype - Updates accrue_type of job on server.
@@ -360,6 +366,15 @@ std::unordered_set<resdef *> create_resresv_sets_resdef(status *policy);
 
 /* Create an array of resresv_sets based on sinfo*/
 resresv_set **create_resresv_sets(status *policy, server_info *sinfo);
+
+/* mark equivalence classes which could not run last cycle and nothing changed */
+int apply_resresv_set_cache(server_info *sinfo);
+
+/* remember the equivalence classes which could not run this cycle */
+void save_resresv_set_cache(server_info *sinfo);
+
+/* free the cross-cycle equivalence class cache */
+void free_resresv_set_cache(void);
 /*
  * This function creates a string and update resources_released job
  *  attribute.
@@ -55,7 +55,10 @@
  * 	has_softlimits()
  * 	new_limcounts()
  * 	free_limcounts()
- * 	make_limcounts()
+ * 	view_limcounts()
+ * 	dup_entity_counts()
+ * 	make_entity_limcounts()
+ * 	update_entity_limcounts()
  * 	check_limits()
  * 	check_soft_limits()
  * 	check_server_max_user_run()
@@ -760,9 +763,63 @@ free_limcounts(limcounts *lc)
 
 /**
  * @brief
- *		make_limcounts - create a limcounts structure by either duplicating
- *			 the passed in data
+ *		view_limcounts - point a limcounts structure at existing counts
+ *			 lists without copying them.  The limit checks only read
+ *			 the counts, so this is all they need when nothing is
+ *			 simulated.  A view must not be passed to free_limcounts().
  *
+ * @param[out]	lc	-	limcounts structure to fill in
+ * @param[in]	user	-	user counts
+ * @param[in]	group	-	group counts
+ * @param[in]	project -	project counts
+ * @param[in]	all	-	alljob counts
+ *
+ * @return	void
+ */
+static void
+view_limcounts(limcounts *lc, counts *user, counts *group, counts *project, counts *all)
+{
+	lc->user = user;
+	lc->group = group;
+	lc->project = project;
+	lc->all = all;
+}
+
+/**
+ * @brief
+ *		dup_entity_counts - duplicate the counts of one entity out of a
+ *			 counts list.  If the entity has no counts yet, empty
+ *			 counts are created for it.
+ *
+ * @param[in]	ctslist	-	counts list to search
+ * @param[in]	name	-	name of the entity
+ *
+ * @return	single element counts list
+ * @retval	NULL	: on error
+ */
+static counts *
+dup_entity_counts(counts *ctslist, const char *name)
+{
+	counts *cts;
+
+	if ((cts = find_counts(ctslist, name)) != NULL)
+		return dup_counts(cts);
+
+	if ((cts = new_counts()) != NULL && name != NULL)
+		cts->name = string_dup(name);
+
+	return cts;
+}
+
+/**
+ * @brief
+ *		make_entity_limcounts - create a limcounts structure holding copies
+ *			 of the counts of only the entities a job is charged to.
+ *			 The limit checks only ever look up the job's own user,
+ *			 group and project and the all entity, so this is all a
+ *			 simulation of future runs needs to copy.
+ *
+ * @param[in]	rr	-	job whose entities to copy
  * @param[in]	user	-	user counts
  * @param[in]	group	-	group counts
  * @param[in]	project -	project counts
@@ -773,30 +830,21 @@ free_limcounts(limcounts *lc)
  * @retval	NULL	: on error
  */
 static limcounts *
-make_limcounts(counts *user, counts *group, counts *project, counts *all)
+make_entity_limcounts(resource_resv *rr, counts *user, counts *group, counts *project, counts *all)
 {
 	limcounts *lc;
 	lc = new_limcounts();
 	if (lc == NULL)
 		return NULL;
 
-	lc->user = dup_counts_list(user);
-	if ((lc->user == NULL) && (user != NULL)) {
-		free_limcounts(lc);
-		return NULL;
-	}
-	lc->group = dup_counts_list(group);
-	if ((lc->group == NULL) && (group != NULL)) {
-		free_limcounts(lc);
-		return NULL;
-	}
-	lc->project = dup_counts_list(project);
-	if ((lc->project == NULL) && (project != NULL)) {
+	if ((lc->user = dup_entity_counts(user, rr->user)) == NULL ||
+	    (lc->group = dup_entity_counts(group, rr->group)) == NULL ||
+	    (lc->project = dup_entity_counts(project, rr->project)) == NULL) {
 		free_limcounts(lc);
 		return NULL;
 	}
-	lc->all = dup_counts_list(all);
-	if ((lc->all == NULL) && (all != NULL)) {
+	/* nothing is counted against the all entity if nothing is running */
+	if (all != NULL && (lc->all = dup_counts(all)) == NULL) {
 		free_limcounts(lc);
 		return NULL;
 	}
@@ -804,6 +852,54 @@ make_limcounts(counts *user, counts *group, counts *project, counts *all)
 	return lc;
 }
 
+/**
+ * @brief
+ *		update_entity_limcounts - account for a job starting or ending in
+ *			 limcounts made by make_entity_limcounts() and keep track
+ *			 of their high water mark
+ *
+ * @param[in,out]	lc	-	counts to update
+ * @param[in,out]	lc_max	-	high water mark of lc
+ * @param[in]	te_rr	-	job which starts or ends
+ * @param[in]	event_type -	TIMED_RUN_EVENT or TIMED_END_EVENT
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error
+ */
+static int
+update_entity_limcounts(limcounts *lc, limcounts *lc_max, resource_resv *te_rr, int event_type)
+{
+	struct {
+		counts *cts;
+		counts **max;
+		const char *name;
+	} ents[] = {
+		{lc->user, &lc_max->user, te_rr->user},
+		{lc->group, &lc_max->group, te_rr->group},
+		{lc->project, &lc_max->project, te_rr->project},
+		{lc->all, &lc_max->all, NULL}
+	};
+
+	for (auto& ent : ents) {
+		if (ent.cts == NULL)
+			continue;
+		/* the all entity is charged for every job */
+		if (ent.cts != lc->all &&
+		    (ent.name == NULL || ent.cts->name == NULL || strcmp(ent.cts->name, ent.name) != 0))
+			continue;
+
+		if (event_type == TIMED_RUN_EVENT) {
+			update_counts_on_run(ent.cts, te_rr->resreq);
+			if ((*ent.max = counts_max(*ent.max, ent.cts)) == NULL)
+				return 0;
+		} else
+			update_counts_on_end(ent.cts, te_rr->resreq);
+	}
+
+	return 1;
+}
+
 /**
  * @brief
  *		check_limits - hard limit checking function.
@@ -835,7 +931,8 @@ check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err
 	limcounts *que_counts_max = NULL;
 	limcounts *server_lim = NULL;
 	limcounts *queue_lim = NULL;
-	counts *cts;
+	limcounts server_view;
+	limcounts queue_view;
 	schd_error *prev_err = NULL;
 
 	if (si == NULL || qi == NULL || rr == NULL)
@@ -859,14 +956,14 @@ check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err
 
 		if (exists_run_event(si->calendar, end)) {
 			if (si->has_hard_limit) {
-				svr_counts_max = make_limcounts(si->user_counts,
+				svr_counts_max = make_entity_limcounts(rr, si->user_counts,
 					si->group_counts,
 					si->project_counts,
 					si->alljobcounts);
 				if (svr_counts_max == NULL)
 					return SE_NONE;
 
-				svr_counts = make_limcounts(si->user_counts,
+				svr_counts = make_entity_limcounts(rr, si->user_counts,
 					si->group_counts,
 					si->project_counts,
 					si->alljobcounts);
@@ -877,7 +974,7 @@ check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err
 			}
 
 			if (qi->has_hard_limit) {
-				que_counts_max = make_limcounts(qi->user_counts,
+				que_counts_max = make_entity_limcounts(rr, qi->user_counts,
 					qi->group_counts,
 					qi->project_counts,
 					qi->alljobcounts);
@@ -887,7 +984,7 @@ check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err
 					return SE_NONE;
 				}
 
-				que_counts = make_limcounts(qi->user_counts,
+				que_counts = make_entity_limcounts(rr, qi->user_counts,
 					qi->group_counts,
 					qi->project_counts,
 					qi->alljobcounts);
@@ -908,132 +1005,16 @@ check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err
 			     te = find_next_timed_event(te, IGNORE_DISABLED_EVENTS, event_mask)) {
 				auto te_rr = static_cast<resource_resv *>(te->event_ptr);
 				if ((te_rr != rr) && te_rr->is_job) {
-					if (te->event_type == TIMED_RUN_EVENT) {
-						if (svr_counts != NULL) {
-							cts = find_alloc_counts(svr_counts->user, te_rr->user);
-							if (svr_counts->user == NULL)
-								svr_counts->user = cts;
-							update_counts_on_run(cts, te_rr->resreq);
-							svr_counts_max->user =
-								counts_max(svr_counts_max->user, cts);
-							if (svr_counts_max->user == NULL) {
-								error = true;
-								break;
-							}
-
-							cts = find_alloc_counts(svr_counts->group, te_rr->group);
-							if (svr_counts->group == NULL)
-								svr_counts->group = cts;
-							update_counts_on_run(cts, te_rr->resreq);
-							svr_counts_max->group =
-								counts_max(svr_counts_max->group, cts);
-							if (svr_counts_max->group == NULL) {
-								error = true;
-								break;
-							}
-
-							cts = find_alloc_counts(svr_counts->project, te_rr->project);
-							if (svr_counts->project == NULL)
-								svr_counts->project = cts;
-							update_counts_on_run(cts, te_rr->resreq);
-							svr_counts_max->project =
-								counts_max(svr_counts_max->project, cts);
-							if (svr_counts_max->project == NULL) {
-								error = true;
-								break;
-							}
-
-							update_counts_on_run(svr_counts->all, te_rr->resreq);
-							svr_counts_max->all =
-								counts_max(svr_counts_max->all, svr_counts->all);
-							if (svr_counts_max->all == NULL) {
-								error = true;
-								break;
-							}
-						}
-
-						if (que_counts != NULL) {
-							if (te_rr->is_job && te_rr->job != NULL) {
-								if (te_rr->job->queue == qi) {
-									cts = find_alloc_counts(que_counts->user, te_rr->user);
-									if (que_counts->user == NULL)
-										que_counts->user = cts;
-									update_counts_on_run(cts, te_rr->resreq);
-									que_counts_max->user =
-										counts_max(que_counts_max->user, cts);
-									if (que_counts_max->user == NULL) {
-										error = true;
-										break;
-									}
-
-									cts = find_alloc_counts(que_counts->group, te_rr->group);
-									if (que_counts->group == NULL)
-										que_counts->group = cts;
-									update_counts_on_run(cts, te_rr->resreq);
-									que_counts_max->group =
-										counts_max(que_counts_max->group, cts);
-									if (que_counts_max->group == NULL) {
-										error = true;
-										break;
-									}
-
-									cts = find_alloc_counts(que_counts->project, te_rr->project);
-									if (que_counts->project == NULL)
-										que_counts->project = cts;
-									update_counts_on_run(cts, te_rr->resreq);
-									que_counts_max->project =
-										counts_max(que_counts_max->project, cts);
-									if (que_counts_max->project == NULL) {
-										error = true;
-										break;
-									}
-
-									update_counts_on_run(que_counts->all, te_rr->resreq);
-									que_counts_max->all = counts_max(que_counts_max->all, que_counts->all);
-									if (que_counts_max->all == NULL) {
-										error = true;
-										break;
-									}
-								}
-							}
+					if (svr_counts != NULL) {
+						if (!update_entity_limcounts(svr_counts, svr_counts_max, te_rr, te->event_type)) {
+							error = true;
+							break;
 						}
 					}
-					else if (te->event_type == TIMED_END_EVENT) {
-						if (svr_counts != NULL) {
-							cts = find_alloc_counts(svr_counts->user, te_rr->user);
-							if (svr_counts->user == NULL)
-								svr_counts->user = cts;
-							update_counts_on_end(cts, te_rr->resreq);
-							cts = find_alloc_counts(svr_counts->group, te_rr->group);
-							if (svr_counts->group == NULL)
-								svr_counts->group = cts;
-							update_counts_on_end(cts, te_rr->resreq);
-							cts = find_alloc_counts(svr_counts->project, te_rr->project);
-							if (svr_counts->project == NULL)
-								svr_counts->project = cts;
-							update_counts_on_end(cts, te_rr->resreq);
-
-							update_counts_on_end(svr_counts->all, te_rr->resreq);
-						}
-						if (que_counts != NULL) {
-							if (te_rr->is_job && te_rr->job != NULL) {
-								if (te_rr->job->queue == qi) {
-									cts = find_alloc_counts(que_counts->user, te_rr->user);
-									if (que_counts->user == NULL)
-										que_counts->user = cts;
-									update_counts_on_end(cts, te_rr->resreq);
-									cts = find_alloc_counts(que_counts->group, te_rr->group);
-									if (que_counts->group == NULL)
-										que_counts->group = cts;
-									update_counts_on_end(cts, te_rr->resreq);
-									cts = find_alloc_counts(que_counts->project, te_rr->project);
-									if (que_counts->project == NULL)
-										que_counts->project = cts;
-									update_counts_on_end(cts, te_rr->resreq);
-
-									update_counts_on_end(que_counts->all, te_rr->resreq);
-								}
-							}
+					if (que_counts != NULL && te_rr->job != NULL && te_rr->job->queue == qi) {
+						if (!update_entity_limcounts(que_counts, que_counts_max, te_rr, te->event_type)) {
+							error = true;
+							break;
 						}
 					}
 				}
@@ -1053,43 +1034,35 @@ check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err
 			server_lim = svr_counts_max;
 		}
 		else {
-			server_lim = make_limcounts(si->user_counts,
+			view_limcounts(&server_view, si->user_counts,
 				si->group_counts,
 				si->project_counts,
 				si->alljobcounts);
-			if (server_lim == NULL)
-				return SE_NONE;
+			server_lim = &server_view;
 		}
 		if (que_counts_max != NULL) {
 			queue_lim = que_counts_max;
 		}
 		else {
-			queue_lim = make_limcounts(qi->user_counts,
+			view_limcounts(&queue_view, qi->user_counts,
 				qi->group_counts,
 				qi->project_counts,
 				qi->alljobcounts);
-			if (queue_lim == NULL) {
-				free_limcounts(server_lim);
-				return SE_NONE;
-			}
+			queue_lim = &queue_view;
 		}
 	} else if ((flags & CHECK_CUMULATIVE_LIMIT)) {
 		if (!si->has_hard_limit && !qi->has_hard_limit)
 			return SE_NONE;
-		server_lim = make_limcounts(si->total_user_counts,
+		view_limcounts(&server_view, si->total_user_counts,
 			si->total_group_counts,
 			si->total_project_counts,
 			si->total_alljobcounts);
-		if (server_lim == NULL)
-			return SE_NONE;
-		queue_lim = make_limcounts(qi->total_user_counts,
+		server_lim = &server_view;
+		view_limcounts(&queue_view, qi->total_user_counts,
 			qi->total_group_counts,
 			qi->total_project_counts,
 			qi->total_alljobcounts);
-		if (queue_lim == NULL) {
-			free_limcounts(server_lim);
-			return SE_NONE;
-		}
+		queue_lim = &queue_view;
 	}
 	for (i = 0; i < sizeof(limfuncs) / sizeof(limfuncs[0]); i++) {
 		rc = static_cast<enum sched_error_code>((limfuncs[i])(si, qi, rr, server_lim, queue_lim, err));
@@ -1102,8 +1075,8 @@ check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err
 				prev_err = err;
 				err = err->next;
 				if(err == NULL) {
-					free_limcounts(server_lim);
-					free_limcounts(queue_lim);
+					free_limcounts(svr_counts_max);
+					free_limcounts(que_counts_max);
 					return SCHD_ERROR;
 				}
 			} else {
@@ -1113,8 +1086,8 @@ check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err
 		}
 	}
 
-	free_limcounts(server_lim);
-	free_limcounts(queue_lim);
+	free_limcounts(svr_counts_max);
+	free_limcounts(que_counts_max);
 
 	if (flags & RETURN_ALL_ERR) {
 		if (prev_err != NULL) {
@@ -1788,7 +1761,7 @@ check_queue_max_res(server_info *si, queue_info *qi, resource_resv *rr,
 		if (max_res == SCHD_INFINITY)
 			continue;
 
-		if ((used_res = find_resource_count(c->rescts, res->def)) == NULL)
+		if ((used_res = find_counts_rescount(c, res->def)) == NULL)
 			used = 0;
 		else
 			used = used_res->amount;
@@ -1863,7 +1836,7 @@ check_server_max_res(server_info *si, queue_info *qi, resource_resv *rr,
 		if (max_res == SCHD_INFINITY)
 			continue;
 
-		if ((used_res = find_resource_count(c->rescts, res->def)) == NULL)
+		if ((used_res = find_counts_rescount(c, res->def)) == NULL)
 			used = 0;
 		else
 			used = used_res->amount;
@@ -2544,7 +2517,7 @@ check_server_max_res_soft(server_info *si, queue_info *qi, resource_resv *rr)
 		if (max_res_soft == SCHD_INFINITY)
 			continue;
 
-		if ((used_res = find_resource_count(c->rescts, res->def)) == NULL)
+		if ((used_res = find_counts_rescount(c, res->def)) == NULL)
 			used = 0;
 		else
 			used = used_res->amount;
@@ -2613,7 +2586,7 @@ check_queue_max_res_soft(server_info *si, queue_info *qi, resource_resv *rr)
 		if (max_res_soft == SCHD_INFINITY)
 			continue;
 
-		if ((used_res = find_resource_count(c->rescts, res->def)) == NULL)
+		if ((used_res = find_counts_rescount(c, res->def)) == NULL)
 			used = 0;
 		else
 			used = used_res->amount;
@@ -1550,4 +1550,82 @@ free_ptr_array(void *inp)
 	for (i = 0; arr[i] != NULL; i++)
 		free(arr[i]);
 	free(arr);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief	add a string (including its terminator) to a 64 bit FNV-1a hash
+ *
+ * @param[in]	sig	-	hash so far
+ * @param[in]	str	-	string to add
+ *
+ * @return	the new hash
+ */
+unsigned long long
+sig_add_str(unsigned long long sig, const char *str)
+{
+	if (str != NULL) {
+		for (; *str != '\0'; str++) {
+			sig ^= static_cast<unsigned char>(*str);
+			sig *= 1099511628211ULL;
+		}
+	}
+	sig *= 1099511628211ULL;
+
+	return sig;
+}
+
+/**
+ * @brief	add a number to a 64 bit FNV-1a hash
+ *
+ * @param[in]	sig	-	hash so far
+ * @param[in]	num	-	number to add
+ *
+ * @return	the new hash
+ */
+unsigned long long
+sig_add_num(unsigned long long sig, unsigned long long num)
+{
+	int i;
+
+	for (i = 0; i < 8; i++, num >>= 8) {
+		sig ^= num & 0xff;
+		sig *= 1099511628211ULL;
+	}
+
+	return sig;
+}
+
+/**
+ * @brief	add every object of a batch_status list to a 64 bit FNV-1a hash
+ *
+ * @param[in]	sig	-	hash so far
+ * @param[in]	bs	-	batch_status list to add
+ * @param[in]	skip	-	NULL terminated list of attribute names to leave out
+ *				(e.g., counters which change with every job submission).
+ *				May be NULL.
+ *
+ * @return	the new hash
+ */
+unsigned long long
+batch_status_sig(unsigned long long sig, struct batch_status *bs, const char **skip)
+{
+	struct attrl *attrp;
+	int i;
+
+	for (; bs != NULL; bs = bs->next) {
+		sig = sig_add_str(sig, bs->name);
+		for (attrp = bs->attribs; attrp != NULL; attrp = attrp->next) {
+			if (skip != NULL) {
+				for (i = 0; skip[i] != NULL && strcmp(attrp->name, skip[i]); i++)
+					;
+				if (skip[i] != NULL)
+					continue;
+			}
+			sig = sig_add_str(sig, attrp->name);
+			sig = sig_add_str(sig, attrp->resource);
+			sig = sig_add_str(sig, attrp->value);
+		}
+	}
+
+	return sig;
+}
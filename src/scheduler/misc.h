@@ -270,6 +270,21 @@ add_str_to_unique_array(char ***str_arr, char *str);
  */
 void free_ptr_array (void *inp);
 
+/*
+ * add a string to a 64 bit FNV-1a hash (start a new hash with SIG_INIT)
+ */
+unsigned long long sig_add_str(unsigned long long sig, const char *str);
+
+/*
+ * add a number to a 64 bit FNV-1a hash
+ */
+unsigned long long sig_add_num(unsigned long long sig, unsigned long long num);
+
+/*
+ * add a batch_status list to a 64 bit FNV-1a hash
+ */
+unsigned long long batch_status_sig(unsigned long long sig, struct batch_status *bs, const char **skip);
+
 void log_eventf(int eventtype, int objclass, int sev, const std::string& objname, const char *fmt, ...);
 void log_event(int eventtype, int objclass, int sev, const std::string& objname, const char *text);
 
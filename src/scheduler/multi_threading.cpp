@@ -47,6 +47,9 @@
 #include <errno.h>
 #include <signal.h>
 
+#include <atomic>
+#include <deque>
+
 #include "log.h"
 #include "pbs_idx.h"
 
@@ -60,6 +63,22 @@
 #include "resource_resv.h"
 #include "multi_threading.h"
 
+/*
+ * Work is distributed over one deque per worker thread.  A worker pops tasks
+ * from the back of its own deque and, when that is empty, steals from the
+ * front of the other workers' deques.  Each deque has its own lock, so
+ * queueing and dequeueing tasks never serializes all threads on one mutex.
+ * work_lock/work_cond are only used to park idle workers.
+ */
+struct th_deque {
+	pthread_mutex_t lock;
+	std::deque<th_task_info *> tasks;
+};
+
+static th_deque *th_deques = NULL;
+static std::atomic<int> num_pending_tasks(0);
+static std::atomic<unsigned int> next_deque(0);
+
 /**
  * @brief	create the thread id key & set it for the main thread
  *
@@ -83,6 +102,31 @@ create_id_key(void)
 	pthread_setspecific(th_id_key, (void *) mainid);
 }
 
+/**
+ * @brief	free the per-thread task deques and any tasks left in them
+ *
+ * @param	void
+ *
+ * @return	void
+ */
+static void
+free_th_deques(void)
+{
+	int i;
+
+	if (th_deques == NULL)
+		return;
+
+	for (i = 0; i < num_threads; i++) {
+		for (auto task : th_deques[i].tasks)
+			free(task);
+		pthread_mutex_destroy(&th_deques[i].lock);
+	}
+	delete[] th_deques;
+	th_deques = NULL;
+	num_pending_tasks = 0;
+}
+
 /**
  * @brief	convenience function to kill worker threads
  *
@@ -113,11 +157,10 @@ kill_threads(void)
 	pthread_cond_destroy(&result_cond);
 	pthread_mutex_destroy(&general_lock);
 	free(threads);
-	free_ds_queue(work_queue);
+	free_th_deques();
 	free_ds_queue(result_queue);
 	threads = NULL;
 	num_threads = 0;
-	work_queue = NULL;
 	result_queue = NULL;
 }
 
@@ -184,17 +227,22 @@ init_multi_threading(int nthreads)
 		return 0;
 	}
 
-	/* Create task and result queues */
-	work_queue = new_ds_queue();
-	if (work_queue == NULL) {
+	/* Create per-thread task deques and the result queue */
+	try {
+		th_deques = new th_deque[num_threads];
+	} catch (std::bad_alloc &e) {
+		log_err(errno, __func__, MEM_ERR_MSG);
 		free(threads);
 		return 0;
 	}
+	for (i = 0; i < num_threads; i++)
+		pthread_mutex_init(&th_deques[i].lock, NULL);
+	num_pending_tasks = 0;
+
 	result_queue = new_ds_queue();
 	if (result_queue == NULL) {
 		free(threads);
-		free_ds_queue(work_queue);
-		work_queue = NULL;
+		free_th_deques();
 		return 0;
 	}
 
@@ -205,9 +253,8 @@ init_multi_threading(int nthreads)
 		thid = static_cast<int *>(malloc(sizeof(int)));
 		if (thid == NULL) {
 			free(threads);
-			free_ds_queue(work_queue);
+			free_th_deques();
 			free_ds_queue(result_queue);
-			work_queue = NULL;
 			result_queue = NULL;
 			log_err(errno, __func__, MEM_ERR_MSG);
 			return 0;
@@ -219,6 +266,47 @@ init_multi_threading(int nthreads)
 	return 1;
 }
 
+/**
+ * @brief	get the next task for a worker thread.  First look in the
+ *		thread's own deque, then try to steal from the other threads.
+ *
+ * @param[in]	qidx - index of the calling thread's deque
+ *
+ * @return	th_task_info *
+ * @retval	the task to run
+ * @retval	NULL if there is no queued work
+ */
+static th_task_info *
+get_next_task(int qidx)
+{
+	th_task_info *task = NULL;
+	int i;
+
+	if (num_pending_tasks == 0)
+		return NULL;
+
+	for (i = 0; i < num_threads && task == NULL; i++) {
+		th_deque *dq = &th_deques[(qidx + i) % num_threads];
+
+		pthread_mutex_lock(&dq->lock);
+		if (!dq->tasks.empty()) {
+			if (i == 0) {
+				task = dq->tasks.back();
+				dq->tasks.pop_back();
+			} else {
+				task = dq->tasks.front();
+				dq->tasks.pop_front();
+			}
+		}
+		pthread_mutex_unlock(&dq->lock);
+	}
+
+	if (task != NULL)
+		num_pending_tasks--;
+
+	return task;
+}
+
 /**
  * @brief	Main pthread routine for worker threads
  *
@@ -248,57 +336,66 @@ worker(void *tid)
 	}
 
 	while (!threads_die) {
-		/* Get the next work task from work queue */
-		pthread_mutex_lock(&work_lock);
-		while (ds_queue_is_empty(work_queue) && !threads_die) {
-			pthread_cond_wait(&work_cond, &work_lock);
+		/* Get the next work task from our deque or steal one */
+		work = get_next_task(ntid - 1);
+		if (work == NULL) {
+			pthread_mutex_lock(&work_lock);
+			while (num_pending_tasks == 0 && !threads_die)
+				pthread_cond_wait(&work_cond, &work_lock);
+			pthread_mutex_unlock(&work_lock);
+			continue;
 		}
-		work = static_cast<th_task_info *>(ds_dequeue(work_queue));
-		pthread_mutex_unlock(&work_lock);
 
 		/* find out what task we need to do */
-		if (work != NULL) {
-			switch (work->task_type) {
-			case TS_IS_ND_ELIGIBLE:
-				snprintf(buf, sizeof(buf), "Thread %d calling check_node_eligibility_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				check_node_eligibility_chunk(static_cast<th_data_nd_eligible *>(work->thread_data));
-				break;
-			case TS_DUP_ND_INFO:
-				snprintf(buf, sizeof(buf), "Thread %d calling dup_node_info_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				dup_node_info_chunk(static_cast<th_data_dup_nd_info *>(work->thread_data));
-				break;
-			case TS_QUERY_ND_INFO:
-				snprintf(buf, sizeof(buf), "Thread %d calling query_node_info_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				query_node_info_chunk(static_cast<th_data_query_ninfo *>(work->thread_data));
-				break;
-			case TS_FREE_ND_INFO:
-				snprintf(buf, sizeof(buf), "Thread %d calling free_node_info_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				free_node_info_chunk(static_cast<th_data_free_ninfo *>(work->thread_data));
-				break;
-			case TS_DUP_RESRESV:
-				snprintf(buf, sizeof(buf), "Thread %d calling dup_resource_resv_array_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				dup_resource_resv_array_chunk(static_cast<th_data_dup_resresv *>(work->thread_data));
-				break;
-			case TS_QUERY_JOB_INFO:
-				snprintf(buf, sizeof(buf), "Thread %d calling query_jobs_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				query_jobs_chunk(static_cast<th_data_query_jinfo *>(work->thread_data));
-				break;
-			case TS_FREE_RESRESV:
-				snprintf(buf, sizeof(buf), "Thread %d calling free_resource_resv_array_chunk()", ntid);
-				log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
-				free_resource_resv_array_chunk(static_cast<th_data_free_resresv *>(work->thread_data));
-				break;
-			default:
-				log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_SCHED, LOG_ERR, __func__,
-						"Invalid task type passed to worker thread");
-			}
+		switch (work->task_type) {
+		case TS_FUNC:
+			work->func(work->thread_data);
+			break;
+		case TS_DUP_ND_INFO:
+			snprintf(buf, sizeof(buf), "Thread %d calling dup_node_info_chunk()", ntid);
+			log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+			dup_node_info_chunk(static_cast<th_data_dup_nd_info *>(work->thread_data));
+			break;
+		case TS_QUERY_ND_INFO:
+			snprintf(buf, sizeof(buf), "Thread %d calling query_node_info_chunk()", ntid);
+			log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+			query_node_info_chunk(static_cast<th_data_query_ninfo *>(work->thread_data));
+			break;
+		case TS_FREE_ND_INFO:
+			snprintf(buf, sizeof(buf), "Thread %d calling free_node_info_chunk()", ntid);
+			log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+			free_node_info_chunk(static_cast<th_data_free_ninfo *>(work->thread_data));
+			break;
+		case TS_DUP_RESRESV:
+			snprintf(buf, sizeof(buf), "Thread %d calling dup_resource_resv_array_chunk()", ntid);
+			log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+			dup_resource_resv_array_chunk(static_cast<th_data_dup_resresv *>(work->thread_data));
+			break;
+		case TS_QUERY_JOB_INFO:
+			snprintf(buf, sizeof(buf), "Thread %d calling query_jobs_chunk()", ntid);
+			log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+			query_jobs_chunk(static_cast<th_data_query_jinfo *>(work->thread_data));
+			break;
+		case TS_FREE_RESRESV:
+			snprintf(buf, sizeof(buf), "Thread %d calling free_resource_resv_array_chunk()", ntid);
+			log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, buf);
+			free_resource_resv_array_chunk(static_cast<th_data_free_resresv *>(work->thread_data));
+			break;
+		default:
+			log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_SCHED, LOG_ERR, __func__,
+					"Invalid task type passed to worker thread");
+		}
+
+		if (work->task_type == TS_FUNC) {
+			/* Report completion to the task's group */
+			th_task_group *grp = work->group;
 
+			free(work);
+			pthread_mutex_lock(&grp->lock);
+			if (--grp->pending == 0)
+				pthread_cond_broadcast(&grp->done_cond);
+			pthread_mutex_unlock(&grp->lock);
+		} else {
 			/* Post results */
 			pthread_mutex_lock(&result_lock);
 			ds_enqueue(result_queue, (void *) work);
@@ -313,6 +410,10 @@ worker(void *tid)
 /**
  * @brief	Convenience function to queue up work for worker threads
  *
+ * @par	Tasks are spread round-robin over the worker threads' deques.
+ *	Idle workers steal from busy ones, so the placement only matters
+ *	for locality, not for load balance.
+ *
  * @param[in]	task - the task to queue up
  *
  * @return void
@@ -320,8 +421,129 @@ worker(void *tid)
 void
 queue_work_for_threads(th_task_info *task)
 {
+	th_deque *dq;
+
+	dq = &th_deques[next_deque++ % num_threads];
+	pthread_mutex_lock(&dq->lock);
+	dq->tasks.push_back(task);
+	pthread_mutex_unlock(&dq->lock);
+	num_pending_tasks++;
+
+	/* wake up a parked worker, if any */
 	pthread_mutex_lock(&work_lock);
-	ds_enqueue(work_queue, (void *) task);
 	pthread_cond_signal(&work_cond);
 	pthread_mutex_unlock(&work_lock);
 }
+
+/**
+ * @brief	create a task group to wait on a set of TS_FUNC tasks
+ *
+ * @param	void
+ *
+ * @return	th_task_group *
+ * @retval	new task group
+ * @retval	NULL on error
+ */
+th_task_group *
+new_th_task_group(void)
+{
+	th_task_group *grp;
+
+	grp = static_cast<th_task_group *>(malloc(sizeof(th_task_group)));
+	if (grp == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	pthread_mutex_init(&grp->lock, NULL);
+	pthread_cond_init(&grp->done_cond, NULL);
+	grp->pending = 0;
+
+	return grp;
+}
+
+/**
+ * @brief	free a task group.  All tasks of the group must have finished.
+ *
+ * @param[in]	grp - the task group to free
+ *
+ * @return	void
+ */
+void
+free_th_task_group(th_task_group *grp)
+{
+	if (grp == NULL)
+		return;
+
+	pthread_mutex_destroy(&grp->lock);
+	pthread_cond_destroy(&grp->done_cond);
+	free(grp);
+}
+
+/**
+ * @brief	queue a call of func(data) for the worker threads.
+ *		Any function can be run this way without adding a new task type.
+ *
+ * @par	If we are not multi-threading (or are a worker thread ourselves),
+ *	func is called right away.
+ *
+ * @param[in]	grp - task group to report completion to
+ * @param[in]	func - function to call
+ * @param[in]	data - argument to func
+ *
+ * @return	int
+ * @retval	1 on success
+ * @retval	0 on error (func has not been called)
+ */
+int
+queue_func_for_threads(th_task_group *grp, th_task_func func, void *data)
+{
+	th_task_info *task;
+	int tid;
+
+	if (grp == NULL || func == NULL)
+		return 0;
+
+	tid = *((int *) pthread_getspecific(th_id_key));
+	if (tid != 0 || num_threads <= 1) {
+		func(data);
+		return 1;
+	}
+
+	task = static_cast<th_task_info *>(malloc(sizeof(th_task_info)));
+	if (task == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+	task->task_id = 0;
+	task->task_type = TS_FUNC;
+	task->thread_data = data;
+	task->func = func;
+	task->group = grp;
+
+	pthread_mutex_lock(&grp->lock);
+	grp->pending++;
+	pthread_mutex_unlock(&grp->lock);
+
+	queue_work_for_threads(task);
+
+	return 1;
+}
+
+/**
+ * @brief	wait until all tasks queued on a task group have finished
+ *
+ * @param[in]	grp - the task group to wait on
+ *
+ * @return	void
+ */
+void
+wait_th_task_group(th_task_group *grp)
+{
+	if (grp == NULL)
+		return;
+
+	pthread_mutex_lock(&grp->lock);
+	while (grp->pending > 0)
+		pthread_cond_wait(&grp->done_cond, &grp->lock);
+	pthread_mutex_unlock(&grp->lock);
+}
@@ -45,10 +45,16 @@
 
 #define MT_CHUNK_SIZE_MIN 1024
 #define MT_CHUNK_SIZE_MAX 8192
+/* placement sets checked per task by eval_selspec() */
+#define MT_NP_CHUNK_SIZE 32
 
 int init_multi_threading(int nthreads);
 void kill_threads(void);
 void *worker(void *);
 void queue_work_for_threads(th_task_info *task);
+th_task_group *new_th_task_group(void);
+void free_th_task_group(th_task_group *grp);
+int queue_func_for_threads(th_task_group *grp, th_task_func func, void *data);
+void wait_th_task_group(th_task_group *grp);
 
 #endif /* SRC_SCHEDULER_MULTI_THREADING_H_ */
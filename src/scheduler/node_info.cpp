@@ -47,6 +47,9 @@
  * Functions included are:
  * 	query_nodes()
  * 	query_node_info()
+ * 	free_node_cache()
+ * 	resdef_set_sig()
+ * 	cache_node_sig()
  * 	free_nodes()
  * 	set_node_info_state()
  * 	remove_node_state()
@@ -103,6 +106,8 @@
  * 	set_current_aoe()
  * 	is_exclhost()
  * 	check_node_array_eligibility()
+ * 	build_node_soa()
+ * 	update_node_soa()
  * 	is_powerok()
  * 	is_eoe_avail_on_vnode()
  * 	set_current_eoe()
@@ -110,6 +115,7 @@
  */
 
 #include <unordered_map>
+#include <unordered_set>
 
 #include <pbs_config.h>
 
@@ -118,6 +124,7 @@
 #include <string.h>
 #include <math.h>
 #include <ctype.h>
+#include <limits.h>
 #include <sys/types.h>
 #include <errno.h>
 #include <math.h>
@@ -156,16 +163,253 @@
 /* name of the last node a job ran on - used in smp_dist = round robin */
 static char last_node_name[PBS_MAXSVRJOBID];
 
+/*
+ * vnodes parsed in earlier cycles, keyed by vnode name.  A vnode whose
+ * batch_status has not changed since it was cached is duplicated from here
+ * instead of being parsed again by query_node_info().
+ */
+static std::unordered_map<std::string, node_cache_ent *> node_cache;
+
+/**
+ * @brief	compute the fingerprint of a node's batch_status.  Two statuses
+ *		with the same fingerprint will create identical node_info objects.
+ *
+ * @param[in]	node	-	a node returned from a pbs_statvnode() call
+ * @param[in]	sinfo	-	server the node is queried for
+ *
+ * @return	unsigned long long
+ * @retval	fingerprint of the node
+ * @retval	0	: node can not be cached
+ */
+static unsigned long long
+node_status_sig(struct batch_status *node, server_info *sinfo)
+{
+	unsigned long long sig = SIG_INIT;
+	struct attrl *attrp;
+
+#ifdef NAS /* localmod 034 */
+	/* site share data is not carried over by dup_node_info() */
+	return 0;
+#endif /* localmod 034 */
+
+	sig = sig_add_str(sig, node->name);
+	for (attrp = node->attribs; attrp != NULL; attrp = attrp->next) {
+		/* a cloud license is checked against the current time */
+		if (!strcmp(attrp->name, ATTR_NODE_License) && attrp->value[0] == ND_LIC_TYPE_cloud)
+			return 0;
+		sig = sig_add_str(sig, attrp->name);
+		sig = sig_add_str(sig, attrp->resource);
+		sig = sig_add_str(sig, attrp->value);
+	}
+	/* the sleep state is only honored if power provisioning is on */
+	if (sinfo->power_provisioning)
+		sig = sig_add_str(sig, ATTR_NODE_power_provisioning);
+
+	return sig == 0 ? 1 : sig;
+}
+
+/**
+ * @brief	free a node cache entry
+ *
+ * @param[in]	ent	-	entry to free
+ *
+ * @return void
+ */
+static void
+free_node_cache_ent(node_cache_ent *ent)
+{
+	if (ent == NULL)
+		return;
+
+	delete ent->ninfo;
+	free(ent);
+}
+
+/**
+ * @brief	free a NULL terminated array of node cache entries
+ *
+ * @param[in]	ents	-	array to free
+ *
+ * @return void
+ */
+static void
+free_node_cache_ents(node_cache_ent **ents)
+{
+	if (ents == NULL)
+		return;
+
+	for (int i = 0; ents[i] != NULL; i++)
+		free_node_cache_ent(ents[i]);
+	free(ents);
+}
+
+/**
+ * @brief	create a node cache entry from a freshly queried node
+ *
+ * @param[in]	ninfo	-	node as returned from query_node_info()
+ * @param[in]	sig	-	fingerprint of the node's batch_status
+ *
+ * @return	node_cache_ent *
+ * @retval	new entry
+ * @retval	NULL	: on error
+ */
+static node_cache_ent *
+new_node_cache_ent(node_info *ninfo, unsigned long long sig)
+{
+	node_cache_ent *ent;
+
+	if ((ent = static_cast<node_cache_ent *>(malloc(sizeof(node_cache_ent)))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	if ((ent->ninfo = dup_node_info(ninfo, ninfo->server, 0)) == NULL) {
+		free(ent);
+		return NULL;
+	}
+	/* the cached node outlives the server it was queried for */
+	ent->ninfo->server = NULL;
+	ent->sig = sig;
+
+	return ent;
+}
+
+/**
+ * @brief	add the entries created while querying nodes to the node cache
+ *
+ * @param[in]	new_ents	-	entries to add.  Ownership moves to the cache.
+ *
+ * @return void
+ */
+static void
+add_node_cache_ents(node_cache_ent **new_ents)
+{
+	if (new_ents == NULL)
+		return;
+
+	for (int i = 0; new_ents[i] != NULL; i++) {
+		auto& ent = node_cache[new_ents[i]->ninfo->name];
+		free_node_cache_ent(ent);
+		ent = new_ents[i];
+	}
+	free(new_ents);
+}
+
+/**
+ * @brief	drop the node cache entries of vnodes which no longer exist
+ *
+ * @param[in]	nodes	-	batch_status of all nodes queried this cycle
+ * @param[in]	num_nodes	-	number of nodes in nodes
+ *
+ * @return void
+ */
+static void
+prune_node_cache(struct batch_status *nodes, int num_nodes)
+{
+	std::unordered_set<std::string> names;
+
+	if (node_cache.size() <= static_cast<size_t>(num_nodes))
+		return;
+
+	for (struct batch_status *cur = nodes; cur != NULL; cur = cur->next)
+		names.insert(cur->name);
+	for (auto it = node_cache.begin(); it != node_cache.end();) {
+		if (names.find(it->first) == names.end()) {
+			free_node_cache_ent(it->second);
+			it = node_cache.erase(it);
+		} else
+			it++;
+	}
+}
+
+/**
+ * @brief	empty the node cache.  This needs to be called whenever the
+ *		resource definitions the cached nodes point to are replaced.
+ *
+ * @return void
+ */
+void
+free_node_cache(void)
+{
+	for (auto& ent : node_cache)
+		free_node_cache_ent(ent.second);
+	node_cache.clear();
+}
+
+/**
+ * @brief	fingerprint a set of resource definitions.  The result does not
+ *		depend on the order the set is walked in.
+ *
+ * @param[in]	defs	-	the resource definitions
+ *
+ * @return	unsigned long long
+ */
+unsigned long long
+resdef_set_sig(const std::unordered_set<resdef *>& defs)
+{
+	unsigned long long sig = defs.size();
+
+	for (const auto& def : defs) {
+		unsigned long long h = def->id + 1;
+
+		/* splitmix64 finalizer, summed so order doesn't matter */
+		h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+		sig += h ^ (h >> 31);
+	}
+
+	return sig;
+}
+
+/**
+ * @brief	remember a node's resource signature in the node cache so the
+ *		next cycle's copy of an unchanged node doesn't need to create it again
+ *
+ * @par	Only call this for nodes of the server universe right after they were
+ *	queried.  Nodes with indirect resources are not remembered because
+ *	their signature depends on other nodes.
+ *
+ * @param[in]	ninfo	-	the node
+ *
+ * @return void
+ */
+void
+cache_node_sig(node_info *ninfo)
+{
+	schd_resource *res;
+	node_info *cninfo;
+
+	if (ninfo == NULL || ninfo->nodesig == NULL)
+		return;
+
+	auto ce = node_cache.find(ninfo->name);
+	if (ce == node_cache.end())
+		return;
+
+	for (res = ninfo->res; res != NULL; res = res->next)
+		if (res->indirect_res != NULL)
+			return;
+
+	cninfo = ce->second->ninfo;
+	if (cninfo->nodesig_defs == ninfo->nodesig_defs && cninfo->nodesig != NULL)
+		return;
+
+	free(cninfo->nodesig);
+	cninfo->nodesig = string_dup(ninfo->nodesig);
+	cninfo->nodesig_defs = ninfo->nodesig_defs;
+}
+
 void
 query_node_info_chunk(th_data_query_ninfo *data)
 {
 	struct batch_status *nodes;
 	struct batch_status *cur_node;
 	node_info **ninfo_arr;
+	node_cache_ent **new_ents;
 	server_info *sinfo;
 	node_info *ninfo;
 	int i;
 	int nidx;
+	int eidx;
 	int start;
 	int end;
 	int num_nodes_chunk;
@@ -183,16 +427,54 @@ query_node_info_chunk(th_data_query_ninfo *data)
 	}
 	ninfo_arr[0] = NULL;
 
+	if ((new_ents = static_cast<node_cache_ent **>(malloc((num_nodes_chunk + 1) * sizeof(node_cache_ent *)))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(ninfo_arr);
+		data->error = 1;
+		return;
+	}
+	new_ents[0] = NULL;
+
 	/* Move to the linked list item corresponding to the 'start' index */
 	for (cur_node = nodes, i = 0; i < start && cur_node != NULL; cur_node = cur_node->next, i++)
 		;
 
-	for (i = start, nidx = 0; i <= end && cur_node != NULL; cur_node = cur_node->next, i++) {
-		/* get node info from the batch_status */
-		if ((ninfo = query_node_info(cur_node, sinfo)) == NULL) {
-			free_nodes(ninfo_arr);
-			data->error = 1;
-			return;
+	for (i = start, nidx = 0, eidx = 0; i <= end && cur_node != NULL; cur_node = cur_node->next, i++) {
+		unsigned long long sig;
+
+		ninfo = NULL;
+		sig = node_status_sig(cur_node, sinfo);
+		if (sig == 0)
+			data->sig_unknown = 1;
+		else
+			data->sig_sum += sig;
+		if (sig != 0) {
+			/* The cache is only modified by the main thread once all chunks are done */
+			auto ce = node_cache.find(cur_node->name);
+			if (ce != node_cache.end() && ce->second->sig == sig) {
+				if ((ninfo = dup_node_info(ce->second->ninfo, sinfo, 0)) == NULL) {
+					free_nodes(ninfo_arr);
+					free_node_cache_ents(new_ents);
+					data->error = 1;
+					return;
+				}
+				if (ninfo->is_multivnoded)
+					sinfo->has_multi_vnode = 1;
+			}
+		}
+
+		if (ninfo == NULL) {
+			/* get node info from the batch_status */
+			if ((ninfo = query_node_info(cur_node, sinfo)) == NULL) {
+				free_nodes(ninfo_arr);
+				free_node_cache_ents(new_ents);
+				data->error = 1;
+				return;
+			}
+			if (sig != 0) {
+				if ((new_ents[eidx] = new_node_cache_ent(ninfo, sig)) != NULL)
+					new_ents[++eidx] = NULL;
+			}
 		}
 
 		if (node_in_partition(ninfo, sc_attrs.partition)) {
@@ -203,6 +485,7 @@ query_node_info_chunk(th_data_query_ninfo *data)
 	ninfo_arr[nidx] = NULL;
 
 	data->oarr = ninfo_arr;
+	data->new_ents = new_ents;
 }
 
 /**
@@ -230,6 +513,9 @@ alloc_tdata_nd_query(struct batch_status *nodes, server_info *sinfo, int sidx, i
 	tdata->error = 0;
 	tdata->nodes = nodes;
 	tdata->oarr = NULL; /* Will be filled by the thread routine */
+	tdata->new_ents = NULL; /* Will be filled by the thread routine */
+	tdata->sig_sum = 0;
+	tdata->sig_unknown = 0;
 	tdata->sinfo = sinfo;
 	tdata->sidx = sidx;
 	tdata->eidx = eidx;
@@ -254,11 +540,15 @@ query_nodes(int pbs_sd, server_info *sinfo)
 	struct batch_status *cur_node;	/* used to cycle through nodes */
 	node_info **ninfo_arr;		/* array of nodes for scheduler's use */
 	int num_nodes = 0;			/* the number of nodes */
+	int num_queried;			/* the number of nodes returned by the server */
 	int nidx = 0;
 	static struct attrl *attrib = NULL;
 	th_data_query_ninfo *tdata = NULL;
 	th_task_info *task = NULL;
 	node_info ***ninfo_arrs_tasks = NULL;
+	node_cache_ent ***new_ents_tasks = NULL;
+	unsigned long long sig_sum = 0;	/* order independent sum of node fingerprints */
+	bool sig_unknown = false;
 	int tid;
 
 	if (attrib == NULL) {
@@ -314,6 +604,7 @@ query_nodes(int pbs_sd, server_info *sinfo)
 		num_nodes++;
 		cur_node = cur_node->next;
 	}
+	num_queried = num_nodes;
 
 	tid = *((int *) pthread_getspecific(th_id_key));
 	if (tid != 0 || num_threads <= 1) {
@@ -324,7 +615,15 @@ query_nodes(int pbs_sd, server_info *sinfo)
 			return NULL;
 		}
 		query_node_info_chunk(tdata);
+		if (tdata->error) {
+			free(tdata);
+			pbs_statfree(nodes);
+			return NULL;
+		}
 		ninfo_arr = tdata->oarr;
+		add_node_cache_ents(tdata->new_ents);
+		sig_sum = tdata->sig_sum;
+		sig_unknown = tdata->sig_unknown;
 		free(tdata);
 
 		for (nidx = 0; ninfo_arr[nidx] != NULL; nidx++)
@@ -363,8 +662,9 @@ query_nodes(int pbs_sd, server_info *sinfo)
 
 			queue_work_for_threads(task);
 		}
-		ninfo_arrs_tasks = static_cast<node_info ***>(malloc(num_tasks * sizeof(node_info **)));
-		if (ninfo_arrs_tasks == NULL) {
+		ninfo_arrs_tasks = static_cast<node_info ***>(calloc(num_tasks, sizeof(node_info **)));
+		new_ents_tasks = static_cast<node_cache_ent ***>(calloc(num_tasks, sizeof(node_cache_ent **)));
+		if (ninfo_arrs_tasks == NULL || new_ents_tasks == NULL) {
 			log_err(errno, __func__, MEM_ERR_MSG);
 			th_err = 1;
 		}
@@ -378,14 +678,36 @@ query_nodes(int pbs_sd, server_info *sinfo)
 				tdata = static_cast<th_data_query_ninfo *>(task->thread_data);
 				if (tdata->error)
 					th_err = 1;
-				ninfo_arrs_tasks[task->task_id] = tdata->oarr;
+				if (ninfo_arrs_tasks != NULL && new_ents_tasks != NULL) {
+					ninfo_arrs_tasks[task->task_id] = tdata->oarr;
+					new_ents_tasks[task->task_id] = tdata->new_ents;
+				} else {
+					free_nodes(tdata->oarr);
+					free_node_cache_ents(tdata->new_ents);
+				}
+				sig_sum += tdata->sig_sum;
+				if (tdata->sig_unknown)
+					sig_unknown = true;
 				free(tdata);
 				free(task);
 				i++;
 			}
 			pthread_mutex_unlock(&result_lock);
 		}
+		/* workers look up the node cache while they run, so only add
+		 * to it once all of them are done
+		 */
+		if (new_ents_tasks != NULL) {
+			for (int i = 0; i < num_tasks; i++)
+				add_node_cache_ents(new_ents_tasks[i]);
+			free(new_ents_tasks);
+		}
 		if (th_err) {
+			if (ninfo_arrs_tasks != NULL) {
+				for (int i = 0; i < num_tasks; i++)
+					free_nodes(ninfo_arrs_tasks[i]);
+				free(ninfo_arrs_tasks);
+			}
 			pbs_statfree(nodes);
 			free_nodes(ninfo_arr);
 			return NULL;
@@ -406,6 +728,14 @@ query_nodes(int pbs_sd, server_info *sinfo)
 		free(ninfo_arrs_tasks);
 	}
 
+	prune_node_cache(nodes, num_queried);
+
+	/* a node we can't fingerprint makes the whole universe unknown */
+	if (sig_unknown)
+		sinfo->ec_state_sig = 0;
+	else if (sinfo->ec_state_sig != 0)
+		sinfo->ec_state_sig = sig_add_num(sinfo->ec_state_sig, sig_sum);
+
 	if (nidx == 0) {
 		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__,
 			"No nodes found in partitions serviced by scheduler");
@@ -616,6 +946,8 @@ query_node_info(struct batch_status *node, server_info *sinfo)
 	if (ninfo->lic_lock != 1)
 		ninfo->nscr |= NSCR_CYCLE_INELIGIBLE;
 
+	index_resource_list(ninfo->res);
+
 	return ninfo;
 }
 
@@ -680,6 +1012,7 @@ node_info::node_info(const std::string& nname): name(nname)
 	current_aoe = NULL;
 	current_eoe = NULL;
 	nodesig = NULL;
+	nodesig_defs = 0;
 	last_state_change_time = 0;
 	last_used_time = 0;
 
@@ -890,6 +1223,7 @@ set_node_info_state(node_info *ninfo, const char *state)
 
 			tok = strtok_r(NULL, ",", &saveptr);
 		}
+		update_node_soa(ninfo);
 		return 0;
 	}
 
@@ -969,6 +1303,8 @@ remove_node_state(node_info *ninfo, const char *state)
 	else
 		ninfo->nscr |= NSCR_CYCLE_INELIGIBLE;
 
+	update_node_soa(ninfo);
+
 	return 0;
 }
 
@@ -1042,6 +1378,8 @@ add_node_state(node_info *ninfo, const char *state)
 	} else
 		ninfo->nscr &= ~NSCR_CYCLE_INELIGIBLE;
 
+	update_node_soa(ninfo);
+
 	return 0;
 }
 
@@ -1418,6 +1756,7 @@ dup_node_info(node_info *onode, server_info *nsinfo, unsigned int flags)
 	nnode->is_maintenance = onode->is_maintenance;
 	nnode->is_provisioning = onode->is_provisioning;
 	nnode->is_multivnoded = onode->is_multivnoded;
+	nnode->is_sleeping = onode->is_sleeping;
 
 	nnode->sharing = onode->sharing;
 
@@ -1454,6 +1793,7 @@ dup_node_info(node_info *onode, server_info *nsinfo, unsigned int flags)
 	set_current_aoe(nnode, onode->current_aoe);
 	set_current_eoe(nnode, onode->current_eoe);
 	nnode->nodesig = string_dup(onode->nodesig);
+	nnode->nodesig_defs = onode->nodesig_defs;
 	nnode->nodesig_ind = onode->nodesig_ind;
 	nnode->last_state_change_time = onode->last_state_change_time;
 	nnode->last_used_time = onode->last_used_time;
@@ -1668,6 +2008,7 @@ collect_jobs_on_nodes(node_info **ninfo_arr, resource_resv **resresv_arr, int si
 
 			}
 			ninfo_arr[i]->num_jobs = k;
+			update_node_soa(ninfo_arr[i]);
 		}
 	}
 
@@ -1741,6 +2082,7 @@ update_node_on_run(nspec *ns, resource_resv *resresv, const char *job_state)
 
 	if (resresv->is_job) {
 		ninfo->num_jobs++;
+		update_node_soa(ninfo);
 		if (find_resource_resv_by_indrank(ninfo->job_arr, resresv->resresv_ind, resresv->rank) == NULL) {
 			tmp_arr = add_resresv_to_array(ninfo->job_arr, resresv, NO_FLAGS);
 			if (tmp_arr == NULL)
@@ -1752,6 +2094,7 @@ update_node_on_run(nspec *ns, resource_resv *resresv, const char *job_state)
 	}
 	else if (resresv->is_resv) {
 		ninfo->num_run_resv++;
+		update_node_soa(ninfo);
 		if (find_resource_resv_by_indrank(ninfo->run_resvs_arr, resresv->resresv_ind, resresv->rank) == NULL) {
 			tmp_arr = add_resresv_to_array(ninfo->run_resvs_arr, resresv, NO_FLAGS);
 			if (tmp_arr == NULL)
@@ -1896,6 +2239,7 @@ update_node_on_end(node_info *ninfo, resource_resv *resresv, const char *job_sta
 		ninfo->num_jobs--;
 		if (ninfo->num_jobs < 0)
 			ninfo->num_jobs = 0;
+		update_node_soa(ninfo);
 
 		remove_resresv_from_array(ninfo->job_arr, resresv);
 	}
@@ -1903,6 +2247,7 @@ update_node_on_end(node_info *ninfo, resource_resv *resresv, const char *job_sta
 		ninfo->num_run_resv--;
 		if (ninfo->num_run_resv < 0)
 			ninfo->num_run_resv = 0;
+		update_node_soa(ninfo);
 
 		remove_resresv_from_array(ninfo->run_resvs_arr, resresv);
 	}
@@ -2195,6 +2540,96 @@ find_nspec_by_rank(nspec **nspec_arr, int rank)
 	return nspec_arr[i];
 }
 
+/**
+ * @brief	check a chunk of placement sets with resresv_can_fit_nodepart()
+ *
+ * @param[in,out]	data - th_data_np_fit for the chunk
+ *
+ * @return	void
+ */
+static void
+can_fit_nodepart_chunk(void *data)
+{
+	th_data_np_fit *tdata = static_cast<th_data_np_fit *>(data);
+	int i;
+
+	for (i = tdata->sidx; i <= tdata->eidx; i++) {
+		tdata->errs[i] = new_schd_error();
+		if (tdata->errs[i] == NULL) {
+			/* let eval_selspec() redo the check itself */
+			tdata->fits[i] = -2;
+			continue;
+		}
+		tdata->fits[i] = resresv_can_fit_nodepart(tdata->policy, tdata->nodepart[i],
+			tdata->resresv, tdata->flags, tdata->errs[i]);
+		if (tdata->fits[i]) {
+			free_schd_error(tdata->errs[i]);
+			tdata->errs[i] = NULL;
+		}
+	}
+}
+
+/**
+ * @brief	run resresv_can_fit_nodepart() on a window of placement sets
+ *		concurrently on the worker threads
+ *
+ * @par	The placement sets are still evaluated in their sort order by the
+ *	caller; this only answers the (read-only) question of which ones are
+ *	big enough ahead of time.
+ *
+ * @param[in]	policy - policy info
+ * @param[in]	nodepart - the placement sets
+ * @param[in]	sidx - first placement set to check
+ * @param[in]	eidx - one past the last placement set to check
+ * @param[in]	resresv - the resource resv to check
+ * @param[in]	flags - flags for resresv_can_fit_nodepart()
+ * @param[out]	fits - per placement set return value of resresv_can_fit_nodepart()
+ *		       left at -2 if it was not checked
+ * @param[out]	errs - per placement set error if it can't fit
+ *
+ * @return	void
+ */
+static void
+precheck_nodeparts(status *policy, node_partition **nodepart, int sidx, int eidx,
+	resource_resv *resresv, unsigned int flags, int *fits, schd_error **errs)
+{
+	th_task_group *grp;
+	std::vector<th_data_np_fit *> tdatas;
+	int i;
+
+	grp = new_th_task_group();
+	if (grp == NULL)
+		return;
+
+	for (i = sidx; i < eidx; i += MT_NP_CHUNK_SIZE) {
+		th_data_np_fit *tdata;
+
+		tdata = static_cast<th_data_np_fit *>(malloc(sizeof(th_data_np_fit)));
+		if (tdata == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			break;
+		}
+		tdata->policy = policy;
+		tdata->nodepart = nodepart;
+		tdata->resresv = resresv;
+		tdata->flags = flags;
+		tdata->fits = fits;
+		tdata->errs = errs;
+		tdata->sidx = i;
+		tdata->eidx = (i + MT_NP_CHUNK_SIZE < eidx) ? i + MT_NP_CHUNK_SIZE - 1 : eidx - 1;
+		if (!queue_func_for_threads(grp, can_fit_nodepart_chunk, tdata)) {
+			free(tdata);
+			break;
+		}
+		tdatas.push_back(tdata);
+	}
+
+	wait_th_task_group(grp);
+	free_th_task_group(grp);
+	for (auto td : tdatas)
+		free(td);
+}
+
 /**
  *	@brief
  *		eval a select spec to see if it is satisfiable
@@ -2232,6 +2667,10 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 	int i = 0;
 	static struct schd_error *failerr = NULL;
 	nspec **tmp;
+	int num_np;
+	int np_checked = 0;	/* placement sets before this one have been prechecked */
+	int *np_fits = NULL;
+	schd_error **np_errs = NULL;
 
 	if (spec == NULL || ninfo_arr == NULL || resresv == NULL || placespec == NULL || nspec_arr == NULL)
 		return 0;
@@ -2316,9 +2755,46 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 
 	/* Otherwise we're node grouping... */
 
+	/* With many placement sets, find out which ones are big enough for the
+	 * job on the worker threads, a window at a time ahead of the loop below.
+	 * The placement sets are still evaluated in order, so the first fit is
+	 * the same as if checked serially, and no window is checked past it.
+	 */
+	num_np = count_array(nodepart);
+	if (num_threads > 1 && num_np > MT_NP_CHUNK_SIZE) {
+		np_fits = static_cast<int *>(malloc(num_np * sizeof(int)));
+		np_errs = static_cast<schd_error **>(calloc(num_np, sizeof(schd_error *)));
+		if (np_fits == NULL || np_errs == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			free(np_fits);
+			free(np_errs);
+			np_fits = NULL;
+			np_errs = NULL;
+		} else {
+			for (i = 0; i < num_np; i++)
+				np_fits[i] = -2;
+		}
+	}
+
 	for (i = 0; nodepart[i] != NULL && rc == 0; i++) {
+		int np_fit;
+
+		if (np_fits != NULL && i == np_checked) {
+			np_checked = i + MT_NP_CHUNK_SIZE * num_threads;
+			if (np_checked > num_np)
+				np_checked = num_np;
+			precheck_nodeparts(policy, nodepart, i, np_checked, resresv, flags, np_fits, np_errs);
+		}
+
 		clear_schd_error(err);
-		if (resresv_can_fit_nodepart(policy, nodepart[i], resresv, flags, err)) {
+		if (np_fits != NULL && np_fits[i] != -2) {
+			np_fit = np_fits[i];
+			if (!np_fit)
+				copy_schd_error(err, np_errs[i]);
+		} else
+			np_fit = resresv_can_fit_nodepart(policy, nodepart[i], resresv, flags, err);
+
+		if (np_fit) {
 			log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name,
 				"Evaluating placement set: %s", nodepart[i]->name);
 			if (nodepart[i]->ok_break)
@@ -2365,6 +2841,15 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 		pass_flags = NO_FLAGS;
 	}
 
+	if (np_fits != NULL) {
+		log_eventf(PBSEVENT_DEBUG4, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name,
+			"Prechecked %d of %d placement sets", np_checked, num_np);
+		for (i = 0; i < num_np; i++)
+			free_schd_error(np_errs[i]);
+		free(np_errs);
+		free(np_fits);
+	}
+
 	if (!can_fit) {
 		if (flags & SPAN_PSETS) {
 			log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG, resresv->name,
@@ -3246,6 +3731,47 @@ eval_simple_selspec(status *policy, chunk *chk, node_info **pninfo_arr,
 	return 0;
 }
 
+/*
+ * The node checks of is_vnode_eligible() which only need fields mirrored in
+ * the node_soa table.  They are shared with node_soa_row_check() so the fast
+ * path and the detailed check can't drift apart.
+ */
+
+/* an exclusive request needs a node with nothing running on it */
+static inline bool
+node_excl_ok(bool excl, int num_jobs, int num_run_resv)
+{
+	return !excl || (num_jobs == 0 && num_run_resv == 0);
+}
+
+/* reservations need resv_enable */
+static inline bool
+node_resv_enable_ok(resource_resv *resresv, bool resv_enable)
+{
+	return !resresv->is_resv || resv_enable;
+}
+
+/* node run limits are enforced for jobs unless a job is being qrun */
+static inline bool
+node_limits_enforced(resource_resv *resresv)
+{
+	return resresv->is_job && resresv->server->qrun_job == NULL;
+}
+
+/* max_running has room for one more job */
+static inline bool
+node_run_limit_ok(int max_running, int num_jobs)
+{
+	return max_running == SCHD_INFINITY || max_running > num_jobs;
+}
+
+/* multi-node requests can't use no_multinode_jobs nodes */
+static inline bool
+node_multinode_ok(resource_resv *resresv, bool no_multinode)
+{
+	return !(no_multinode && resresv->will_use_multinode);
+}
+
 /**
  * @brief
  * 		evaluate one node to see if it is eligible
@@ -3279,8 +3805,7 @@ is_vnode_eligible(node_info *node, resource_resv *resresv,
 	/* A node is invalid for an exclusive job if jobs/resvs are running on it
 	 * NOTE: this check must be the first check or exclhost may break
 	 */
-	if (is_excl(pl, node->sharing) &&
-		(node->num_jobs > 0 || node->num_run_resv > 0)) {
+	if (!node_excl_ok(is_excl(pl, node->sharing), node->num_jobs, node->num_run_resv)) {
 		set_schd_error_codes(err, NOT_RUN, NODE_NOT_EXCL);
 		set_schd_error_arg(err, ARG1, resresv->is_job ? "Job":"Reservation");
 		return 0;
@@ -3324,36 +3849,32 @@ is_vnode_eligible(node_info *node, resource_resv *resresv,
 		}
 	}
 
-	if (resresv->is_resv && !node->resv_enable) {
+	if (!node_resv_enable_ok(resresv, node->resv_enable)) {
 		set_schd_error_codes(err, NOT_RUN, NODE_RESV_ENABLE);
 		return 0;
 	}
 
-	if (resresv->is_job) {
-		/* don't enforce max run limits of job is being qrun */
-		if (resresv->server->qrun_job == NULL) {
-			if (node->max_running != SCHD_INFINITY &&
-			    node->max_running <= node->num_jobs) {
-				set_schd_error_codes(err, NOT_RUN, NODE_JOB_LIMIT_REACHED);
-				return 0;
-			}
-
-			if (node->max_user_run != SCHD_INFINITY &&
-			    node->max_user_run <= find_counts_elm(node->user_counts, resresv->user, NULL, NULL, NULL)) {
-				set_schd_error_codes(err, NOT_RUN, NODE_USER_LIMIT_REACHED);
-				return 0;
-			}
+	/* don't enforce max run limits of job is being qrun */
+	if (node_limits_enforced(resresv)) {
+		if (!node_run_limit_ok(node->max_running, node->num_jobs)) {
+			set_schd_error_codes(err, NOT_RUN, NODE_JOB_LIMIT_REACHED);
+			return 0;
+		}
 
-			if (node->max_group_run != SCHD_INFINITY &&
-			    node->max_group_run <= find_counts_elm(node->group_counts, resresv->group, NULL, NULL, NULL)) {
-				set_schd_error_codes(err, NOT_RUN, NODE_GROUP_LIMIT_REACHED);
-				return 0;
-			}
+		if (node->max_user_run != SCHD_INFINITY &&
+		    node->max_user_run <= find_counts_elm(node->user_counts, resresv->user, NULL, NULL, NULL)) {
+			set_schd_error_codes(err, NOT_RUN, NODE_USER_LIMIT_REACHED);
+			return 0;
 		}
 
+		if (node->max_group_run != SCHD_INFINITY &&
+		    node->max_group_run <= find_counts_elm(node->group_counts, resresv->group, NULL, NULL, NULL)) {
+			set_schd_error_codes(err, NOT_RUN, NODE_GROUP_LIMIT_REACHED);
+			return 0;
+		}
 	}
 
-	if (node->no_multinode_jobs && resresv->will_use_multinode) {
+	if (!node_multinode_ok(resresv, node->no_multinode_jobs)) {
 		set_schd_error_codes(err, NOT_RUN, NODE_NO_MULT_JOBS);
 		return 0; /* multiple nodes jobs/resvs not allowed on this node */
 	}
@@ -5406,12 +5927,246 @@ is_exclhost(place *placespec, enum vnode_sharing sharing)
 	return 0;
 }
 
+/**
+ * @brief	fill one row of a node_soa table from a node
+ *
+ * @param[in,out]	soa	-	the table
+ * @param[in]	ind	-	row to fill
+ * @param[in]	node	-	the node the row describes
+ *
+ * @return void
+ */
+static void
+set_node_soa_row(node_soa *soa, int ind, node_info *node)
+{
+	unsigned char flags = NSOA_NONE;
+
+	if (node->is_free)
+		flags |= NSOA_FREE;
+	if (node->resv_enable)
+		flags |= NSOA_RESV_ENABLE;
+	if (node->no_multinode_jobs)
+		flags |= NSOA_NO_MULTINODE;
+	if (node->nscr & NSCR_CYCLE_INELIGIBLE)
+		flags |= NSOA_CYCLE_INELIGIBLE;
+	if (node->max_user_run != SCHD_INFINITY || node->max_group_run != SCHD_INFINITY)
+		flags |= NSOA_ENT_LIMIT;
+
+	soa->node[ind] = node;
+	soa->flags[ind] = flags;
+	soa->sharing[ind] = node->sharing;
+	soa->num_jobs[ind] = node->num_jobs;
+	soa->num_run_resv[ind] = node->num_run_resv;
+	soa->max_running[ind] = node->max_running;
+}
+
+/**
+ * @brief	build the node_soa table of a server from sinfo->unordered_nodes
+ *
+ * @param[in,out]	sinfo	-	the server whose nodes to lay out
+ *
+ * @return void
+ *
+ * @par	On allocation failure the table is left empty, and every node
+ *	takes the detailed path in check_node_eligibility_chunk().
+ */
+void
+build_node_soa(server_info *sinfo)
+{
+	node_soa *soa;
+	int num_nodes;
+	int i;
+
+	if (sinfo == NULL)
+		return;
+
+	soa = &sinfo->nsoa;
+	soa->node.clear();
+
+	if (sinfo->unordered_nodes == NULL)
+		return;
+
+	num_nodes = count_array(sinfo->unordered_nodes);
+	try {
+		soa->node.resize(num_nodes);
+		soa->flags.resize(num_nodes);
+		soa->sharing.resize(num_nodes);
+		soa->num_jobs.resize(num_nodes);
+		soa->num_run_resv.resize(num_nodes);
+		soa->max_running.resize(num_nodes);
+	} catch (std::bad_alloc &e) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		soa->node.clear();
+		return;
+	}
+
+	for (i = 0; i < num_nodes; i++)
+		set_node_soa_row(soa, i, sinfo->unordered_nodes[i]);
+}
+
+/**
+ * @brief	refresh a node's row in its server's node_soa table.  Must be
+ *		called whenever a field the table mirrors changes.
+ *
+ * @param[in]	node	-	the node which changed
+ *
+ * @return void
+ *
+ * @par	Nodes without a row (e.g., reservation nodes) are ignored.
+ */
+void
+update_node_soa(node_info *node)
+{
+	node_soa *soa;
+	int ind;
+
+	if (node == NULL || node->server == NULL)
+		return;
+
+	soa = &node->server->nsoa;
+	ind = node->node_ind;
+	if (ind < 0 || static_cast<size_t>(ind) >= soa->node.size() || soa->node[ind] != node)
+		return;
+
+	set_node_soa_row(soa, ind, node);
+}
+
+/* what a request needs from a node_soa row, worked out once per request */
+struct node_soa_filter
+{
+	const node_soa *soa;
+	resource_resv *resresv;
+	bool limits;			/* node run limits are enforced */
+	bool excl[VNS_FORCE_SHARED + 1];	/* node must be idle for each sharing value */
+};
+
+/**
+ * @brief	set up a node_soa_filter for a request
+ *
+ * @param[out]	f	-	the filter
+ * @param[in]	resresv	-	the request
+ * @param[in]	pl	-	place spec of the request
+ *
+ * @return	int
+ * @retval	1	: the filter can be used
+ * @retval	0	: every node needs the detailed check
+ */
+static int
+init_node_soa_filter(node_soa_filter *f, resource_resv *resresv, place *pl)
+{
+	int i;
+
+	if (resresv->server == NULL || resresv->server->nsoa.node.empty())
+		return 0;
+
+	/* these checks look beyond the node itself; leave them to is_vnode_eligible() */
+	if (resresv->eoename != NULL)
+		return 0;
+	if (resresv->job != NULL && resresv->job->resv != NULL)
+		return 0;
+
+	f->soa = &resresv->server->nsoa;
+	f->resresv = resresv;
+	f->limits = node_limits_enforced(resresv);
+	for (i = 0; i <= VNS_FORCE_SHARED; i++)
+		f->excl[i] = is_excl(pl, static_cast<enum vnode_sharing>(i));
+
+	return 1;
+}
+
+/**
+ * @brief	check a node against a node_soa_filter without touching
+ *		the node_info itself
+ *
+ * @param[in]	f	-	the filter
+ * @param[in]	ind	-	the node's row
+ *
+ * @return	enum node_soa_row
+ * @retval	NSOA_ROW_OK	: is_vnode_eligible() would pass the node
+ * @retval	NSOA_ROW_DETAIL	: the node needs the detailed check
+ * @retval	NSOA_ROW_SKIP	: the node is ineligible for the whole cycle
+ */
+static inline enum node_soa_row
+node_soa_row_check(const node_soa_filter *f, int ind)
+{
+	const node_soa *soa = f->soa;
+	unsigned char flags = soa->flags[ind];
+
+	if (flags & NSOA_CYCLE_INELIGIBLE)
+		return NSOA_ROW_SKIP;
+
+	/* max_user_run/max_group_run need the node's counts; leave them to is_vnode_eligible() */
+	if ((flags & NSOA_FREE) &&
+	    node_excl_ok(f->excl[soa->sharing[ind]], soa->num_jobs[ind], soa->num_run_resv[ind]) &&
+	    node_resv_enable_ok(f->resresv, flags & NSOA_RESV_ENABLE) &&
+	    (!f->limits || (node_run_limit_ok(soa->max_running[ind], soa->num_jobs[ind]) &&
+	    !(flags & NSOA_ENT_LIMIT))) &&
+	    node_multinode_ok(f->resresv, flags & NSOA_NO_MULTINODE))
+		return NSOA_ROW_OK;
+
+	return NSOA_ROW_DETAIL;
+}
+
+/**
+ * @brief	run the detailed eligibility check on one node and mark it
+ *		(and its host for exclhost) ineligible if it fails
+ *
+ * @param[in,out]	data	-	th_data_nd_eligible of the chunk
+ * @param[in,out]	node	-	the node to check
+ * @param[in,out]	err	-	scratch error structure
+ * @param[in,out]	misc_err	-	first error of the chunk
+ *
+ * @return void
+ */
+static void
+check_node_eligibility_detail(th_data_nd_eligible *data, node_info *node,
+		schd_error *err, schd_error *misc_err)
+{
+	resource_resv *resresv = data->resresv;
+	place *pl = data->pl;
+
+	if (node->nscr) {
+		data->num_skip++;
+		return;
+	}
+
+	data->num_detail++;
+	if (is_vnode_eligible(node, resresv, pl, err) == 0) {
+		node->nscr |= NSCR_INELIGIBLE;
+		if (node->hostset != NULL) {
+			if ((err->error_code == NODE_NOT_EXCL && is_exclhost(pl, node->sharing))
+					|| sim_exclhost(resresv->server->calendar, resresv, node) == 0) {
+				int j;
+
+				for (j = 0; node->hostset->ninfo_arr[j] != NULL; j++) {
+					node_info *n = node->hostset->ninfo_arr[j];
+					n->nscr |= NSCR_INELIGIBLE;
+					set_schd_error_codes(misc_err, NOT_RUN, NODE_NOT_EXCL);
+					schdlogerr(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG, n->name,
+							NULL, misc_err);
+					clear_schd_error(misc_err);
+				}
+			}
+		}
+		if (err->status_code != SCHD_UNKWN) {
+			if (misc_err->status_code == SCHD_UNKWN)
+				copy_schd_error(misc_err, err);
+			schdlogerr(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG, node->name, NULL, err);
+		}
+		clear_schd_error(err);
+	}
+}
+
 /**
  * @brief	pthread routing to check eligibility for a chunk of nodes
  *
  * @param[in,out]	data - th_data_nd_eligible object
  *
  * @return void
+ *
+ * @par	If data->by_row is set, sidx and eidx are rows of the server's
+ *	node_soa table and the chunk is scanned straight down the table.
+ *	Only the rows the table can't decide on touch their node_info.
  */
 void
 check_node_eligibility_chunk(th_data_nd_eligible *data)
@@ -5420,9 +6175,10 @@ check_node_eligibility_chunk(th_data_nd_eligible *data)
 	int start, end;
 	schd_error *err;
 	schd_error *misc_err;
-	resource_resv *resresv;
-	place *pl;
 	node_info **ninfo_arr;
+	node_soa_filter filter = {};
+	int use_soa;
+	int num_rows = 0;
 
 	if (data == NULL)
 		return;
@@ -5440,39 +6196,41 @@ check_node_eligibility_chunk(th_data_nd_eligible *data)
 
 	start = data->sidx;
 	end = data->eidx;
-	resresv = data->resresv;
-	pl = data->pl;
 	ninfo_arr = data->ninfo_arr;
 
-	for (i = start; i <= end && ninfo_arr[i] != NULL; i++) {
-		node_info *node;
-
-		node = ninfo_arr[i];
-		if (!node->nscr) {
-			if (is_vnode_eligible(node, resresv, pl, err) == 0) {
-				node->nscr |= NSCR_INELIGIBLE;
-				if (node->hostset != NULL) {
-					if ((err->error_code == NODE_NOT_EXCL && is_exclhost(pl, node->sharing))
-							|| sim_exclhost(resresv->server->calendar, resresv, node) == 0) {
-						int j;
-
-						for (j = 0; node->hostset->ninfo_arr[j] != NULL; j++) {
-							node_info *n = node->hostset->ninfo_arr[j];
-							n->nscr |= NSCR_INELIGIBLE;
-							set_schd_error_codes(misc_err, NOT_RUN, NODE_NOT_EXCL);
-							schdlogerr(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG, n->name,
-									NULL, misc_err);
-							clear_schd_error(misc_err);
-						}
-					}
-				}
-				if (err->status_code != SCHD_UNKWN) {
-					if (misc_err->status_code == SCHD_UNKWN)
-						copy_schd_error(misc_err, err);
-					schdlogerr(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG, node->name, NULL, err);
+	use_soa = init_node_soa_filter(&filter, data->resresv, data->pl);
+	if (use_soa)
+		num_rows = filter.soa->node.size();
+
+	if (data->by_row && use_soa) {
+		if (end >= num_rows)
+			end = num_rows - 1;
+		for (i = start; i <= end; i++) {
+			switch (node_soa_row_check(&filter, i)) {
+				case NSOA_ROW_OK:
+					data->num_ok++;
+					break;
+				case NSOA_ROW_SKIP:
+					data->num_skip++;
+					break;
+				default:
+					check_node_eligibility_detail(data, filter.soa->node[i], err, misc_err);
+			}
+		}
+	} else {
+		for (i = start; i <= end && ninfo_arr[i] != NULL; i++) {
+			node_info *node = ninfo_arr[i];
+
+			if (use_soa && !node->nscr) {
+				int ind = node->node_ind;
+
+				if (ind >= 0 && ind < num_rows && filter.soa->node[ind] == node &&
+				    node_soa_row_check(&filter, ind) == NSOA_ROW_OK) {
+					data->num_ok++;
+					continue;
 				}
-				clear_schd_error(err);
 			}
+			check_node_eligibility_detail(data, node, err, misc_err);
 		}
 	}
 
@@ -5480,15 +6238,28 @@ check_node_eligibility_chunk(th_data_nd_eligible *data)
 	data->err = misc_err;
 }
 
+/**
+ * @brief	TS_FUNC task wrapper around check_node_eligibility_chunk()
+ *
+ * @param[in,out]	data - th_data_nd_eligible for the chunk
+ *
+ * @return	void
+ */
+static void
+check_node_eligibility_task(void *data)
+{
+	check_node_eligibility_chunk(static_cast<th_data_nd_eligible *>(data));
+}
+
 /**
  * @brief	 Allocates th_data_nd_eligible for multi-threading of check_node_array_eligibility
  *
  * @param[in]	pl	-	the placement object
  * @param[in]	resresv	-	resresv to check to place on nodes
- * @param[in]	exclerr_buf	-	buffer for not exclusive error message
  * @param[in]	ninfo_arr	-	array to check
  * @param[in]	sidx	-	the start index in ninfo_arr for the thread
  * @param[in]	eidx	-	the end index in ninfo_arr for the thread
+ * @param[in]	by_row	-	sidx and eidx are node_soa rows instead
  *
  * @return th_data_nd_eligible *
  * @retval a newly allocated th_data_nd_eligible object
@@ -5496,7 +6267,7 @@ check_node_eligibility_chunk(th_data_nd_eligible *data)
  */
 static inline th_data_nd_eligible *
 alloc_tdata_nd_eligible(place *pl, resource_resv *resresv, node_info **ninfo_arr,
-		int sidx, int eidx)
+		int sidx, int eidx, bool by_row)
 {
 	th_data_nd_eligible *tdata;
 
@@ -5511,6 +6282,10 @@ alloc_tdata_nd_eligible(place *pl, resource_resv *resresv, node_info **ninfo_arr
 	tdata->ninfo_arr = ninfo_arr;
 	tdata->sidx = sidx;
 	tdata->eidx = eidx;
+	tdata->by_row = by_row;
+	tdata->num_ok = 0;
+	tdata->num_detail = 0;
+	tdata->num_skip = 0;
 
 	return tdata;
 }
@@ -5528,6 +6303,9 @@ alloc_tdata_nd_eligible(place *pl, resource_resv *resresv, node_info **ninfo_arr
  * 		If an error occurs in this function, no indication will be returned.
  *		This is not a huge concern because, it will just cause more work to be done.
  *
+ * @par	When ninfo_arr holds every node of the request's server, the nodes
+ *	are checked in node_soa table order rather than ninfo_arr order.
+ *
  * @return	void
  */
 void
@@ -5535,8 +6313,11 @@ check_node_array_eligibility(node_info **ninfo_arr, resource_resv *resresv, plac
 		int num_nodes, schd_error *err)
 {
 	th_data_nd_eligible *tdata = NULL;
-	th_task_info *task = NULL;
 	int tid;
+	bool by_row = false;
+	int num_ok = 0;
+	int num_detail = 0;
+	int num_skip = 0;
 
 	if (ninfo_arr == NULL || resresv == NULL || pl == NULL || err == NULL)
 		return;
@@ -5544,58 +6325,65 @@ check_node_array_eligibility(node_info **ninfo_arr, resource_resv *resresv, plac
 	if (num_nodes == -1)
 		num_nodes = count_array(ninfo_arr);
 
+	/* the whole server: walk its node_soa table instead of ninfo_arr */
+	if (num_nodes > 0 && resresv->server != NULL && ninfo_arr[0]->server == resresv->server &&
+	    resresv->server->nsoa.node.size() == static_cast<size_t>(num_nodes))
+		by_row = true;
+
 	tid = *((int *) pthread_getspecific(th_id_key));
 	if (tid != 0 || num_threads <= 1) {
 		/* don't use multi-threading if I am a worker thread or num_threads is 1 */
-		tdata = alloc_tdata_nd_eligible(pl, resresv, ninfo_arr, 0, num_nodes - 1);
+		tdata = alloc_tdata_nd_eligible(pl, resresv, ninfo_arr, 0, num_nodes - 1, by_row);
 		if (tdata == NULL)
 			return;
 		check_node_eligibility_chunk(tdata);
 		copy_schd_error(err, tdata->err);
+		num_ok = tdata->num_ok;
+		num_detail = tdata->num_detail;
+		num_skip = tdata->num_skip;
 		free_schd_error(tdata->err);
 		free(tdata);
 	} else {	 /* We are multithreading */
+		th_task_group *grp;
+		std::vector<th_data_nd_eligible *> tdatas;
 		int j;
-		int num_tasks;
 		int chunk_size = num_nodes / num_threads;
 		chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN) ? chunk_size : MT_CHUNK_SIZE_MIN;
-		for (j = 0, num_tasks = 0; num_nodes > 0;
-				num_tasks++, j += chunk_size, num_nodes -= chunk_size) {
-			tdata = alloc_tdata_nd_eligible(pl, resresv, ninfo_arr, j, j + chunk_size - 1);
+
+		grp = new_th_task_group();
+		if (grp == NULL)
+			return;
+
+		for (j = 0; num_nodes > 0; j += chunk_size, num_nodes -= chunk_size) {
+			tdata = alloc_tdata_nd_eligible(pl, resresv, ninfo_arr, j, j + chunk_size - 1, by_row);
 			if (tdata == NULL)
 				break;
-
-			task = static_cast<th_task_info *>(malloc(sizeof(th_task_info)));
-			if (task == NULL) {
+			if (!queue_func_for_threads(grp, check_node_eligibility_task, tdata)) {
+				free_schd_error(tdata->err);
 				free(tdata);
-				log_err(errno, __func__, MEM_ERR_MSG);
 				break;
 			}
-			task->task_type = TS_IS_ND_ELIGIBLE;
-			task->thread_data = (void *) tdata;
-
-			queue_work_for_threads(task);
+			tdatas.push_back(tdata);
 		}
 
 		/* Get results from worker threads */
-		for (int i = 0; i < num_tasks;) {
-			pthread_mutex_lock(&result_lock);
-			while (ds_queue_is_empty(result_queue))
-				pthread_cond_wait(&result_cond, &result_lock);
-			while (!ds_queue_is_empty(result_queue)) {
-				task = static_cast<th_task_info *>(ds_dequeue(result_queue));
-				tdata = static_cast<th_data_nd_eligible *>(task->thread_data);
-				if (err->status_code == SCHD_UNKWN && tdata->err->status_code != SCHD_UNKWN)
-					copy_schd_error(err, tdata->err);
-
-				free_schd_error(tdata->err);
-				free(tdata);
-				free(task);
-				i++;
-			}
-			pthread_mutex_unlock(&result_lock);
+		wait_th_task_group(grp);
+		free_th_task_group(grp);
+		for (auto td : tdatas) {
+			if (err->status_code == SCHD_UNKWN && td->err->status_code != SCHD_UNKWN)
+				copy_schd_error(err, td->err);
+			num_ok += td->num_ok;
+			num_detail += td->num_detail;
+			num_skip += td->num_skip;
+
+			free_schd_error(td->err);
+			free(td);
 		}
 	}
+
+	log_eventf(PBSEVENT_DEBUG4, resresv->is_job ? PBS_EVENTCLASS_JOB : PBS_EVENTCLASS_RESV,
+		LOG_DEBUG, resresv->name, "Node table: %d nodes eligible, %d checked in detail, %d already ineligible",
+		num_ok, num_detail, num_skip);
 }
 
 /**
@@ -45,6 +45,21 @@
 
 void query_node_info_chunk(th_data_query_ninfo *data);
 
+/*
+ *      free_node_cache - empty the cross-cycle node cache
+ */
+void free_node_cache(void);
+
+/*
+ *      resdef_set_sig - fingerprint a set of resource definitions
+ */
+unsigned long long resdef_set_sig(const std::unordered_set<resdef *>& defs);
+
+/*
+ *      cache_node_sig - remember a node's resource signature across cycles
+ */
+void cache_node_sig(node_info *ninfo);
+
 /*
  *      query_nodes - query all the nodes associated with a server
  */
@@ -572,6 +587,12 @@ check_node_eligibility_chunk(th_data_nd_eligible *data);
 void check_node_array_eligibility(node_info **ninfo_arr, resource_resv *resresv, place *pl,
 		int num_nodes, schd_error *err);
 
+/* build the node_soa table of a server from its unordered_nodes */
+void build_node_soa(server_info *sinfo);
+
+/* refresh a node's row in its server's node_soa table */
+void update_node_soa(node_info *node);
+
 int node_in_partition(node_info *ninfo, char *partition);
 /* add a node to a node array*/
 node_info **add_node_to_array(node_info **ninfo_arr, node_info *node);
@@ -755,6 +755,8 @@ node_partition_update(status *policy, node_partition *np)
 		}
 	}
 
+	index_resource_list(np->res);
+
 	if (!policy->node_sort->empty() && conf.node_sort_unused) {
 		/* Resort the nodes in the partition so that selection works correctly. */
 		qsort(np->ninfo_arr, np->tot_nodes, sizeof(node_info *),
@@ -1197,6 +1197,11 @@ sched_main(int argc, char *argv[], schedule_func sched_ptr)
 	setvbuf(stderr, NULL, _IOLBF, 0);
 #endif
 	pid = getpid();
+
+	/* log from a writer thread, now that we are in the background */
+	if (pbs_conf.pbs_log_async && log_async_start() != 0)
+		log_err(-1, __func__, "unable to start the log writer thread");
+
 	daemon_protect(0, PBS_DAEMON_PROTECT_ON);
 	freopen("/dev/null", "r", stdin);
 
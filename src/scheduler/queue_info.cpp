@@ -135,6 +135,8 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 
 	schd_error *sch_err;
 
+	const char *sig_skip[] = {ATTR_count, ATTR_total, NULL};
+
 	if (policy == NULL || sinfo == NULL)
 		return NULL;
 
@@ -154,6 +156,10 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 		return NULL;
 	}
 
+	/* the job counters change with every submission and don't matter */
+	if (sinfo->ec_state_sig != 0)
+		sinfo->ec_state_sig = batch_status_sig(sinfo->ec_state_sig, queues, sig_skip);
+
 	cur_queue = queues;
 
 	while (cur_queue != NULL) {
@@ -83,6 +83,8 @@
 #include "parse.h"
 #include "limits_if.h"
 #include "fifo.h"
+#include "node_info.h"
+#include "formula.h"
 
 
 
@@ -101,6 +103,7 @@ query_resources(int pbs_sd)
 	struct batch_status *cur_bs;		/* used to iterate over resources */
 	struct attrl *attrp;			/* iterate over resource fields */
 	std::unordered_map<std::string, resdef *> tmpres;
+	int num_defs = 0;
 
 	if ((bs = send_statrsc(pbs_sd, NULL, NULL, const_cast<char *>("p"))) == NULL) {
 		const char *errmsg = pbs_geterrmsg(pbs_sd);
@@ -126,7 +129,7 @@ query_resources(int pbs_sd)
 				flags = strtol(attrp->value, &endp, 10);
 			}
 		}
-		tmpres[cur_bs->name] = new resdef(cur_bs->name, flags, rtype);
+		tmpres[cur_bs->name] = new resdef(cur_bs->name, flags, rtype, num_defs++);
 	}
 	pbs_statfree(bs);
 
@@ -379,6 +382,14 @@ update_resource_defs(int pbs_sd)
 		}
 	}
 
+	/* cached nodes, compiled formulas and equivalence class errors point at
+	 * the definitions we are about to free.  The equivalence class errors
+	 * also depend on the config, which is reread before we are called.
+	 */
+	free_node_cache();
+	free_formula_cache();
+	free_resresv_set_cache();
+
 	for (auto& d : allres)
 		delete d.second;
 
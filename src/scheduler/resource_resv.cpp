@@ -124,8 +124,6 @@ resource_resv::resource_resv(const std::string& rname): name(rname)
 	group = NULL;
 	project = NULL;
 	nodepart_name = NULL;
-	select = NULL;
-	execselect = NULL;
 
 	place_spec = NULL;
 
@@ -313,8 +311,6 @@ resource_resv::~resource_resv()
 	free(group);
 	free(project);
 	free(nodepart_name);
-	delete select;
-	delete execselect;
 	free_place(place_spec);
 	free_resource_req_list(resreq);
 	free(ninfo_arr);
@@ -556,10 +552,9 @@ dup_resource_resv(resource_resv *oresresv, server_info *nsinfo, queue_info *nqin
 	nresresv->project = string_dup(oresresv->project);
 
 	nresresv->nodepart_name = string_dup(oresresv->nodepart_name);
-	if (oresresv->select != NULL)
-		nresresv->select = new selspec(*oresresv->select); /* must come before calls to dup_nspecs() below */
-	if (oresresv->execselect != NULL)
-		nresresv->execselect = new selspec(*oresresv->execselect);
+	/* select specs are shared, not copied.  Must come before calls to dup_nspecs() below */
+	nresresv->select = oresresv->select;
+	nresresv->execselect = oresresv->execselect;
 
 	nresresv->is_invalid = oresresv->is_invalid;
 	nresresv->can_not_fit = oresresv->can_not_fit;
@@ -621,7 +616,7 @@ dup_resource_resv(resource_resv *oresresv, server_info *nsinfo, queue_info *nqin
 		if (nresresv->resv->select_orig != NULL)
 			sel = nresresv->resv->select_orig;
 		else
-			sel = nresresv->select;
+			sel = nresresv->select.get();
 		nresresv->resv->orig_nspec_arr = dup_nspecs(oresresv->resv->orig_nspec_arr, nsinfo->nodes, sel);
 		nresresv->ninfo_arr = copy_node_ptr_array(oresresv->ninfo_arr, nsinfo->nodes);
 		nresresv->nspec_arr = dup_nspecs(oresresv->nspec_arr, nsinfo->nodes, NULL);
@@ -1527,7 +1522,7 @@ update_resresv_on_run(resource_resv *resresv, nspec **nspec_arr)
 		if (resresv->execselect == NULL) {
 			std::string selectspec;
 			selectspec = create_select_from_nspec(nspec_arr);
-			resresv->execselect = parse_selspec(selectspec);
+			resresv->execselect.reset(parse_selspec(selectspec));
 		}
 		if (resresv->job->dependent_jobs != NULL) {
 			for (int i = 0; resresv->job->dependent_jobs[i] != NULL; i++) {
@@ -1624,8 +1619,7 @@ update_resresv_on_end(resource_resv *resresv, const char *job_state)
 				free(resresv->nodepart_name);
 				resresv->nodepart_name = NULL;
 			}
-			delete resresv->execselect;
-			resresv->execselect = NULL;
+			resresv->execselect.reset();
 		}
 		/* We need to correct our calendar */
 		if (resresv->end_event != NULL)
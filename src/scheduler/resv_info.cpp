@@ -255,8 +255,8 @@ query_reservations(int pbs_sd, server_info *sinfo, struct batch_status *resvs)
 
 		resresv->rank = get_sched_rank();
 
-		resresv->aoename = getaoename(resresv->select);
-		resresv->eoename = geteoename(resresv->select);
+		resresv->aoename = getaoename(resresv->select.get());
+		resresv->eoename = geteoename(resresv->select.get());
 
 		/* reservations requesting AOE mark nodes as exclusive */
 		if (resresv->aoename) {
@@ -531,12 +531,11 @@ query_reservations(int pbs_sd, server_info *sinfo, struct batch_status *resvs)
 					release_nodes(resresv_ocr);
 
 					if (resresv_ocr->resv->select_standing != NULL) {
-						delete resresv_ocr->select;
-						resresv_ocr->select = new selspec(*resresv_ocr->resv->select_standing);
+						resresv_ocr->select = std::make_shared<selspec>(*resresv_ocr->resv->select_standing);
 					}
 
 					resresv_ocr->resv->orig_nspec_arr = parse_execvnode(
-						execvnode_ptr[degraded_idx - 1], sinfo, resresv_ocr->select);
+						execvnode_ptr[degraded_idx - 1], sinfo, resresv_ocr->select.get());
 					resresv_ocr->nspec_arr = combine_nspec_array(resresv_ocr->resv->orig_nspec_arr);
 					resresv_ocr->ninfo_arr = create_node_array_from_nspec(resresv_ocr->nspec_arr);
 					resresv_ocr->resv->resv_nodes = create_resv_nodes(
@@ -636,7 +635,7 @@ query_resv(struct batch_status *resv, server_info *sinfo)
 		else if (!strcmp(attrp->name, ATTR_queue))
 			advresv->resv->queuename = string_dup(attrp->value);
 		else if (!strcmp(attrp->name, ATTR_SchedSelect)) {
-			advresv->select = parse_selspec(attrp->value);
+			advresv->select.reset(parse_selspec(attrp->value));
 			if (advresv->select != NULL && advresv->select->chunks != NULL) {
 				/* Ignore resv if any of the chunks has no resource req. */
 				int i;
@@ -785,7 +784,7 @@ query_resv(struct batch_status *resv, server_info *sinfo)
 		if (advresv->resv->select_orig != NULL)
 			sel = advresv->resv->select_orig;
 		else
-			sel = advresv->select;
+			sel = advresv->select.get();
 		advresv->resv->orig_nspec_arr = parse_execvnode(resv_nodes, sinfo, sel);
 		advresv->nspec_arr = combine_nspec_array(advresv->resv->orig_nspec_arr);
 		advresv->ninfo_arr = create_node_array_from_nspec(advresv->nspec_arr);
@@ -795,7 +794,7 @@ query_resv(struct batch_status *resv, server_info *sinfo)
 		 */
 		advresv->resv->resv_nodes = create_resv_nodes(advresv->nspec_arr, sinfo);
 		selectspec = create_select_from_nspec(advresv->resv->orig_nspec_arr);
-		advresv->execselect = parse_selspec(selectspec);
+		advresv->execselect.reset(parse_selspec(selectspec));
 	}
 
 	/* If reservation is unconfirmed and the number of occurrences is 0 then flag
@@ -1170,14 +1169,13 @@ check_new_reservations(status *policy, int pbs_sd, resource_resv **resvs, server
 							if (nresv_copy == NULL)
 								break;
 							if (nresv_copy->resv->select_standing != NULL) {
-								delete nresv_copy->select;
-								nresv_copy->select = new selspec(*nresv_copy->resv->select_standing);
+								nresv_copy->select = std::make_shared<selspec>(*nresv_copy->resv->select_standing);
 							}
 						}
 					}
 					release_nodes(nresv_copy);
 
-					nresv_copy->resv->orig_nspec_arr = parse_execvnode(occr_execvnodes_arr[j], sinfo, nresv_copy->select);
+					nresv_copy->resv->orig_nspec_arr = parse_execvnode(occr_execvnodes_arr[j], sinfo, nresv_copy->select.get());
 					nresv_copy->nspec_arr = combine_nspec_array(nresv_copy->resv->orig_nspec_arr);
 					nresv_copy->ninfo_arr = create_node_array_from_nspec(nresv_copy->nspec_arr);
 					nresv_copy->resv->resv_nodes = create_resv_nodes(nresv_copy->nspec_arr, sinfo);
@@ -1522,13 +1520,12 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 				if (nresv->resv->is_running) {
 					std::string sel;
 					int ind;
-					delete nresv->execselect;
 					/* Use resv->orig_nspec_arr over nspec_arr because
 					 * A) we modified it above in check_vnodes_unavailable() for reconfirmation
 					 * B) it will allow us to map the original select back to the new resv_nodes
 					 */
 					sel = create_select_from_nspec(nresv->resv->orig_nspec_arr);
-					nresv->execselect = parse_selspec(sel);
+					nresv->execselect.reset(parse_selspec(sel));
 					for (ind = 0; nresv->resv->orig_nspec_arr[ind] != NULL; ind++) {
 					    nresv->execselect->chunks[ind]->seq_num = nresv->resv->orig_nspec_arr[ind]->seq_num;
 					}
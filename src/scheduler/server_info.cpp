@@ -53,6 +53,7 @@
  * 	find_alloc_resource_by_str()
  * 	find_resource_by_str()
  * 	find_resource()
+ * 	index_resource_list()
  * 	free_server_info()
  * 	free_resource_list()
  * 	free_resource()
@@ -86,6 +87,7 @@
  * 	dup_counts_list()
  * 	find_counts()
  * 	find_alloc_counts()
+ * 	find_counts_rescount()
  * 	update_counts_on_run()
  * 	update_counts_on_end()
  * 	counts_max()
@@ -188,6 +190,10 @@ query_server(status *pol, int pbs_sd)
 	status *policy;
 	int job_arrays_associated = FALSE;
 	int i;
+	unsigned long long nodesig_defs;
+	std::unordered_map<std::string, int> nodesig_inds;
+	int num_sigs_reused = 0;
+	const char *sig_skip[] = {ATTR_count, ATTR_total, ATTR_license_count, NULL};
 
 	if (pol == NULL)
 		return NULL;
@@ -217,6 +223,11 @@ query_server(status *pol, int pbs_sd)
 	/* We dup'd the policy structure for the cycle */
 	policy = sinfo->policy;
 
+	/* start the fingerprint equivalence class results are cached against.
+	 * The job counters change with every submission and don't matter
+	 */
+	sinfo->ec_state_sig = batch_status_sig(SIG_INIT, server, sig_skip);
+
 	/* set the time to the current time */
 	sinfo->server_time = policy->current_time;
 
@@ -227,6 +238,16 @@ query_server(status *pol, int pbs_sd)
 		return NULL;
 	}
 
+	/* server_dyn_res scripts can return something new every cycle */
+	for (const auto& dr : conf.dynamic_res) {
+		auto res = find_resource_by_str(sinfo->res, dr.res);
+
+		if (res != NULL) {
+			sinfo->ec_state_sig = sig_add_str(sinfo->ec_state_sig, res->name);
+			sinfo->ec_state_sig = sig_add_str(sinfo->ec_state_sig, res->orig_str_avail);
+		}
+	}
+
 	if (!dflt_sched && (sc_attrs.partition == NULL)) {
 		log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_SERVER, LOG_ERR, __func__, "Scheduler does not contain a partition");
 		pbs_statfree(server);
@@ -311,6 +332,8 @@ query_server(status *pol, int pbs_sd)
 
 	/* get reservations, if any - NOTE: will set sinfo -> num_resvs */
 	sinfo->resvs = query_reservations(pbs_sd, sinfo, bs_resvs);
+	if (sinfo->ec_state_sig != 0)
+		sinfo->ec_state_sig = batch_status_sig(sinfo->ec_state_sig, bs_resvs, NULL);
 	pbs_statfree(bs_resvs);
 
 	if (create_server_arrays(sinfo) == 0) { /* bad stuff happened */
@@ -431,12 +454,31 @@ query_server(status *pol, int pbs_sd)
 		return NULL;
 	}
 
+	nodesig_defs = resdef_set_sig(policy->resdef_to_check_no_hostvnode);
 	for (i = 0; sinfo->nodes[i] != NULL; i++) {
 		auto *ninfo = sinfo->nodes[i];
-		ninfo->nodesig = create_resource_signature(ninfo->res,
-							   policy->resdef_to_check_no_hostvnode, ADD_ALL_BOOL);
-		ninfo->nodesig_ind = add_str_to_unique_array(&(sinfo->nodesigs),
-							     ninfo->nodesig);
+
+		/* A node carried over unchanged from the last cycle keeps its signature
+		 * if it was made over the same resources
+		 */
+		if (ninfo->nodesig == NULL || ninfo->nodesig_defs != nodesig_defs) {
+			free(ninfo->nodesig);
+			ninfo->nodesig = create_resource_signature(ninfo->res,
+								   policy->resdef_to_check_no_hostvnode, ADD_ALL_BOOL);
+			ninfo->nodesig_defs = nodesig_defs;
+			cache_node_sig(ninfo);
+		} else
+			num_sigs_reused++;
+		if (ninfo->nodesig != NULL) {
+			auto si = nodesig_inds.find(ninfo->nodesig);
+			if (si == nodesig_inds.end()) {
+				ninfo->nodesig_ind = add_str_to_unique_array(&(sinfo->nodesigs),
+									     ninfo->nodesig);
+				nodesig_inds[ninfo->nodesig] = ninfo->nodesig_ind;
+			} else
+				ninfo->nodesig_ind = si->second;
+		} else
+			ninfo->nodesig_ind = -1;
 
 		if (ninfo->has_ghost_job)
 			create_resource_assn_for_node(ninfo);
@@ -445,6 +487,9 @@ query_server(status *pol, int pbs_sd)
 		sinfo->unordered_nodes[i] = ninfo;
 	}
 	sinfo->unordered_nodes[i] = NULL;
+	log_eventf(PBSEVENT_DEBUG4, PBS_EVENTCLASS_NODE, LOG_DEBUG, __func__,
+		"%d of %d node signatures reused from the last cycle", num_sigs_reused, i);
+	build_node_soa(sinfo);
 
 	generic_sim(sinfo->calendar, TIMED_RUN_EVENT, 0, 0, add_node_events, NULL, NULL);
 
@@ -933,6 +978,12 @@ find_resource_by_str(schd_resource *reslist, const char *name)
 	if (reslist == NULL || name == NULL)
 		return NULL;
 
+	if (reslist->idx != NULL) {
+		resdef *def = find_resdef(name);
+		if (def != NULL)
+			return find_resource(reslist, def);
+	}
+
 	resp = reslist;
 
 	while (resp != NULL && strcmp(resp->name, name))
@@ -965,7 +1016,18 @@ find_resource(schd_resource *reslist, resdef *def)
 	if (reslist == NULL || def == NULL)
 		return NULL;
 
-	resp = reslist;
+	if (reslist->idx != NULL) {
+		schd_resource_idx *idx = reslist->idx;
+
+		if (def->id >= 0 && static_cast<size_t>(def->id) < idx->by_def.size()) {
+			resp = idx->by_def[def->id];
+			if (resp != NULL && resp->def == def)
+				return resp;
+		}
+		/* not indexed: it can only be one added since the index was built */
+		resp = idx->last->next;
+	} else
+		resp = reslist;
 
 	while (resp != NULL && resp->def != def)
 		resp = resp->next;
@@ -973,6 +1035,59 @@ find_resource(schd_resource *reslist, resdef *def)
 	return resp;
 }
 
+/**
+ * @brief
+ * 		index_resource_list - build a lookup index by resource definition
+ *		for a resource list.  The index is hung off the head of the list and
+ *		used by find_resource().  Short lists are not indexed.
+ *
+ * @param[in]	reslist - the resource list to index
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+void
+index_resource_list(schd_resource *reslist)
+{
+	schd_resource *resp;
+	schd_resource *last = NULL;
+	int max_id = -1;
+	int len = 0;
+
+	if (reslist == NULL)
+		return;
+
+	for (resp = reslist; resp != NULL; resp = resp->next) {
+		if (resp->def != NULL && resp->def->id > max_id)
+			max_id = resp->def->id;
+		last = resp;
+		len++;
+	}
+
+	delete reslist->idx;
+	reslist->idx = NULL;
+
+	if (len < RES_IDX_MIN)
+		return;
+
+	try {
+		reslist->idx = new schd_resource_idx;
+		reslist->idx->by_def.assign(max_id + 1, NULL);
+	} catch (std::bad_alloc &e) {
+		delete reslist->idx;
+		reslist->idx = NULL;
+		return;
+	}
+	reslist->idx->last = last;
+
+	/* keep the first of any duplicate, which is what a list walk would find */
+	for (resp = reslist; resp != NULL; resp = resp->next) {
+		if (resp->def != NULL && reslist->idx->by_def[resp->def->id] == NULL)
+			reslist->idx->by_def[resp->def->id] = resp;
+	}
+}
+
 /**
  * @brief	free the sinfo->svr_to_psets map
  * 			Note: this won't be needed once we convert node_partition to a class
@@ -1159,6 +1274,8 @@ free_resource(schd_resource *resp)
 	if (resp->str_assigned != NULL)
 		free(resp->str_assigned);
 
+	delete resp->idx;
+
 	free(resp);
 }
 
@@ -1236,6 +1353,7 @@ new_server_info(int limallocflag)
 	sinfo->policy = NULL;
 	sinfo->fstree = NULL;
 	sinfo->equiv_classes = NULL;
+	sinfo->ec_state_sig = 0;
 	sinfo->buckets = NULL;
 	sinfo->unordered_nodes = NULL;
 	sinfo->num_queues = 0;
@@ -1282,6 +1400,7 @@ new_resource()
 	resp->name = NULL;
 	resp->next = NULL;
 	resp->def = NULL;
+	resp->idx = NULL;
 	resp->orig_str_avail = NULL;
 	resp->indirect_vnode_name = NULL;
 	resp->indirect_res = NULL;
@@ -2250,6 +2369,7 @@ dup_server_info(server_info *osinfo)
 		nsinfo->unassoc_nodes = nsinfo->nodes;
 
 	nsinfo->unordered_nodes = dup_unordered_nodes(osinfo->unordered_nodes, nsinfo->nodes);
+	build_node_soa(nsinfo);
 
 	/* dup the reservations */
 	nsinfo->resvs = dup_resource_resv_array(osinfo->resvs, nsinfo, NULL);
@@ -2291,6 +2411,7 @@ dup_server_info(server_info *osinfo)
 #endif /* localmod 054 */
 
 	nsinfo->equiv_classes = dup_resresv_set_array(osinfo->equiv_classes, nsinfo);
+	nsinfo->ec_state_sig = osinfo->ec_state_sig;
 
 	/* the event list is created dynamically during the evaluation of resource
 	 * reservations. It is a sorted list of all_resresv, initialized to NULL to
@@ -2368,7 +2489,7 @@ dup_server_info(server_info *osinfo)
 		nsinfo->nodes[i]->np_arr =
 			copy_node_partition_ptr_array(osinfo->nodes[i]->np_arr, nsinfo->nodepart);
 		if (nsinfo->calendar != NULL)
-			nsinfo->nodes[i]->node_events = dup_te_lists(osinfo->nodes[i]->node_events, nsinfo->calendar->next_event);
+			nsinfo->nodes[i]->node_events = dup_te_lists(osinfo->nodes[i]->node_events, nsinfo->calendar);
 	}
 	nsinfo->buckets = dup_node_bucket_array(osinfo->buckets, nsinfo);
 	/* Now that all job information has been created, time to associate
@@ -2427,6 +2548,9 @@ dup_resource_list(schd_resource *res)
 		prev = nres;
 	}
 
+	if (res != NULL && res->idx != NULL)
+		index_resource_list(head);
+
 	return head;
 }
 /**
@@ -2531,6 +2655,9 @@ dup_ind_resource_list(schd_resource *res)
 		prev = nres;
 	}
 
+	if (res != NULL && res->idx != NULL)
+		index_resource_list(head);
+
 	return head;
 }
 
@@ -2615,7 +2742,9 @@ new_counts(void)
 
 	counts *cts;
 
-	if ((cts = static_cast<struct counts *>(malloc(sizeof(struct counts)))) == NULL) {
+	try {
+		cts = new counts();
+	} catch (std::bad_alloc &e) {
 		log_err(errno, __func__, MEM_ERR_MSG);
 		return NULL;
 	}
@@ -2624,6 +2753,7 @@ new_counts(void)
 	cts->running = 0;
 	cts->rescts = NULL;
 	cts->soft_limit_preempt_bit = 0;
+	cts->idx = NULL;
 	cts->next = NULL;
 
 	return cts;
@@ -2651,9 +2781,10 @@ free_counts(counts *cts)
 	if (cts->rescts != NULL)
 		free_resource_count_list(cts->rescts);
 
+	delete cts->idx;
 	cts->next = NULL;
 
-	free(cts);
+	delete cts;
 }
 
 /**
@@ -2683,6 +2814,185 @@ free_counts_list(counts *ctslist)
 	}
 }
 
+/**
+ * @brief
+ * 		index_counts_list - build the by name lookup index of a counts
+ *		list.  The index is hung off the head of the list.
+ *
+ * @param[in]	ctslist	- the counts list to index
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+static void
+index_counts_list(counts *ctslist)
+{
+	counts_idx *idx = NULL;
+	counts *cur;
+
+	if (ctslist == NULL)
+		return;
+
+	delete ctslist->idx;
+	ctslist->idx = NULL;
+
+	try {
+		idx = new counts_idx;
+		/* keep the first of any duplicate, which is what a list walk would find */
+		for (cur = ctslist; cur != NULL; cur = cur->next) {
+			if (cur->name != NULL)
+				idx->by_name.emplace(cur->name, cur);
+			idx->last = cur;
+		}
+	} catch (std::bad_alloc &e) {
+		/* lookups fall back to walking the list */
+		delete idx;
+		return;
+	}
+
+	ctslist->idx = idx;
+}
+
+/**
+ * @brief
+ * 		append_counts - add a counts structure to the end of a list and
+ *		keep the list's index up to date.  Lists which have grown long
+ *		enough are indexed.
+ *
+ * @param[in]	ctslist	- the head of the counts list
+ * @param[in]	ncts	- the counts structure to add
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+static void
+append_counts(counts *ctslist, counts *ncts)
+{
+	counts *last;
+	int len = 1;
+
+	if (ctslist == NULL || ncts == NULL)
+		return;
+
+	if (ctslist->idx != NULL) {
+		ctslist->idx->last->next = ncts;
+		ctslist->idx->last = ncts;
+		try {
+			if (ncts->name != NULL)
+				ctslist->idx->by_name.emplace(ncts->name, ncts);
+		} catch (std::bad_alloc &e) {
+			delete ctslist->idx;
+			ctslist->idx = NULL;
+		}
+		return;
+	}
+
+	for (last = ctslist; last->next != NULL; last = last->next)
+		len++;
+	last->next = ncts;
+
+	if (len + 1 >= COUNTS_IDX_MIN)
+		index_counts_list(ctslist);
+}
+
+/**
+ * @brief
+ * 		index_counts_rescount - add a resource_count of a counts structure
+ *		to the structure's by resource definition index
+ *
+ * @param[in]	cts	- the counts structure
+ * @param[in]	rcount	- resource_count in cts->rescts
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+static void
+index_counts_rescount(counts *cts, resource_count *rcount)
+{
+	int id;
+
+	if (rcount->def == NULL)
+		return;
+
+	id = rcount->def->id;
+	try {
+		if (static_cast<size_t>(id) >= cts->res_by_def.size())
+			cts->res_by_def.resize(id + 1, NULL);
+	} catch (std::bad_alloc &e) {
+		/* ids past the end of the index are found by walking rescts */
+		return;
+	}
+	if (cts->res_by_def[id] == NULL)
+		cts->res_by_def[id] = rcount;
+}
+
+/**
+ * @brief
+ * 		find_counts_rescount - find the resource_count of a resource in a
+ *		counts structure
+ *
+ * @param[in]	cts	- the counts structure to search
+ * @param[in]	def	- the resource definition to find
+ *
+ * @return	resource_count *
+ * @retval	found resource_count
+ * @retval	NULL	: if not found
+ *
+ * @par MT-Safe:	no
+ */
+resource_count *
+find_counts_rescount(counts *cts, resdef *def)
+{
+	if (cts == NULL || def == NULL)
+		return NULL;
+
+	/* every resource_count is indexed unless growing the index failed */
+	if (static_cast<size_t>(def->id) < cts->res_by_def.size())
+		return cts->res_by_def[def->id];
+
+	return find_resource_count(cts->rescts, def);
+}
+
+/**
+ * @brief
+ * 		find_alloc_counts_rescount - find the resource_count of a resource
+ *		in a counts structure or allocate a new one and add it
+ *
+ * @param[in]	cts	- the counts structure
+ * @param[in]	def	- the resource definition to find
+ *
+ * @return	resource_count *
+ * @retval	found or newly allocated resource_count
+ * @retval	NULL	: on error
+ *
+ * @par MT-Safe:	no
+ */
+static resource_count *
+find_alloc_counts_rescount(counts *cts, resdef *def)
+{
+	resource_count *rcount;
+
+	if (def == NULL)
+		return NULL;
+
+	if ((rcount = find_counts_rescount(cts, def)) != NULL)
+		return rcount;
+
+	if ((rcount = new_resource_count()) == NULL)
+		return NULL;
+
+	rcount->def = def;
+	rcount->name = def->name.c_str();
+	rcount->next = cts->rescts;
+	cts->rescts = rcount;
+	index_counts_rescount(cts, rcount);
+
+	return rcount;
+}
+
 /**
  * @brief
  * 		dup_counts - duplicate a counts structure
@@ -2709,6 +3019,8 @@ dup_counts(counts *octs)
 		ncts->soft_limit_preempt_bit = octs->soft_limit_preempt_bit;
 
 		ncts->rescts = dup_resource_count_list(octs->rescts);
+		for (auto rcount = ncts->rescts; rcount != NULL; rcount = rcount->next)
+			index_counts_rescount(ncts, rcount);
 	}
 
 	return ncts;
@@ -2732,6 +3044,7 @@ dup_counts_list(counts *ctslist)
 	counts *nhead;
 	counts *prev;
 	counts *ncts;
+	int len = 0;
 
 	nhead = NULL;
 	prev = NULL;
@@ -2745,10 +3058,14 @@ dup_counts_list(counts *ctslist)
 				prev->next = ncts;
 
 			prev = ncts;
+			len++;
 		}
 		cur = cur->next;
 	}
 
+	if (len >= COUNTS_IDX_MIN)
+		index_counts_list(nhead);
+
 	return nhead;
 }
 
@@ -2772,6 +3089,13 @@ find_counts(counts *ctslist, const char *name)
 	if (ctslist == NULL || name == NULL)
 		return NULL;
 
+	if (ctslist->idx != NULL) {
+		auto f = ctslist->idx->by_name.find(name);
+		if (f == ctslist->idx->by_name.end())
+			return NULL;
+		return f->second;
+	}
+
 	cur = ctslist;
 
 	while (cur != NULL && strcmp(cur->name, name))
@@ -2796,31 +3120,23 @@ find_counts(counts *ctslist, const char *name)
 counts *
 find_alloc_counts(counts *ctslist, const char *name)
 {
-	counts *cur, *prev;
+	counts *cur;
 	counts *ncounts;
 
 	if (name == NULL)
 		return NULL;
 
-	prev = cur = ctslist;
-
-	while (cur != NULL && strcmp(cur->name, name)) {
-		prev = cur;
-		cur = cur->next;
-	}
-
-	if (cur == NULL) {
-		ncounts = new_counts();
+	if ((cur = find_counts(ctslist, name)) != NULL)
+		return cur;
 
-		if (ncounts != NULL)
-			ncounts->name = string_dup(name);
+	ncounts = new_counts();
 
-		if (prev != NULL)
-			prev->next = ncounts;
+	if (ncounts != NULL) {
+		ncounts->name = string_dup(name);
+		append_counts(ctslist, ncounts);
+	}
 
-		return ncounts;
-	} else
-		return cur;
+	return ncounts;
 }
 
 /**
@@ -2852,14 +3168,11 @@ update_counts_on_run(counts *cts, resource_req *resreq)
 	req = resreq;
 
 	while (req != NULL) {
-		ctsreq = find_alloc_resource_count(cts->rescts, req->def);
-
-		if (ctsreq != NULL) {
-			if (cts->rescts == NULL)
-				cts->rescts = ctsreq;
+		ctsreq = find_alloc_counts_rescount(cts, req->def);
 
+		if (ctsreq != NULL)
 			ctsreq->amount += req->amount;
-		}
+
 		req = req->next;
 	}
 }
@@ -2886,7 +3199,7 @@ update_counts_on_end(counts *cts, resource_req *resreq)
 	cts->running--;
 
 	for(auto req = resreq; req != NULL; req = req->next) {
-		auto ctsreq = find_resource_count(cts->rescts, req->def);
+		auto ctsreq = find_counts_rescount(cts, req->def);
 		if (ctsreq != NULL)
 			ctsreq->amount -= req->amount;
 	}
@@ -2911,7 +3224,6 @@ counts_max(counts *cmax, counts *ncounts)
 {
 	counts *cur;
 	counts *cur_fmax;
-	counts *cmax_head;
 	resource_count *cur_res;
 	resource_count *cur_res_max;
 
@@ -2921,34 +3233,32 @@ counts_max(counts *cmax, counts *ncounts)
 	if (cmax == NULL)
 		return dup_counts_list(ncounts);
 
-	cmax_head = cmax;
-
 	for (cur = ncounts; cur != NULL; cur = cur->next) {
 		cur_fmax = find_counts(cmax, cur->name);
 		if (cur_fmax == NULL) {
 			cur_fmax = dup_counts(cur);
 			if (cur_fmax == NULL) {
-				free_counts_list(cmax_head);
+				free_counts_list(cmax);
 				return NULL;
 			}
 
-			cur_fmax->next = cmax_head;
-			cmax_head = cur_fmax;
+			append_counts(cmax, cur_fmax);
 		} else {
 			if (cur->running > cur_fmax->running)
 				cur_fmax->running = cur->running;
 
 			for (cur_res = cur->rescts; cur_res != NULL; cur_res = cur_res->next) {
-				cur_res_max = find_resource_count(cur_fmax->rescts, cur_res->def);
+				cur_res_max = find_counts_rescount(cur_fmax, cur_res->def);
 				if (cur_res_max == NULL) {
 					cur_res_max = dup_resource_count(cur_res);
 					if (cur_res_max == NULL) {
-						free_counts_list(cmax_head);
+						free_counts_list(cmax);
 						return NULL;
 					}
 
 					cur_res_max->next = cur_fmax->rescts;
 					cur_fmax->rescts = cur_res_max;
+					index_counts_rescount(cur_fmax, cur_res_max);
 				} else {
 					if (cur_res->amount > cur_res_max->amount)
 						cur_res_max->amount = cur_res->amount;
@@ -2956,7 +3266,7 @@ counts_max(counts *cmax, counts *ncounts)
 			}
 		}
 	}
-	return cmax_head;
+	return cmax;
 }
 
 /**
@@ -88,6 +88,11 @@ schd_resource *find_resource_by_str(schd_resource *reslist, const std::string& n
  */
 schd_resource *find_resource(schd_resource *reslist, resdef *def);
 
+/*
+ *	index_resource_list - build a lookup index for find_resource()
+ */
+void index_resource_list(schd_resource *reslist);
+
 /*
  *	free_server_info - free the space used by a server_info structure
  */
@@ -278,6 +283,12 @@ counts *find_counts(counts *ctslist, const char *name);
  */
 counts *find_alloc_counts(counts *ctslist, const char *name);
 
+/*
+ *      find_counts_rescount - find the resource_count of a resource in a
+ *                             counts structure
+ */
+resource_count *find_counts_rescount(counts *cts, resdef *def);
+
 /*
  *      update_counts_on_run - update a counts struct on the running of a job
  */
@@ -70,7 +70,10 @@
  * 	free_timed_event()
  * 	free_timed_event_list()
  * 	add_event()
+ * 	clear_event_list_idx()
+ * 	index_event_list()
  * 	add_timed_event()
+ * 	remove_timed_event()
  * 	delete_event()
  * 	create_event()
  * 	determine_event_name()
@@ -558,6 +561,72 @@ timed_event *find_timed_event(timed_event *te_list, time_t event_time)
 	return find_timed_event(te_list, "", 0, TIMED_NOEVENT, event_time);
 }
 
+/**
+ * @brief
+ * 		is an event before another one in the calendar
+ *
+ * @param[in]	a	- event
+ * @param[in]	b	- event in the same calendar as a
+ *
+ * @return	bool
+ * @retval	true	- a comes before b
+ * @retval	false	- a is b or comes after it
+ */
+static inline bool
+event_before(const timed_event *a, const timed_event *b)
+{
+	if (a->event_time != b->event_time)
+		return a->event_time < b->event_time;
+	return a->seq < b->seq;
+}
+
+/**
+ * @brief
+ * 		find a timed_event in a calendar by name and optionally by
+ *		event type and time.  The calendar's name index is used, so this
+ *		doesn't walk the calendar.
+ *
+ * @param[in]	calendar	- calendar to search
+ * @param[in]	start		- first event to consider, events before it are ignored
+ * @param[in]	name		- name of timed_event to search for
+ * @param[in] 	ignore_disabled - ignore disabled events
+ * @param[in] 	event_type 	- event_type or TIMED_NOEVENT to ignore
+ * @param[in] 	event_time 	- time or 0 to ignore
+ *
+ * @return	the first matching event at or after start
+ * @retval	NULL	: not found
+ */
+timed_event *
+find_timed_event(event_list *calendar, timed_event *start, const std::string &name, int ignore_disabled,
+		 enum timed_event_types event_type, time_t event_time)
+{
+	timed_event *found = NULL;
+
+	if (calendar == NULL || start == NULL)
+		return NULL;
+
+	if (name.empty())
+		return find_timed_event(start, name, ignore_disabled, event_type, event_time);
+
+	auto range = calendar->idx->by_name.equal_range(name);
+	for (auto it = range.first; it != range.second; ++it) {
+		timed_event *te = it->second;
+
+		if (ignore_disabled && te->disabled)
+			continue;
+		if (event_type != TIMED_NOEVENT && te->event_type != event_type)
+			continue;
+		if (event_time != 0 && te->event_time != event_time)
+			continue;
+		if (event_before(te, start))
+			continue;
+		if (found == NULL || event_before(te, found))
+			found = te;
+	}
+
+	return found;
+}
+
 /**
  * @brief
  * 		takes a timed_event and performs any actions
@@ -670,23 +739,16 @@ exists_run_event(event_list *calendar, time_t end)
 int
 exists_resv_event(event_list *calendar, time_t end)
 {
-	timed_event *te;
-	timed_event *te_list;
-
 	if (calendar == NULL)
 		return 0;
 
-	te_list = calendar->first_run_event;
-	if (te_list == NULL) /* no run events in our calendar */
-		return 0;
+	for (auto& re : calendar->idx->run_events) {
+		timed_event *te = re.second;
 
-	for (te = te_list; te != NULL && te->event_time <= end;
-		te = find_next_timed_event(te, 0, TIMED_RUN_EVENT)) {
-		if (te->event_type == TIMED_RUN_EVENT) {
-			resource_resv *resresv = static_cast<resource_resv *>(te->event_ptr);
-			if(resresv->is_resv)
-				return 1;
-		}
+		if (te->event_time > end)
+			break;
+		if (static_cast<resource_resv *>(te->event_ptr)->is_resv)
+			return 1;
 	}
 	return 0;
 }
@@ -843,10 +905,11 @@ create_event_list(server_info *sinfo)
 	if (elist == NULL)
 		return NULL;
 
-	elist->events = create_events(sinfo);
+	create_events(elist, sinfo);
 
 	elist->next_event = elist->events;
-	elist->first_run_event = find_timed_event(elist->events, TIMED_RUN_EVENT);
+	if (!elist->idx->run_events.empty())
+		elist->first_run_event = elist->idx->run_events.begin()->second;
 	elist->current_time = &sinfo->server_time;
 	add_dedtime_events(elist, sinfo->policy);
 
@@ -855,18 +918,20 @@ create_event_list(server_info *sinfo)
 
 /**
  * @brief
- *		create_events - creates an timed_event list from running jobs
+ *		create_events - creates the timed events of a calendar from running jobs
  *			    and confirmed reservations
  *
+ * @param[in,out] elist - calendar to add the events to
  * @param[in] sinfo - server universe to act upon
  *
- * @return	timed_event list
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error, the calendar is left empty
  *
  */
-timed_event *
-create_events(server_info *sinfo)
+int
+create_events(event_list *elist, server_info *sinfo)
 {
-	timed_event	*events = NULL;
 	timed_event	*te = NULL;
 	resource_resv	**all = NULL;
 	int		errflag = 0;
@@ -901,7 +966,7 @@ create_events(server_info *sinfo)
 				errflag++;
 				break;
 			}
-			events = add_timed_event(events, te);
+			add_timed_event(elist, te);
 		}
 
 		if (sinfo->use_hard_duration)
@@ -913,7 +978,7 @@ create_events(server_info *sinfo)
 			errflag++;
 			break;
 		}
-		events = add_timed_event(events, te);
+		add_timed_event(elist, te);
 	}
 
 	/* for nodes that are in state=sleep add a timed event */
@@ -926,19 +991,21 @@ create_events(server_info *sinfo)
 				errflag++;
 				break;
 			}
-			events = add_timed_event(events, te);
+			add_timed_event(elist, te);
 		}
 	}
 
 	/* A malloc error was encountered, free all allocated memory and return */
 	if (errflag > 0) {
-		free_timed_event_list(events);
+		free_timed_event_list(elist->events);
+		elist->events = NULL;
+		clear_event_list_idx(elist->idx);
 		free(all_resresv_copy);
 		return 0;
 	}
 
 	free(all_resresv_copy);
-	return events;
+	return 1;
 }
 
 /**
@@ -964,6 +1031,15 @@ new_event_list()
 	elist->first_run_event = NULL;
 	elist->current_time = NULL;
 
+	try {
+		elist->idx = new event_list_idx();
+	} catch (std::bad_alloc &e) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(elist);
+		return NULL;
+	}
+	elist->idx->last = NULL;
+
 	return elist;
 }
 
@@ -999,10 +1075,11 @@ dup_event_list(event_list *oelist, server_info *nsinfo)
 			free_event_list(nelist);
 			return NULL;
 		}
+		index_event_list(nelist);
 	}
 
 	if (oelist->next_event != NULL) {
-		nelist->next_event = find_timed_event(nelist->events, oelist->next_event->name,
+		nelist->next_event = find_timed_event(nelist, nelist->events, oelist->next_event->name, 0,
 						      oelist->next_event->event_type,
 						      oelist->next_event->event_time);
 		if (nelist->next_event == NULL) {
@@ -1015,7 +1092,7 @@ dup_event_list(event_list *oelist, server_info *nsinfo)
 
 	if (oelist->first_run_event != NULL) {
 		nelist->first_run_event =
-			find_timed_event(nelist->events, oelist->first_run_event->name, TIMED_RUN_EVENT,
+			find_timed_event(nelist, nelist->events, oelist->first_run_event->name, 0, TIMED_RUN_EVENT,
 					 oelist->first_run_event->event_time);
 		if (nelist->first_run_event == NULL) {
 			log_event(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, oelist->first_run_event->name,
@@ -1041,6 +1118,7 @@ free_event_list(event_list *elist)
 		return;
 
 	free_timed_event_list(elist->events);
+	delete elist->idx;
 	free(elist);
 }
 
@@ -1068,6 +1146,7 @@ new_timed_event()
 	te->event_ptr = NULL;
 	te->event_func = NULL;
 	te->event_func_arg = NULL;
+	te->seq = 0;
 	te->next = NULL;
 	te->prev = NULL;
 
@@ -1145,23 +1224,24 @@ free_te_list(te_list *tel) {
 /*
  * @brief te_list copy constructor
  * @param[in] ote - te_list to copy
- * @param[in] new_timed_even_list - new timed events
+ * @param[in] ncalendar - new calendar, events are looked for from its next event on
  *
  * @return copied te_list
  */
 te_list *
-dup_te_list(te_list *ote, timed_event *new_timed_event_list)
+dup_te_list(te_list *ote, event_list *ncalendar)
 {
 	te_list *nte;
 
-	if(ote == NULL || new_timed_event_list == NULL)
+	if(ote == NULL || ncalendar == NULL || ncalendar->next_event == NULL)
 		return NULL;
 
 	nte = new_te_list();
 	if(nte == NULL)
 		return NULL;
 
-	nte->event = find_timed_event(new_timed_event_list, ote->event->name, ote->event->event_type, ote->event->event_time);
+	nte->event = find_timed_event(ncalendar, ncalendar->next_event, ote->event->name, 0,
+				      ote->event->event_type, ote->event->event_time);
 
 	return nte;
 }
@@ -1169,23 +1249,23 @@ dup_te_list(te_list *ote, timed_event *new_timed_event_list)
 /*
  * @brief copy constructor for a list of te_list structures
  * @param[in] ote - te_list to copy
- * @param[in] new_timed_even_list - new timed events
+ * @param[in] ncalendar - new calendar, events are looked for from its next event on
  *
  * @return copied te_list list
  */
 
 te_list *
-dup_te_lists(te_list *ote, timed_event *new_timed_event_list) {
+dup_te_lists(te_list *ote, event_list *ncalendar) {
 	te_list *nte;
 	te_list *end_te = NULL;
 	te_list *cur;
 	te_list *nte_head = NULL;
 
-	if (ote == NULL || new_timed_event_list == NULL)
+	if (ote == NULL || ncalendar == NULL || ncalendar->next_event == NULL)
 		return NULL;
 
 	for(cur = ote; cur != NULL; cur = cur->next) {
-		nte = dup_te_list(cur, new_timed_event_list);
+		nte = dup_te_list(cur, ncalendar);
 		if (nte == NULL) {
 			free_te_list(nte_head);
 			return NULL;
@@ -1439,7 +1519,7 @@ add_event(event_list *calendar, timed_event *te)
 	if (calendar->events == NULL)
 		events_is_null = 1;
 
-	calendar->events = add_timed_event(calendar->events, te);
+	add_timed_event(calendar, te);
 
 	/* empty event list - the new event is the only event */
 	if (events_is_null)
@@ -1452,8 +1532,8 @@ add_event(event_list *calendar, timed_event *te)
 			if (te->event_time < calendar->next_event->event_time)
 				calendar->next_event = te;
 			else if (te->event_time == calendar->next_event->event_time) {
-				calendar->next_event =
-					find_timed_event(calendar->events, te->event_time);
+				/* the first event at that time */
+				calendar->next_event = calendar->idx->by_time[te->event_time];
 			}
 		}
 	}
@@ -1462,8 +1542,7 @@ add_event(event_list *calendar, timed_event *te)
 		calendar->next_event = te;
 
 	if (te->event_type == TIMED_RUN_EVENT)
-		if (calendar->first_run_event == NULL || te->event_time < calendar->first_run_event->event_time)
-			calendar->first_run_event = te;
+		calendar->first_run_event = calendar->idx->run_events.begin()->second;
 
 	/* if we had previously run to the end of the list
 	 * and now we have more work to do, clear the eol bit
@@ -1476,54 +1555,162 @@ add_event(event_list *calendar, timed_event *te)
 
 /**
  * @brief
- * 		add_timed_event - add an event to a sorted list of events
+ * 		clear_event_list_idx - empty a calendar's index
+ *
+ * @param[in,out]	idx	- index to clear
+ *
+ * @return void
+ */
+void
+clear_event_list_idx(event_list_idx *idx)
+{
+	if (idx == NULL)
+		return;
+
+	idx->by_time.clear();
+	idx->by_name.clear();
+	idx->run_events.clear();
+	idx->last = NULL;
+}
+
+/**
+ * @brief
+ * 		index_event_list - (re)build the index of a calendar from its
+ *		already sorted event list
+ *
+ * @param[in,out]	calendar	- calendar to index
+ *
+ * @return void
+ */
+void
+index_event_list(event_list *calendar)
+{
+	event_list_idx *idx = calendar->idx;
+	timed_event *te;
+	long seq = 0;
+
+	clear_event_list_idx(idx);
+
+	for (te = calendar->events; te != NULL; te = te->next) {
+		te->seq = seq++;
+		/* keeps the first event at each time */
+		idx->by_time.emplace(te->event_time, te);
+		idx->by_name.emplace(te->name, te);
+		if (te->event_type == TIMED_RUN_EVENT)
+			idx->run_events[std::make_pair(te->event_time, te->seq)] = te;
+		idx->last = te;
+	}
+}
+
+/**
+ * @brief
+ * 		add_timed_event - add an event to the sorted list of events of
+ *		a calendar.  The calendar's index is used to find where the event
+ *		goes, and is updated.
  *
  * @note
  *		ASSUMPTION: if multiple events are at the same time, all
  *		    end events will come first
  *
- * @param	events - event list to add event to
+ * @param	calendar - calendar to add event to
  * @param 	te     - timed_event to add to list
  *
- * @return	head of timed_event list
+ * @return	void
  */
-timed_event *
-add_timed_event(timed_event *events, timed_event *te)
+void
+add_timed_event(event_list *calendar, timed_event *te)
 {
-	timed_event *eloop;
-	timed_event *eloop_prev = NULL;
-
-	if (te == NULL)
-		return events;
+	event_list_idx *idx;
+	timed_event *eloop;		/* te goes in front of this event */
+	timed_event *eloop_prev;
+	bool same_time;
 
-	if (events == NULL)
-		return te;
+	if (calendar == NULL || te == NULL)
+		return;
 
-	for (eloop = events; eloop != NULL; eloop = eloop->next) {
-		if (eloop->event_time > te->event_time)
-			break;
-		if (eloop->event_time == te->event_time &&
-			te->event_type == TIMED_END_EVENT) {
-			break;
-		}
+	idx = calendar->idx;
 
-		eloop_prev = eloop;
-	}
+	auto first = idx->by_time.lower_bound(te->event_time);
+	same_time = first != idx->by_time.end() && first->first == te->event_time;
 
-	if (eloop_prev == NULL) {
-		te->next = events;
-		events->prev = te;
-		te->prev = NULL;
-		return te;
+	if (te->event_type == TIMED_END_EVENT) {
+		/* in front of all events at the same time */
+		eloop = (first == idx->by_time.end()) ? NULL : first->second;
+		te->seq = same_time ? eloop->seq - 1 : 0;
+	} else {
+		/* behind all events at the same time */
+		auto after = same_time ? std::next(first) : first;
+		eloop = (after == idx->by_time.end()) ? NULL : after->second;
+		if (same_time)
+			te->seq = ((eloop == NULL) ? idx->last : eloop->prev)->seq + 1;
+		else
+			te->seq = 0;
 	}
 
-	te->next = eloop;
-	eloop_prev->next = te;
+	eloop_prev = (eloop == NULL) ? idx->last : eloop->prev;
 	te->prev = eloop_prev;
-	if (eloop != NULL)
+	te->next = eloop;
+	if (eloop_prev == NULL)
+		calendar->events = te;
+	else
+		eloop_prev->next = te;
+	if (eloop == NULL)
+		idx->last = te;
+	else
 		eloop->prev = te;
 
-	return events;
+	if (!same_time || te->event_type == TIMED_END_EVENT)
+		idx->by_time[te->event_time] = te;
+	idx->by_name.emplace(te->name, te);
+	if (te->event_type == TIMED_RUN_EVENT)
+		idx->run_events[std::make_pair(te->event_time, te->seq)] = te;
+}
+
+/**
+ * @brief
+ * 		remove_timed_event - unlink an event from a calendar and its index
+ *
+ * @param	calendar - calendar to remove the event from
+ * @param 	e      - timed_event to remove
+ *
+ * @return	void
+ */
+static void
+remove_timed_event(event_list *calendar, timed_event *e)
+{
+	event_list_idx *idx = calendar->idx;
+
+	auto f = idx->by_time.find(e->event_time);
+	if (f != idx->by_time.end() && f->second == e) {
+		if (e->next != NULL && e->next->event_time == e->event_time)
+			f->second = e->next;
+		else
+			idx->by_time.erase(f);
+	}
+
+	auto range = idx->by_name.equal_range(e->name);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second == e) {
+			idx->by_name.erase(it);
+			break;
+		}
+	}
+
+	if (e->event_type == TIMED_RUN_EVENT)
+		idx->run_events.erase(std::make_pair(e->event_time, e->seq));
+
+	if (e->prev == NULL)
+		calendar->events = e->next;
+	else
+		e->prev->next = e->next;
+
+	if (e->next == NULL)
+		idx->last = e->prev;
+	else
+		e->next->prev = e->prev;
+
+	e->next = NULL;
+	e->prev = NULL;
 }
 
 /**
@@ -1549,16 +1736,14 @@ delete_event(server_info *sinfo, timed_event *e)
 	if (calendar->next_event == e)
 		calendar->next_event = e->next;
 
-	if (calendar->first_run_event == e)
-		calendar->first_run_event = find_timed_event(calendar->events, TIMED_RUN_EVENT);
+	remove_timed_event(calendar, e);
 
-	if (e->prev == NULL)
-		calendar->events = e->next;
-	else
-		e->prev->next = e->next;
-
-	if (e->next != NULL)
-		e->next->prev = e->prev;
+	if (calendar->first_run_event == e) {
+		if (calendar->idx->run_events.empty())
+			calendar->first_run_event = NULL;
+		else
+			calendar->first_run_event = calendar->idx->run_events.begin()->second;
+	}
 
 	free_timed_event(e);
 }
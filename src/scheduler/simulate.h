@@ -139,6 +139,14 @@ timed_event *find_timed_event(timed_event *te_list, enum timed_event_types event
 timed_event *find_timed_event(timed_event *te_list, const std::string &name, enum timed_event_types event_type, time_t event_time);
 timed_event *find_timed_event(timed_event *te_list, time_t event_time);
 
+/*
+ *	find_timed_event - find a timed_event in a calendar by name using the
+ *			   calendar's index, ignoring events before start
+ */
+timed_event *
+find_timed_event(event_list *calendar, timed_event *start, const std::string &name, int ignore_disabled,
+		 enum timed_event_types event_type, time_t event_time);
+
 /*
  *      next_event - move an event_list to the next event and return it
  *
@@ -191,15 +199,15 @@ int exists_resv_event(event_list *calendar, time_t end);
 
 
 /*
- *      create_events - creates an timed_event list from running jobs
- *                          and confirmed reservations
+ *      create_events - creates the timed events of a calendar from running
+ *                          jobs and confirmed reservations
  *
+ *        \param elist - calendar to add the events to
  *        \param sinfo - server universe to act upon
- *        \param flags -
  *
- *        \return timed_event list
+ *        \return 1 on success / 0 on error
  */
-timed_event *create_events(server_info *sinfo);
+int create_events(event_list *elist, server_info *sinfo);
 
 /*
  * new_event_list() - event_list constructor
@@ -294,17 +302,27 @@ timed_event *find_event_by_name(timed_event *events, char *name);
 
 
 /*
- *      add_timed_event - add an event to a sorted list of events
+ *      clear_event_list_idx - empty a calendar's index
+ */
+void clear_event_list_idx(event_list_idx *idx);
+
+/*
+ *      index_event_list - (re)build the index of a calendar from its
+ *                         already sorted event list
+ */
+void index_event_list(event_list *calendar);
+
+/*
+ *      add_timed_event - add an event to the sorted list of events of
+ *                        a calendar
  *
  *      ASSUMPTION: if multiple events are at the same time, all
  *                  end events will come first
  *
- *        \param events - event list to add event to
- *        \param te     - timed_event to add to list
- *
- *      \return head of timed_event list
+ *        \param calendar - calendar to add event to
+ *        \param te       - timed_event to add to list
  */
-timed_event *add_timed_event(timed_event *events, timed_event *te);
+void add_timed_event(event_list *calendar, timed_event *te);
 /*
  *
  *	add_event - add a timed_event to an event list
@@ -447,8 +465,8 @@ generic_sim(event_list *calendar, unsigned int event_mask, time_t end, int defau
 
 te_list *new_te_list();
 
-te_list *dup_te_list(te_list *ote, timed_event *new_timed_event_list);
-te_list *dup_te_lists(te_list *ote, timed_event *new_timed_event_list);
+te_list *dup_te_list(te_list *ote, event_list *ncalendar);
+te_list *dup_te_lists(te_list *ote, event_list *ncalendar);
 
 void free_te_list(te_list *tel);
 
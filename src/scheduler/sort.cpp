@@ -68,6 +68,12 @@
  * 	cmp_node_host()
  * 	cmp_aoe()
  * 	cmp_job_preemption_time_asc()
+ * 	cmp_job_sort_key()
+ * 	rank_fairshare_groups()
+ * 	sort_keys_chunk()
+ * 	merge_keys_chunk()
+ * 	run_sort_tasks()
+ * 	sort_job_array()
  * 	sort_jobs()
  * 	swapfunc()
  * 	med3()
@@ -80,7 +86,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <math.h>
 #include <log.h>
+#include <algorithm>
 #include "data_types.h"
 #include "sort.h"
 #include "resource_resv.h"
@@ -93,6 +101,7 @@
 #include "constant.h"
 #include "server_info.h"
 #include "resource.h"
+#include "multi_threading.h"
 
 #ifdef NAS
 #include "site_code.h"
@@ -1180,6 +1189,259 @@ cmp_resv_state(const void *r1, const void *r2)
 		return 0;
 }
 
+/**
+ * @brief
+ * 		cmp_job_sort_key - compare two job_sort_keys.  The jobs come out
+ *		in the same order cmp_sort() puts them in.
+ *
+ * @param[in] k1 - key to compare
+ * @param[in] k2 - key to compare
+ * @param[in] nres - number of amounts in each key
+ *
+ * @return int
+ * @retval -1, 0, 1 : standard qsort() cmp
+ */
+static int
+cmp_job_sort_key(const job_sort_key& k1, const job_sort_key& k2, int nres)
+{
+	if (k1.runnable != k2.runnable)
+		return k1.runnable ? -1 : 1;
+
+	/* higher preemption priority first */
+	if (k1.preempt != k2.preempt)
+		return k1.preempt > k2.preempt ? -1 : 1;
+
+	/* preempted jobs first, the earliest preempted first */
+	if (k1.time_preempted != k2.time_preempted) {
+		if (k2.time_preempted == UNSPECIFIED)
+			return -1;
+		if (k1.time_preempted == UNSPECIFIED)
+			return 1;
+		return k1.time_preempted < k2.time_preempted ? -1 : 1;
+	}
+
+	/* higher job_sort_formula value first */
+	if (k1.formula_value != k2.formula_value)
+		return k1.formula_value > k2.formula_value ? -1 : 1;
+
+	if (k1.fs_rank != k2.fs_rank)
+		return k1.fs_rank < k2.fs_rank ? -1 : 1;
+
+	for (int i = 0; i < nres; i++) {
+		if (k1.res[i] != k2.res[i])
+			return k1.res[i] < k2.res[i] ? -1 : 1;
+	}
+
+	if (k1.qrank != k2.qrank)
+		return k1.qrank < k2.qrank ? -1 : 1;
+	if (k1.rank != k2.rank)
+		return k1.rank < k2.rank ? -1 : 1;
+	return 0;
+}
+
+/* strict weak ordering on job_sort_keys for the std algorithms */
+struct job_sort_key_less
+{
+	int nres;
+	bool operator()(const job_sort_key& k1, const job_sort_key& k2) const
+	{
+		return cmp_job_sort_key(k1, k2, nres) < 0;
+	}
+};
+
+/**
+ * @brief
+ * 		rank_fairshare_groups - number the fairshare groups of a set of jobs
+ *		so that a more deserving group gets a lower number.  Groups
+ *		compare_path() finds equal get the same number.
+ *
+ * @param[in]	jobs	-	jobs whose groups to rank
+ * @param[in]	num_jobs	-	number of jobs
+ * @param[out]	fs_ranks	-	group -> rank
+ *
+ * @return void
+ */
+static void
+rank_fairshare_groups(resource_resv **jobs, int num_jobs, std::unordered_map<group_info *, int>& fs_ranks)
+{
+	std::vector<group_info *> groups;
+	int r = 0;
+
+	for (int i = 0; i < num_jobs; i++) {
+		group_info *ginfo = jobs[i]->job->ginfo;
+
+		if (ginfo != NULL && fs_ranks.emplace(ginfo, 0).second)
+			groups.push_back(ginfo);
+	}
+
+	/* there are few groups, so calling compare_path() on them is cheap */
+	std::stable_sort(groups.begin(), groups.end(), [](group_info *g1, group_info *g2) {
+		return compare_path(g1->gpath, g2->gpath) < 0;
+	});
+	for (size_t i = 0; i < groups.size(); i++) {
+		if (i > 0 && compare_path(groups[i - 1]->gpath, groups[i]->gpath) != 0)
+			r++;
+		fs_ranks[groups[i]] = r;
+	}
+}
+
+/**
+ * @brief
+ * 		fill in the job_sort_keys for a chunk of jobs and sort the chunk
+ *
+ * @param[in,out]	data	-	th_data_sort_keys for the chunk
+ *
+ * @return void
+ */
+static void
+sort_keys_chunk(void *data)
+{
+	th_data_sort_keys *tdata = static_cast<th_data_sort_keys *>(data);
+
+	for (int i = tdata->sidx; i <= tdata->eidx; i++) {
+		resource_resv *resresv = tdata->jobs[i];
+		job_sort_key& key = tdata->keys[i];
+		sch_resource_t *res = tdata->res + (size_t) i * tdata->nres;
+		int j = 0;
+
+		key.resresv = resresv;
+		key.runnable = in_runnable_state(resresv);
+		key.preempt = resresv->job->preempt;
+		key.time_preempted = resresv->job->time_preempted;
+		/* NaN compares equal to everything, which would break the sort */
+		key.formula_value = std::isnan(resresv->job->formula_value) ? -HUGE_VALF : resresv->job->formula_value;
+		key.fs_rank = -1;
+		if (tdata->fs_ranks != NULL && resresv->job->ginfo != NULL) {
+			auto it = tdata->fs_ranks->find(resresv->job->ginfo);
+			if (it != tdata->fs_ranks->end())
+				key.fs_rank = it->second;
+		}
+		for (const auto& si : *cstat.sort_by) {
+			sch_resource_t amount = find_resresv_amount(resresv, si.res_name, si.def);
+			res[j++] = (si.order == ASC) ? amount : -amount;
+		}
+		key.res = res;
+		key.qrank = resresv->qrank;
+		key.rank = resresv->rank;
+	}
+	std::sort(tdata->keys + tdata->sidx, tdata->keys + tdata->eidx + 1, job_sort_key_less{tdata->nres});
+}
+
+/**
+ * @brief
+ * 		merge two adjacent sorted runs of job_sort_keys
+ *
+ * @param[in,out]	data	-	th_data_sort_keys, the runs are sidx..midx-1
+ *					and midx..eidx
+ *
+ * @return void
+ */
+static void
+merge_keys_chunk(void *data)
+{
+	th_data_sort_keys *tdata = static_cast<th_data_sort_keys *>(data);
+
+	std::inplace_merge(tdata->keys + tdata->sidx, tdata->keys + tdata->midx,
+		tdata->keys + tdata->eidx + 1, job_sort_key_less{tdata->nres});
+}
+
+/**
+ * @brief
+ * 		run a function over every th_data_sort_keys on the worker threads
+ *		and wait for all of them
+ *
+ * @param[in,out]	tdatas	-	one entry per task
+ * @param[in]	func	-	sort_keys_chunk() or merge_keys_chunk()
+ *
+ * @return void
+ */
+static void
+run_sort_tasks(std::vector<th_data_sort_keys>& tdatas, th_task_func func)
+{
+	th_task_group *grp;
+
+	grp = new_th_task_group();
+	if (grp == NULL) {
+		for (auto& td : tdatas)
+			func(&td);
+		return;
+	}
+	for (auto& td : tdatas) {
+		if (!queue_func_for_threads(grp, func, &td))
+			func(&td);
+	}
+	wait_th_task_group(grp);
+	free_th_task_group(grp);
+}
+
+/**
+ * @brief
+ * 		sort_job_array - sort an array of jobs into cmp_sort() order.
+ *
+ * @par
+ *		The sort keys of every job are read once into a job_sort_key, so
+ *		comparisons don't look up resources or walk fairshare paths.
+ *		With worker threads, chunks of the array are keyed and sorted in
+ *		parallel and then merged pairwise, also in parallel.
+ *
+ * @param[in,out]	jobs	-	jobs to sort
+ * @param[in]	num_jobs	-	number of jobs in the array
+ *
+ * @return void
+ */
+static void
+sort_job_array(resource_resv **jobs, int num_jobs)
+{
+	std::vector<job_sort_key> keys;
+	std::vector<sch_resource_t> res;
+	std::unordered_map<group_info *, int> fs_ranks;
+	const std::unordered_map<group_info *, int> *fsp = NULL;
+	int nres;
+	int tid;
+
+	if (jobs == NULL || num_jobs <= 1)
+		return;
+
+#ifndef NAS /* localmod 041 */
+	if (jobs[0]->server->policy->fair_share) {
+		rank_fairshare_groups(jobs, num_jobs, fs_ranks);
+		fsp = &fs_ranks;
+	}
+#endif /* localmod 041 */
+
+	nres = cstat.sort_by->size();
+	keys.resize(num_jobs);
+	res.resize((size_t) num_jobs * nres);
+
+	tid = *((int *) pthread_getspecific(th_id_key));
+	if (tid != 0 || num_threads <= 1 || num_jobs <= MT_CHUNK_SIZE_MIN) {
+		th_data_sort_keys tdata = {jobs, keys.data(), res.data(), nres, fsp, 0, 0, num_jobs - 1};
+		sort_keys_chunk(&tdata);
+	} else {
+		std::vector<th_data_sort_keys> tdatas;
+		int chunk_size = num_jobs / num_threads;
+		int width;
+		int j;
+
+		chunk_size = (chunk_size > MT_CHUNK_SIZE_MIN) ? chunk_size : MT_CHUNK_SIZE_MIN;
+		chunk_size = (chunk_size < MT_CHUNK_SIZE_MAX) ? chunk_size : MT_CHUNK_SIZE_MAX;
+		for (j = 0; j < num_jobs; j += chunk_size)
+			tdatas.push_back({jobs, keys.data(), res.data(), nres, fsp, j, j, std::min(j + chunk_size, num_jobs) - 1});
+		run_sort_tasks(tdatas, sort_keys_chunk);
+
+		for (width = chunk_size; width < num_jobs; width *= 2) {
+			tdatas.clear();
+			for (j = 0; j + width < num_jobs; j += 2 * width)
+				tdatas.push_back({jobs, keys.data(), res.data(), nres, fsp,
+					j, j + width, std::min(j + 2 * width, num_jobs) - 1});
+			run_sort_tasks(tdatas, merge_keys_chunk);
+		}
+	}
+
+	for (int i = 0; i < num_jobs; i++)
+		jobs[i] = keys[i].resresv;
+}
+
 /**
  * @brief
  * 		sort_jobs - This function sorts all jobs according to their preemption
@@ -1210,8 +1472,7 @@ sort_jobs(status *policy, server_info *sinfo)
 			 */
 			for (int i = 0; i < sinfo->num_queues; i++) {
 				if (sinfo->queues[i]->sc.total > 0) {
-					qsort(sinfo->queues[i]->jobs, sinfo->queues[i]->sc.total,
-						sizeof(resource_resv*), cmp_sort);
+					sort_job_array(sinfo->queues[i]->jobs, sinfo->queues[i]->sc.total);
 				}
 			}
 			for (int count = 0; count != sinfo->num_queues; count++) {
@@ -1224,14 +1485,14 @@ sort_jobs(status *policy, server_info *sinfo)
 		}
 		/** Sort on entire complex **/
 		else if (!policy->by_queue && !policy->round_robin) {
-			qsort(sinfo->jobs, count_array(sinfo->jobs), sizeof(resource_resv *), cmp_sort);
+			sort_job_array(sinfo->jobs, count_array(sinfo->jobs));
 		}
 	}
 	else if (policy->by_queue) {
 		for (int i = 0; i < sinfo->num_queues; i++) {
-			qsort(sinfo->queues[i]->jobs, count_array(sinfo->queues[i]->jobs), sizeof(resource_resv *), cmp_sort);
+			sort_job_array(sinfo->queues[i]->jobs, count_array(sinfo->queues[i]->jobs));
 		}
-		qsort(sinfo->jobs, count_array(sinfo->jobs), sizeof(resource_resv*), cmp_sort);
+		sort_job_array(sinfo->jobs, count_array(sinfo->jobs));
 	}
 	else if (policy->round_robin) {
 		if (sinfo -> queue_list != NULL) {
@@ -1241,13 +1502,12 @@ sort_jobs(status *policy, server_info *sinfo)
 				int queue_index_size = count_array(sinfo->queue_list[i]);
 				for (int j = 0; j < queue_index_size; j++)
 				{
-					qsort(sinfo->queue_list[i][j]->jobs, count_array(sinfo->queue_list[i][j]->jobs),
-						sizeof(resource_resv *), cmp_sort);
+					sort_job_array(sinfo->queue_list[i][j]->jobs, count_array(sinfo->queue_list[i][j]->jobs));
 				}
 			}
 
 		}
 	}
 	else
-		qsort(sinfo->jobs, count_array(sinfo->jobs), sizeof(resource_resv*), cmp_sort);
+		sort_job_array(sinfo->jobs, count_array(sinfo->jobs));
 }
@@ -56,6 +56,9 @@
 #include "portability.h"
 #include <sys/param.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <string.h>
 #include <errno.h>
 #include <limits.h>
@@ -79,7 +82,7 @@
 
 /* Local Data */
 
-static FILE *acctfile;		/* open stream for log file */
+static int acctfd = -1;		/* open descriptor of the log file */
 static volatile int acct_opened = 0;
 static int acct_opened_day;
 static int acct_auto_switch = 0;
@@ -922,7 +925,7 @@ acct_open(char *filename)
 {
     char  filen[_POSIX_PATH_MAX];
 	char  logmsg[_POSIX_PATH_MAX+80];
-	FILE *newacct;
+	int newacct;
 	time_t now;
 	struct tm *ptm;
 
@@ -946,17 +949,15 @@ acct_open(char *filename)
 	} else if (*filename != '/') {
 		return (-1);		/* not absolute */
 	}
-	if ((newacct = fopen(filename, "a")) == NULL) {
+	if ((newacct = open(filename, O_WRONLY | O_APPEND | O_CREAT, 0666)) == -1) {
 		log_err(errno, "acct_open", filename);
 		return (-1);
 	}
 
-	(void)setvbuf(newacct, NULL, _IOLBF, 0); /* set line buffering */
-
 	if (acct_opened > 0) 		/* if acct was open, close it */
-		(void)fclose(acctfile);
+		acct_close();
 
-	acctfile = newacct;
+	acctfd = newacct;
 	acct_opened = 1;			/* note that file is open */
 	(void)sprintf(logmsg, "Account file %s opened", filename);
 	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO,
@@ -967,7 +968,8 @@ acct_open(char *filename)
 
 /**
  * @brief
- * acct_close - close the current open log file
+ * acct_close - close the current open log file, once the records
+ * queued for it by write_account_record() are written out
  *
  * @return	void
  */
@@ -975,7 +977,9 @@ void
 acct_close()
 {
 	if (acct_opened == 1) {
-		(void)fclose(acctfile);
+		log_async_flush();
+		(void)close(acctfd);
+		acctfd = -1;
 		acct_opened = 0;
 	}
 }
@@ -984,6 +988,9 @@ acct_close()
  * @brief
  * write_account_record - write basic accounting record
  *
+ * @par	With PBS_LOG_ASYNC, the record is written by the log writer thread,
+ *	see log_async_queue_fd(), otherwise it is written here.
+ *
  * @param[in]	acctype - accounting record type
  * @param[in]	id - accounting record id
  * @param[in,out]	text - text to log, may be null
@@ -993,27 +1000,77 @@ acct_close()
 void
 write_account_record(int acctype, const char *id, char *text)
 {
-	struct tm *ptm;
+	/* time stamp of the last record, time_now only moves once per loop */
+	static time_t stamp_time = (time_t)-1;
+	static int stamp_yday;
+	static char stamp[72];	/* room for six ints of any value */
+	static int stamp_len;
+	char *rec;
+	char *pc;
+	size_t id_len;
+	size_t text_len;
+	int len;
+	ssize_t n;
 
 	if (acct_opened == 0)
 		return;		/* file not open, don't bother */
 
-	ptm = localtime(&time_now);
+	if (time_now != stamp_time) {
+		struct tm *ptm;
+
+		ptm = localtime(&time_now);
+		stamp_len = snprintf(stamp, sizeof(stamp), "%02d/%02d/%04d %02d:%02d:%02d",
+			ptm->tm_mon+1, ptm->tm_mday, ptm->tm_year+1900,
+			ptm->tm_hour, ptm->tm_min, ptm->tm_sec);
+		stamp_yday = ptm->tm_yday;
+		stamp_time = time_now;
+	}
 
 	/* Do we need to switch files */
 
-	if (acct_auto_switch && (acct_opened_day != ptm->tm_yday)) {
+	if (acct_auto_switch && (acct_opened_day != stamp_yday)) {
 		acct_close();
 		acct_open(NULL);
 	}
 	if (text == NULL)
 		text = "";
 
-	(void)fprintf(acctfile,
-		"%02d/%02d/%04d %02d:%02d:%02d;%c;%s;%s\n",
-		ptm->tm_mon+1, ptm->tm_mday, ptm->tm_year+1900,
-		ptm->tm_hour, ptm->tm_min, ptm->tm_sec,
-		(char)acctype, id, text);
+	/* "stamp;type;id;text\n" */
+	id_len = strlen(id);
+	text_len = strlen(text);
+	len = stamp_len + 3 + id_len + 1 + text_len + 1;
+	if ((rec = malloc(len)) == NULL) {
+		log_err(errno, __func__, "record not written, out of memory");
+		return;
+	}
+	pc = rec;
+	memcpy(pc, stamp, stamp_len);
+	pc += stamp_len;
+	*pc++ = ';';
+	*pc++ = (char)acctype;
+	*pc++ = ';';
+	memcpy(pc, id, id_len);
+	pc += id_len;
+	*pc++ = ';';
+	memcpy(pc, text, text_len);
+	pc += text_len;
+	*pc = '\n';
+
+	if (log_async_queue_fd(acctfd, rec, len) == 0)
+		return;
+
+	for (pc = rec; len > 0; pc += n, len -= n) {
+		n = write(acctfd, pc, len);
+		if (n == -1) {
+			if (errno == EINTR) {
+				n = 0;
+				continue;
+			}
+			log_err(errno, __func__, "could not write to the account file");
+			break;
+		}
+	}
+	free(rec);
 }
 
 /**
@@ -2120,7 +2177,7 @@ void log_alter_records_for_attrs(job *pjob, svrattrl *plist) {
 	entire_record[0] = '\0';
 
 	CLEAR_HEAD(phead);
-	for (i = 0; i < JOB_ATR_LAST; i++) {
+	for (i = next_jattr(pjob, -1); i >= 0; i = next_jattr(pjob, i)) {
 		attribute *pattr = get_jattr(pjob, i);
 		if (pattr->at_flags & ATR_VFLAG_MODIFY) {
 			svrattrl *svrattrl_list = NULL;
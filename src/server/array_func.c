@@ -728,6 +728,8 @@ create_subjob(job *parent, char *newjid, int *rc)
 	CLEAR_HEAD(attrl);
 	for (i = 0; attrs_to_copy[i] != JOB_ATR_LAST; i++) {
 		j    = (int)attrs_to_copy[i];
+		if (!is_jattr_set(parent, j))
+			continue;
 		ppar = get_jattr(parent, j);
 		psub = get_jattr(subj, j);
 		pdef = &job_attr_def[j];
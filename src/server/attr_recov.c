@@ -217,41 +217,42 @@ save_flush(void)
  *		own file.
  *
  * @param[in]	padef - Address of parent's attribute definition array
- * @param[in]	pattr - Address of the parent objects attribute array
- * @param[in]	numattr - Number of attributes in the list
+ * @param[in]	ps - Address of the parent objects sparse attribute storage
  *
  * @return      Error code
  * @retval	 0  - Success
  * @retval	-1  - Failure
  */
 int
-save_attr_fs(attribute_def *padef, attribute *pattr, int numattr)
+save_attr_fs(attribute_def *padef, attr_sparse *ps)
 {
 	svrattrl	 dummy;
 	int		 errct = 0;
 	pbs_list_head 	 lhead;
 	int		 i;
 	svrattrl	*pal;
+	attribute	*pattr;
 	int		 rc;
 
 	/* encode each attribute which has a value (not non-set) */
 
 	CLEAR_HEAD(lhead);
 
-	for (i = 0; i < numattr; i++) {
+	for (i = attr_sparse_next(ps, -1); i >= 0; i = attr_sparse_next(ps, i)) {
+		pattr = attr_sparse_find(ps, i);
 
 		if ((padef+i)->at_type != ATR_TYPE_ACL) {
 
 			/* note access lists are not saved this way */
 
-			rc = (padef+i)->at_encode(pattr+i, &lhead,
+			rc = (padef+i)->at_encode(pattr, &lhead,
 				(padef+i)->at_name,
 				NULL, ATR_ENCODE_SAVE, NULL);
 
 			if (rc < 0)
 				errct++;
 
-			(pattr+i)->at_flags &= ~ATR_VFLAG_MODIFY;
+			pattr->at_flags &= ~ATR_VFLAG_MODIFY;
 
 			/* now that it has been encoded, block and save it */
 
@@ -296,7 +297,7 @@ save_attr_fs(attribute_def *padef, attribute *pattr, int numattr)
  *					  to whom these attributes belong
  * @param[in]   padef_idx - Search index of this attribute definition array
  * @param[in]	padef - Address of parent's attribute definition array
- * @param[in]	pattr - Address of the parent objects attribute array
+ * @param[in]	ps - Address of the parent objects sparse attribute storage
  * @param[in]	limit - Index of the last attribute
  * @param[in]	unknown - Index of the start of the unknown attribute list
  *
@@ -306,8 +307,9 @@ save_attr_fs(attribute_def *padef, attribute *pattr, int numattr)
  */
 
 int
-recov_attr_fs(int fd, void *parent, void *padef_idx, attribute_def *padef, attribute *pattr, int limit, int unknown)
+recov_attr_fs(int fd, void *parent, void *padef_idx, attribute_def *padef, attr_sparse *ps, int limit, int unknown)
 {
+	attribute *pattr;
 	int	  amt;
 	int	  len;
 	int	  index;
@@ -427,17 +429,22 @@ recov_attr_fs(int fd, void *parent, void *padef_idx, attribute_def *padef, attri
 		 * call set_entity to do the INCR.
 		 */
 
+		if ((pattr = attr_sparse_get(ps, padef, index)) == NULL) {
+			log_err(errno, __func__, MALLOC_ERR_MSG);
+			free(pal);
+			return (-1);
+		}
 		if (((padef+index)->at_type != ATR_TYPE_ENTITY) || (pal->al_atopl.op != INCR)) {
-			int rc = set_attr_generic(pattr+index, padef+index, pal->al_value, pal->al_resc, INTERNAL);
+			int rc = set_attr_generic(pattr, padef+index, pal->al_value, pal->al_resc, INTERNAL);
 			if (! rc) {
 				if ((padef+index)->at_action)
-					(void)(padef+index)->at_action(pattr+index, parent, ATR_ACTION_RECOV);
+					(void)(padef+index)->at_action(pattr, parent, ATR_ACTION_RECOV);
 			}
 		} else {
 			/* for INCR case of entity limit, decode locally */
-			set_attr_generic(pattr+index, padef+index, pal->al_value, pal->al_resc, INCR);
+			set_attr_generic(pattr, padef+index, pal->al_value, pal->al_resc, INCR);
 		}
-		(pattr+index)->at_flags = pal->al_flags & ~ATR_VFLAG_MODIFY;
+		pattr->at_flags = pal->al_flags & ~ATR_VFLAG_MODIFY;
 	}
 
 	(void)free(pal);
@@ -529,6 +529,10 @@ dis_request_read(int sfds, struct batch_request *request)
 			rc = decode_DIS_Status(sfds, request);
 			break;
 
+		case PBS_BATCH_StatusJobPage:
+			rc = decode_DIS_StatusPage(sfds, request);
+			break;
+
 		case PBS_BATCH_PySpawn:
 			rc = decode_DIS_PySpawn(sfds, request);
 			break;
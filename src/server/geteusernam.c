@@ -203,6 +203,24 @@ determine_egroup(void *pobj, int objtype, attribute *pattr)
 	return (groupname);
 }
 
+/**
+ * @brief
+ * 		get_objattr - return an attribute of a job or reservation
+ *
+ * @param[in]	pobj - pointer to the job or reservation
+ * @param[in]	objtype - JOB_OBJECT or RESC_RESV_OBJECT
+ * @param[in]	idx - index of the attribute
+ *
+ * @return	attribute *
+ */
+static attribute *
+get_objattr(void *pobj, int objtype, int idx)
+{
+	if (objtype == JOB_OBJECT)
+		return get_jattr((job *)pobj, idx);
+	return get_rattr((resc_resv *)pobj, idx);
+}
+
 /**
  * @brief
  * 		set_objexid - validate and set the object's effective/execution username
@@ -231,8 +249,8 @@ determine_egroup(void *pobj, int objtype, attribute *pattr)
  *
  * @param[in]	objtype - object type
  * @param[in]	pobj -  ptr to object to link in
- * @param[in]	pattr - pointer to attribute structure
- * 						which contains group_List attributes and User_List attributes
+ * @param[in]	attrry - attribute array which contains group_List and
+ *			 User_List attributes, or NULL to use the object's own
  *
  * @returns	 int
  * @retval	 0	- if everything got determined and set appropriately else,
@@ -252,7 +270,6 @@ set_objexid(void *pobj, int objtype, attribute *attrry)
 	int idx_owner, idx_euser, idx_egroup;
 	int idx_acct;
 	int bad_euser, bad_egrp;
-	attribute *objattrs;
 	attribute_def *obj_attr_def;
 	attribute *paclRoot; /*future: aclRoot resv != aclRoot job*/
 	char **pmem;
@@ -269,7 +286,6 @@ set_objexid(void *pobj, int objtype, attribute *attrry)
 		idx_egroup = (int)JOB_ATR_egroup;
 		idx_acct = (int)JOB_ATR_account;
 		obj_attr_def = job_attr_def;
-		objattrs = ((job *)pobj)->ji_wattr;
 		owner = get_jattr_str(pobj, idx_owner);
 		paclRoot = get_sattr(SVR_ATR_AclRoot);
 		bad_euser = PBSE_BADUSER;
@@ -282,7 +298,6 @@ set_objexid(void *pobj, int objtype, attribute *attrry)
 		idx_egroup = (int)RESV_ATR_egroup;
 		idx_acct = (int)RESV_ATR_account;
 		obj_attr_def = resv_attr_def;
-		objattrs = ((resc_resv *)pobj)->ri_wattr;
 		owner = get_rattr_str(pobj, idx_owner);
 		paclRoot = get_sattr(SVR_ATR_AclRoot);
 		bad_euser = PBSE_R_UID;
@@ -295,10 +310,10 @@ set_objexid(void *pobj, int objtype, attribute *attrry)
 	 * actually be the same as what is passed into this function
 	 */
 
-	if ((attrry + idx_ul)->at_flags & ATR_VFLAG_SET)
+	if ((attrry != NULL) && ((attrry + idx_ul)->at_flags & ATR_VFLAG_SET))
 		pattr = attrry + idx_ul;
 	else
-		pattr = &objattrs[idx_ul];
+		pattr = get_objattr(pobj, objtype, idx_ul);
 
 	if ((puser = determine_euser(pobj, objtype, pattr, &isowner)) == NULL)
 		return (bad_euser);
@@ -319,14 +334,14 @@ set_objexid(void *pobj, int objtype, attribute *attrry)
 			return (bad_euser);
 	}
 
-	pattr = &objattrs[idx_euser];
+	pattr = get_objattr(pobj, objtype, idx_euser);
 	free_attr(obj_attr_def, pattr, idx_euser);
 	set_attr_generic(pattr, &obj_attr_def[idx_euser], puser, NULL, INTERNAL);
 
 	if (pwent != NULL) {
 		/* if account (qsub -A) is not specified, set to empty string */
 
-		pattr = &objattrs[idx_acct];
+		pattr = get_objattr(pobj, objtype, idx_acct);
 		if (!is_attr_set(pattr))
 			set_attr_generic(pattr, &obj_attr_def[idx_acct], "\0", NULL, INTERNAL);
 
@@ -341,10 +356,10 @@ set_objexid(void *pobj, int objtype, attribute *attrry)
 		 * be same as what was passed
 		 */
 
-		if (is_attr_set(attrry + idx_gl))
+		if ((attrry != NULL) && is_attr_set(attrry + idx_gl))
 			pattr = attrry + idx_gl;
 		else
-			pattr = &objattrs[idx_gl];
+			pattr = get_objattr(pobj, objtype, idx_gl);
 		if ((pgrpn = determine_egroup(pobj, objtype, pattr)) != NULL) {
 
 			/* user specified a group, group must exists and either	   */
@@ -398,7 +413,10 @@ set_objexid(void *pobj, int objtype, attribute *attrry)
 
 	}
 
-	pattr = attrry + idx_egroup;
+	if (attrry != NULL)
+		pattr = attrry + idx_egroup;
+	else
+		pattr = get_objattr(pobj, objtype, idx_egroup);
 	free_attr(obj_attr_def, pattr, idx_egroup);
 
 	if (addflags != 0) {
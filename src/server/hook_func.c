@@ -113,6 +113,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "pbs_ifl.h"
 #include "libpbs.h"
 #include "list_link.h"
@@ -2321,6 +2322,8 @@ status_hook(hook *phook, struct batch_request *preq, pbs_list_head *pstathd, cha
 	(void)strcpy(pstat->brp_objname, hookname);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blobs = NULL;
+	pstat->brp_nblobs = 0;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -6754,8 +6757,236 @@ get_hook_results_end:
 
 /**
  * @brief
- *		Callback function for reaping server periodic hook child.
- * @param[in]	ptask	- work task pointer
+ *		Print a list made by get_vnode_list() or get_resv_list() as
+ *		pbs_python hook input, one line per entry:
+ *			<head_str>["<id>"].<attribute_name>=<attribute value>
+ *			<head_str>["<id>"].<attribute_name>[<resource_name>]=<resource value>
+ *
+ * @param[in]	fp	- the hook input stream
+ * @param[in]	head_str - EVENT_VNODELIST_OBJECT or EVENT_RESVLIST_OBJECT
+ * @param[in]	phead	- list of "<id>.<attribute_name>" entries
+ *
+ * @return	void
+ */
+static void
+fprint_periodic_list(FILE *fp, char *head_str, pbs_list_head *phead)
+{
+	svrattrl *plist;
+	char *attr_name;
+	char *fmt;
+
+	for (plist = (svrattrl *)GET_NEXT(*phead); plist != NULL;
+		plist = (svrattrl *)GET_NEXT(plist->al_link)) {
+		/* an id may have dots, an attribute name has none */
+		if ((attr_name = strrchr(plist->al_name, '.')) == NULL)
+			continue;
+		*attr_name++ = '\0';
+		/* a value spanning lines is read back in triple quotes */
+		fmt = (strchr(plist->al_value, '\n') != NULL) ? "\"\"\"%s\"\"\"\n" : "%s\n";
+		if ((plist->al_resc != NULL) && (plist->al_resc[0] != '\0'))
+			fprintf(fp, "%s[\"%s\"].%s[%s]=", head_str,
+				plist->al_name, attr_name, plist->al_resc);
+		else
+			fprintf(fp, "%s[\"%s\"].%s=", head_str,
+				plist->al_name, attr_name);
+		fprintf(fp, fmt, plist->al_value);
+		*(attr_name - 1) = '.';
+	}
+}
+
+/**
+ * @brief
+ *		Run by a server helper, in a child of its own: write the hook input
+ *		it was sent and become pbs_python to run the periodic hook.
+ *
+ * @param[in]	data	- built by run_periodic_hook_helper(): the input file
+ *			  name, a "name=value" environment string or "", the
+ *			  pbs_python arguments ended by "", then the hook input
+ * @param[in]	len	- length of data
+ *
+ * @return	int
+ * @retval	1	- the input could not be written or pbs_python not run
+ */
+static int
+periodic_hook_helper(char *data, size_t len)
+{
+	char *argv[16];
+	char *infile;
+	char *env;
+	char *end = data + len;
+	char *p;
+	int argc = 0;
+	int fd;
+	ssize_t n;
+
+	infile = data;
+	env = infile + strlen(infile) + 1;
+	p = env + strlen(env) + 1;
+	while ((p < end) && (*p != '\0') && (argc < 15)) {
+		argv[argc++] = p;
+		p += strlen(p) + 1;
+	}
+	argv[argc] = NULL;
+	if ((argc == 0) || (p >= end))
+		return 1;
+	p++;
+
+	if ((fd = open(infile, O_WRONLY | O_CREAT | O_TRUNC, 0600)) == -1) {
+		log_err(errno, __func__, infile);
+		return 1;
+	}
+	while (p < end) {
+		if ((n = write(fd, p, end - p)) == -1) {
+			if (errno == EINTR)
+				continue;
+			log_err(errno, __func__, infile);
+			close(fd);
+			return 1;
+		}
+		p += n;
+	}
+	close(fd);
+
+	if ((*env != '\0') && (putenv(env) != 0))
+		log_err(errno, __func__, "Failed to set PBS_HOOK_CONFIG_FILE");
+	execv(argv[0], argv);
+	log_err(errno, __func__, argv[0]);
+	return 1;
+}
+
+/**
+ * @brief
+ *		Have a server helper run a periodic hook through pbs_python, as
+ *		MOM runs its hooks, so the server need not fork.  The hook input,
+ *		with the vnodes and reservations, goes to the helper with the
+ *		request; the results come back in the hook output file, which
+ *		post_server_periodic_hook() reads.
+ *
+ * @param[in]	phook	- the periodic hook
+ * @param[out]	pseq	- number of the hook input and output files
+ *
+ * @return	long
+ * @retval	tag of the helper request, see helper_call()
+ * @retval	0	- no helper took the hook, the caller must fork
+ */
+static long
+run_periodic_hook_helper(hook *phook, int *pseq)
+{
+	static int periodic_seq = 0;	/* numbers the hook files */
+	char pypath[MAXPATHLEN + 1];
+	char infile[MAXPATHLEN + 1];
+	char outfile[MAXPATHLEN + 1];
+	char datafile[MAXPATHLEN + 1];
+	char config_env[MAXPATHLEN + sizeof(PBS_HOOK_CONFIG_FILE) + 2] = {'\0'};
+	char logmask[32];
+	char *argv[16];
+	struct stat sbuf;
+	pbs_list_head *plist;
+	FILE *fp;
+	char *data = NULL;
+	size_t len = 0;
+	long tag = 0;
+	int argc = 0;
+	int rc;
+	int i;
+	char *p;
+
+	if (phook->script == NULL)
+		return 0;
+
+	if (++periodic_seq == INT_MAX)
+		periodic_seq = 1;
+	*pseq = periodic_seq;
+	snprintf(infile, sizeof(infile), FMT_HOOK_INFILE, path_hooks_workdir,
+		HOOKSTR_PERIODIC, phook->hook_name, *pseq);
+	snprintf(outfile, sizeof(outfile), FMT_HOOK_OUTFILE, path_hooks_workdir,
+		HOOKSTR_PERIODIC, phook->hook_name, *pseq);
+
+	/* hook config file is the script path ending in HOOK_CONFIG_SUFFIX */
+	pbs_strncpy(pypath, ((struct python_script *)phook->script)->path, sizeof(pypath));
+	if ((p = strstr(pypath, HOOK_SCRIPT_SUFFIX)) != NULL) {
+		snprintf(p, sizeof(pypath) - (p - pypath), "%s", HOOK_CONFIG_SUFFIX);
+		if (stat(pypath, &sbuf) == 0)
+			snprintf(config_env, sizeof(config_env), "%s=%s",
+				PBS_HOOK_CONFIG_FILE, pypath);
+	}
+
+	snprintf(pypath, sizeof(pypath), "%s/bin/pbs_python", pbs_conf.pbs_exec_path);
+	argv[argc++] = pypath;
+	argv[argc++] = "--hook";
+	argv[argc++] = "-i";
+	argv[argc++] = infile;
+	argv[argc++] = "-o";
+	argv[argc++] = outfile;
+	if (log_file == NULL || log_file[0] == '\0') {
+		argv[argc++] = "-L";
+		argv[argc++] = path_log;
+	} else {
+		argv[argc++] = "-l";
+		argv[argc++] = log_file;
+	}
+	argv[argc++] = "-e";
+	snprintf(logmask, sizeof(logmask), "%ld", *log_event_mask);
+	argv[argc++] = logmask;
+	if (stat(path_rescdef, &sbuf) == 0) {
+		argv[argc++] = "-r";
+		argv[argc++] = path_rescdef;
+	}
+	argv[argc++] = ((struct python_script *)phook->script)->path;
+
+	if ((fp = open_memstream(&data, &len)) == NULL) {
+		log_err(errno, __func__, "open_memstream failed");
+		return 0;
+	}
+	fprintf(fp, "%s%c%s%c", infile, '\0', config_env, '\0');
+	for (i = 0; i < argc; i++)
+		fprintf(fp, "%s%c", argv[i], '\0');
+	fputc('\0', fp);
+
+	fprintf(fp, "%s.%s=%s\n", PBS_OBJ, GET_NODE_NAME_FUNC, server_host);
+	fprintf(fp, "%s.%s=%s\n", EVENT_OBJECT, PY_EVENT_TYPE, HOOKSTR_PERIODIC);
+	fprintf(fp, "%s.%s=%s\n", EVENT_OBJECT, PY_EVENT_HOOK_NAME, phook->hook_name);
+	fprintf(fp, "%s.%s=%s\n", EVENT_OBJECT, PY_EVENT_HOOK_TYPE,
+		hook_type_as_string(phook->type));
+	fprintf(fp, "%s.%s=%s\n", EVENT_OBJECT, HOOKATT_USER,
+		hook_user_as_string(phook->user));
+	fprintf(fp, "%s.%s=%d\n", EVENT_OBJECT, "alarm", phook->alarm);
+	fprintf(fp, "%s.%s=%d\n", EVENT_OBJECT, PY_EVENT_FREQ, phook->freq);
+	if (phook->debug) {
+		snprintf(datafile, sizeof(datafile), FMT_HOOK_DATAFILE,
+			path_hooks_workdir, HOOKSTR_PERIODIC, phook->hook_name, *pseq);
+		fprintf(fp, "%s.%s=%s\n", EVENT_OBJECT, "debug", datafile);
+	}
+	plist = get_vnode_list();
+	fprint_periodic_list(fp, EVENT_VNODELIST_OBJECT, plist);
+	free_attrlist(plist);
+	plist = get_resv_list();
+	fprint_periodic_list(fp, EVENT_RESVLIST_OBJECT, plist);
+	free_attrlist(plist);
+
+	if (fclose(fp) != 0) {
+		log_err(errno, __func__, "failed to build hook input");
+		free(data);
+		return 0;
+	}
+
+	/* too much input for a helper request makes this fail too */
+	rc = helper_call(periodic_hook_helper, data, len, &tag);
+	free(data);
+	if (rc != 0)
+		return 0;
+
+	log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_HOOK, LOG_INFO,
+		phook->hook_name, "periodic hook handed to a server helper");
+	return tag;
+}
+
+/**
+ * @brief
+ *		Callback function for reaping server periodic hook child, or
+ *		the pbs_python run by a server helper for the hook.
+ * @param[in]	ptask	- work task pointer, wt_aux2 is the number of
+ *			  the hook output file
  *
  * @return	void
  */
@@ -6772,19 +7003,28 @@ post_server_periodic_hook(struct work_task *ptask)
 	int	reject_flag = 0;
 	stat = ptask->wt_aux;
 	phook = (hook *)ptask->wt_parm1;
-	mypid = ptask->wt_event;
+	mypid = ptask->wt_aux2;
 
 	if (phook == NULL) {
 		log_err(-1, __func__, "A periodic hook disappeared");
 		return;
 	}
+	if ((ptask->wt_event < 0) && !phook->debug) {
+		/* remove the input file written by the helper */
+		snprintf(hook_outfile, MAXPATHLEN, FMT_HOOK_INFILE,
+			path_hooks_workdir, HOOKSTR_PERIODIC,
+			phook->hook_name, mypid);
+		(void)unlink(hook_outfile);
+	}
 	if (WIFEXITED(stat)) {
 		char reject_msg[HOOK_MSG_SIZE + 1] = {'\0'};
 		char *next_time_str;
 		int hook_error_flag = 0;
 
-		/* Check hook exit status */
-		if (stat == 0) {
+		/* Check hook exit status: a forked server child exits 0 */
+		/* on reject, pbs_python run by a helper on any error     */
+		if ((ptask->wt_event > 0) ? (WEXITSTATUS(stat) == 0) :
+			(WEXITSTATUS(stat) != 0)) {
 			snprintf(log_buffer, LOG_BUF_SIZE,
 				"Hook got rejected");
 			log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_HOOK,
@@ -6873,6 +7113,8 @@ run_periodic_hook(struct work_task *ptask)
 	hook_input_param_t req_ptr;
 	pid_t pid;
 	int event_initialized = 0;
+	long tag;
+	int seq;
 
 	phook = (hook *)ptask->wt_parm1;
 	hook_input_param_init(&req_ptr);
@@ -6896,6 +7138,20 @@ run_periodic_hook(struct work_task *ptask)
 		return;
 	}
 
+	if ((tag = run_periodic_hook_helper(phook, &seq)) != 0) {
+		struct  work_task *ptask;
+		ptask = set_task(WORK_Deferred_Child, tag,
+			post_server_periodic_hook, phook);
+		if (!ptask) {
+			log_err(errno, __func__, msg_err_malloc);
+			return;
+		}
+		ptask->wt_aux2 = seq;
+		(void)set_task(WORK_Timed, time_now + phook->freq,
+			run_periodic_hook, phook);
+		return;
+	}
+
 	pid = fork();
 
 	if (pid == -1) {	/* Error on fork */
@@ -6913,6 +7169,7 @@ run_periodic_hook(struct work_task *ptask)
 			log_err(errno, __func__, msg_err_malloc);
 			return;
 		}
+		ptask->wt_aux2 = pid;
 		/* Set a timed task for next occurance of this hook */
 		(void)set_task(WORK_Timed, time_now + phook->freq,
 			run_periodic_hook, phook);
@@ -410,6 +410,9 @@ issue_Drequest(int conn, struct batch_request *request, void (*func)(), struct w
 
 	request->tppcmd_msgid = NULL;
 
+	/* commit pending job saves before another daemon acts on them */
+	(void)job_save_flush();
+
 	if (conn == PBS_LOCAL_CONNECTION) {
 		wt   = WORK_Deferred_Local;
 		request->rq_conn = PBS_LOCAL_CONNECTION;
@@ -37,11 +37,18 @@
  * subject to Altair's trademark licensing policies.
  */
 
+#include <errno.h>
 #include "job.h"
+#include "libutil.h"
+#include "log.h"
 
 /**
  * @brief	Get attribute of job based on given attr index
  *
+ * @par	The job's attributes are held in sparse storage, an attribute the
+ *	job did not use before is given a slot and cleared here.  Getters that
+ *	only read a value use find_jattr() so that they do not add slots.
+ *
  * @param[in] pjob     - pointer to job struct
  * @param[in] attr_idx - attribute index
  *
@@ -51,10 +58,67 @@
  */
 attribute *
 get_jattr(const job *pjob, int attr_idx)
+{
+	attribute *pattr;
+
+	if (pjob == NULL)
+		return NULL;
+	pattr = attr_sparse_get((attr_sparse *)&pjob->ji_wattr, job_attr_def, attr_idx);
+	if (pattr == NULL)
+		log_err(errno, __func__, MALLOC_ERR_MSG);
+	return pattr;
+}
+
+/**
+ * @brief	Find attribute of job based on given attr index, if the job
+ *		uses it.  An attribute that is not used is not set.
+ *
+ * @param[in] pjob     - pointer to job struct
+ * @param[in] attr_idx - attribute index
+ *
+ * @return attribute *
+ * @retval NULL  - the job does not use the attribute
+ * @retval !NULL - pointer to attribute struct
+ */
+static attribute *
+find_jattr(const job *pjob, int attr_idx)
+{
+	return attr_sparse_find(&pjob->ji_wattr, attr_idx);
+}
+
+/**
+ * @brief	Return the index of the next attribute the job uses, to walk
+ *		the job's attributes without giving slots to unused ones:
+ *
+ *		for (i = next_jattr(pjob, -1); i >= 0; i = next_jattr(pjob, i))
+ *
+ * @param[in] pjob     - pointer to job struct
+ * @param[in] attr_idx - attribute index to start after, -1 to start
+ *
+ * @return int
+ * @retval -1   - no more attributes
+ * @retval >= 0 - index of the next attribute
+ */
+int
+next_jattr(const job *pjob, int attr_idx)
+{
+	if (pjob == NULL)
+		return -1;
+	return attr_sparse_next(&pjob->ji_wattr, attr_idx);
+}
+
+/**
+ * @brief	Free all attributes of a job and their storage
+ *
+ * @param[in] pjob - pointer to job struct
+ *
+ * @return void
+ */
+void
+free_jattrs(job *pjob)
 {
 	if (pjob != NULL)
-		return _get_attr_by_idx((attribute *)pjob->ji_wattr, attr_idx);
-	return NULL;
+		attr_sparse_free(&pjob->ji_wattr, job_attr_def);
 }
 
 /**
@@ -113,8 +177,12 @@ check_job_substate(const job *pjob, int substate)
 char
 get_job_state(const job *pjob)
 {
+	attribute *pattr;
+
 	if (pjob != NULL) {
-		return get_attr_c(get_jattr(pjob, JOB_ATR_state));
+		if ((pattr = find_jattr(pjob, JOB_ATR_state)) == NULL)
+			return 0;
+		return get_attr_c(pattr);
 	}
 
 	return JOB_STATE_LTR_UNKNOWN;
@@ -138,7 +206,7 @@ get_job_state_num(const job *pjob)
 	if (pjob == NULL)
 		return -1;
 
-	statec = get_attr_c(get_jattr(pjob, JOB_ATR_state));
+	statec = get_job_state(pjob);
 	if (statec == -1)
 		return -1;
 
@@ -159,9 +227,8 @@ get_job_state_num(const job *pjob)
 long
 get_job_substate(const job *pjob)
 {
-	if (pjob != NULL) {
-		return get_attr_l(get_jattr(pjob, JOB_ATR_substate));
-	}
+	if (pjob != NULL)
+		return get_jattr_long(pjob, JOB_ATR_substate);
 
 	return -1;
 }
@@ -180,7 +247,7 @@ char *
 get_jattr_str(const job *pjob, int attr_idx)
 {
 	if (pjob != NULL)
-		return get_attr_str(get_jattr(pjob, attr_idx));
+		return get_attr_str(find_jattr(pjob, attr_idx));
 
 	return NULL;
 }
@@ -198,8 +265,10 @@ get_jattr_str(const job *pjob, int attr_idx)
 struct array_strings *
 get_jattr_arst(const job *pjob, int attr_idx)
 {
-	if (pjob != NULL)
-		return get_attr_arst(get_jattr(pjob, attr_idx));
+	attribute *pattr;
+
+	if ((pjob != NULL) && ((pattr = find_jattr(pjob, attr_idx)) != NULL))
+		return get_attr_arst(pattr);
 
 	return NULL;
 }
@@ -216,7 +285,9 @@ get_jattr_arst(const job *pjob, int attr_idx)
 pbs_list_head
 get_jattr_list(const job *pjob, int attr_idx)
 {
-	return get_attr_list(get_jattr(pjob, attr_idx));
+	if (pjob == NULL)
+		return get_attr_list(NULL);
+	return get_attr_list(find_jattr(pjob, attr_idx));
 }
 
 /**
@@ -232,8 +303,13 @@ get_jattr_list(const job *pjob, int attr_idx)
 long
 get_jattr_long(const job *pjob, int attr_idx)
 {
-	if (pjob != NULL)
-		return get_attr_l(get_jattr(pjob, attr_idx));
+	attribute *pattr;
+
+	if (pjob != NULL) {
+		if ((pattr = find_jattr(pjob, attr_idx)) == NULL)
+			return 0;
+		return get_attr_l(pattr);
+	}
 
 	return -1;
 }
@@ -251,8 +327,13 @@ get_jattr_long(const job *pjob, int attr_idx)
 long long
 get_jattr_ll(const job *pjob, int attr_idx)
 {
-	if (pjob != NULL)
-		return get_attr_ll(get_jattr(pjob, attr_idx));
+	attribute *pattr;
+
+	if (pjob != NULL) {
+		if ((pattr = find_jattr(pjob, attr_idx)) == NULL)
+			return 0;
+		return get_attr_ll(pattr);
+	}
 
 	return -1;
 }
@@ -270,8 +351,10 @@ get_jattr_ll(const job *pjob, int attr_idx)
 svrattrl *
 get_jattr_usr_encoded(const job *pjob, int attr_idx)
 {
-	if (pjob != NULL)
-		return (get_jattr(pjob, attr_idx))->at_user_encoded;
+	attribute *pattr;
+
+	if ((pjob != NULL) && ((pattr = find_jattr(pjob, attr_idx)) != NULL))
+		return pattr->at_user_encoded;
 
 	return NULL;
 }
@@ -289,8 +372,10 @@ get_jattr_usr_encoded(const job *pjob, int attr_idx)
 svrattrl *
 get_jattr_priv_encoded(const job *pjob, int attr_idx)
 {
-	if (pjob != NULL)
-		return (get_jattr(pjob, attr_idx))->at_priv_encoded;
+	attribute *pattr;
+
+	if ((pjob != NULL) && ((pattr = find_jattr(pjob, attr_idx)) != NULL))
+		return pattr->at_priv_encoded;
 
 	return NULL;
 }
@@ -476,7 +561,7 @@ int
 is_jattr_set(const job *pjob, int attr_idx)
 {
 	if (pjob != NULL)
-		return is_attr_set(get_jattr(pjob, attr_idx));
+		return is_attr_set(find_jattr(pjob, attr_idx));
 
 	return 0;
 }
@@ -492,10 +577,10 @@ is_jattr_set(const job *pjob, int attr_idx)
 void
 mark_jattr_not_set(job *pjob, int attr_idx)
 {
-	if (pjob != NULL) {
-		attribute *attr = get_jattr(pjob, attr_idx);
+	attribute *attr;
+
+	if ((pjob != NULL) && ((attr = find_jattr(pjob, attr_idx)) != NULL))
 		ATR_UNSET(attr);
-	}
 }
 
 /**
@@ -525,5 +610,5 @@ void
 free_jattr(job *pjob, int attr_idx)
 {
 	if (pjob != NULL)
-		free_attr(job_attr_def, get_jattr(pjob, attr_idx), attr_idx);
+		free_attr(job_attr_def, find_jattr(pjob, attr_idx), attr_idx);
 }
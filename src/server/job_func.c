@@ -367,6 +367,7 @@ job_alloc(void)
 	pj->ji_deletehistory = 0;
 	pj->ji_script = NULL;
 	pj->ji_prov_startjob_task = NULL;
+	CLEAR_LINK(pj->ji_saveq);
 #endif
 	pj->ji_qs.ji_jsversion = JSVERSION;
 	pj->ji_momhandle = -1;		/* mark mom connection invalid */
@@ -466,8 +467,6 @@ free_job_work_tasks(job *pj)
 void
 job_free(job *pj)
 {
-	int i;
-
 #ifdef PBS_MOM
 
 #ifdef WIN32
@@ -501,14 +500,14 @@ job_free(job *pj)
 
 	/* remove any malloc working attribute space */
 
-	for (i = 0; i < (int)JOB_ATR_LAST; i++)
-		free_jattr(pj, i);
+	free_jattrs(pj);
 
 #ifndef PBS_MOM
 	{
 		/* Server only */
 		badplace		*bp;
 
+		job_save_forget(pj);
 		free_job_work_tasks(pj);
 
 		/* free any bad destination structs */
@@ -546,6 +545,8 @@ job_free(job *pj)
 	nodes_free(pj);
 	tasks_free(pj);
 	if (pj->ji_resources) {
+		int i;
+
 		for (i = 0; i < pj->ji_numrescs; i++) {
 			free(pj->ji_resources[i].nodehost);
 			pj->ji_resources[i].nodehost = NULL;
@@ -603,8 +604,9 @@ job_free(job *pj)
 
 /**
  * @brief
- * 		job_init_wattr - initialize job working attribute array
- *		set the types and the "unspecified value" flag
+ * 		job_init_wattr - initialize job working attribute storage
+ *		to empty, each attribute gets its type and the "unspecified
+ *		value" flag when the job first uses it, see get_jattr()
  *
  * @see
  * 		job_alloc
@@ -616,11 +618,7 @@ job_free(job *pj)
 static void
 job_init_wattr(job *pj)
 {
-	int	i;
-
-	for (i=0; i<(int)JOB_ATR_LAST; i++) {
-		clear_attr(get_jattr(pj, i), &job_attr_def[i]);
-	}
+	attr_sparse_init(&pj->ji_wattr);
 }
 
 
@@ -1208,6 +1206,9 @@ job_purge(job *pjob)
 #endif
 
 #else
+	/* drop any pending save, the row is about to go away */
+	job_save_forget(pjob);
+
 	/* delete job and dependants from database */
 	obj.pbs_db_obj_type = PBS_DB_JOB;
 	obj.pbs_db_un.pbs_db_job = &dbjob;
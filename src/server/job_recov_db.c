@@ -104,7 +104,7 @@ job_to_db(job *pjob, pbs_db_job_info_t *dbjob)
 	if (check_job_state(pjob, JOB_STATE_LTR_FINISHED))
 		save_all_attrs = 1;
 
-	if ((encode_attr_db(job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, &dbjob->db_attr_list, save_all_attrs)) != 0)
+	if ((encode_attr_db_sparse(job_attr_def, &pjob->ji_wattr, &dbjob->db_attr_list, save_all_attrs)) != 0)
 		return -1;
 
 	if (pjob->newobj) /* object was never saved/loaded before */
@@ -205,7 +205,7 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
 	strcpy(pjob->ji_extended.ji_ext.ji_jid, dbjob->ji_jid);
 	pjob->ji_extended.ji_ext.ji_credtype = dbjob->ji_credtype;
 
-	if ((decode_attr_db(pjob, &dbjob->db_attr_list.attrs, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, JOB_ATR_UNKN)) != 0)
+	if ((decode_attr_db_sparse(pjob, &dbjob->db_attr_list.attrs, job_attr_idx, job_attr_def, &pjob->ji_wattr, JOB_ATR_LAST, JOB_ATR_UNKN)) != 0)
 		return -1;
 
 	compare_obj_hash(&pjob->ji_qs, sizeof(pjob->ji_qs), pjob->qs_hash);
@@ -215,10 +215,158 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
 	return 0;
 }
 
+/*
+ * Journal of jobs whose changes have not reached the database yet.
+ * job_save_db() queues existing jobs here, so a job that is saved several
+ * times within one pass of the main loop is written only once, and
+ * job_save_flush() writes all of them in a single transaction.
+ */
+#define JOB_SAVEQ_MAX 1000	/* flush early once this many jobs are pending */
+#define JOB_SAVE_PENDING(pj) ((pj)->ji_saveq.ll_next != &(pj)->ji_saveq)
+
+static pbs_list_head job_saveq = {&job_saveq, &job_saveq, NULL};
+static int job_saveq_len = 0;
+
+struct job_save_ent {
+	job *js_job;
+	pbs_db_job_info_t js_dbjob;
+	int js_savetype;
+	int js_rc;
+	long js_old_mtime;
+	int js_old_flags;
+};
+
+/**
+ * @brief
+ *		Encode a job for saving and stamp its mtime
+ *
+ * @param[in]	pjob - The job to save
+ * @param[out]	ent  - Save entry to fill in
+ *
+ * @return      int
+ * @retval	 0 - Success
+ * @retval	-1 - Failure
+ *
+ */
+static int
+job_save_prep(job *pjob, struct job_save_ent *ent)
+{
+	ent->js_job = pjob;
+	ent->js_rc = -1;
+	ent->js_old_mtime = get_jattr_long(pjob, JOB_ATR_mtime);
+	ent->js_old_flags = (get_jattr(pjob, JOB_ATR_mtime))->at_flags;
+
+	if ((ent->js_savetype = job_to_db(pjob, &ent->js_dbjob)) == -1)
+		return -1;
+
+	/* update mtime before save, so the same value gets to the DB as well */
+	set_jattr_l_slim(pjob, JOB_ATR_mtime, time_now, SET);
+	return 0;
+}
+
+/**
+ * @brief
+ *		Write an encoded job to the database
+ *
+ * @param[in]	ent - Save entry prepared by job_save_prep
+ *
+ * @return      int
+ * @retval	 0 - Success
+ * @retval	!0 - Failure, see pbs_db_save_obj
+ *
+ */
+static int
+job_save_write(struct job_save_ent *ent)
+{
+	pbs_db_obj_info_t obj;
+
+	obj.pbs_db_obj_type = PBS_DB_JOB;
+	obj.pbs_db_un.pbs_db_job = &ent->js_dbjob;
+
+	return (pbs_db_save_obj(svr_db_conn, &obj, ent->js_savetype));
+}
+
+/**
+ * @brief
+ *		Finish a job save: revert the mtime update and report the
+ *		failure if the save did not succeed.
+ *
+ * @param[in]	ent - Save entry, js_rc holds the result of the save
+ *
+ * @return      Error code
+ * @retval	 0 - Success
+ * @retval	-1 - Failure
+ * @retval	 1 - Jobid clash, retry with new jobid
+ *
+ */
+static int
+job_save_done(struct job_save_ent *ent)
+{
+	job *pjob = ent->js_job;
+	int rc = ent->js_rc;
+	char *conn_db_err = NULL;
+
+	if (rc == 0) {
+		pjob->newobj = 0;
+		return 0;
+	}
+
+	/* revert mtime, flags update */
+	set_jattr_l_slim(pjob, JOB_ATR_mtime, ent->js_old_mtime, SET);
+	(get_jattr(pjob, JOB_ATR_mtime))->at_flags = ent->js_old_flags;
+
+	pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
+	log_errf(PBSE_INTERNAL, __func__, "Failed to save job %s %s", pjob->ji_qs.ji_jobid, conn_db_err? conn_db_err : "");
+	if (conn_db_err) {
+		if ((ent->js_savetype & OBJ_SAVE_NEW) && strstr(conn_db_err, "duplicate key value"))
+			rc = 1;
+		free(conn_db_err);
+	}
+
+	if (rc == -1)
+		panic_stop_db();
+
+	return (rc);
+}
+
+/**
+ * @brief
+ *		Save a job to the database right away
+ *
+ * @param[in]	pjob - The job to save
+ *
+ * @return      Error code
+ * @retval	 0 - Success
+ * @retval	-1 - Failure
+ * @retval	 1 - Jobid clash, retry with new jobid
+ *
+ */
+static int
+job_save_now(job *pjob)
+{
+	struct job_save_ent ent = {0};
+
+	if (job_save_prep(pjob, &ent) == 0)
+		ent.js_rc = job_save_write(&ent);
+	free_db_attr_list(&ent.js_dbjob.db_attr_list);
+
+	return (job_save_done(&ent));
+}
+
+static int job_save_batch(job *self);
+
 /**
  * @brief
  *		Save job to database
  *
+ *		A job that was never saved before is written right away, since
+ *		the caller needs to know whether the jobid is unique. Changes to
+ *		existing jobs are queued on the save journal and written by the
+ *		next job_save_flush(), which runs once per pass of the main loop
+ *		and before anything that makes the change visible outside the
+ *		server: replies to clients, requests to other daemons and jobs
+ *		sent to a MoM or another server.
+ *
  * @param[in]	pjob - The job to save
  *
  * @return      Error code
@@ -230,49 +378,139 @@ db_to_job(job *pjob,  pbs_db_job_info_t *dbjob)
 int
 job_save_db(job *pjob)
 {
-	pbs_db_job_info_t dbjob = {{0}};
-	pbs_db_obj_info_t obj;
-	void *conn = svr_db_conn;
-	int savetype;
-	int rc = -1;
-	int old_mtime, old_flags;
-	char *conn_db_err = NULL;
+	if (pjob->newobj) {
+		job_save_forget(pjob);
+		return (job_save_now(pjob));
+	}
 
-	old_mtime = get_jattr_long(pjob, JOB_ATR_mtime);
-	old_flags = (get_jattr(pjob, JOB_ATR_mtime))->at_flags;
+	if (JOB_SAVE_PENDING(pjob))
+		return 0;	/* already pending, its changes go out together */
 
-	if ((savetype = job_to_db(pjob, &dbjob)) == -1)
-		goto done;
+	append_link(&job_saveq, &pjob->ji_saveq, pjob);
+	if (++job_saveq_len >= JOB_SAVEQ_MAX)
+		return (job_save_batch(pjob));	/* failures of other jobs are theirs */
 
-	obj.pbs_db_obj_type = PBS_DB_JOB;
-	obj.pbs_db_un.pbs_db_job = &dbjob;
-
-	/* update mtime before save, so the same value gets to the DB as well */
-	set_jattr_l_slim(pjob, JOB_ATR_mtime, time_now, SET);
-	if ((rc = pbs_db_save_obj(conn, &obj, savetype)) == 0)
-		pjob->newobj = 0;
+	return 0;
+}
 
-done:
-	free_db_attr_list(&dbjob.db_attr_list);
+/**
+ * @brief
+ *		Remove a job from the save journal, dropping any pending save.
+ *		Called before a job is purged or freed.
+ *
+ * @param[in]	pjob - The job
+ *
+ * @return	void
+ */
+void
+job_save_forget(job *pjob)
+{
+	if (JOB_SAVE_PENDING(pjob)) {
+		delete_link(&pjob->ji_saveq);
+		job_saveq_len--;
+	}
+}
 
-	if (rc != 0) {
-		/* revert mtime, flags update */
-		set_jattr_l_slim(pjob, JOB_ATR_mtime, old_mtime, SET);
-		(get_jattr(pjob, JOB_ATR_mtime))->at_flags = old_flags;
+/**
+ * @brief
+ *		Write all jobs pending on the save journal to the database in
+ *		one transaction.
+ *
+ *		Each job is encoded as it stands now, so the transaction holds a
+ *		consistent snapshot of every pending job. If the transaction
+ *		fails, it is rolled back and the jobs are written one at a time
+ *		so that a single bad row does not hold back the rest. A job that
+ *		fails to save is logged against its own jobid by job_save_done().
+ *
+ * @param[in]	self - job whose result is wanted, or NULL for all jobs
+ *
+ * @return      Error code
+ * @retval	 0 - Success
+ * @retval	-1 - self failed to save, or with self NULL, any job did
+ *
+ */
+static int
+job_save_batch(job *self)
+{
+	struct job_save_ent *ents;
+	job *pjob;
+	int count = 0;
+	int failed = 0;
+	int abort_trx = 0;
+	int rc;
+	int i;
+
+	if (job_saveq_len == 0)
+		return 0;
+
+	ents = calloc(job_saveq_len, sizeof(struct job_save_ent));
+	if (ents == NULL) {
+		log_err(errno, __func__, MALLOC_ERR_MSG);
+		/* fall back to saving one job at a time */
+		while ((pjob = (job *)GET_NEXT(job_saveq)) != NULL) {
+			job_save_forget(pjob);
+			if ((job_save_now(pjob) != 0) && (self == NULL || self == pjob))
+				failed = 1;
+		}
+		return (failed ? -1 : 0);
+	}
 
-		pbs_db_get_errmsg(PBS_DB_ERR, &conn_db_err);
-		log_errf(PBSE_INTERNAL, __func__, "Failed to save job %s %s", pjob->ji_qs.ji_jobid, conn_db_err? conn_db_err : "");
-		if (conn_db_err) {
-			if ((savetype & OBJ_SAVE_NEW) && strstr(conn_db_err, "duplicate key value"))
-				rc = 1;
-			free(conn_db_err);
+	while ((pjob = (job *)GET_NEXT(job_saveq)) != NULL) {
+		job_save_forget(pjob);
+		if (job_save_prep(pjob, &ents[count]) == -1) {
+			free_db_attr_list(&ents[count].js_dbjob.db_attr_list);
+			rc = job_save_done(&ents[count]);
+			if ((rc != 0) && (self == NULL || self == pjob))
+				failed = 1;
+			continue;
 		}
+		count++;
+	}
 
-		if (rc == -1)
-			panic_stop_db();
+	if (pbs_db_begin_trx(svr_db_conn) != 0)
+		abort_trx = 1;
+	for (i = 0; i < count && !abort_trx; i++) {
+		ents[i].js_rc = job_save_write(&ents[i]);
+		if (ents[i].js_rc == -1)
+			abort_trx = 1;	/* the transaction is no longer usable */
+	}
+	if (pbs_db_end_trx(svr_db_conn, !abort_trx) != 0)
+		abort_trx = 1;
+
+	if (abort_trx) {
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_NOTICE, __func__,
+			"Batched save of %d jobs rolled back, saving one at a time", count);
+		for (i = 0; i < count; i++)
+			ents[i].js_rc = job_save_write(&ents[i]);
 	}
 
-	return (rc);
+	for (i = 0; i < count; i++) {
+		free_db_attr_list(&ents[i].js_dbjob.db_attr_list);
+		rc = job_save_done(&ents[i]);
+		if ((rc != 0) && (self == NULL || self == ents[i].js_job))
+			failed = 1;
+	}
+	free(ents);
+
+	return (failed ? -1 : 0);
+}
+
+/**
+ * @brief
+ *		Write all jobs pending on the save journal to the database.
+ *		Runs once per pass of the main loop and before the server makes
+ *		a job change visible outside itself, so what a client, MoM or
+ *		peer server is told has been committed first.
+ *
+ * @return      Error code
+ * @retval	 0 - Success
+ * @retval	-1 - One or more jobs failed to save
+ *
+ */
+int
+job_save_flush(void)
+{
+	return (job_save_batch(NULL));
 }
 
 /**
@@ -464,7 +464,7 @@ send_job_resc_updates(int mtfd)
 	     pjob = GET_NEXT(pjob->ji_alljobs)) {
 		if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_RescUpdt_Rqd) &&
 		    (pjob->ji_qs.ji_svrflags & JOB_SVFLG_RescAssn)) {
-			psvr_ru = init_psvr_ru(pjob, INCR, pjob->ji_wattr[JOB_ATR_exec_vnode].at_val.at_str, FALSE);
+			psvr_ru = init_psvr_ru(pjob, INCR, get_jattr_str(pjob, JOB_ATR_exec_vnode), FALSE);
 			if (psvr_ru) {
 				append_link(&ru_head, &psvr_ru->ru_link, psvr_ru);
 				ct++;
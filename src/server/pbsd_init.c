@@ -721,6 +721,10 @@ pbsd_init(int type)
 		log_err(-1, __func__, "Creating jobs index failed!");
 		return (-1);
 	}
+	if ((alljobs_qrank_idx = pbs_idx_create(0, QRANK_IDX_KEYLEN)) == NULL) {
+		log_err(-1, __func__, "Creating jobs qrank index failed!");
+		return (-1);
+	}
 
 	server.sv_qs.sv_numjobs = 0;
 
@@ -177,6 +177,7 @@ struct batch_request	*saved_takeover_req;
 int svr_unsent_qrun_req = 0;	/* Set to 1 for scheduling unsent qrun requests */
 
 void *jobs_idx;
+void *alljobs_qrank_idx;
 void *queues_idx;
 void *resvs_idx;
 
@@ -473,19 +474,46 @@ clear_exec_vnode()
 	}
 }
 
+/**
+ * @brief
+ * 		child_exited() - complete the work tasks waiting on a child
+ *
+ * 		The list entries for the child are marked as immediate to show the
+ * 		child is gone and svr_delay_entry is incremented to indicate to
+ * 		next_task() to check for them.
+ *
+ * @param[in]	pid	- pid of the child, or the tag of work done by a
+ *			  helper process
+ * @param[in]	statloc	- wait status of the child
+ */
+void
+child_exited(long pid, int statloc)
+{
+	struct work_task *ptask;
+
+	ptask = (struct work_task *)GET_NEXT(task_list_event);
+	while (ptask) {
+		if ((ptask->wt_type == WORK_Deferred_Child) &&
+			(ptask->wt_event == pid)) {
+			ptask->wt_type = WORK_Deferred_Cmp;
+			ptask->wt_aux = (int)statloc;	/* exit status */
+			svr_delay_entry++;	/* see next_task() */
+		}
+		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkevent);
+	}
+}
+
 /**
  * @brief
  * 		reap_child() - reap dead child processes
  *
- * 		Collect child status and add to work list entry for that child.
- * 		The list entry is marked as immediate to show the child is gone and
- * 		svr_delay_entry is incremented to indicate to next_task() to check for it.
+ * 		Collect child status and add to work list entry for that child,
+ * 		see child_exited().
  */
 
 static void
 reap_child(void)
 {
-	struct work_task *ptask;
 	pid_t		  pid;
 	int		  statloc;
 
@@ -503,16 +531,7 @@ reap_child(void)
 			reap_child_flag = 0;
 			return;
 		}
-		ptask = (struct work_task *)GET_NEXT(task_list_event);
-		while (ptask) {
-			if ((ptask->wt_type == WORK_Deferred_Child) &&
-				(ptask->wt_event == pid)) {
-				ptask->wt_type = WORK_Deferred_Cmp;
-				ptask->wt_aux = (int)statloc;	/* exit status */
-				svr_delay_entry++;	/* see next_task() */
-			}
-			ptask = (struct work_task *)GET_NEXT(ptask->wt_linkevent);
-		}
+		child_exited((long)pid, statloc);
 	}
 }
 
@@ -871,7 +890,6 @@ main(int argc, char **argv)
 	CLEAR_HEAD(svr_requests);
 	CLEAR_HEAD(task_list_immed);
 	CLEAR_HEAD(task_list_interleave);
-	CLEAR_HEAD(task_list_timed);
 	CLEAR_HEAD(task_list_event);
 	CLEAR_HEAD(svr_queues);
 	CLEAR_HEAD(svr_alljobs);
@@ -1124,6 +1142,14 @@ main(int argc, char **argv)
 	(void)setvbuf(stderr, NULL, _IOLBF, 0);
 #endif	/* end the ifndef DEBUG */
 
+	/* fork the helper processes while the server is small and single threaded */
+	if (helper_pool_init() != 0)
+		log_err(-1, msg_daemonname, "unable to start the helper processes");
+
+	/* log from a writer thread, now that we are in the background */
+	if (pbs_conf.pbs_log_async && log_async_start() != 0)
+		log_err(-1, msg_daemonname, "unable to start the log writer thread");
+
 	/* Protect from being killed by kernel */
 	daemon_protect(0, PBS_DAEMON_PROTECT_ON);
 
@@ -1220,6 +1246,14 @@ main(int argc, char **argv)
 		return (3);
 	}
 
+	/* threads writing status replies, if PBS_SERVER_REPLY_THREADS is set */
+	if (reply_pool_init() != 0) {
+		log_err(-1, msg_daemonname, "reply_pool_init failed");
+		pbs_python_ext_quick_shutdown_interpreter();
+		stop_db();
+		return (3);
+	}
+
 	/* record the fact that the Secondary is up and active (running) */
 
 	if (pbs_failover_active) {
@@ -1419,6 +1453,9 @@ main(int argc, char **argv)
 		if (reap_child_flag)
 			reap_child();
 
+		/* write out job changes made during this pass in one transaction */
+		(void)job_save_flush();
+
 		/* wait for a request and process it */
 		if (wait_request(waittime, priority_context) != 0) {
 			log_err(-1, msg_daemonname, "wait_requst failed");
@@ -1466,6 +1503,9 @@ main(int argc, char **argv)
 	if (state != SV_STATE_SECIDLE && (shutdown_who & SHUT_WHO_MOM))
 		shutdown_nodes();
 
+	/* write out any job changes still pending */
+	(void)job_save_flush();
+
 	/* if brought up the DB, take it down */
 	stop_db();
 
@@ -1513,6 +1553,7 @@ main(int argc, char **argv)
 	 * SERVER is going to be shutdown, destroy indexes
 	 */
 	pbs_idx_destroy(jobs_idx);
+	pbs_idx_destroy(alljobs_qrank_idx);
 	pbs_idx_destroy(queues_idx);
 	pbs_idx_destroy(resvs_idx);
 
@@ -313,6 +313,19 @@ req_register_sched(conn_t *conn, struct batch_request *preq)
 		rc = PBSE_SCHEDCONNECTED;
 		goto rerr;
 	}
+
+	/*
+	 * A scheduler which understands the binary wire encoding says so in
+	 * the extend field; everything we send it from here on, starting with
+	 * the reply to this request, is binary.  It tells the two apart per
+	 * packet, so the switch needs no further handshake.
+	 */
+	if (preq->rq_extend != NULL && strcmp(preq->rq_extend, EXTEND_OPT_DIS_WIRE_BIN) == 0) {
+		dis_set_wire(conn->cn_sock, DIS_WIRE_BIN);
+		log_eventf(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG, sched->sc_name,
+			"connection %d switched to %s", conn->cn_sock, EXTEND_OPT_DIS_WIRE_BIN);
+	}
+
 	if (sched->sc_primary_conn == -1) {
 		sched->sc_primary_conn = conn->cn_sock;
 		net_add_close_func(conn->cn_sock, scheduler_close);
@@ -785,6 +798,10 @@ dispatch_request(int sfds, struct batch_request *request)
 	int prot = request->prot;
 #ifndef PBS_MOM
 	struct work_task ptask;
+	int rq_type = request->rq_type;
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
 #endif
 
 	if (prot == PROT_TCP) {
@@ -994,6 +1011,7 @@ dispatch_request(int sfds, struct batch_request *request)
 #ifndef PBS_MOM		/* Server Only Functions */
 
 		case PBS_BATCH_StatusJob:
+		case PBS_BATCH_StatusJobPage:
 			if (set_to_non_blocking(conn) == -1) {
 				req_reject(PBSE_SYSTEM, 0, request);
 				close_client(sfds);
@@ -1154,6 +1172,9 @@ dispatch_request(int sfds, struct batch_request *request)
 			close_client(sfds);
 			break;
 	}
+#ifndef PBS_MOM
+	req_latency_note(rq_type, &start);
+#endif
 	return;
 }
 
@@ -1555,6 +1576,9 @@ decode_DIS_RelnodesJob(int sock, struct batch_request *preq)
 void
 free_br(struct batch_request *preq)
 {
+#ifndef PBS_MOM
+	reply_pool_forget(preq);
+#endif
 	delete_link(&preq->rq_link);
 	reply_free(&preq->rq_reply);
 
@@ -1645,6 +1669,7 @@ free_br(struct batch_request *preq)
 			}
 			break;
 		case PBS_BATCH_StatusJob:
+		case PBS_BATCH_StatusJobPage:
 		case PBS_BATCH_StatusQue:
 		case PBS_BATCH_StatusNode:
 		case PBS_BATCH_StatusSvr:
@@ -80,6 +80,7 @@
 #include "pbs_nodes.h"
 #include "pbs_sched.h"
 #include "pbs_idx.h"
+#include "svrfunc.h"
 
 /* Global Data */
 
@@ -119,11 +120,17 @@ que_alloc(char *name)
 	pq->newobj = 1;
 	CLEAR_HEAD(pq->qu_jobs);
 	CLEAR_LINK(pq->qu_link);
+	if ((pq->qu_qrank_idx = pbs_idx_create(0, QRANK_IDX_KEYLEN)) == NULL) {
+		log_err(errno, __func__, "no memory");
+		free(pq);
+		return NULL;
+	}
 
 	snprintf(pq->qu_qs.qu_name, sizeof(pq->qu_qs.qu_name), "%s", name);
 	if (pbs_idx_insert(queues_idx, pq->qu_qs.qu_name, pq) != PBS_IDX_RET_OK) {
 		log_eventf(PBSEVENT_ERROR | PBSEVENT_FORCE, PBS_EVENTCLASS_QUEUE, LOG_ERR,
 			   "Failed to add queue in index %s", pq->qu_qs.qu_name);
+		pbs_idx_destroy(pq->qu_qrank_idx);
 		free(pq);
 		return NULL;
 	}
@@ -166,12 +173,15 @@ que_free(pbs_queue *pq)
 		free(pkvp);
 	}
 
+	drop_stat_cursors(pq);
+
 	/* now free the main structure */
 	server.sv_qs.sv_numque--;
 	delete_link(&pq->qu_link);
 	if (pbs_idx_delete(queues_idx, pq->qu_qs.qu_name) != PBS_IDX_RET_OK)
 		log_eventf(PBSEVENT_ERROR | PBSEVENT_FORCE, PBS_EVENTCLASS_QUEUE, LOG_ERR,
 			   "Failed to delete queue %s from index", pq->qu_qs.qu_name);
+	pbs_idx_destroy(pq->qu_qrank_idx);
 	(void) free(pq);
 }
 
@@ -0,0 +1,676 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	reply_pool.c
+ *
+ * @brief
+ * 		Worker threads which write status replies out to clients, and the
+ * 		per request type latency counters of the server.
+ *
+ *	Hundreds of monitoring clients stating jobs, nodes and reservations
+ *	used to keep the main loop busy writing replies to sockets, stalling
+ *	job submission behind them.  With PBS_SERVER_REPLY_THREADS set in
+ *	pbs.conf, read-only requests from plain clients (status of jobs,
+ *	queues, nodes and reservations, and job selection) are served by a
+ *	worker thread against a snapshot of the server.
+ *
+ *	The snapshot is the reply the request handler builds on the main
+ *	thread, between two mutations: object names and values are copied
+ *	into it and the pre-encoded attribute blobs it refers to are never
+ *	changed once built.  Nothing in it points back at live server
+ *	objects, so the reply is taken from the request and a worker DIS
+ *	encodes it through a channel of its own (see dis_set_thread_chan())
+ *	and writes it out.  The connection stays out of the poll set until
+ *	the worker is done, so the next request on it is read after its
+ *	reply went out, as before; a close of the connection meanwhile is
+ *	put off until then, see close_conn().
+ *
+ *	The request handlers themselves stay on the main thread: they share
+ *	the attribute encode caches and, for jobs, briefly rewrite attributes
+ *	while encoding them.  Scheduler connections are not handed off.
+ *
+ * Functions included are:
+ * 	reply_pool_init()
+ * 	reply_pool_part()
+ * 	reply_pool_send()
+ * 	reply_pool_drain()
+ * 	reply_pool_forget()
+ * 	req_latency_note()
+ * 	req_latency_log()
+ *
+ */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include "libpbs.h"
+#include "dis.h"
+#include "log.h"
+#include "pbs_error.h"
+#include "pbs_internal.h"
+#include "server_limits.h"
+#include "list_link.h"
+#include "net_connect.h"
+#include "attribute.h"
+#include "job.h"
+#include "batch_request.h"
+#include "work_task.h"
+#include "svrfunc.h"
+#include <libutil.h>
+
+extern time_t time_now;
+
+#define REQ_LAT_NTYPES	(PBS_BATCH_StatusJobPage + 1)
+#define REQ_LAT_PERIOD	60	/* seconds between two latency reports */
+
+/* a reply on its way to a client */
+typedef struct reply_out {
+	pbs_list_link	ro_link;
+	struct batch_request *ro_req;	/* request the reply answers */
+	int		ro_sock;	/* connection the reply is for */
+	int		ro_type;	/* request type, for the counters */
+	int		ro_err;		/* errno of a failed write, 0 once sent */
+	struct timespec	ro_start;	/* when the reply was queued */
+	struct batch_reply **ro_parts;	/* the reply and any parts before it */
+	int		ro_nparts;
+	pbs_tcp_chan_t	ro_chan;	/* private copy of the connection's channel */
+	pbs_dis_buf_t	ro_buf;		/* sealed DIS packets, see dis_flush_to() */
+} reply_out;
+
+/* latency of one request type since the last report */
+struct req_latency {
+	unsigned long	rl_count;	/* requests dispatched */
+	double		rl_total;	/* seconds spent on the main thread */
+	double		rl_max;
+	unsigned long	rl_sent;	/* replies written by a worker */
+	double		rl_sent_total;	/* seconds from queued to written */
+	double		rl_sent_max;
+};
+
+static int reply_nthreads = 0;
+static int reply_pipe[2] = {-1, -1};	/* workers wake the main loop */
+static pthread_mutex_t reply_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reply_cond = PTHREAD_COND_INITIALIZER;
+static pbs_list_head reply_queue;	/* replies waiting for a worker */
+static pbs_list_head reply_done;	/* replies written, for the main loop */
+static reply_out *reply_building = NULL; /* parts of the current reply */
+static struct req_latency req_lat[REQ_LAT_NTYPES];
+
+/**
+ * @brief
+ *		Seconds elapsed since a given time.
+ *
+ * @param[in]	start	- CLOCK_MONOTONIC time
+ *
+ * @return	double
+ */
+static double
+elapsed(struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) (now.tv_sec - start->tv_sec) +
+	       (double) (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief
+ *		Free a reply_out.
+ *
+ * @param[in]	ro	- the reply
+ */
+static void
+free_reply_out(reply_out *ro)
+{
+	int i;
+
+	if (ro == NULL)
+		return;
+	if (ro == reply_building)
+		reply_building = NULL;
+	for (i = 0; i < ro->ro_nparts; i++) {
+		reply_free(ro->ro_parts[i]);
+		free(ro->ro_parts[i]);
+	}
+	free(ro->ro_parts);
+	free(ro->ro_chan.writebuf.tdis_data);
+	free(ro->ro_buf.tdis_data);
+	free(ro);
+}
+
+/**
+ * @brief
+ *		DIS encode the parts of a reply into ro_buf.  Runs on a worker
+ *		thread, so it goes through the reply's own channel and not the
+ *		connection table.
+ *
+ * @param[in]	ro	- the reply
+ *
+ * @return	int
+ * @retval	0	- the reply was encoded
+ * @retval	!0	- DIS error
+ */
+static int
+reply_encode(reply_out *ro)
+{
+	int rc = 0;
+	int i;
+
+	dis_set_thread_chan(ro->ro_sock, &ro->ro_chan);
+	for (i = 0; i < ro->ro_nparts && rc == 0; i++) {
+		rc = encode_DIS_reply(ro->ro_sock, ro->ro_parts[i]);
+		if (rc == 0)
+			rc = dis_flush_to(ro->ro_sock, &ro->ro_buf);
+	}
+	dis_set_thread_chan(-1, NULL);
+	return rc;
+}
+
+/**
+ * @brief
+ *		Write a reply to its socket.  Runs on a worker thread, so it only
+ *		touches the socket and the bytes of the reply.  As in
+ *		dis_reply_write(), the whole reply must go out within
+ *		PBS_DIS_TCP_TIMEOUT_REPLY seconds.
+ *
+ * @param[in]	ro	- the reply
+ *
+ * @return	int
+ * @retval	0	- the reply was written
+ * @retval	!0	- errno of the failure, EAGAIN on timeout
+ */
+static int
+reply_write(reply_out *ro)
+{
+	char *pb = ro->ro_buf.tdis_data;
+	size_t left = ro->ro_buf.tdis_len;
+	struct timespec start;
+	struct pollfd pfd;
+	ssize_t n;
+	int wait;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while (left > 0) {
+		n = send(ro->ro_sock, pb, left, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (n > 0) {
+			pb += n;
+			left -= n;
+			continue;
+		}
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK)
+			return errno;
+
+		wait = (int) ((PBS_DIS_TCP_TIMEOUT_REPLY - elapsed(&start)) * 1000);
+		if (wait <= 0)
+			return EAGAIN;
+		pfd.fd = ro->ro_sock;
+		pfd.events = POLLOUT;
+		pfd.revents = 0;
+		n = poll(&pfd, 1, wait);
+		if (n == 0)
+			return EAGAIN;
+		if (n == -1 && errno != EINTR)
+			return errno;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *		Worker thread: encode and write out queued replies and pass them
+ *		back to the main loop through reply_done.
+ *
+ * @param[in]	arg	- unused
+ *
+ * @return	void *	- never returns
+ */
+static void *
+reply_worker(void *arg)
+{
+	sigset_t allsigs;
+	reply_out *ro;
+
+	/* signals are for the main loop */
+	sigfillset(&allsigs);
+	pthread_sigmask(SIG_BLOCK, &allsigs, NULL);
+
+	for (;;) {
+		pthread_mutex_lock(&reply_mutex);
+		while ((ro = (reply_out *) GET_NEXT(reply_queue)) == NULL)
+			pthread_cond_wait(&reply_cond, &reply_mutex);
+		delete_link(&ro->ro_link);
+		pthread_mutex_unlock(&reply_mutex);
+
+		if (reply_encode(ro) != 0)
+			ro->ro_err = EPROTO;
+		else
+			ro->ro_err = reply_write(ro);
+
+		pthread_mutex_lock(&reply_mutex);
+		append_link(&reply_done, &ro->ro_link, ro);
+		pthread_mutex_unlock(&reply_mutex);
+		/* a full pipe already has a wake up in it */
+		while (write(reply_pipe[1], "r", 1) == -1 && errno == EINTR)
+			;
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ *		Finish a reply written by a worker: account for it, and put its
+ *		connection back in the poll set or, if the write failed or the
+ *		connection was closed while the reply was out, close it.
+ *
+ * @param[in]	ro	- the reply, freed here
+ */
+static void
+reply_finish(reply_out *ro)
+{
+	char hn[PBS_MAXHOSTNAME + 1];
+	double secs = elapsed(&ro->ro_start);
+
+	if (ro->ro_type >= 0 && ro->ro_type < REQ_LAT_NTYPES) {
+		req_lat[ro->ro_type].rl_sent++;
+		req_lat[ro->ro_type].rl_sent_total += secs;
+		if (secs > req_lat[ro->ro_type].rl_sent_max)
+			req_lat[ro->ro_type].rl_sent_max = secs;
+	}
+
+	if (ro->ro_err != 0) {
+		if (get_connecthost(ro->ro_sock, hn, PBS_MAXHOSTNAME) == -1)
+			strcpy(hn, "??");
+		log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_REQUEST, LOG_WARNING, __func__,
+			"DIS reply failure, %d, to host %s, errno=%d%s", -1, hn, ro->ro_err,
+			ro->ro_err == EAGAIN ? " write timed out" : "");
+	}
+	/* a held connection can only be closed once it is released */
+	if (release_conn(ro->ro_sock) == -1 || ro->ro_err != 0)
+		close_client(ro->ro_sock);
+	free_reply_out(ro);
+}
+
+/**
+ * @brief
+ *		Read function of the wake up pipe: finish every reply the workers
+ *		have written since the last call.
+ *
+ * @param[in]	fd	- read end of the wake up pipe
+ */
+void
+reply_pool_drain(int fd)
+{
+	char buf[64];
+	pbs_list_head done;
+	reply_out *ro;
+
+	while (read(fd, buf, sizeof(buf)) > 0)
+		;
+
+	CLEAR_HEAD(done);
+	pthread_mutex_lock(&reply_mutex);
+	while ((ro = (reply_out *) GET_NEXT(reply_done)) != NULL) {
+		delete_link(&ro->ro_link);
+		append_link(&done, &ro->ro_link, ro);
+	}
+	pthread_mutex_unlock(&reply_mutex);
+
+	while ((ro = (reply_out *) GET_NEXT(done)) != NULL) {
+		delete_link(&ro->ro_link);
+		reply_finish(ro);
+	}
+}
+
+/**
+ * @brief
+ *		Start the reply workers, PBS_SERVER_REPLY_THREADS of them, and
+ *		the periodic latency report.  With no workers, every reply is
+ *		written by the main thread as before.
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- failure
+ */
+int
+reply_pool_init(void)
+{
+	conn_t *conn;
+	pthread_t tid;
+	pthread_attr_t attr;
+	int i;
+
+	CLEAR_HEAD(reply_queue);
+	CLEAR_HEAD(reply_done);
+	(void) set_task(WORK_Timed, time_now + REQ_LAT_PERIOD, req_latency_log, NULL);
+
+	if (pbs_conf.pbs_server_reply_threads == 0)
+		return 0;
+
+	if (pipe(reply_pipe) == -1) {
+		log_err(errno, __func__, "pipe");
+		return -1;
+	}
+	for (i = 0; i < 2; i++) {
+		(void) fcntl(reply_pipe[i], F_SETFL, fcntl(reply_pipe[i], F_GETFL) | O_NONBLOCK);
+		(void) fcntl(reply_pipe[i], F_SETFD, FD_CLOEXEC);
+	}
+	conn = add_conn(reply_pipe[0], ChildPipe, (pbs_net_t) 0, 0, NULL, reply_pool_drain);
+	if (conn == NULL) {
+		log_err(-1, __func__, "could not add the reply pipe to the connection table");
+		close(reply_pipe[0]);
+		close(reply_pipe[1]);
+		return -1;
+	}
+	conn->cn_authen |= PBS_NET_CONN_AUTHENTICATED | PBS_NET_CONN_NOTIMEOUT;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	for (i = 0; i < (int) pbs_conf.pbs_server_reply_threads; i++) {
+		if (pthread_create(&tid, &attr, reply_worker, NULL) != 0) {
+			log_err(errno, __func__, "could not start a reply thread");
+			break;
+		}
+	}
+	pthread_attr_destroy(&attr);
+	reply_nthreads = i;
+
+	log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__,
+		"%d reply threads started", reply_nthreads);
+	return 0;
+}
+
+/**
+ * @brief
+ *		Can the reply to this request be written by a worker?  Only replies
+ *		to read-only requests from plain clients over TCP are.
+ *
+ * @param[in]	preq	- the request
+ *
+ * @return	int
+ * @retval	1	- yes
+ * @retval	0	- no
+ */
+static int
+reply_pool_eligible(struct batch_request *preq)
+{
+	conn_t *conn;
+
+	if (reply_nthreads == 0 || preq->prot != PROT_TCP ||
+		preq->rq_conn < 0 || preq->rq_parentbr != NULL)
+		return 0;
+
+	switch (preq->rq_type) {
+		case PBS_BATCH_StatusJob:
+		case PBS_BATCH_StatusJobPage:
+		case PBS_BATCH_StatusQue:
+		case PBS_BATCH_StatusNode:
+		case PBS_BATCH_StatusResv:
+		case PBS_BATCH_SelectJobs:
+		case PBS_BATCH_SelStat:
+			break;
+		default:
+			return 0;
+	}
+
+	conn = get_conn(preq->rq_conn);
+	if (conn == NULL || conn->cn_active != FromClientDIS ||
+		conn->cn_origin != CONN_UNKNOWN || conn->cn_prio_flag)
+		return 0;
+	return 1;
+}
+
+/**
+ * @brief
+ *		Take the reply of a request, as it stands, for a worker to encode:
+ *		it is added to the parts already taken for the same request and
+ *		the request is left with an empty reply.
+ *
+ * @param[in]	preq	- the request
+ *
+ * @return	reply_out *	- the reply being built
+ * @retval	NULL	- out of memory, the connection was closed
+ */
+static reply_out *
+reply_pool_take(struct batch_request *preq)
+{
+	reply_out *ro = reply_building;
+	struct batch_reply *part;
+	struct batch_reply **tmp;
+	struct brp_status *pstat;
+	pbs_tcp_chan_t *chan;
+	int sfds = preq->rq_conn;
+
+	if (ro != NULL && (ro->ro_req != preq || ro->ro_sock != sfds)) {
+		free_reply_out(ro);
+		ro = NULL;
+	}
+	if (ro == NULL) {
+		ro = calloc(1, sizeof(reply_out));
+		if (ro == NULL)
+			goto nomem;
+		CLEAR_LINK(ro->ro_link);
+		ro->ro_req = preq;
+		ro->ro_sock = sfds;
+		ro->ro_type = preq->rq_type;
+		DIS_tcp_funcs();
+		if ((chan = transport_get_chan(sfds)) != NULL) {
+			/*
+			 * the security context is only borrowed: nothing else
+			 * uses it while the connection is held, and the close
+			 * which frees it waits for the reply, see close_conn()
+			 */
+			ro->ro_chan.wire = chan->wire;
+			memcpy(ro->ro_chan.auths, chan->auths, sizeof(ro->ro_chan.auths));
+		}
+		reply_building = ro;
+	}
+
+	part = malloc(sizeof(struct batch_reply));
+	tmp = realloc(ro->ro_parts, (ro->ro_nparts + 1) * sizeof(struct batch_reply *));
+	if (part == NULL || tmp == NULL) {
+		free(part);
+		if (tmp != NULL)
+			ro->ro_parts = tmp;
+		free_reply_out(ro);
+		goto nomem;
+	}
+	ro->ro_parts = tmp;
+	ro->ro_parts[ro->ro_nparts++] = part;
+
+	/* move the reply over; a status list head cannot just be copied */
+	*part = preq->rq_reply;
+	if (part->brp_choice == BATCH_REPLY_CHOICE_Status) {
+		CLEAR_HEAD(part->brp_un.brp_status);
+		while ((pstat = (struct brp_status *) GET_NEXT(preq->rq_reply.brp_un.brp_status)) != NULL) {
+			delete_link(&pstat->brp_stlink);
+			append_link(&part->brp_un.brp_status, &pstat->brp_stlink, pstat);
+		}
+	}
+	memset(&preq->rq_reply.brp_un, 0, sizeof(preq->rq_reply.brp_un));
+	preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_NULL;
+	return ro;
+
+nomem:
+	log_err(errno, __func__, MALLOC_ERR_MSG);
+	close_client(sfds);
+	return NULL;
+}
+
+/**
+ * @brief
+ *		Counterpart of reply_send_status_part() for a reply which will be
+ *		sent by a worker: the part is kept with the request until
+ *		reply_pool_send() queues the whole reply.
+ *
+ * @param[in]	preq	- the request
+ *
+ * @return	int
+ * @retval	-1	- not for the workers, send the part directly
+ * @retval	0	- the part was taken
+ * @retval	PBSE_SYSTEM	- failure, the connection was closed
+ */
+int
+reply_pool_part(struct batch_request *preq)
+{
+	if (!reply_pool_eligible(preq))
+		return -1;
+	return (reply_pool_take(preq) == NULL) ? PBSE_SYSTEM : 0;
+}
+
+/**
+ * @brief
+ *		Counterpart of dis_reply_write() for a reply which will be sent by
+ *		a worker: take the reply from the request, take the connection
+ *		out of the poll set and queue the reply.  The caller still frees
+ *		the request.
+ *
+ * @param[in]	preq	- the request
+ *
+ * @return	int
+ * @retval	-1	- not for the workers, write the reply directly
+ * @retval	0	- the reply was queued
+ * @retval	PBSE_SYSTEM	- failure, the connection was closed
+ */
+int
+reply_pool_send(struct batch_request *preq)
+{
+	reply_out *ro;
+
+	if (!reply_pool_eligible(preq))
+		return -1;
+	if ((ro = reply_pool_take(preq)) == NULL)
+		return PBSE_SYSTEM;
+	reply_building = NULL;
+	ro->ro_req = NULL;
+	clock_gettime(CLOCK_MONOTONIC, &ro->ro_start);
+
+	if (hold_conn(ro->ro_sock) == -1) {
+		/* cannot leave it to a worker, send it here */
+		if (reply_encode(ro) != 0)
+			ro->ro_err = EPROTO;
+		else
+			ro->ro_err = reply_write(ro);
+		reply_finish(ro);
+		return 0;
+	}
+
+	pthread_mutex_lock(&reply_mutex);
+	append_link(&reply_queue, &ro->ro_link, ro);
+	pthread_cond_signal(&reply_cond);
+	pthread_mutex_unlock(&reply_mutex);
+	return 0;
+}
+
+/**
+ * @brief
+ *		Drop the parts sealed for a request which is freed without a final
+ *		reply, e.g. because its connection was closed.
+ *
+ * @param[in]	preq	- the request being freed
+ */
+void
+reply_pool_forget(struct batch_request *preq)
+{
+	if (reply_building != NULL && reply_building->ro_req == preq)
+		free_reply_out(reply_building);
+}
+
+/**
+ * @brief
+ *		Account for a request dispatched by the main thread.
+ *
+ * @param[in]	type	- request type
+ * @param[in]	start	- CLOCK_MONOTONIC time the dispatch started
+ */
+void
+req_latency_note(int type, struct timespec *start)
+{
+	double secs;
+
+	if (type < 0 || type >= REQ_LAT_NTYPES)
+		return;
+	secs = elapsed(start);
+	req_lat[type].rl_count++;
+	req_lat[type].rl_total += secs;
+	if (secs > req_lat[type].rl_max)
+		req_lat[type].rl_max = secs;
+}
+
+/**
+ * @brief
+ *		Work task: log the latency of every request type seen since the
+ *		last report, then start counting afresh.
+ *
+ * @param[in]	ptask	- work task
+ */
+void
+req_latency_log(struct work_task *ptask)
+{
+	struct req_latency *rl;
+	int i;
+
+	for (i = 0; i < REQ_LAT_NTYPES; i++) {
+		rl = &req_lat[i];
+		if (rl->rl_count == 0 && rl->rl_sent == 0)
+			continue;
+		log_eventf(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG, "req_latency",
+			"Type %d: %lu dispatched, avg %.6fs max %.6fs; "
+			"%lu replies by threads, avg %.6fs max %.6fs",
+			i, rl->rl_count,
+			rl->rl_count ? rl->rl_total / rl->rl_count : 0.0, rl->rl_max,
+			rl->rl_sent,
+			rl->rl_sent ? rl->rl_sent_total / rl->rl_sent : 0.0, rl->rl_sent_max);
+	}
+	memset(req_lat, 0, sizeof(req_lat));
+	(void) set_task(WORK_Timed, time_now + REQ_LAT_PERIOD, req_latency_log, NULL);
+}
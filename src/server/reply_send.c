@@ -89,6 +89,7 @@ extern char *msg_system;
 extern pbs_list_head task_list_event;
 extern pbs_list_head task_list_immed;
 extern char *resc_in_err;
+extern int job_save_flush(void);
 #endif	/* PBS_MOM */
 
 #ifndef WIN32
@@ -260,7 +261,11 @@ reply_send_status_part(struct batch_request *preq)
 	if (preq->rq_conn >= 0) {
 		struct batch_reply *preply = &preq->rq_reply;
 		preply->brp_is_part = 1;
-		rc = dis_reply_write(preq->rq_conn, preq);
+#ifndef PBS_MOM
+		/* a part for a reply thread is kept until the reply is complete */
+		if ((rc = reply_pool_part(preq)) == -1)
+#endif
+			rc = dis_reply_write(preq->rq_conn, preq);
 		if (rc != PBSE_NONE)
 			return rc;
 		reply_free(&preq->rq_reply);
@@ -316,6 +321,11 @@ reply_send(struct batch_request *request)
 		return 0;
 	}
 
+#ifndef PBS_MOM
+	/* commit pending job saves before the client learns of the change */
+	(void)job_save_flush();
+#endif
+
 	request->rq_reply.brp_is_part = 0;
 
 	/* if this is a child request, just move the error to the parent */
@@ -367,7 +377,11 @@ reply_send(struct batch_request *request)
 		 * Otherwise, the reply is to be sent to a remote client
 		 */
 		if (rc == PBSE_NONE) {
-			rc = dis_reply_write(sfds, request);
+#ifndef PBS_MOM
+			/* status replies may be written out by a reply thread */
+			if ((rc = reply_pool_send(request)) == -1)
+#endif
+				rc = dis_reply_write(sfds, request);
 		}
 	}
 
@@ -438,6 +452,7 @@ reply_free(struct batch_reply *prep)
 	struct brp_select  *pselx;
 	struct batch_deljob_status *pdelstat;
 	struct batch_deljob_status *pdelstatx;
+	int i;
 
 	if (prep->brp_choice == BATCH_REPLY_CHOICE_Text) {
 		if (prep->brp_un.brp_txt.brp_str) {
@@ -459,6 +474,9 @@ reply_free(struct batch_reply *prep)
 		while (pstat) {
 			pstatx = (struct brp_status *)GET_NEXT(pstat->brp_stlink);
 			free_attrlist(&pstat->brp_attr);
+			for (i = 0; i < pstat->brp_nblobs; i++)
+				free_svrattrl_blob(pstat->brp_blobs[i]);
+			free(pstat->brp_blobs);
 			(void)free(pstat);
 			pstat = pstatx;
 		}
@@ -814,7 +814,10 @@ req_deletejob2(struct batch_request *preq, job *pjob)
 					pwtnew->wt_type = pwtold->wt_type;
 					pwtnew->wt_aux = pwtold->wt_aux;
 
-					kill((pid_t) pwtold->wt_event, SIGTERM);
+					/* a send handed to a server helper has */
+					/* a negative tag, not a pid to signal   */
+					if (pwtold->wt_event > 0)
+						kill((pid_t) pwtold->wt_event, SIGTERM);
 					set_job_substate(pjob, JOB_SUBSTATE_ABORT);
 					if (preq->rq_type == PBS_BATCH_DeleteJobList) {
 						/* let the caller know that the deljoblist request needs to be suspended */
@@ -1146,7 +1149,7 @@ req_deleteReservation(struct batch_request *preq)
 	/*Know resc_resv struct exists and requester allowed to remove it*/
 	futuredr = presv->ri_futuredr;
 	presv->ri_futuredr = 0; /*would be non-zero if getting*/
-	/*here from task_list_timed*/
+	/*here from a timed work task*/
 	strcpy(user, preq->rq_user); /*need after request is gone*/
 	strcpy(host, preq->rq_host);
 	perm = preq->rq_perm;
@@ -453,7 +453,14 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 	else
 		allow_unkn = (int)JOB_ATR_UNKN;
 
-	pattr = pjob->ji_wattr;
+	/* the job's attributes are held in sparse storage, take a full copy
+	 * to decode against and to restore them from if an action fails
+	 */
+
+	attr_save = calloc(JOB_ATR_LAST, sizeof(attribute));
+	if (attr_save == NULL)
+		return PBSE_SYSTEM;
+	attr_sparse_copy_out(attr_save, &pjob->ji_wattr, job_attr_def, JOB_ATR_LAST);
 
 	/* call attr_atomic_set to decode and set a copy of the attributes.
 	 * We need 2 copies: 1 for copying to pattr and 1 for calling the action functions
@@ -462,30 +469,25 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 	 */
 
 	newattr = calloc(JOB_ATR_LAST, sizeof(attribute));
-	if (newattr == NULL)
+	if (newattr == NULL) {
+		attr_atomic_kill(attr_save, job_attr_def, JOB_ATR_LAST);
 		return PBSE_SYSTEM;
-	rc = attr_atomic_set(plist, pattr, newattr, job_attr_idx, job_attr_def, JOB_ATR_LAST, allow_unkn, perm, bad);
+	}
+	rc = attr_atomic_set(plist, attr_save, newattr, job_attr_idx, job_attr_def, JOB_ATR_LAST, allow_unkn, perm, bad);
 	if (rc) {
 		attr_atomic_kill(newattr, job_attr_def, JOB_ATR_LAST);
+		attr_atomic_kill(attr_save, job_attr_def, JOB_ATR_LAST);
 		return rc;
 	}
 
 	pre_copy = calloc(JOB_ATR_LAST, sizeof(attribute));
 	if(pre_copy == NULL) {
 		attr_atomic_kill(newattr, job_attr_def, JOB_ATR_LAST);
+		attr_atomic_kill(attr_save, job_attr_def, JOB_ATR_LAST);
 		return PBSE_SYSTEM;
 	}
 	attr_atomic_copy(pre_copy, newattr, job_attr_def, JOB_ATR_LAST);
 
-	attr_save = calloc(JOB_ATR_LAST, sizeof(attribute));
-	if (attr_save == NULL) {
-		attr_atomic_kill(newattr, job_attr_def, JOB_ATR_LAST);
-		attr_atomic_kill(pre_copy, job_attr_def, JOB_ATR_LAST);
-		return PBSE_SYSTEM;
-	}
-
-	attr_atomic_copy(attr_save, pattr, job_attr_def, JOB_ATR_LAST);
-
 	/* If resource limits are being changed ... */
 
 	changed_resc = is_attr_set(&newattr[JOB_ATR_resource]);
@@ -561,7 +563,7 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 		if ((hold_e == NULL) ||
 			((hold_e->al_flags & ATR_VFLAG_HOOK) == 0)) {
 			i = newattr[(int)JOB_ATR_hold].at_val.at_long ^
-				(pattr+(int)JOB_ATR_hold)->at_val.at_long;
+				get_jattr_long(pjob, JOB_ATR_hold);
 			rc = chk_hold_priv(i, perm);
 		}
 	}
@@ -601,16 +603,17 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 			 */
 			if (i == JOB_ATR_accrue_type)
 				continue;
-			free_attr(job_attr_def, &pattr[i], i);
+			pattr = get_jattr(pjob, i);
+			free_attr(job_attr_def, pattr, i);
 			if ((pre_copy[i].at_type == ATR_TYPE_LIST) ||
 				(pre_copy[i].at_type == ATR_TYPE_RESC)) {
 				list_move(&pre_copy[i].at_val.at_list,
-					  &pattr[i].at_val.at_list);
+					  &pattr->at_val.at_list);
 			} else {
-				pattr[i] = pre_copy[i];
+				*pattr = pre_copy[i];
 			}
 			/* ATR_VFLAG_MODCACHE will be included if set */
-			pattr[i].at_flags = pre_copy[i].at_flags;
+			pattr->at_flags = pre_copy[i].at_flags;
 		}
 	}
 
@@ -634,7 +637,7 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 		}
 	}
 	if (rc) {
-		attr_atomic_copy(pjob->ji_wattr, attr_save, job_attr_def, JOB_ATR_LAST);
+		attr_sparse_copy_in(&pjob->ji_wattr, attr_save, job_attr_def, JOB_ATR_LAST);
 		free(pre_copy);
 		attr_atomic_kill(newattr, job_attr_def, JOB_ATR_LAST);
 		attr_atomic_kill(attr_save, job_attr_def, JOB_ATR_LAST);
@@ -644,7 +647,8 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 	/* The action functions may have modified the attributes, need to set them to newattr2 */
 	for (i = 0; i < JOB_ATR_LAST; i++) {
 		if (newattr[i].at_flags & ATR_VFLAG_MODIFY) {
-			free_attr(job_attr_def, &pattr[i], i);
+			pattr = get_jattr(pjob, i);
+			free_attr(job_attr_def, pattr, i);
 			switch (i) {
 				case JOB_ATR_state:
 					newstate = get_attr_c(&newattr[i]);
@@ -659,13 +663,13 @@ modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
 					if ((newattr[i].at_type == ATR_TYPE_LIST) ||
 					    (newattr[i].at_type == ATR_TYPE_RESC)) {
 						list_move(&newattr[i].at_val.at_list,
-							  &pattr[i].at_val.at_list);
+							  &pattr->at_val.at_list);
 					} else {
-						pattr[i] = newattr[i];
+						*pattr = newattr[i];
 					}
 			}
 			/* ATR_VFLAG_MODCACHE will be included if set */
-			pattr[i].at_flags = newattr[i].at_flags;
+			pattr->at_flags = newattr[i].at_flags;
 		}
 	}
 
@@ -1348,7 +1352,7 @@ modify_resv_attr(resc_resv *presv, svrattrl *plist, int perm, int *bad)
 			((newattr[(int)RESV_ATR_userlst].at_flags & ATR_VFLAG_MODIFY) ||
 			(newattr[(int)RESV_ATR_grouplst].at_flags & ATR_VFLAG_MODIFY))) {
 			/* Need to reset execution uid and gid */
-			rc = set_objexid((void *)presv, JOB_OBJECT, newattr);
+			rc = set_objexid((void *)presv, RESC_RESV_OBJECT, newattr);
 		}
 
 	}
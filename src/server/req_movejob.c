@@ -264,6 +264,8 @@ req_orderjob(struct batch_request *req)
 	} else {
 		swap_link(&pjob1->ji_jobque,  &pjob2->ji_jobque);
 		swap_link(&pjob1->ji_alljobs, &pjob2->ji_alljobs);
+		update_job_qrank(pjob1);
+		update_job_qrank(pjob2);
 	}
 
 	/* need to update disk copy of both jobs to save new order */
@@ -802,7 +802,7 @@ req_confirmresv(struct batch_request *preq)
 		return;
 	}
 
-	/* place "Time4resv" task on "task_list_timed" only if this is a
+	/* place "Time4resv" task on the timed task heap only if this is a
 	 * confirmation but not the reconfirmation of a degraded reservation as
 	 * in this case, the reservation had already been confirmed and added to
 	 * the task list before
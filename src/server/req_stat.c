@@ -47,6 +47,12 @@
  * Functions included are:
  * 	do_stat_of_a_job()
  * 	stat_a_jobidname()
+ * 	free_stat_cursor()
+ * 	stat_cursor_by_id()
+ * 	find_stat_cursor()
+ * 	new_stat_cursor()
+ * 	advance_stat_cursors()
+ * 	drop_stat_cursors()
  * 	req_stat_job()
  * 	req_stat_que()
  * 	status_que()
@@ -69,6 +75,8 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 #include "libpbs.h"
 #include <ctype.h>
 #include "server_limits.h"
@@ -111,7 +119,7 @@ extern pbs_license_counts license_counts;
 
 /* Extern Functions */
 
-extern int status_attrib(svrattrl *, void *, attribute_def *, attribute *, int, int, pbs_list_head *, int *);
+extern int status_attrib(svrattrl *, void *, attribute_def *, attribute *, int, int, struct brp_status *, int *);
 extern int status_nodeattrib(svrattrl *, struct pbsnode *, int, int, pbs_list_head *, int *);
 
 extern int svr_chk_histjob(job *);
@@ -121,6 +129,26 @@ extern int svr_chk_histjob(job *);
 
 static int bad;
 
+/*
+ * Server side cursor of a paginated job status (PBS_BATCH_StatusJobPage).
+ * It remembers the next job to return so that the following page can pick
+ * up where the last one ended; advance_stat_cursors() moves it along when
+ * that job leaves the list being walked.
+ */
+typedef struct stat_cursor {
+	pbs_list_link sc_link;
+	int sc_id;			       /* handed to the client in brp_auxcode */
+	job *sc_next;			       /* next job to return */
+	pbs_queue *sc_que;		       /* queue walked, NULL for all jobs */
+	time_t sc_used;			       /* when the cursor was last used */
+	char sc_user[PBS_MAXUSER + 1];	       /* owner of the cursor */
+	char sc_host[PBS_MAXHOSTNAME + 1];
+} stat_cursor;
+
+static pbs_list_head stat_cursors;
+static int stat_cursor_ct;
+static int stat_cursor_lastid;
+
 /* The following private support functions are included */
 
 static int status_que(pbs_queue *, struct batch_request *, pbs_list_head *);
@@ -274,6 +302,177 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
 	}
 }
 
+/**
+ * @brief
+ * 	Unlink and free a job status cursor.
+ *
+ * @param[in] pcur - the cursor
+ */
+static void
+free_stat_cursor(stat_cursor *pcur)
+{
+	delete_link(&pcur->sc_link);
+	stat_cursor_ct--;
+	free(pcur);
+}
+
+/**
+ * @brief
+ * 	Look up a job status cursor by id alone, without checking who owns
+ * 	it and without touching its place in the least recently used order.
+ *
+ * @param[in] id - cursor id
+ *
+ * @return stat_cursor *
+ * @retval the cursor
+ * @retval NULL - no cursor has that id
+ */
+static stat_cursor *
+stat_cursor_by_id(int id)
+{
+	stat_cursor *pcur;
+
+	if (stat_cursors.ll_next == NULL)
+		return NULL;
+
+	for (pcur = (stat_cursor *) GET_NEXT(stat_cursors); pcur; pcur = (stat_cursor *) GET_NEXT(pcur->sc_link))
+		if (pcur->sc_id == id)
+			return pcur;
+	return NULL;
+}
+
+/**
+ * @brief
+ * 	Find the cursor a paginated job status request continues from.
+ *
+ * @par
+ * 	A cursor can only be used by the user and host that created it and
+ * 	only for the same queue (or the whole server).
+ *
+ * @param[in] id   - cursor id sent by the client
+ * @param[in] preq - the stat job batch request
+ * @param[in] pque - queue being statused, NULL for all jobs in the server
+ *
+ * @return stat_cursor *
+ * @retval the cursor
+ * @retval NULL - no such cursor, it expired or belongs to somebody else
+ */
+static stat_cursor *
+find_stat_cursor(int id, struct batch_request *preq, pbs_queue *pque)
+{
+	stat_cursor *pcur;
+
+	if ((pcur = stat_cursor_by_id(id)) == NULL)
+		return NULL;
+	if (pcur->sc_que != pque || strcmp(pcur->sc_user, preq->rq_user) != 0 ||
+	    strcasecmp(pcur->sc_host, preq->rq_host) != 0)
+		return NULL;
+	/* keep the list in least recently used order */
+	delete_link(&pcur->sc_link);
+	append_link(&stat_cursors, &pcur->sc_link, pcur);
+	return pcur;
+}
+
+/**
+ * @brief
+ * 	Create a cursor for a paginated job status request.
+ *
+ * @par
+ * 	Cursors left behind by clients that went away are dropped once idle
+ * 	for STAT_CURSOR_TIMEOUT seconds; if STAT_CURSOR_MAX are still in use
+ * 	the least recently used one is dropped.
+ *
+ * @param[in] preq - the stat job batch request
+ * @param[in] pque - queue being statused, NULL for all jobs in the server
+ *
+ * @return stat_cursor *
+ * @retval the new cursor
+ * @retval NULL - out of memory
+ */
+static stat_cursor *
+new_stat_cursor(struct batch_request *preq, pbs_queue *pque)
+{
+	stat_cursor *pcur;
+	stat_cursor *pnxt;
+
+	if (stat_cursors.ll_next == NULL)
+		CLEAR_HEAD(stat_cursors);
+
+	for (pcur = (stat_cursor *) GET_NEXT(stat_cursors); pcur; pcur = pnxt) {
+		pnxt = (stat_cursor *) GET_NEXT(pcur->sc_link);
+		if (pcur->sc_used + STAT_CURSOR_TIMEOUT < time_now || stat_cursor_ct >= STAT_CURSOR_MAX)
+			free_stat_cursor(pcur);
+	}
+
+	pcur = (stat_cursor *) calloc(1, sizeof(stat_cursor));
+	if (pcur == NULL) {
+		log_err(errno, __func__, "Failed to allocate memory.");
+		return NULL;
+	}
+	CLEAR_LINK(pcur->sc_link);
+	do {
+		if (++stat_cursor_lastid <= 0)
+			stat_cursor_lastid = 1;
+	} while (stat_cursor_by_id(stat_cursor_lastid) != NULL);
+	pcur->sc_id = stat_cursor_lastid;
+	pcur->sc_que = pque;
+	pbs_strncpy(pcur->sc_user, preq->rq_user, sizeof(pcur->sc_user));
+	pbs_strncpy(pcur->sc_host, preq->rq_host, sizeof(pcur->sc_host));
+	append_link(&stat_cursors, &pcur->sc_link, pcur);
+	stat_cursor_ct++;
+
+	return pcur;
+}
+
+/**
+ * @brief
+ * 	Move any job status cursor positioned on a job that is about to be
+ * 	removed from the server (or its queue) on to the following job.
+ *
+ * @param[in] pjob - job being dequeued
+ */
+void
+advance_stat_cursors(job *pjob)
+{
+	stat_cursor *pcur;
+
+	if (stat_cursors.ll_next == NULL)
+		return;
+
+	for (pcur = (stat_cursor *) GET_NEXT(stat_cursors); pcur; pcur = (stat_cursor *) GET_NEXT(pcur->sc_link)) {
+		if (pcur->sc_next != pjob)
+			continue;
+		if (pcur->sc_que != NULL)
+			pcur->sc_next = (job *) GET_NEXT(pjob->ji_jobque);
+		else
+			pcur->sc_next = (job *) GET_NEXT(pjob->ji_alljobs);
+		if (pcur->sc_next == pjob)	/* was not linked after all */
+			pcur->sc_next = NULL;
+	}
+}
+
+/**
+ * @brief
+ * 	Drop the job status cursors walking a queue that is being freed.
+ *
+ * @param[in] pque - the queue
+ */
+void
+drop_stat_cursors(pbs_queue *pque)
+{
+	stat_cursor *pcur;
+	stat_cursor *pnxt;
+
+	if (stat_cursors.ll_next == NULL)
+		return;
+
+	for (pcur = (stat_cursor *) GET_NEXT(stat_cursors); pcur; pcur = pnxt) {
+		pnxt = (stat_cursor *) GET_NEXT(pcur->sc_link);
+		if (pcur->sc_que == pque)
+			free_stat_cursor(pcur);
+	}
+}
+
 /**
  * @brief
  * 	Service the Status Job Request
@@ -286,6 +485,10 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
  * 	job, a subjob or a range of subjobs), a comma separated list of the above,
  * 	a queue name or null (or @...) for all jobs in the Server.
  *
+ * 	For PBS_BATCH_StatusJobPage requests on a queue or the Server at most
+ * 	rq_limit jobs are returned.  If more remain, the id of a cursor to pass
+ * 	with the request for the next page is returned in brp_auxcode.
+ *
  * @param[in/out] preq - pointer to the stat job batch request, reply updated
  *
  * @return void
@@ -304,6 +507,10 @@ req_stat_job(struct batch_request *preq)
 	int rc = 0;
 	int type = 0;
 	char *pnxtjid = NULL;
+	int paged = (preq->rq_type == PBS_BATCH_StatusJobPage);
+	int limit = 0;
+	int njobs = 0;
+	stat_cursor *pcur = NULL;
 
 	/* check for any extended flag in the batch request. 't' for
 	 * the sub jobs. If 'x' is there, then check if the server is
@@ -389,13 +596,27 @@ req_stat_job(struct batch_request *preq)
 		return;
 
 	} else {
-		pjob = (job *) GET_NEXT(type == 2 ? pque->qu_jobs : svr_alljobs);
+		if (paged && preq->rq_ind.rq_status.rq_cursor != 0) {
+			pcur = find_stat_cursor(preq->rq_ind.rq_status.rq_cursor, preq, pque);
+			if (pcur == NULL) {
+				req_reject(PBSE_IVALREQ, 0, preq);
+				return;
+			}
+			pjob = pcur->sc_next;
+		} else
+			pjob = (job *) GET_NEXT(type == 2 ? pque->qu_jobs : svr_alljobs);
+		if (paged)
+			limit = preq->rq_ind.rq_status.rq_limit > 0 ? preq->rq_ind.rq_status.rq_limit : MAX_JOBS_PER_REPLY;
+
 		while (pjob) {
+			if (paged && njobs >= limit)
+				break;
 			rc = do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs);
 			if (rc != PBSE_NONE) {
 				req_reject(rc, bad, preq);
 				return;
 			}
+			njobs++;
 			pjob = (job *) GET_NEXT(type == 2 ? pjob->ji_jobque : pjob->ji_alljobs);
 			if (preply->brp_count >= MAX_JOBS_PER_REPLY && pjob) {
 				rc = reply_send_status_part(preq);
@@ -403,6 +624,21 @@ req_stat_job(struct batch_request *preq)
 					return;
 			}
 		}
+
+		if (paged) {
+			if (pjob == NULL) {
+				if (pcur != NULL)
+					free_stat_cursor(pcur);
+			} else {
+				if (pcur == NULL && (pcur = new_stat_cursor(preq, pque)) == NULL) {
+					req_reject(PBSE_SYSTEM, 0, preq);
+					return;
+				}
+				pcur->sc_next = pjob;
+				pcur->sc_used = time_now;
+				preply->brp_auxcode = pcur->sc_id;
+			}
+		}
 	}
 
 	if (rc && rc != PBSE_PERM)
@@ -527,6 +763,8 @@ status_que(pbs_queue *pque, struct batch_request *preq, pbs_list_head *pstathd)
 	strcpy(pstat->brp_objname, pque->qu_qs.qu_name);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blobs = NULL;
+	pstat->brp_nblobs = 0;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -535,7 +773,7 @@ status_que(pbs_queue *pque, struct batch_request *preq, pbs_list_head *pstathd)
 	bad = 0;
 	pal = (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_attr);
 	if (status_attrib(pal, que_attr_idx, que_attr_def, pque->qu_attr, QA_ATR_LAST,
-		preq->rq_perm, &pstat->brp_attr, &bad))
+		preq->rq_perm, pstat, &bad))
 		rc = PBSE_NOATTR;
 
 	if (is_attr_set(qattr))
@@ -676,6 +914,8 @@ status_node(struct pbsnode *pnode, struct batch_request *preq, pbs_list_head *ps
 	strcpy(pstat->brp_objname, pnode->nd_name);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blobs = NULL;
+	pstat->brp_nblobs = 0;
 
 	/*add this new brp_status structure to the list hanging off*/
 	/*the request's reply substructure                         */
@@ -780,6 +1020,8 @@ req_stat_svr(struct batch_request *preq)
 	strcpy(pstat->brp_objname, server_name);
 	pstat->brp_objtype = MGR_OBJ_SERVER;
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blobs = NULL;
+	pstat->brp_nblobs = 0;
 	append_link(&preply->brp_un.brp_status, &pstat->brp_stlink, pstat);
 	preply->brp_count++;
 
@@ -788,7 +1030,7 @@ req_stat_svr(struct batch_request *preq)
 	bad = 0;
 	pal = (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_attr);
 	if (status_attrib(pal, svr_attr_idx, svr_attr_def, server.sv_attr, SVR_ATR_LAST,
-		preq->rq_perm, &pstat->brp_attr, &bad))
+		preq->rq_perm, pstat, &bad))
 		reply_badattr(PBSE_NOATTR, bad, pal, preq);
 	else
 		reply_send(preq);
@@ -887,6 +1129,8 @@ status_sched(pbs_sched *psched, struct batch_request *preq, pbs_list_head *pstat
 
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blobs = NULL;
+	pstat->brp_nblobs = 0;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -894,7 +1138,7 @@ status_sched(pbs_sched *psched, struct batch_request *preq, pbs_list_head *pstat
 	bad = 0;
 	pal = (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_attr);
 	if (status_attrib(pal, sched_attr_idx, sched_attr_def, psched->sch_attr, SCHED_ATR_LAST,
-		preq->rq_perm, &pstat->brp_attr, &bad))
+		preq->rq_perm, pstat, &bad))
 		reply_badattr(PBSE_NOATTR, bad, pal, preq);
 
 	return (rc);
@@ -1104,6 +1348,8 @@ status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd
 	strcpy(pstat->brp_objname, presv->ri_qs.ri_resvID);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blobs = NULL;
+	pstat->brp_nblobs = 0;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -1113,7 +1359,7 @@ status_resv(resc_resv *presv, struct batch_request *preq, pbs_list_head *pstathd
 	pal = (svrattrl *) GET_NEXT(preq->rq_ind.rq_status.rq_attr);
 
 	if (status_attrib(pal, resv_attr_idx, resv_attr_def, presv->ri_wattr,
-		RESV_ATR_LAST, preq->rq_perm, &pstat->brp_attr, &bad) == 0)
+		RESV_ATR_LAST, preq->rq_perm, pstat, &bad) == 0)
 		return (0);
 	else
 		return (PBSE_NOATTR);
@@ -1157,6 +1403,8 @@ status_resc(struct resource_def *prd, struct batch_request *preq, pbs_list_head
 	strcpy(pstat->brp_objname, prd->rs_name);
 	CLEAR_LINK(pstat->brp_stlink);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blobs = NULL;
+	pstat->brp_nblobs = 0;
 
 	/* add attributes to the status reply */
 	if (private) {
@@ -84,28 +84,70 @@ extern time_t time_now;
 
 /**
  * @brief
- * 		svrcached - either link in (to phead) a cached svrattrl struct which is
- *		pointed to by the attribute, or if the cached struct isn't there or
- *		is out of date, then replace it with a new svrattrl structure.
+ * 		status_attrib_prep - set up for adding attributes to a status reply,
+ *		make room for one blob reference per attribute that may be returned
+ *
+ * @param[in]		pal 	-	specific attributes to status
+ * @param[in]		limit	-	limit on size of def array
+ * @param[in]		priv	-	user-client privilege
+ * @param[in,out]	pstat	-	status reply entry to add the attributes to
+ *
+ * @return	int
+ * @retval	the user-client read privilege
+ */
+static int
+status_attrib_prep(svrattrl *pal, int limit, int priv, struct brp_status *pstat)
+{
+	int   nmax = 0;
+	svrattrl *ps;
+
+	priv &= (ATR_DFLAG_RDACC | ATR_DFLAG_SvWR);  /* user-client privilege */
+	resc_access_perm = priv;  /* pass privilege to encode_resc()	*/
+
+	if (pal) {
+		for (ps = pal; ps; ps = (svrattrl *)GET_NEXT(ps->al_link))
+			nmax++;
+	} else
+		nmax = limit;
+	if ((pstat->brp_blobs == NULL) && (nmax > 0)) {
+		pstat->brp_blobs = malloc(nmax * sizeof(svrattrl_blob *));
+		pstat->brp_nblobs = 0;
+	}
+	return priv;
+}
+
+/**
+ * @brief
+ * 		svrcached - add to the status reply a reference to the shared,
+ *		pre-encoded form of an attribute, building and caching that form
+ *		on the attribute first if it isn't there or is out of date.
+ * @par
+ *		The cached form is an immutable DIS encoded blob, so any number
+ *		of replies, including several entries of the same reply, may hold
+ *		it at once without copying.  Only resource attributes are encoded
+ *		differently for managers/operators and users (see encode_resc()),
+ *		every other attribute has a single blob shared by all clients.
  * @par
- *		When replacing, unlink and delete old one if the reference count goes
- *		to zero.
+ *		If the blob cannot be built, the freshly encoded svrattrl entries
+ *		are linked into the reply instead.
  *
- * @par[in,out]	pat	-	attribute structure which contains a cached svrattrl struct
- * @par[in,out]	phead	-	list of new attribute values
+ * @par[in,out]	pat	-	attribute structure which holds the cached blobs
+ * @par[in,out]	pstat	-	status reply entry to add the attribute to
  * @par[in]	pdef	-	attribute for any parent object.
  *
  * @note
  *	If an attribute has the ATR_DFLAG_HIDDEN flag set, then no
- *	need to obtain and cache new svrattrl values.
+ *	need to obtain and cache new encoded values.
  */
 
 static void
-svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
+svrcached(attribute *pat, struct brp_status *pstat, attribute_def *pdef)
 {
+	svrattrl_blob *pblob;
 	svrattrl *working = NULL;
-	svrattrl *wcopy;
-	svrattrl *encoded;
+	svrattrl *next;
+	pbs_list_head encoded;
+	int priv;
 
 	if (pdef == NULL)
 		return;
@@ -117,63 +159,53 @@ svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
 	if (pat->at_flags & ATR_VFLAG_MODCACHE) {
 		/* free old cache value if the value has changed */
 		free_svrcache(pat);
-		encoded = NULL;
-	} else {
-		if (resc_access_perm & PRIV_READ)
-			encoded = pat->at_priv_encoded;
-		else
-			encoded = pat->at_user_encoded;
 	}
+	if (!is_attr_set(pat))
+		return;
 
-	if ((encoded == NULL) || (pat->at_flags & ATR_VFLAG_MODCACHE)) {
-		if (is_attr_set(pat)) {
-			/* encode and cache new svrattrl structure */
-			(void)pdef->at_encode(pat, phead, pdef->at_name,
-				NULL, ATR_ENCODE_CLIENT, &working);
-			if (resc_access_perm & PRIV_READ)
-				pat->at_priv_encoded = working;
-			else
-				pat->at_user_encoded = working;
-
-			pat->at_flags &= ~ATR_VFLAG_MODCACHE;
-			while (working) {
-				working->al_refct++;	/* incr ref count */
-				working = working->al_sister;
-			}
-		}
-	} else {
-		/* can use the existing cached svrattrl struture */
+	priv = 0;
+	if ((pdef->at_type == ATR_TYPE_RESC) && (resc_access_perm & PRIV_READ))
+		priv = 1;
 
-		working = encoded;
-		if (working->al_refct < 2) {
-			while (working) {
-				CLEAR_LINK(working->al_link);
-				if (phead != NULL)
-					append_link(phead, &working->al_link, working);
-				working->al_refct++;	/* incr ref count */
-				working = working->al_sister;
-			}
-		} else {
-			/*
-			 * already linked in, must make a copy to link
-			 * NOTE: the copy points to the original's data
-			 * so it should be freed by itself, hence the
-			 * ref count is set to 1 and the sisters are not
-			 * linked in
-			 */
+	for (pblob = pat->at_blob; pblob; pblob = pblob->sb_next) {
+		if (pblob->sb_priv == priv)
+			break;
+	}
+
+	if (pblob == NULL) {
+		/* encode and cache a new blob */
+		CLEAR_HEAD(encoded);
+		(void)pdef->at_encode(pat, &encoded, pdef->at_name,
+			NULL, ATR_ENCODE_CLIENT, &working);
+		pat->at_flags &= ~ATR_VFLAG_MODCACHE;
+
+		pblob = encode_svrattrl_blob((svrattrl *)GET_NEXT(encoded), priv);
+		if (pblob != NULL) {
+			pblob->sb_next = pat->at_blob;
+			pat->at_blob = pblob;
+		}
+		if ((pblob == NULL) || (pstat->brp_blobs == NULL)) {
+			/* can't share it, hand the entries to the reply */
+			working = (svrattrl *)GET_NEXT(encoded);
 			while (working) {
-				wcopy = malloc(sizeof(struct svrattrl));
-				if (wcopy) {
-					*wcopy = *working;
-					working = working->al_sister;
-					CLEAR_LINK(wcopy->al_link);
-					if (phead != NULL)
-						append_link(phead, &wcopy->al_link, wcopy);
-					wcopy->al_refct = 1;
-					wcopy->al_sister = NULL;
-				}
+				next = (svrattrl *)GET_NEXT(working->al_link);
+				delete_link(&working->al_link);
+				append_link(&pstat->brp_attr, &working->al_link, working);
+				working = next;
 			}
+			return;
 		}
+		free_attrlist(&encoded);
+	} else if (pstat->brp_blobs == NULL) {
+		/* no room in the reply for a reference, send a private copy */
+		(void)pdef->at_encode(pat, &pstat->brp_attr, pdef->at_name,
+			NULL, ATR_ENCODE_CLIENT, &working);
+		return;
+	}
+
+	if (pblob->sb_count > 0) {
+		pblob->sb_refct++;
+		pstat->brp_blobs[pstat->brp_nblobs++] = pblob;
 	}
 }
 
@@ -186,7 +218,7 @@ svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
  * @param[in,out]	pattr	-	attribute structure
  * @param[in]		limit	-	limit on size of def array
  * @param[in]		priv	-	user-client privilege
- * @param[in,out]	phead	-	pbs_list_head
+ * @param[in,out]	pstat	-	status reply entry to add the attributes to
  * @param[out]		bad 	-	RETURN: index of first bad attribute
  *
  * @return	int
@@ -195,13 +227,12 @@ svrcached(attribute *pat, pbs_list_head *phead, attribute_def *pdef)
  */
 
 int
-status_attrib(svrattrl *pal, void *pidx, attribute_def *padef, attribute *pattr, int limit, int priv, pbs_list_head *phead, int *bad)
+status_attrib(svrattrl *pal, void *pidx, attribute_def *padef, attribute *pattr, int limit, int priv, struct brp_status *pstat, int *bad)
 {
 	int   index;
 	int   nth = 0;
 
-	priv &= (ATR_DFLAG_RDACC | ATR_DFLAG_SvWR);  /* user-client privilege */
-	resc_access_perm = priv;  /* pass privilege to encode_resc()	*/
+	priv = status_attrib_prep(pal, limit, priv, pstat);
 
 	/* for each attribute asked for or for all attributes, add to reply */
 
@@ -214,14 +245,68 @@ status_attrib(svrattrl *pal, void *pidx, attribute_def *padef, attribute *pattr,
 				return (-1);
 			}
 			if ((padef+index)->at_flags & priv) {
-				svrcached(pattr+index, phead, padef+index);
+				svrcached(pattr+index, pstat, padef+index);
 			}
 			pal = (svrattrl *)GET_NEXT(pal->al_link);
 		}
 	} else {	/* non specified, return all readable attributes */
 		for (index = 0; index < limit; index++) {
 			if ((padef+index)->at_flags & priv) {
-				svrcached(pattr+index, phead, padef+index);
+				svrcached(pattr+index, pstat, padef+index);
+			}
+		}
+	}
+	return (0);
+}
+
+/**
+ * @brief
+ * 		status_attrib_sparse - add the attributes held in sparse storage
+ *		to a status reply, see status_attrib().  Attributes that are not
+ *		in use are not set and so are never returned.
+ *
+ * @param[in,out]	pal 	-	specific attributes to status
+ * @param[in]		pidx 	-	Search index of the attribute array
+ * @param[in]		padef	-	attribute definition structure
+ * @param[in,out]	ps	-	sparse attribute storage
+ * @param[in]		limit	-	limit on size of def array
+ * @param[in]		priv	-	user-client privilege
+ * @param[in,out]	pstat	-	status reply entry to add the attributes to
+ * @param[out]		bad 	-	RETURN: index of first bad attribute
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: on error (bad attribute)
+ */
+static int
+status_attrib_sparse(svrattrl *pal, void *pidx, attribute_def *padef, attr_sparse *ps, int limit, int priv, struct brp_status *pstat, int *bad)
+{
+	int   index;
+	int   nth = 0;
+	attribute *pattr;
+
+	priv = status_attrib_prep(pal, limit, priv, pstat);
+
+	/* for each attribute asked for or for all attributes, add to reply */
+
+	if (pal) {		/* client specified certain attributes */
+		while (pal) {
+			++nth;
+			index = find_attr(pidx, padef, pal->al_name);
+			if (index < 0) {
+				*bad = nth;
+				return (-1);
+			}
+			if (((padef+index)->at_flags & priv) &&
+			    ((pattr = attr_sparse_find(ps, index)) != NULL)) {
+				svrcached(pattr, pstat, padef+index);
+			}
+			pal = (svrattrl *)GET_NEXT(pal->al_link);
+		}
+	} else {	/* non specified, return all readable attributes */
+		for (index = attr_sparse_next(ps, -1); (index >= 0) && (index < limit); index = attr_sparse_next(ps, index)) {
+			if ((padef+index)->at_flags & priv) {
+				svrcached(attr_sparse_find(ps, index), pstat, padef+index);
 			}
 		}
 	}
@@ -292,6 +377,8 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 		pstat->brp_objtype = MGR_OBJ_JOB;
 	(void)strcpy(pstat->brp_objname, pjob->ji_qs.ji_jobid);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blobs = NULL;
+	pstat->brp_nblobs = 0;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -309,7 +396,7 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 	/* add attributes to the status reply */
 
 	*bad = 0;
-	if (status_attrib(pal, job_attr_idx, job_attr_def, pjob->ji_wattr, JOB_ATR_LAST, preq->rq_perm, &pstat->brp_attr, bad))
+	if (status_attrib_sparse(pal, job_attr_idx, job_attr_def, &pjob->ji_wattr, JOB_ATR_LAST, preq->rq_perm, pstat, bad))
 		return (PBSE_NOATTR);
 
 	/* reset eligible time, it was calctd on the fly, real calctn only when accrue_type changes */
@@ -403,6 +490,8 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 		pstat->brp_objtype = MGR_OBJ_JOB;
 	(void)strcpy(pstat->brp_objname, objname);
 	CLEAR_HEAD(pstat->brp_attr);
+	pstat->brp_blobs = NULL;
+	pstat->brp_nblobs = 0;
 	append_link(pstathd, &pstat->brp_stlink, pstat);
 	preq->rq_reply.brp_count++;
 
@@ -461,7 +550,7 @@ status_subjob(job *pjob, struct batch_request *preq, svrattrl *pal, int subj, pb
 		mark_jattr_not_set(pjob, JOB_ATR_accrue_type);
 	}
 
-	if (status_attrib(pal, job_attr_idx, job_attr_def, pjob->ji_wattr, limit, preq->rq_perm, &pstat->brp_attr, bad))
+	if (status_attrib_sparse(pal, job_attr_idx, job_attr_def, &pjob->ji_wattr, limit, preq->rq_perm, pstat, bad))
 		rc =  PBSE_NOATTR;
 
 	/* Set the parent state back to what it really is */
@@ -408,6 +408,7 @@ ps_process_discard_job(int c)
 	discard_job(pjob, "Discard request for non local job", 1);
 
 end:
+	free_jattrs(pjob);
 	free(pjob);
 	free(exechost);
 	free(execvnode);
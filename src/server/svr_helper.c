@@ -0,0 +1,636 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file	svr_helper.c
+ *
+ * @brief
+ * 		A pool of small helper processes which do work for the server.
+ *
+ *	Forking the server copies the page tables of the whole server, which
+ *	takes tens of milliseconds once the server has grown to many gigabytes,
+ *	and the main loop waits for every such fork.  The helpers are forked at
+ *	boot, before any jobs, nodes or hooks are loaded, so they stay small.
+ *	The server sends a helper a request over a socket and goes on; the
+ *	helper forks a child of its own to do the work.  A request is either
+ *	a program to run, with its arguments, environment and the data for its
+ *	standard input, or a function of the server with the data it needs;
+ *	the helper is a copy of the server image, so the function is found at
+ *	the same address.  Sending mail, running server periodic hooks through
+ *	pbs_python and sending big jobs are done this way.
+ *
+ *	A request made with a tag has its wait status sent back under the tag
+ *	when the work is done.  Tags are negative, so they never collide with
+ *	pids, and the server waits for them with WORK_Deferred_Child tasks just
+ *	as it waits for its own children.  If a helper dies, the work it had
+ *	in hand is reported as killed.
+ *
+ *	The number of helpers comes from PBS_SERVER_HELPERS in pbs.conf, 0,
+ *	the default, turns them off.  When no helper can take a request, for
+ *	example because its socket is full or it died, the request fails and
+ *	the caller forks as it used to.
+ *
+ * Functions included are:
+ * 	helper_pool_init()
+ * 	helper_exec()
+ * 	helper_call()
+ * 	helper_main()
+ * 	helper_run()
+ * 	helper_reply()
+ * 	helper_lost()
+ *
+ */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "log.h"
+#include "pbs_internal.h"
+#include "server_limits.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "job.h"
+#include "work_task.h"
+#include "net_connect.h"
+#include "svrfunc.h"
+#include <libutil.h>
+
+#define HELPER_MSG_MAX	(128 * 1024)	/* largest request */
+#define HELPER_MAX_STR	64		/* most arguments or environment strings */
+#define HELPER_FAILED	SIGKILL		/* wait status of work that was lost */
+
+/*
+ * header of a request, followed by hm_argc argument strings, hm_envc
+ * environment strings and the input, or by the data for hm_func
+ */
+typedef struct {
+	int (*hm_func)(char *, size_t);	/* function to call, NULL to run argv */
+	long hm_tag;	/* report the wait status under this tag, 0 for none */
+	int hm_argc;	/* number of arguments */
+	int hm_envc;	/* number of environment strings */
+	int hm_len;	/* bytes after the header */
+} helper_msg_t;
+
+/* what a helper sends back for a request with a tag */
+typedef struct {
+	long hr_tag;
+	int hr_status;	/* wait status of the work */
+} helper_reply_t;
+
+extern char *log_file;
+extern char path_log[];
+extern pbs_list_head task_list_event;
+
+static int num_helpers = 0;
+static int *helper_fds = NULL;		/* server end of each helper socket */
+static pid_t *helper_pids = NULL;
+static int next_helper = 0;
+static long helper_seq = 0;		/* makes the tags */
+
+/**
+ * @brief
+ *		Send the wait status of a request back to the server.
+ *
+ * @param[in]	sock	- helper end of the socket to the server
+ * @param[in]	tag	- tag of the request, nothing is sent if 0
+ * @param[in]	status	- wait status of the work
+ */
+static void
+helper_report(int sock, long tag, int status)
+{
+	helper_reply_t rep;
+
+	if (tag == 0)
+		return;
+	rep.hr_tag = tag;
+	rep.hr_status = status;
+	while (send(sock, &rep, sizeof(rep), 0) == -1 && errno == EINTR)
+		;
+}
+
+/**
+ * @brief
+ *		Do the work of a request in a child of the helper, and do not
+ *		wait for it.  The child runs the program or calls the function
+ *		in a process of its own, waits for it and reports its status.
+ *
+ * @param[in]	sock	- helper end of the socket to the server
+ * @param[in]	hdr	- header of the request
+ * @param[in]	argv	- program and its arguments
+ * @param[in]	envp	- strings to add to the environment of the program
+ * @param[in]	input	- data for the standard input of the program, or
+ *			  for the function
+ * @param[in]	len	- length of input
+ */
+static void
+helper_run(int sock, helper_msg_t *hdr, char **argv, char **envp, char *input, size_t len)
+{
+	int pfds[2] = {-1, -1};
+	pid_t pid;
+	int status;
+	int i;
+
+	if (fork() != 0)
+		return;	/* the helper, or the fork failed and the work is lost */
+
+	/* the child, which waits for the work */
+	(void) signal(SIGCHLD, SIG_DFL);
+	if (hdr->hm_func == NULL && pipe(pfds) == -1) {
+		helper_report(sock, hdr->hm_tag, HELPER_FAILED);
+		_exit(1);
+	}
+
+	pid = fork();
+	if (pid == -1) {
+		helper_report(sock, hdr->hm_tag, HELPER_FAILED);
+		_exit(1);
+	}
+	if (pid == 0) {
+		int nullfd;
+
+		close(sock);
+		if (hdr->hm_func != NULL) {
+			(void) log_open(log_file, path_log);
+			_exit(hdr->hm_func(input, len));
+		}
+
+		close(pfds[1]);
+		if (pfds[0] != 0) {
+			(void) dup2(pfds[0], 0);
+			close(pfds[0]);
+		}
+		if ((nullfd = open("/dev/null", O_WRONLY)) != -1) {
+			(void) dup2(nullfd, 1);
+			(void) dup2(nullfd, 2);
+			if (nullfd > 2)
+				close(nullfd);
+		}
+		for (i = 0; envp[i] != NULL; i++)
+			(void) putenv(envp[i]);
+		execv(argv[0], argv);
+		_exit(1);
+	}
+
+	if (hdr->hm_func == NULL) {
+		close(pfds[0]);
+		while (len > 0) {
+			ssize_t rc = write(pfds[1], input, len);
+
+			if (rc == -1) {
+				if (errno == EINTR)
+					continue;
+				break;
+			}
+			input += rc;
+			len -= rc;
+		}
+		close(pfds[1]);
+	}
+
+	while (waitpid(pid, &status, 0) == -1) {
+		if (errno != EINTR) {
+			status = HELPER_FAILED;
+			break;
+		}
+	}
+	helper_report(sock, hdr->hm_tag, status);
+	_exit(0);
+}
+
+/**
+ * @brief
+ *		Body of a helper process: read requests from the server until
+ *		the server closes its end of the socket.
+ *
+ * @param[in]	sock	- helper end of the socket to the server
+ *
+ * @return	never returns
+ */
+static void
+helper_main(int sock)
+{
+	struct sigaction act;
+	sigset_t allsigs;
+	char *buf;
+	char *strs[2 * HELPER_MAX_STR + 2];
+	int fd;
+	int maxfd;
+
+	/* let go of everything inherited from the server, the log included */
+	log_close(0);
+	maxfd = sysconf(_SC_OPEN_MAX);
+	for (fd = 3; fd < maxfd; fd++) {
+		if (fd != sock)
+			(void) close(fd);
+	}
+
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = 0;
+	act.sa_handler = SIG_IGN;
+	(void) sigaction(SIGCHLD, &act, NULL);	/* children are reaped by the system */
+	(void) sigaction(SIGPIPE, &act, NULL);
+	(void) sigaction(SIGHUP, &act, NULL);
+	act.sa_handler = SIG_DFL;
+	(void) sigaction(SIGINT, &act, NULL);
+	(void) sigaction(SIGTERM, &act, NULL);
+	sigemptyset(&allsigs);
+	(void) sigprocmask(SIG_SETMASK, &allsigs, NULL);
+
+	/* Unprotect the helper from being killed by kernel */
+	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
+
+	if ((buf = malloc(HELPER_MSG_MAX + 1)) == NULL)
+		exit(1);
+
+	for (;;) {
+		helper_msg_t hdr;
+		char **argv;
+		char **envp;
+		ssize_t n;
+		char *p;
+		char *end;
+		int nstr;
+		int i;
+
+		n = recv(sock, buf, HELPER_MSG_MAX, 0);
+		if (n == 0)
+			exit(0);	/* the server is gone */
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			exit(1);
+		}
+		if (n < (ssize_t) sizeof(hdr))
+			continue;
+
+		memcpy(&hdr, buf, sizeof(hdr));
+		if (hdr.hm_len != n - (ssize_t) sizeof(hdr) ||
+			hdr.hm_argc < 0 || hdr.hm_argc > HELPER_MAX_STR ||
+			hdr.hm_envc < 0 || hdr.hm_envc > HELPER_MAX_STR ||
+			(hdr.hm_func == NULL && hdr.hm_argc < 1)) {
+			helper_report(sock, hdr.hm_tag, HELPER_FAILED);
+			continue;
+		}
+
+		/* arguments, a NULL, environment, a NULL */
+		buf[n] = '\0';
+		p = buf + sizeof(hdr);
+		end = buf + n;
+		argv = strs;
+		envp = strs + hdr.hm_argc + 1;
+		nstr = hdr.hm_argc + hdr.hm_envc;
+		for (i = 0; i < nstr && p < end; i++) {
+			if (i < hdr.hm_argc)
+				argv[i] = p;
+			else
+				envp[i - hdr.hm_argc] = p;
+			p += strlen(p) + 1;
+		}
+		if (i < nstr || p > end) {
+			helper_report(sock, hdr.hm_tag, HELPER_FAILED);
+			continue;
+		}
+		argv[hdr.hm_argc] = NULL;
+		envp[hdr.hm_envc] = NULL;
+
+		helper_run(sock, &hdr, argv, envp, p, end - p);
+	}
+}
+
+/**
+ * @brief
+ *		A helper is gone: close its socket and report the work it had
+ *		in hand as killed.
+ *
+ * @param[in]	i	- index of the helper
+ */
+static void
+helper_lost(int i)
+{
+	struct work_task *ptask;
+	struct work_task *pnext;
+
+	log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_WARNING, __func__,
+		"helper process %d is gone", helper_pids[i]);
+	close_conn(helper_fds[i]);
+	helper_fds[i] = -1;
+
+	for (ptask = (struct work_task *) GET_NEXT(task_list_event); ptask; ptask = pnext) {
+		pnext = (struct work_task *) GET_NEXT(ptask->wt_linkevent);
+		if (ptask->wt_type == WORK_Deferred_Child && ptask->wt_event < 0 &&
+			(-ptask->wt_event - 1) % num_helpers == i)
+			child_exited(ptask->wt_event, HELPER_FAILED);
+	}
+}
+
+/**
+ * @brief
+ *		Read the wait status of finished requests from a helper and
+ *		complete the tasks waiting on them.  Called from the main loop
+ *		when the helper socket is readable.
+ *
+ * @param[in]	fd	- server end of the helper socket
+ */
+static void
+helper_reply(int fd)
+{
+	helper_reply_t rep;
+	ssize_t n;
+	int i;
+
+	for (;;) {
+		n = recv(fd, &rep, sizeof(rep), 0);
+		if (n == (ssize_t) sizeof(rep)) {
+			child_exited(rep.hr_tag, rep.hr_status);
+			continue;
+		}
+		if (n > 0)
+			continue;	/* not a reply, drop it */
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return;
+		break;
+	}
+
+	for (i = 0; i < num_helpers; i++) {
+		if (helper_fds[i] == fd) {
+			helper_lost(i);
+			return;
+		}
+	}
+	close_conn(fd);
+}
+
+/**
+ * @brief
+ *		Fork the helper processes, PBS_SERVER_HELPERS of them.  Called
+ *		once at boot, after the network is initialized, while the server
+ *		is still small and has no other threads.
+ *
+ * @return	int
+ * @retval	0	- success, even if fewer helpers could be started
+ * @retval	-1	- failure
+ */
+int
+helper_pool_init(void)
+{
+	int n = (int) pbs_conf.pbs_server_helpers;
+	conn_t *conn;
+	int sv[2];
+	pid_t pid;
+	int i;
+
+	if (n == 0)
+		return 0;
+
+	helper_fds = calloc(n, sizeof(int));
+	helper_pids = calloc(n, sizeof(pid_t));
+	if (helper_fds == NULL || helper_pids == NULL) {
+		log_err(errno, __func__, MALLOC_ERR_MSG);
+		free(helper_fds);
+		free(helper_pids);
+		helper_fds = NULL;
+		helper_pids = NULL;
+		return -1;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) == -1) {
+			log_err(errno, __func__, "socketpair");
+			break;
+		}
+		pid = fork();
+		if (pid == -1) {
+			log_err(errno, __func__, "fork failed");
+			close(sv[0]);
+			close(sv[1]);
+			break;
+		}
+		if (pid == 0) {
+			close(sv[0]);
+			helper_main(sv[1]);
+		}
+
+		close(sv[1]);
+		(void) fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK);
+		(void) fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+		conn = add_conn(sv[0], ChildPipe, (pbs_net_t) 0, 0, NULL, helper_reply);
+		if (conn == NULL) {
+			log_err(-1, __func__, "could not add a helper socket to the connection table");
+			close(sv[0]);
+			break;	/* the helper exits when it sees the socket close */
+		}
+		conn->cn_authen |= PBS_NET_CONN_AUTHENTICATED | PBS_NET_CONN_NOTIMEOUT;
+		helper_fds[i] = sv[0];
+		helper_pids[i] = pid;
+	}
+	num_helpers = i;
+
+	log_eventf(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, __func__,
+		"%d helper processes started", num_helpers);
+	return 0;
+}
+
+/**
+ * @brief
+ *		Hand a request to the next helper that takes it.
+ *
+ * @param[in]	buf	- the request, header first
+ * @param[in]	size	- size of the request
+ * @param[out]	tag	- if not NULL, the tag the wait status will come
+ *			  back under
+ *
+ * @return	int
+ * @retval	0	- a helper took the request
+ * @retval	-1	- no helper could take it
+ */
+static int
+helper_send(char *buf, size_t size, long *tag)
+{
+	helper_msg_t *hdr = (helper_msg_t *) buf;
+	int tries;
+	int i;
+
+	for (tries = 0; tries < num_helpers; tries++) {
+		i = next_helper;
+		next_helper = (next_helper + 1) % num_helpers;
+		if (helper_fds[i] == -1)
+			continue;
+
+		if (tag != NULL) {
+			if (helper_seq >= INT_MAX / num_helpers - 1)
+				helper_seq = 0;
+			hdr->hm_tag = -(helper_seq * num_helpers + i + 1);
+		}
+		if (send(helper_fds[i], buf, size, 0) == (ssize_t) size) {
+			if (tag != NULL) {
+				helper_seq++;
+				*tag = hdr->hm_tag;
+			}
+			return 0;
+		}
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+			continue;	/* busy, try the next one */
+
+		helper_lost(i);
+	}
+	return -1;
+}
+
+/**
+ * @brief
+ *		Have a helper process run a program, so the server need not fork.
+ *
+ * @param[in]	argv	- program, by absolute path, and its arguments
+ * @param[in]	envp	- "name=value" strings to add to the environment of
+ *			  the program, may be NULL
+ * @param[in]	input	- data for the standard input of the program, may be NULL
+ * @param[in]	len	- length of input
+ * @param[out]	tag	- if not NULL, the program's wait status is reported
+ *			  under this tag, see child_exited()
+ *
+ * @return	int
+ * @retval	0	- a helper took the request
+ * @retval	-1	- no helper could take it, the caller must run the program
+ */
+int
+helper_exec(char **argv, char **envp, char *input, size_t len, long *tag)
+{
+	helper_msg_t hdr;
+	size_t size = sizeof(hdr);
+	char *buf;
+	char *p;
+	int argc;
+	int envc = 0;
+	int i;
+	int rc;
+
+	if (num_helpers == 0)
+		return -1;
+
+	for (argc = 0; argv[argc] != NULL; argc++)
+		size += strlen(argv[argc]) + 1;
+	if (envp != NULL) {
+		for (envc = 0; envp[envc] != NULL; envc++)
+			size += strlen(envp[envc]) + 1;
+	}
+	size += len;
+	if (size > HELPER_MSG_MAX || argc > HELPER_MAX_STR || envc > HELPER_MAX_STR)
+		return -1;
+
+	if ((buf = malloc(size)) == NULL) {
+		log_err(errno, __func__, MALLOC_ERR_MSG);
+		return -1;
+	}
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.hm_argc = argc;
+	hdr.hm_envc = envc;
+	hdr.hm_len = size - sizeof(hdr);
+	memcpy(buf, &hdr, sizeof(hdr));
+	p = buf + sizeof(hdr);
+	for (i = 0; i < argc; i++) {
+		strcpy(p, argv[i]);
+		p += strlen(argv[i]) + 1;
+	}
+	for (i = 0; i < envc; i++) {
+		strcpy(p, envp[i]);
+		p += strlen(envp[i]) + 1;
+	}
+	if (len > 0)
+		memcpy(p, input, len);
+
+	rc = helper_send(buf, size, tag);
+	free(buf);
+	return rc;
+}
+
+/**
+ * @brief
+ *		Have a helper process call a function of the server, in a child
+ *		of its own, so the server need not fork.  The function gets a
+ *		copy of the data and its return value is the exit status of the
+ *		child; it must need nothing of the server but the data, as the
+ *		helper was forked at boot.
+ *
+ * @param[in]	func	- function to call
+ * @param[in]	data	- data for the function
+ * @param[in]	len	- length of data
+ * @param[out]	tag	- if not NULL, the wait status of the child is
+ *			  reported under this tag, see child_exited()
+ *
+ * @return	int
+ * @retval	0	- a helper took the request
+ * @retval	-1	- no helper could take it, the caller must do the work
+ */
+int
+helper_call(int (*func)(char *, size_t), char *data, size_t len, long *tag)
+{
+	helper_msg_t hdr;
+	size_t size = sizeof(hdr) + len;
+	char *buf;
+	int rc;
+
+	if (num_helpers == 0 || size > HELPER_MSG_MAX)
+		return -1;
+
+	if ((buf = malloc(size)) == NULL) {
+		log_err(errno, __func__, MALLOC_ERR_MSG);
+		return -1;
+	}
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.hm_func = func;
+	hdr.hm_len = len;
+	memcpy(buf, &hdr, sizeof(hdr));
+	if (len > 0)
+		memcpy(buf + sizeof(hdr), data, len);
+
+	rc = helper_send(buf, size, tag);
+	free(buf);
+	return rc;
+}
@@ -51,6 +51,8 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 #include <errno.h>
 #include <string.h>
 #include <ctype.h>
@@ -149,6 +151,162 @@ extern void free_job_work_tasks(job *);
 static void correct_ct(pbs_queue *);
 #endif 	/* NDEBUG */
 
+/**
+ * @brief
+ * 		build the key a job is filed under in a qrank index
+ *
+ * @par
+ *		The key is the queue rank followed by the job pointer, both
+ *		big-endian so that a plain memcmp() orders the keys by rank
+ *		(the sign bit of the rank is flipped to make it unsigned) and
+ *		jobs with the same rank remain distinct.
+ *
+ * @param[out]	key	-	buffer of QRANK_IDX_KEYLEN bytes
+ * @param[in]	rank	-	queue rank
+ * @param[in]	pjob	-	the job, NULL to build a lower bound for rank
+ */
+static void
+make_qrank_key(unsigned char *key, long long rank, job *pjob)
+{
+	unsigned long long urank;
+	uintptr_t uptr;
+	int i;
+
+	urank = (unsigned long long) rank ^ (1ULL << 63);
+	for (i = sizeof(long long) - 1; i >= 0; i--) {
+		key[i] = urank & 0xff;
+		urank >>= 8;
+	}
+	uptr = (uintptr_t) pjob;
+	for (i = sizeof(void *) - 1; i >= 0; i--) {
+		key[sizeof(long long) + i] = uptr & 0xff;
+		uptr >>= 8;
+	}
+}
+
+/**
+ * @brief
+ * 		file a job in a qrank index under the rank in ji_qrank_key
+ *
+ * @param[in]	idx	-	qrank index
+ * @param[in]	pjob	-	job to add
+ *
+ * @return	int
+ * @retval	PBS_IDX_RET_OK	: success
+ * @retval	PBS_IDX_RET_FAIL	: failure
+ */
+static int
+qrank_idx_insert(void *idx, job *pjob)
+{
+	unsigned char key[QRANK_IDX_KEYLEN];
+
+	make_qrank_key(key, pjob->ji_qrank_key, pjob);
+	return pbs_idx_insert(idx, key, pjob);
+}
+
+/**
+ * @brief
+ * 		remove a job from a qrank index
+ *
+ * @param[in]	idx	-	qrank index
+ * @param[in]	pjob	-	job to remove
+ */
+static void
+qrank_idx_delete(void *idx, job *pjob)
+{
+	unsigned char key[QRANK_IDX_KEYLEN];
+
+	make_qrank_key(key, pjob->ji_qrank_key, pjob);
+	(void) pbs_idx_delete(idx, key);
+}
+
+/**
+ * @brief
+ * 		find the job a new job of the given rank must be linked in front of
+ *
+ * @par
+ *		That is the first job in the index whose rank is strictly greater
+ *		than rank, so that jobs of equal rank stay in the order they were
+ *		enqueued in.  The caller has already checked the tail of the list,
+ *		which covers the common case of a job newer than all others.
+ *
+ * @param[in]	idx	-	qrank index
+ * @param[in]	rank	-	queue rank of the new job
+ *
+ * @return	job *
+ * @retval	job to link in front of
+ * @retval	NULL	: append to the end of the list
+ */
+static job *
+find_qrank_next(void *idx, long long rank)
+{
+	unsigned char key[QRANK_IDX_KEYLEN];
+	job *pjnext = NULL;
+
+	if (rank == LLONG_MAX)
+		return NULL;
+
+	make_qrank_key(key, rank + 1, NULL);
+	if (pbs_idx_find_ge(idx, key, (void **) &pjnext) != PBS_IDX_RET_OK)
+		return NULL;
+	return pjnext;
+}
+
+/**
+ * @brief
+ * 		is the job linked into svr_alljobs?
+ *
+ * @par
+ *		On the server a job is in jobs_idx exactly while it is in
+ *		svr_alljobs, so this avoids walking the whole list.
+ *
+ * @param[in]	pjob	-	the job
+ *
+ * @return	int
+ * @retval	1	: job is in svr_alljobs
+ * @retval	0	: it is not
+ */
+static int
+is_job_in_alljobs(job *pjob)
+{
+	char *jid = pjob->ji_qs.ji_jobid;
+	void *pdata = NULL;
+
+	if (pbs_idx_find(jobs_idx, (void **) &jid, &pdata, NULL) != PBS_IDX_RET_OK)
+		return 0;
+	return pdata == (void *) pjob;
+}
+
+/**
+ * @brief
+ * 		refile an enqueued job in the qrank indices after its queue rank
+ *		was changed in place, e.g. when two jobs swap positions in the
+ *		same queue.  The caller is responsible for the list links.
+ *
+ * @param[in]	pjob	-	the job
+ */
+void
+update_job_qrank(job *pjob)
+{
+	int in_alljobs;
+	int in_queue;
+
+	in_alljobs = is_job_in_alljobs(pjob);
+	in_queue = pjob->ji_qhdr != NULL && pjob->ji_jobque.ll_next != &pjob->ji_jobque;
+
+	if (in_alljobs)
+		qrank_idx_delete(alljobs_qrank_idx, pjob);
+	if (in_queue)
+		qrank_idx_delete(pjob->ji_qhdr->qu_qrank_idx, pjob);
+
+	pjob->ji_qrank_key = get_jattr_ll(pjob, JOB_ATR_qrank);
+
+	if (in_alljobs && qrank_idx_insert(alljobs_qrank_idx, pjob) != PBS_IDX_RET_OK)
+		log_joberr(PBSE_INTERNAL, __func__, "Failed add job in qrank index", pjob->ji_qs.ji_jobid);
+	if (in_queue && qrank_idx_insert(pjob->ji_qhdr->qu_qrank_idx, pjob) != PBS_IDX_RET_OK)
+		log_joberr(PBSE_INTERNAL, __func__, "Failed add job in queue qrank index", pjob->ji_qs.ji_jobid);
+}
+
 /**
  * @brief
  * 		clear the default resource from structures
@@ -208,6 +366,8 @@ int
 svr_enquejob(job *pjob, char *selectspec)
 {
 	job *pjcur;
+	job *pjnext;
+	long long rank;
 	pbs_queue *pque;
 	int rc;
 	pbs_sched *psched;
@@ -229,11 +389,17 @@ svr_enquejob(job *pjob, char *selectspec)
 		 */
 		if ((check_job_state(pjob, JOB_STATE_LTR_MOVED)) ||
 			(check_job_state(pjob, JOB_STATE_LTR_FINISHED))) {
-			if (is_linked(&svr_alljobs, &pjob->ji_alljobs) == 0) {
+			if (!is_job_in_alljobs(pjob)) {
 				if (pbs_idx_insert(jobs_idx, pjob->ji_qs.ji_jobid, pjob) != PBS_IDX_RET_OK) {
 					log_joberr(PBSE_INTERNAL, __func__, "Failed add history job in index", pjob->ji_qs.ji_jobid);
 					return PBSE_INTERNAL;
 				}
+				pjob->ji_qrank_key = get_jattr_ll(pjob, JOB_ATR_qrank);
+				if (qrank_idx_insert(alljobs_qrank_idx, pjob) != PBS_IDX_RET_OK) {
+					log_joberr(PBSE_INTERNAL, __func__, "Failed add history job in qrank index", pjob->ji_qs.ji_jobid);
+					(void) pbs_idx_delete(jobs_idx, pjob->ji_qs.ji_jobid);
+					return PBSE_INTERNAL;
+				}
 				append_link(&svr_alljobs, &pjob->ji_alljobs, pjob);
 			}
 			server.sv_qs.sv_numjobs++;
@@ -259,23 +425,36 @@ svr_enquejob(job *pjob, char *selectspec)
 		log_joberr(PBSE_INTERNAL, __func__, "Failed add job in index", pjob->ji_qs.ji_jobid);
 		return PBSE_INTERNAL;
 	}
-
-	pjcur = (job *)GET_PRIOR(svr_alljobs);
-	while (pjcur) {
-		if (get_jattr_ll(pjob, JOB_ATR_qrank) >= get_jattr_ll(pjcur, JOB_ATR_qrank))
-			break;
-		pjcur = (job *)GET_PRIOR(pjcur->ji_alljobs);
+	rank = get_jattr_ll(pjob, JOB_ATR_qrank);
+	pjob->ji_qrank_key = rank;
+	if (qrank_idx_insert(alljobs_qrank_idx, pjob) != PBS_IDX_RET_OK) {
+		log_joberr(PBSE_INTERNAL, __func__, "Failed add job in qrank index", pjob->ji_qs.ji_jobid);
+		(void) pbs_idx_delete(jobs_idx, pjob->ji_qs.ji_jobid);
+		return PBSE_INTERNAL;
 	}
-	if (pjcur == 0) {
-		/* link first in server's list */
-		insert_link(&svr_alljobs, &pjob->ji_alljobs, pjob,
-			LINK_INSET_AFTER);
-	} else {
-		/* link after 'current' job in server's list */
-		insert_link(&pjcur->ji_alljobs, &pjob->ji_alljobs, pjob,
-			LINK_INSET_AFTER);
+	if (qrank_idx_insert(pque->qu_qrank_idx, pjob) != PBS_IDX_RET_OK) {
+		log_joberr(PBSE_INTERNAL, __func__, "Failed add job in queue qrank index", pjob->ji_qs.ji_jobid);
+		qrank_idx_delete(alljobs_qrank_idx, pjob);
+		(void) pbs_idx_delete(jobs_idx, pjob->ji_qs.ji_jobid);
+		return PBSE_INTERNAL;
 	}
 
+	/*
+	 * Place into the server's list in order of queue rank.  New jobs and
+	 * jobs recovered at startup (which come back from the database
+	 * already sorted by rank) are never older than the last job, so only
+	 * go to the index when the job really belongs in the middle.
+	 */
+	pjnext = NULL;
+	pjcur = (job *)GET_PRIOR(svr_alljobs);
+	if (pjcur != NULL && rank < get_jattr_ll(pjcur, JOB_ATR_qrank))
+		pjnext = find_qrank_next(alljobs_qrank_idx, rank);
+	if (pjnext == NULL)
+		append_link(&svr_alljobs, &pjob->ji_alljobs, pjob);
+	else
+		insert_link(&pjnext->ji_alljobs, &pjob->ji_alljobs, pjob,
+			LINK_INSET_BEFORE);
+
 	server.sv_qs.sv_numjobs++;
 	if (state_num != -1)
 		server.sv_jobstates[state_num]++;
@@ -284,21 +463,15 @@ svr_enquejob(job *pjob, char *selectspec)
 
 	pjob->ji_qhdr = pque;
 
+	pjnext = NULL;
 	pjcur = (job *)GET_PRIOR(pque->qu_jobs);
-	while (pjcur) {
-		if (get_jattr_ll(pjob, JOB_ATR_qrank) >= get_jattr_ll(pjcur, JOB_ATR_qrank))
-			break;
-		pjcur = (job *)GET_PRIOR(pjcur->ji_jobque);
-	}
-	if (pjcur == 0) {
-		/* link first in list */
-		insert_link(&pque->qu_jobs, &pjob->ji_jobque, pjob,
-			LINK_INSET_AFTER);
-	} else {
-		/* link after 'current' job in list */
-		insert_link(&pjcur->ji_jobque, &pjob->ji_jobque, pjob,
-			LINK_INSET_AFTER);
-	}
+	if (pjcur != NULL && rank < get_jattr_ll(pjcur, JOB_ATR_qrank))
+		pjnext = find_qrank_next(pque->qu_qrank_idx, rank);
+	if (pjnext == NULL)
+		append_link(&pque->qu_jobs, &pjob->ji_jobque, pjob);
+	else
+		insert_link(&pjnext->ji_jobque, &pjob->ji_jobque, pjob,
+			LINK_INSET_BEFORE);
 
 	/* update counts: queue and queue by state */
 
@@ -438,12 +611,16 @@ svr_dequejob(job *pjob)
 	pbs_queue *pque;
 	int state_num;
 
+	/* move any paginated job status past this job before unlinking it */
+	advance_stat_cursors(pjob);
+
 	/* remove job from server's all job list and reduce server counts */
 
-	if (is_linked(&svr_alljobs, &pjob->ji_alljobs)) {
+	if (is_job_in_alljobs(pjob)) {
 		int state_num;
 
 		delete_link(&pjob->ji_alljobs);
+		qrank_idx_delete(alljobs_qrank_idx, pjob);
 		delete_link(&pjob->ji_unlicjobs);
 		if (pbs_idx_delete(jobs_idx, pjob->ji_qs.ji_jobid) != PBS_IDX_RET_OK)
 			log_joberr(PBSE_INTERNAL, __func__, "Failed to delete job from index", pjob->ji_qs.ji_jobid);
@@ -463,8 +640,10 @@ svr_dequejob(job *pjob)
 				pjob->ji_etlimit_decr_queued ? ETLIM_ACC_ALL_MAX : ETLIM_ACC_ALL);
 
 
-		if (is_linked(&pque->qu_jobs, &pjob->ji_jobque)) {
+		/* on the server ji_jobque only ever links a job into its queue */
+		if (pjob->ji_jobque.ll_next != &pjob->ji_jobque) {
 			delete_link(&pjob->ji_jobque);
+			qrank_idx_delete(pque->qu_qrank_idx, pjob);
 			if (--pque->qu_numjobs < 0)
 				bad_ct = 1;
 
@@ -1049,7 +1228,7 @@ svr_chkque(job *pjob, pbs_queue *pque, char *hostname, int mtype)
 	/* if not already set, set up a uid/gid/name */
 
 	if (!is_jattr_set(pjob, JOB_ATR_euser) || !is_jattr_set(pjob, JOB_ATR_egroup)) {
-		if ((i = set_objexid((void*)pjob, JOB_OBJECT, pjob->ji_wattr)) != 0)
+		if ((i = set_objexid((void*)pjob, JOB_OBJECT, NULL)) != 0)
 			return (i);  /* PBSE_BADUSER or GRP */
 	}
 
@@ -1523,7 +1702,7 @@ job_set_wait(attribute *pattr, void *pjob, int mode)
 			if ((ptask->wt_event == WORK_Timed) &&
 				(ptask->wt_func == job_wait_over) &&
 				(ptask->wt_parm1 == pjob)) {
-				ptask->wt_event = when;
+				(void)set_task_time(ptask, when);
 				return (0);
 			}
 			ptask = (struct work_task *)GET_NEXT(ptask->wt_linkobj);
@@ -2970,7 +3149,7 @@ Time4occurrenceFinish(resc_resv *presv)
 		return;
 	}
 
-	/* place "Time4resv" task on "task_list_timed" */
+	/* place "Time4resv" task on the timed task heap */
 	if ((rc = gen_task_Time4resv(presv)) != 0) {
 		sprintf(log_buffer, "problem generating task Time for occurrence (%d)", rc);
 		log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_RESV, LOG_NOTICE, presv->ri_qs.ri_resvID, log_buffer);
@@ -3838,7 +4017,7 @@ remove_deleted_resvs(void)
 		nxresv = (resc_resv *)GET_NEXT(presv->ri_allresvs);
 
 		if (presv->ri_qs.ri_state == RESV_FINISHED) {
-			/*put a task on the server's "task_list_timed" that causes
+			/*put a timed task on the server that causes
 			 *an internal BATCH_REQUEST_DeleteResv to be generated
 			 *and issued against this reservation
 			 */
@@ -3862,7 +4041,7 @@ remove_deleted_resvs(void)
 /**
  * @brief
  * 	add_resv_beginEnd_tasks - for each reservation not in state
- *	RESV_FINISHED add to "task_list_timed" the "begin" and
+ *	RESV_FINISHED add to the timed task heap the "begin" and
  *	"end" reservation tasks as appropriate.  Function used
  *	in "pbsd_init" code
  *
@@ -3882,7 +4061,7 @@ add_resv_beginEnd_tasks(void)
 		if (presv->ri_qs.ri_state == RESV_CONFIRMED ||
 			presv->ri_qs.ri_state == RESV_RUNNING) {
 
-			/* add "begin" and "end" tasks onto "task_list_timed" */
+			/* add "begin" and "end" timed tasks */
 
 			if ((rc = gen_task_EndResvWindow(presv)) != 0) {
 				sprintf(txt, "%s : EndResvWindow task creation failed",
@@ -3896,7 +4075,7 @@ add_resv_beginEnd_tasks(void)
 			}
 		} else if (presv->ri_qs.ri_state == RESV_UNCONFIRMED) {
 
-			/* add "end" task onto "task_list_timed" */
+			/* add "end" timed task */
 
 			if ((rc = gen_task_EndResvWindow(presv)) != 0) {
 				sprintf(txt, "%s : EndResvWindow task creation failed",
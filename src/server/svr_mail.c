@@ -74,6 +74,7 @@
 #include "reservation.h"
 #include "server.h"
 #include "tpp.h"
+#include "svrfunc.h"
 
 
 /* External Functions Called */
@@ -152,13 +153,71 @@ svr_exec_mailer(char *mailer, char *mailfrom, char *mailto)
 	return(fdopen(mfds[1], "w"));
 }
 
+/**
+ * @brief
+ * 		Pass a finished mail message to sendmail.  A helper process
+ *		runs the mailer when one is available; otherwise a child is
+ *		forked to not hold up the Server.  This child will fork/exec
+ *		sendmail and pipe the message to it.
+ *
+ * @param[in]	mailer - path to sendmail/mailer
+ * @param[in]	mailfrom - the sender of the email
+ * @param[in]	mailto - the recipient of the email
+ * @param[in]	msg - the message, headers and body
+ * @param[in]	len - length of msg
+ *
+ * @return	none
+ */
+static void
+svr_send_mail(char *mailer, char *mailfrom, char *mailto, char *msg, size_t len)
+{
+	char *margs[5];
+	FILE *outmail;
+	pid_t mcpid;
+
+	margs[0] = mailer;
+	margs[1] = "-f";
+	margs[2] = mailfrom;
+	margs[3] = mailto;
+	margs[4] = NULL;
+
+	if (helper_exec(margs, NULL, msg, len, NULL) == 0)
+		return;
+
+	mcpid = fork();
+	if (mcpid == -1) { /* Error on fork */
+		log_err(errno, __func__, "fork failed\n");
+		return;
+	}
+	if (mcpid > 0)
+		return;		/* its all up to the child now */
+
+	/*
+	 * From here on, we are a child process of the server.
+	 * Fix up file descriptors and signal handlers.
+	 */
+	net_close(-1);
+	tpp_terminate();
+
+	/* Unprotect child from being killed by kernel */
+	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
+
+	if ((outmail = svr_exec_mailer(mailer, mailfrom, mailto)) == NULL)
+		exit(1);
+	if (len > 0)
+		(void)fwrite(msg, 1, len, outmail);
+	fclose(outmail);
+
+	exit(0);
+}
+
 /**
  * @brief
  * 		Send mail to owner of a job when an event happens that
  *		requires mail, such as the job starts, ends or is aborted.
  *		The event is matched against those requested by the user.
- *		For Unix/Linux, a child is forked to not hold up the Server.  This child
- *		will fork/exec sendmail and pipe the To, Subject and body to it.
+ *		The message is built in memory and passed to svr_send_mail() so
+ *		that the Server is not held up waiting on sendmail.
  *
  * @param[in]	jid	-	the Job ID (string)
  * @param[in]	pjob	-	pointer to the job structure
@@ -182,7 +241,8 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 	char	*pat;
 
 	FILE   *outmail;
-	pid_t   mcpid;
+	char   *msg = NULL;
+	size_t  msglen = 0;
 
 
 	/* if force is true, force the mail out regardless of mailpoint */
@@ -214,29 +274,6 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 		}
 	}
 
-	/*
-	 * ok, now we will fork a process to do the mailing to not
-	 * hold up the server's other work.
-	 */
-
-	mcpid = fork();
-	if (mcpid == -1) { /* Error on fork */
-		log_err(errno, __func__, "fork failed\n");
-		return;
-	}
-	if (mcpid > 0)
-		return;		/* its all up to the child now */
-
-	/*
-	 * From here on, we are a child process of the server.
-	 * Fix up file descriptors and signal handlers.
-	 */
-	net_close(-1);
-	tpp_terminate();
-
-	/* Unprotect child from being killed by kernel */
-	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
-
 	if (is_sattr_set(SVR_ATR_mailer))
 		mailer = get_sattr_str(SVR_ATR_mailer);
 	else
@@ -316,8 +353,11 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 		strcpy(mailto, mailfrom);
 	}
 
-	if ((outmail = svr_exec_mailer(mailer, mailfrom, mailto)) == NULL)
-		exit(1);
+	/* build the message here, svr_send_mail() hands it to the mailer */
+	if ((outmail = open_memstream(&msg, &msglen)) == NULL) {
+		log_err(errno, __func__, "open_memstream failed");
+		return;
+	}
 
 	/* Pipe in mail headers: To: and Subject: */
 
@@ -359,17 +399,17 @@ svr_mailowner_id(char *jid, job *pjob, int mailpoint, int force, char *text)
 		fprintf(outmail, "%s\n", stdmessage);
 	if (text != NULL)
 		fprintf(outmail, "%s\n", text);
-	fclose(outmail);
-
-	exit(0);
+	if (fclose(outmail) == 0)
+		svr_send_mail(mailer, mailfrom, mailto, msg, msglen);
+	free(msg);
 }
 /**
  * @brief
  * 		svr_mailowner - Send mail to owner of a job when an event happens that
  *		requires mail, such as the job starts, ends or is aborted.
  *		The event is matched against those requested by the user.
- *		For Unix/Linux, a child is forked to not hold up the Server.  This child
- *		will fork/exec sendmail and pipe the To, Subject and body to it.
+ *		The message is built in memory and passed to svr_send_mail() so
+ *		that the Server is not held up waiting on sendmail.
  *
  * @param[in]	pjob	-	ptr to job (null for server based mail)
  * @param[in]	mailpoint	-	note, single character
@@ -387,8 +427,8 @@ svr_mailowner(job *pjob, int mailpoint, int force, char *text)
  * 		Send mail to owner of a reservation when an event happens that
  *		requires mail, such as the reservation starts, ends or is aborted.
  *		The event is matched against those requested by the user.
- *		For Unix/Linux, a child is forked to not hold up the Server.  This child
- *		will fork/exec sendmail and pipe the To, Subject and body to it.
+ *		The message is built in memory and passed to svr_send_mail() so
+ *		that the Server is not held up waiting on sendmail.
  *
  * @param[in]	presv	-	pointer to the reservation structure
  * @param[in]	mailpoint	-	which mail event is triggering the send
@@ -411,7 +451,8 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 	char	*stdmessage = NULL;
 
 	FILE	*outmail;
-	pid_t	 mcpid;
+	char	*msg = NULL;
+	size_t	 msglen = 0;
 
 	if (force != MAIL_FORCE) {
 		/*Not forcing out mail regardless of mailpoint */
@@ -435,30 +476,6 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 			return;
 	}
 
-	/*
-	 * ok, now we will fork a process to do the mailing to not
-	 * hold up the server's other work.
-	 */
-
-	mcpid = fork();
-	if (mcpid == -1) { /* Error on fork */
-		log_err(errno, __func__, "fork failed\n");
-		return;
-	}
-	if (mcpid > 0)
-		return;		/* its all up to the child now */
-
-	/*
-	 * From here on, we are a child process of the server.
-	 * Fix up file descriptors and signal handlers.
-	 */
-
-	net_close(-1);
-	tpp_terminate();
-
-	/* Unprotect child from being killed by kernel */
-	daemon_protect(0, PBS_DAEMON_PROTECT_OFF);
-
 	if (is_sattr_set(SVR_ATR_mailer))
 		mailer = get_sattr_str(SVR_ATR_mailer);
 	else
@@ -529,8 +546,11 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 		}
 	}
 
-	if ((outmail = svr_exec_mailer(mailer, mailfrom, mailto)) == NULL)
-		exit(1);
+	/* build the message here, svr_send_mail() hands it to the mailer */
+	if ((outmail = open_memstream(&msg, &msglen)) == NULL) {
+		log_err(errno, __func__, "open_memstream failed");
+		return;
+	}
 
 	/* Pipe in mail headers: To: and Subject: */
 
@@ -568,7 +588,7 @@ svr_mailownerResv(resc_resv *presv, int mailpoint, int force, char *text)
 		fprintf(outmail, "%s\n", stdmessage);
 	if (text != NULL)
 		fprintf(outmail, "%s\n", text);
-	fclose(outmail);
-
-	exit(0);
+	if (fclose(outmail) == 0)
+		svr_send_mail(mailer, mailfrom, mailto, msg, msglen);
+	free(msg);
 }
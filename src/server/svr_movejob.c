@@ -87,6 +87,24 @@
 
 #define	RETRY	3	/* number of times to retry network move */
 
+/* flags of a job send handed to a server helper */
+#define	SJ_COMMIT_ONLY	0x1	/* job already sent, only commit it */
+#define	SJ_SCRIPT	0x2	/* send the job script file */
+#define	SJ_FILES	0x4	/* send the files of a prior run */
+
+/*
+ * fixed part of a job send handed to a server helper, followed by the
+ * job id, destination, script file and spool file prefix strings, then
+ * by the name, resource, value and operator strings of each attribute
+ */
+typedef struct {
+	pbs_net_t sj_hostaddr;
+	unsigned int sj_port;
+	int sj_move_type;
+	int sj_flags;
+	int sj_nattr;
+} send_job_msg_t;
+
 /* External functions called */
 
 extern void	stat_mom_job(job *);
@@ -97,6 +115,9 @@ int  local_move(job *, struct batch_request *);
 static void post_movejob(struct work_task *);
 static void post_routejob(struct work_task *);
 static int small_job_files(job* pjob);
+static int send_job_helper(char *data, size_t len);
+static long send_job_via_helper(job *jobp, pbs_net_t hostaddr, unsigned int port, int move_type, char *script_name);
+static int send_job_file(int conn, char *fileprefix, char *jobid, enum job_file which, int prot, char **msgid);
 extern int should_retry_route(int err);
 extern int move_job_file(int con, job *pjob, enum job_file which, int prot, char **msgid);
 extern void post_sendmom(struct work_task *pwt);
@@ -581,7 +602,7 @@ send_job_exec(job *jobp, pbs_net_t hostaddr, int port, int move_type, struct bat
 		encode_type = ATR_ENCODE_MOM;
 	}
 
-	for (i = 0; i < (int) JOB_ATR_LAST; i++) {
+	for (i = next_jattr(jobp, -1); i >= 0; i = next_jattr(jobp, i)) {
 		if (i == JOB_ATR_server_inst_id)
 			continue;
 		if ((job_attr_def + i)->at_flags & resc_access_perm) {
@@ -710,12 +731,351 @@ send_err:
 	return (-1);
 }
 
+/**
+ * @brief
+ * 		Write the reject message of a hook at the destination where
+ * 		post_sendmom() and post_movejob() look for it.
+ *
+ * @param[in]	jobid	-	job id
+ * @param[in]	reject_msg	-	the message, nothing is written if empty
+ *
+ * @return	void
+ */
+static void
+write_send_job_reject(char *jobid, char *reject_msg)
+{
+	char name_buf[MAXPATHLEN + 1];
+	int rfd;
+	int len;
+
+	if ((reject_msg == NULL) || (reject_msg[0] == '\0'))
+		return;
+
+	(void)strcpy(name_buf, path_hooks_workdir);
+	(void)strcat(name_buf, jobid);
+	(void)strcat(name_buf, HOOK_REJECT_SUFFIX);
+
+	if ((rfd = open(name_buf, O_RDWR|O_CREAT|O_TRUNC, 0600)) == -1) {
+		sprintf(log_buffer, "open of reject file %s failed: errno %d", name_buf, errno);
+		log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, jobid, log_buffer);
+	} else {
+		len = strlen(reject_msg)+1;
+		/* write also trailing null char */
+		if (write(rfd, reject_msg, len) != len) {
+			sprintf(log_buffer, "write to file %s incomplete: errno %d", name_buf, errno);
+			log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, jobid, log_buffer);
+		}
+		close(rfd);
+	}
+}
+
+/**
+ * @brief
+ * 		Send a job the way the child of send_job() does, in a child of
+ * 		a server helper, from the request made by send_job_via_helper().
+ *
+ * @param[in]	data	-	the request, a send_job_msg_t and its strings
+ * @param[in]	len	-	length of data
+ *
+ * @return	int
+ * @retval	SEND_JOB_*	: as the exit status of the child of send_job()
+ */
+static int
+send_job_helper(char *data, size_t len)
+{
+	send_job_msg_t hdr;
+	struct attropl *patr = NULL;
+	char *str[4];	/* job id, destination, script file, spool file prefix */
+	char *jobid;
+	char *script_name;
+	char *end = data + len;
+	char *p;
+	char *reject_msg;
+	int con = -1;
+	int err;
+	int i;
+
+	if ((len <= sizeof(hdr)) || (*(end - 1) != '\0'))
+		return SEND_JOB_FATAL;
+	memcpy(&hdr, data, sizeof(hdr));
+	p = data + sizeof(hdr);
+	for (i = 0; i < 4; i++) {
+		if (p >= end)
+			return SEND_JOB_FATAL;
+		str[i] = p;
+		p += strlen(p) + 1;
+	}
+	jobid = str[0];
+	script_name = str[2];
+
+	if (hdr.sj_nattr > 0) {
+		if ((patr = calloc(hdr.sj_nattr, sizeof(struct attropl))) == NULL) {
+			log_err(errno, __func__, msg_err_malloc);
+			unlink(script_name);
+			return SEND_JOB_RETRY;
+		}
+		for (i = 0; i < hdr.sj_nattr; i++) {
+			if (p >= end) {
+				free(patr);
+				unlink(script_name);
+				return SEND_JOB_FATAL;
+			}
+			patr[i].name = p;
+			p += strlen(p) + 1;
+			patr[i].resource = (*p != '\0') ? p : NULL;
+			p += strlen(p) + 1;
+			patr[i].value = p;
+			p += strlen(p) + 1;
+			patr[i].op = (enum batch_op)atoi(p);
+			p += strlen(p) + 1;
+			patr[i].next = (i + 1 < hdr.sj_nattr) ? &patr[i + 1] : NULL;
+		}
+	}
+
+	pbs_errno = 0;
+
+	for (i = 0; i < RETRY; i++) {
+
+		/* connect to receiving server with retries */
+
+		if (i > 0) {	/* recycle after an error */
+			if (con >= 0)
+				svr_disconnect_with_wait_option(con, 1);
+			con = -1;
+			if (should_retry_route(pbs_errno) == -1)
+				break;
+			sleep(1<<i);
+		}
+		con = client_to_svr(hdr.sj_hostaddr, hdr.sj_port, B_RESERVED);
+		if ((con < 0) && (errno == ECONNREFUSED))
+			con = client_to_svr(hdr.sj_hostaddr, hdr.sj_port, B_RESERVED);
+		if (con == PBS_NET_RC_FATAL) {
+			pbs_errno = PBSE_NORELYMOM;
+			log_errf(pbs_errno, __func__, "send_job failed to %lx port %d",
+				hdr.sj_hostaddr, hdr.sj_port);
+			free(patr);
+			unlink(script_name);
+			return SEND_JOB_FATAL;
+		} else if (con < 0) {
+			pbs_errno = ECONNREFUSED;	/* should retry */
+			continue;
+		}
+		DIS_tcp_funcs();
+
+		if (!(hdr.sj_flags & SJ_COMMIT_ONLY)) {
+			if (PBSD_queuejob(con, jobid, str[1], patr, NULL, PROT_TCP, NULL, NULL) == 0) {
+				if (pbs_errno == PBSE_JOBEXIST &&
+					(hdr.sj_move_type == MOVE_TYPE_Exec || hdr.sj_move_type == MOVE_TYPE_Move_Run)) {
+					/* already running, mark it so */
+					log_event(PBSEVENT_ERROR, PBS_EVENTCLASS_JOB, LOG_INFO, jobid, "Mom reports job already running");
+					svr_disconnect_with_wait_option(con, 1);
+					free(patr);
+					unlink(script_name);
+					return SEND_JOB_OK;
+				} else if ((pbs_errno == PBSE_HOOKERROR) || (pbs_errno == PBSE_HOOK_REJECT) ||
+					(pbs_errno == PBSE_HOOK_REJECT_RERUNJOB) || (pbs_errno == PBSE_HOOK_REJECT_DELETEJOB)) {
+					err = pbs_errno;
+					reject_msg = pbs_geterrmsg(con);
+					(void)sprintf(log_buffer, "send of job to %s failed error = %d reject_msg=%s", str[1], err, reject_msg ? reject_msg : "");
+					log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, jobid, log_buffer);
+					write_send_job_reject(jobid, reject_msg);
+					svr_disconnect_with_wait_option(con, 1);
+					free(patr);
+					unlink(script_name);
+					if (err == PBSE_HOOKERROR)
+						return SEND_JOB_HOOKERR;
+					if (err == PBSE_HOOK_REJECT)
+						return SEND_JOB_HOOK_REJECT;
+					if (err == PBSE_HOOK_REJECT_RERUNJOB)
+						return SEND_JOB_HOOK_REJECT_RERUNJOB;
+					return SEND_JOB_HOOK_REJECT_DELETEJOB;
+				} else {
+					(void)sprintf(log_buffer, "send of job to %s failed error = %d", str[1], pbs_errno);
+					log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, jobid, log_buffer);
+					continue;
+				}
+			}
+
+			if (hdr.sj_flags & SJ_SCRIPT) {
+				if (PBSD_jscript(con, script_name, PROT_TCP, NULL) != 0)
+					continue;
+			}
+
+			if (hdr.sj_flags & SJ_FILES) {
+				/* send files created on prior run */
+				if ((send_job_file(con, str[3], jobid, StdOut, PROT_TCP, NULL) != 0) ||
+					(send_job_file(con, str[3], jobid, StdErr, PROT_TCP, NULL) != 0) ||
+					(send_job_file(con, str[3], jobid, Chkpt, PROT_TCP, NULL) != 0))
+					continue;
+			}
+		}
+
+		if (PBSD_commit(con, jobid, PROT_TCP, NULL, NULL) != 0) {
+			svr_disconnect_with_wait_option(con, 1);
+			free(patr);
+			unlink(script_name);
+			return SEND_JOB_FATAL;
+		}
+
+		svr_disconnect_with_wait_option(con, 1);
+		free(patr);
+		unlink(script_name);
+		return SEND_JOB_OK;
+	}
+	if (con >= 0)
+		svr_disconnect_with_wait_option(con, 1);
+	free(patr);
+	unlink(script_name);
+
+	/* see the end of send_job() */
+	if ((hdr.sj_move_type == MOVE_TYPE_Exec) && (pbs_errno == ECONNREFUSED || pbs_errno == PBSE_BADHOST))
+		i = SEND_JOB_NODEDW;
+	else if (should_retry_route(pbs_errno) == -1)
+		i = SEND_JOB_FATAL;
+	else
+		i = SEND_JOB_RETRY;
+	(void)sprintf(log_buffer, "send_job failed with error %d", pbs_errno);
+	log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_NOTICE, jobid, log_buffer);
+	return i;
+}
+
+/**
+ * @brief
+ * 		Hand a job send to a server helper, so the server need not fork
+ * 		for it.  The job attributes are encoded here as the child of
+ * 		send_job() would encode them, without changing the job, and go
+ * 		to the helper with the request; the script stays in the file
+ * 		written by send_job().
+ *
+ * @param[in]	jobp	-	pointer to the job being sent.
+ * @param[in]	hostaddr	-	the address of host to send job to, host byte order.
+ * @param[in]	port	-	the destination port, host byte order
+ * @param[in]	move_type	-	the type of move (e.g. MOVE_TYPE_exec)
+ * @param[in]	script_name	-	the job script file, "" if none
+ *
+ * @return	long
+ * @retval	tag of the helper request, see helper_call()
+ * @retval	0	: no helper took the send, the caller must fork
+ */
+static long
+send_job_via_helper(job *jobp, pbs_net_t hostaddr, unsigned int port, int move_type, char *script_name)
+{
+	pbs_list_head attrl;
+	send_job_msg_t hdr;
+	svrattrl *pal;
+	attribute *pattr;
+	attribute eligible;
+	mominfo_t *pmom;
+	FILE *fp;
+	char *data = NULL;
+	size_t len = 0;
+	long tag = 0;
+	int save_resc_access_perm = resc_access_perm;
+	int encode_type;
+	int elig = 0;
+	int rc;
+	int i;
+
+	/* the server itself, peer servers and down moms are left to svr_connect() */
+	if ((hostaddr == pbs_server_addr) && (port == pbs_server_port_dis))
+		return 0;
+	pmom = tfind2((unsigned long)hostaddr, port, &ipaddrs);
+	if (pmom && (port == pmom->mi_port) &&
+		(is_peersvr(pmom) || (pmom->mi_dmn_info->dmn_state & INUSE_DOWN)))
+		return 0;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.sj_hostaddr = hostaddr;
+	hdr.sj_port = port;
+	hdr.sj_move_type = move_type;
+	if (check_job_substate(jobp, JOB_SUBSTATE_TRNOUTCM))
+		hdr.sj_flags |= SJ_COMMIT_ONLY;
+	if (jobp->ji_qs.ji_svrflags & JOB_SVFLG_SCRIPT)
+		hdr.sj_flags |= SJ_SCRIPT;
+	if ((move_type == MOVE_TYPE_Exec) &&
+		(jobp->ji_qs.ji_svrflags & JOB_SVFLG_HASRUN) &&
+		(hostaddr != pbs_server_addr))
+		hdr.sj_flags |= SJ_FILES;
+
+	CLEAR_HEAD(attrl);
+	if (move_type == MOVE_TYPE_Exec) {
+		resc_access_perm = ATR_DFLAG_MOM;
+		encode_type = ATR_ENCODE_MOM;
+	} else {
+		resc_access_perm = ATR_DFLAG_USWR | ATR_DFLAG_OPWR |
+			ATR_DFLAG_MGWR | ATR_DFLAG_SvRD;
+		encode_type = ATR_ENCODE_SVR;
+		/* send_job() adds the time the job was eligible here */
+		if ((get_jattr_long(jobp, JOB_ATR_accrue_type) == JOB_ELIGIBLE) &&
+			(get_sattr_long(SVR_ATR_EligibleTimeEnable) == 1)) {
+			if ((pattr = get_jattr(jobp, JOB_ATR_eligible_time)) == NULL) {
+				resc_access_perm = save_resc_access_perm;
+				return 0;
+			}
+			eligible = *pattr;
+			set_attr_l(&eligible, (long)time_now - get_jattr_long(jobp, JOB_ATR_sample_starttime), INCR);
+			elig = 1;
+		}
+	}
+
+	for (i = next_jattr(jobp, -1); i >= 0; i = next_jattr(jobp, i)) {
+		if (!((job_attr_def+i)->at_flags & resc_access_perm))
+			continue;
+		/* svr_dequejob() unsets qtime; ATR_ENCODE_SVR already */
+		/* leaves out the default resources it clears */
+		if ((move_type != MOVE_TYPE_Exec) && (i == JOB_ATR_qtime))
+			continue;
+		if (elig && (i == JOB_ATR_eligible_time))
+			pattr = &eligible;
+		else
+			pattr = get_jattr(jobp, i);
+		(void)(job_attr_def+i)->at_encode(pattr, &attrl,
+			(job_attr_def+i)->at_name, NULL, encode_type, NULL);
+	}
+	resc_access_perm = save_resc_access_perm;
+
+	if ((fp = open_memstream(&data, &len)) == NULL) {
+		log_err(errno, __func__, "open_memstream failed");
+		free_attrlist(&attrl);
+		return 0;
+	}
+	for (pal = (svrattrl *)GET_NEXT(attrl); pal != NULL; pal = (svrattrl *)GET_NEXT(pal->al_link))
+		hdr.sj_nattr++;
+	(void)fwrite(&hdr, sizeof(hdr), 1, fp);
+	fprintf(fp, "%s%c%s%c%s%c%s%c", jobp->ji_qs.ji_jobid, '\0',
+		jobp->ji_qs.ji_destin, '\0', script_name, '\0',
+		(*jobp->ji_qs.ji_fileprefix != '\0') ?
+		jobp->ji_qs.ji_fileprefix : jobp->ji_qs.ji_jobid, '\0');
+	for (pal = (svrattrl *)GET_NEXT(attrl); pal != NULL; pal = (svrattrl *)GET_NEXT(pal->al_link))
+		fprintf(fp, "%s%c%s%c%s%c%d%c", pal->al_name, '\0',
+			pal->al_resc ? pal->al_resc : "", '\0',
+			pal->al_value ? pal->al_value : "", '\0',
+			(pal->al_flags & ATR_VFLAG_DEFLT) ? DFLT : SET, '\0');
+	free_attrlist(&attrl);
+	if (fclose(fp) != 0) {
+		log_err(errno, __func__, "failed to build job send");
+		free(data);
+		return 0;
+	}
+
+	/* a request too big for a helper fails here too */
+	rc = helper_call(send_job_helper, data, len, &tag);
+	free(data);
+	if (rc != 0)
+		return 0;
+
+	log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_INFO,
+		jobp->ji_qs.ji_jobid, "job send handed to a server helper");
+	return tag;
+}
+
 /**
  *
  * @brief
  * 		Send a job over the network to some other server or MOM.
  * @par
- * 		Under Linux/Unix, this starts a child process to do the work.
+ * 		Under Linux/Unix, this starts a child process to do the work,
+ * 		or hands it to a server helper, see send_job_via_helper().
  *		Connect to the destination host and port,
  * 		and go through the protocol to transfer the job.
  * 		Signals are blocked.
@@ -729,7 +1089,7 @@ send_err:
  * @param[in]	data	-	input data to 'post_func'
  *
  * @return	int
- * @retval	2	parent	: success (child forked)
+ * @retval	2	parent	: success (child forked or helper started)
  * @retval	-1	parent	: on failure (pbs_errno set to error number)
  * @retval	SEND_JOB_OK	child	: 0 success, job sent
  * @retval	SEND_JOB_FATAL	child	: 1 permenent failure or rejection,
@@ -756,6 +1116,10 @@ send_job(job *jobp, pbs_net_t hostaddr, int port, int move_type,
 	struct hostent *hp;
 	struct in_addr addr;
 	long tempval;
+	long tag;
+
+	/* commit pending job saves, the state change to running among them */
+	(void)job_save_flush();
 
 	/* if job has a script read it from database */
 	if (jobp->ji_qs.ji_svrflags & JOB_SVFLG_SCRIPT) {
@@ -800,6 +1164,17 @@ send_job(job *jobp, pbs_net_t hostaddr, int port, int move_type,
 		jobp->ji_script = NULL;
 	}
 
+	if ((tag = send_job_via_helper(jobp, hostaddr, port, move_type, script_name)) != 0) {
+		ptask = set_task(WORK_Deferred_Child, tag, post_func, preq);
+		if (!ptask) {
+			log_err(errno, __func__, msg_err_malloc);
+			return (-1);
+		}
+		ptask->wt_parm2 = jobp;
+		append_link(&jobp->ji_svrtask, &ptask->wt_linkobj, ptask);
+		return 2;
+	}
+
 	pid = fork();
 	if (pid == -1) {	/* Error on fork */
 		log_err(errno, __func__, "fork failed\n");
@@ -870,7 +1245,7 @@ send_job(job *jobp, pbs_net_t hostaddr, int port, int move_type,
 		set_jattr_l_slim(jobp, JOB_ATR_eligible_time, tempval, INCR);
 	}
 
-	for (i=0; i < (int)JOB_ATR_LAST; i++) {
+	for (i = next_jattr(jobp, -1); i >= 0; i = next_jattr(jobp, i)) {
 		if ((job_attr_def+i)->at_flags & resc_access_perm) {
 			(void)(job_attr_def+i)->at_encode(get_jattr(jobp, i), &attrl,
 				(job_attr_def+i)->at_name, NULL, encode_type, NULL);
@@ -937,9 +1312,6 @@ send_job(job *jobp, pbs_net_t hostaddr, int port, int move_type,
 				}
 				else if ((pbs_errno == PBSE_HOOKERROR) || (pbs_errno == PBSE_HOOK_REJECT)  ||
 					(pbs_errno == PBSE_HOOK_REJECT_RERUNJOB) || (pbs_errno == PBSE_HOOK_REJECT_DELETEJOB)) {
-					char name_buf[MAXPATHLEN + 1];
-					int rfd;
-					int len;
 					char *reject_msg;
 					int err;
 
@@ -949,24 +1321,7 @@ send_job(job *jobp, pbs_net_t hostaddr, int port, int move_type,
 					(void)sprintf(log_buffer, "send of job to %s failed error = %d reject_msg=%s", destin, err, reject_msg ? reject_msg : "");
 					log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, jobp->ji_qs.ji_jobid, log_buffer);
 
-					(void)strcpy(name_buf, path_hooks_workdir);
-					(void)strcat(name_buf, jobp->ji_qs.ji_jobid);
-					(void)strcat(name_buf, HOOK_REJECT_SUFFIX);
-
-					if ((reject_msg != NULL) && (reject_msg[0] != '\0')) {
-						if ((rfd = open(name_buf, O_RDWR|O_CREAT|O_TRUNC, 0600)) == -1) {
-							sprintf(log_buffer, "open of reject file %s failed: errno %d", name_buf, errno);
-							log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, jobp->ji_qs.ji_jobid, log_buffer);
-						} else {
-							len = strlen(reject_msg)+1;
-							/* write also trailing null char */
-							if (write(rfd, reject_msg, len) != len) {
-								sprintf(log_buffer, "write to file %s incomplete: errno %d", name_buf, errno);
-								log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, LOG_INFO, jobp->ji_qs.ji_jobid, log_buffer);
-							}
-							close(rfd);
-						}
-					}
+					write_send_job_reject(jobp->ji_qs.ji_jobid, reject_msg);
 
 					if (err == PBSE_HOOKERROR)
 						exit(SEND_JOB_HOOKERR);
@@ -1149,14 +1504,36 @@ should_retry_route(int err)
  */
 int
 move_job_file(int conn, job *pjob, enum job_file which, int prot, char **msgid)
+{
+	if (*pjob->ji_qs.ji_fileprefix != '\0')
+		return send_job_file(conn, pjob->ji_qs.ji_fileprefix,
+			pjob->ji_qs.ji_jobid, which, prot, msgid);
+	return send_job_file(conn, pjob->ji_qs.ji_jobid,
+		pjob->ji_qs.ji_jobid, which, prot, msgid);
+}
+
+/**
+ * @brief
+ * 		send_job_file - send a spool file of a job, see move_job_file()
+ *
+ * @param[in]	conn	-	connection handle
+ * @param[in]	fileprefix	-	prefix of the job's spool files
+ * @param[in]	jobid	-	job id
+ * @param[in]	which	-	standard file type, see libpbs.h
+ * @param[in]	prot	-	PROT_TPP or PROT_TCP
+ * @param[out]	msgid	-	message id
+ *
+ * @return	int
+ * @retval	0	: success, or there is no such file
+ * @retval	!=0	: error code
+ */
+static int
+send_job_file(int conn, char *fileprefix, char *jobid, enum job_file which, int prot, char **msgid)
 {
 	char path[MAXPATHLEN+1];
 
 	(void)strcpy(path, path_spool);
-	if (*pjob->ji_qs.ji_fileprefix != '\0')
-		(void)strcat(path, pjob->ji_qs.ji_fileprefix);
-	else
-		(void)strcat(path, pjob->ji_qs.ji_jobid);
+	(void)strcat(path, fileprefix);
 	if (which == StdOut)
 		(void)strcat(path, JOB_STDOUT_SUFFIX);
 	else if (which == StdErr)
@@ -1170,7 +1547,7 @@ move_job_file(int conn, job *pjob, enum job_file which, int prot, char **msgid)
 		else
 			return (errno);
 	}
-	return PBSD_jobfile(conn, PBS_BATCH_MvJobFile, path, pjob->ji_qs.ji_jobid, which, prot, msgid);
+	return PBSD_jobfile(conn, PBS_BATCH_MvJobFile, path, jobid, which, prot, msgid);
 }
 
 /**
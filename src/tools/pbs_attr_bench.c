@@ -0,0 +1,350 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file pbs_attr_bench.c
+ *
+ * @brief
+ *		pbs_attr_bench.c - benchmark of dense and sparse job attribute storage
+ *
+ *	Builds a number of jobs with the attributes a typical running job has
+ *	set, once in a dense array of JOB_ATR_LAST attributes and once in sparse
+ *	storage, then reports the memory each takes and times reading and
+ *	setting the attributes of the jobs.
+ *
+ * Functions included are:
+ * 	main()
+ * 	now()
+ * 	report()
+ * 	setup_defs()
+ * 	set_one()
+ * 	bench_dense()
+ * 	bench_sparse()
+ */
+#include <pbs_config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "pbs_ifl.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "server_limits.h"
+#include "job.h"
+
+/*
+ * The attributes set on a typical running job.  The definitions are built
+ * here as plain long and string attributes, the real job_attr_def[] needs
+ * the server's action functions.
+ */
+static struct {
+	int idx;
+	int is_str;
+} typical[] = {
+	{JOB_ATR_jobname, 1},
+	{JOB_ATR_job_owner, 1},
+	{JOB_ATR_state, 0},
+	{JOB_ATR_substate, 0},
+	{JOB_ATR_in_queue, 1},
+	{JOB_ATR_at_server, 1},
+	{JOB_ATR_ctime, 0},
+	{JOB_ATR_mtime, 0},
+	{JOB_ATR_qtime, 0},
+	{JOB_ATR_etime, 0},
+	{JOB_ATR_stime, 0},
+	{JOB_ATR_priority, 0},
+	{JOB_ATR_euser, 1},
+	{JOB_ATR_egroup, 1},
+	{JOB_ATR_hashname, 1},
+	{JOB_ATR_exec_host, 1},
+	{JOB_ATR_exec_vnode, 1},
+	{JOB_ATR_session_id, 0},
+	{JOB_ATR_outpath, 1},
+	{JOB_ATR_errpath, 1},
+	{JOB_ATR_join, 1},
+	{JOB_ATR_keep, 1},
+	{JOB_ATR_mailpnts, 1},
+	{JOB_ATR_run_version, 0},
+	{JOB_ATR_runcount, 0},
+	{JOB_ATR_SchedSelect, 1},
+	{JOB_ATR_submit_host, 1},
+	{JOB_ATR_project, 1},
+	{JOB_ATR_eligible_time, 0},
+	{JOB_ATR_queuetype, 0},
+};
+#define NUM_TYPICAL	(int)(sizeof(typical) / sizeof(typical[0]))
+
+static attribute_def defs[JOB_ATR_LAST];
+static int num_jobs = 10000;
+static int num_ops = 10000000;
+
+/**
+ * @brief
+ *	return the time in seconds from a monotonic clock
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief
+ *	print the result of a benchmark phase
+ *
+ * @param[in] flavor - storage flavor
+ * @param[in] phase  - name of the phase
+ * @param[in] ops    - number of operations
+ * @param[in] secs   - time the phase took
+ */
+static void
+report(const char *flavor, const char *phase, long ops, double secs)
+{
+	printf("%-7s %-16s %10ld ops %8.3f s %12.0f ops/s\n",
+	       flavor, phase, ops, secs, secs > 0 ? ops / secs : 0);
+}
+
+/**
+ * @brief
+ *	build the attribute definitions, every attribute is a long but for
+ *	the string ones in typical[]
+ */
+static void
+setup_defs(void)
+{
+	attribute_def l = {"long", decode_l, encode_l, set_l, comp_l, free_null,
+		NULL_FUNC, READ_WRITE, ATR_TYPE_LONG, PARENT_TYPE_JOB};
+	attribute_def s = {"str", decode_str, encode_str, set_str, comp_str, free_str,
+		NULL_FUNC, READ_WRITE, ATR_TYPE_STR, PARENT_TYPE_JOB};
+	int i;
+
+	for (i = 0; i < JOB_ATR_LAST; i++)
+		defs[i] = l;
+	for (i = 0; i < NUM_TYPICAL; i++)
+		if (typical[i].is_str)
+			defs[typical[i].idx] = s;
+}
+
+/**
+ * @brief
+ *	set one of the typical attributes of a job
+ *
+ * @param[in] pattr - the attribute
+ * @param[in] t     - index into typical[]
+ * @param[in] job   - job number, used to make the values differ
+ */
+static void
+set_one(attribute *pattr, int t, int job)
+{
+	char buf[64];
+
+	if (typical[t].is_str) {
+		snprintf(buf, sizeof(buf), "value-%d-%d.pbsserver", t, job);
+		set_attr_generic(pattr, &defs[typical[t].idx], buf, NULL, SET);
+	} else
+		set_attr_l(pattr, (long) job + t, SET);
+}
+
+/**
+ * @brief
+ *	time building, reading and setting jobs held in dense attribute arrays
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval 1 - failure
+ */
+static int
+bench_dense(void)
+{
+	attribute **jobs;
+	double t;
+	long sum = 0;
+	size_t bytes;
+	int i;
+	int j;
+
+	if ((jobs = calloc(num_jobs, sizeof(attribute *))) == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	t = now();
+	for (i = 0; i < num_jobs; i++) {
+		if ((jobs[i] = malloc(JOB_ATR_LAST * sizeof(attribute))) == NULL) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+		for (j = 0; j < JOB_ATR_LAST; j++)
+			clear_attr(&jobs[i][j], &defs[j]);
+		for (j = 0; j < NUM_TYPICAL; j++)
+			set_one(&jobs[i][typical[j].idx], j, i);
+	}
+	report("dense", "build", (long) num_jobs * NUM_TYPICAL, now() - t);
+
+	t = now();
+	for (i = 0; i < num_ops; i++) {
+		attribute *pattr = &jobs[i % num_jobs][i % JOB_ATR_LAST];
+
+		if (is_attr_set(pattr) && pattr->at_type == ATR_TYPE_LONG)
+			sum += get_attr_l(pattr);
+	}
+	report("dense", "get", num_ops, now() - t);
+
+	t = now();
+	for (i = 0; i < num_ops; i++)
+		set_attr_l(&jobs[i % num_jobs][typical[2].idx], i, SET);
+	report("dense", "set", num_ops, now() - t);
+
+	bytes = (size_t) JOB_ATR_LAST * sizeof(attribute);
+	printf("dense   %d jobs, %zu attribute bytes per job (checksum %ld)\n",
+	       num_jobs, bytes, sum);
+
+	for (i = 0; i < num_jobs; i++) {
+		for (j = 0; j < JOB_ATR_LAST; j++)
+			free_attr(defs, &jobs[i][j], j);
+		free(jobs[i]);
+	}
+	free(jobs);
+	return 0;
+}
+
+/**
+ * @brief
+ *	time building, reading and setting jobs held in sparse attribute storage
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval 1 - failure
+ */
+static int
+bench_sparse(void)
+{
+	attr_sparse *jobs;
+	attribute *pattr;
+	double t;
+	long sum = 0;
+	size_t bytes = 0;
+	int i;
+	int j;
+
+	if ((jobs = calloc(num_jobs, sizeof(attr_sparse))) == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	t = now();
+	for (i = 0; i < num_jobs; i++) {
+		attr_sparse_init(&jobs[i]);
+		for (j = 0; j < NUM_TYPICAL; j++) {
+			if ((pattr = attr_sparse_get(&jobs[i], defs, typical[j].idx)) == NULL) {
+				fprintf(stderr, "out of memory\n");
+				return 1;
+			}
+			set_one(pattr, j, i);
+		}
+	}
+	report("sparse", "build", (long) num_jobs * NUM_TYPICAL, now() - t);
+
+	t = now();
+	for (i = 0; i < num_ops; i++) {
+		pattr = attr_sparse_find(&jobs[i % num_jobs], i % JOB_ATR_LAST);
+
+		if (pattr != NULL && is_attr_set(pattr) && pattr->at_type == ATR_TYPE_LONG)
+			sum += get_attr_l(pattr);
+	}
+	report("sparse", "get", num_ops, now() - t);
+
+	t = now();
+	for (i = 0; i < num_ops; i++)
+		set_attr_l(attr_sparse_get(&jobs[i % num_jobs], defs, typical[2].idx), i, SET);
+	report("sparse", "set", num_ops, now() - t);
+
+	for (i = 0; i < num_jobs; i++)
+		bytes += sizeof(attr_sparse) + attr_sparse_size(&jobs[i]);
+	printf("sparse  %d jobs, %zu attribute bytes per job (checksum %ld)\n",
+	       num_jobs, bytes / num_jobs, sum);
+
+	for (i = 0; i < num_jobs; i++)
+		attr_sparse_free(&jobs[i], defs);
+	free(jobs);
+	return 0;
+}
+
+/**
+ * @brief
+ *      This is main function of pbs_attr_bench.
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval 1 - failure
+ */
+int
+main(int argc, char *argv[])
+{
+	int c;
+
+	while ((c = getopt(argc, argv, "j:n:")) != -1)
+		switch (c) {
+			case 'j':
+				num_jobs = atoi(optarg);
+				break;
+			case 'n':
+				num_ops = atoi(optarg);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-j jobs] [-n operations]\n", argv[0]);
+				return 1;
+		}
+
+	if (num_jobs <= 0 || num_ops <= 0) {
+		fprintf(stderr, "usage: %s [-j jobs] [-n operations]\n", argv[0]);
+		return 1;
+	}
+
+	printf("%d jobs with %d of %d attributes set\n", num_jobs, NUM_TYPICAL, (int) JOB_ATR_LAST);
+	setup_defs();
+	if (bench_dense() || bench_sparse())
+		return 1;
+
+	return 0;
+}
@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file pbs_idx_bench.c
+ *
+ * @brief
+ *		pbs_idx_bench.c - benchmark of the pbs_idx index flavors
+ *
+ *	Times insert, find, iterate and delete of job id like keys on a plain
+ *	index and on a PBS_IDX_CONCURRENT one, then times finds from several
+ *	threads on the concurrent index while the main thread keeps changing it.
+ *
+ * Functions included are:
+ * 	main()
+ * 	now()
+ * 	report()
+ * 	bench_serial()
+ * 	reader()
+ * 	bench_concurrent()
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "pbs_idx.h"
+#include "avltree.h"
+
+static char **keys;		/* the keys, "<n>.<server>" like job ids */
+static int num_keys = 1000000;
+static volatile int readers_done;
+
+/* data of a reader thread */
+typedef struct {
+	void *idx;
+	int seed;
+	long finds;	/* finds done */
+	long found;	/* finds which found their key */
+} reader_data;
+
+/**
+ * @brief
+ *	return the time in seconds from a monotonic clock
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief
+ *	print the result of a benchmark phase
+ *
+ * @param[in] flavor - index flavor
+ * @param[in] phase  - name of the phase
+ * @param[in] ops    - number of operations
+ * @param[in] secs   - time the phase took
+ */
+static void
+report(const char *flavor, const char *phase, long ops, double secs)
+{
+	printf("%-10s %-24s %10ld ops %8.3f s %12.0f ops/s\n",
+	       flavor, phase, ops, secs, secs > 0 ? ops / secs : 0);
+}
+
+/**
+ * @brief
+ *	time single threaded insert, find, iterate and delete of all keys
+ *
+ * @param[in] flags - pbs_idx_create() flags
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval 1 - failure
+ */
+static int
+bench_serial(int flags)
+{
+	const char *flavor = (flags & PBS_IDX_CONCURRENT) ? "concurrent" : "plain";
+	void *idx;
+	void *ctx = NULL;
+	void *data;
+	double t;
+	long n;
+	int i;
+
+	if ((idx = pbs_idx_create(flags, 0)) == NULL) {
+		fprintf(stderr, "pbs_idx_create failed\n");
+		return 1;
+	}
+
+	t = now();
+	for (i = 0; i < num_keys; i++) {
+		if (pbs_idx_insert(idx, keys[i], keys[i]) != PBS_IDX_RET_OK) {
+			fprintf(stderr, "insert of %s failed\n", keys[i]);
+			return 1;
+		}
+	}
+	report(flavor, "insert", num_keys, now() - t);
+
+	t = now();
+	for (i = 0, n = 0; i < num_keys; i++) {
+		if (pbs_idx_find(idx, (void **) &keys[i], &data, NULL) == PBS_IDX_RET_OK && data == keys[i])
+			n++;
+	}
+	report(flavor, "find", num_keys, now() - t);
+	if (n != num_keys) {
+		fprintf(stderr, "found %ld keys of %d\n", n, num_keys);
+		return 1;
+	}
+
+	t = now();
+	n = 0;
+	while (pbs_idx_find(idx, NULL, &data, &ctx) == PBS_IDX_RET_OK)
+		n++;
+	pbs_idx_free_ctx(ctx);
+	report(flavor, "iterate", n, now() - t);
+	if (n != num_keys) {
+		fprintf(stderr, "iterated over %ld keys of %d\n", n, num_keys);
+		return 1;
+	}
+
+	t = now();
+	for (i = 0; i < num_keys; i++)
+		pbs_idx_delete(idx, keys[i]);
+	report(flavor, "delete", num_keys, now() - t);
+
+	pbs_idx_destroy(idx);
+	return 0;
+}
+
+/**
+ * @brief
+ *	reader thread: find random keys until told to stop
+ *
+ * @param[in] arg - reader_data of the thread
+ */
+static void *
+reader(void *arg)
+{
+	reader_data *rd = (reader_data *) arg;
+	unsigned int seed = rd->seed;
+	void *data;
+
+	while (!readers_done) {
+		int i = rand_r(&seed) % num_keys;
+
+		if (pbs_idx_find(rd->idx, (void **) &keys[i], &data, NULL) == PBS_IDX_RET_OK)
+			rd->found++;
+		rd->finds++;
+	}
+	free_avl_tls();
+	return NULL;
+}
+
+/**
+ * @brief
+ *	time finds from several threads on a concurrent index while the
+ *	main thread deletes and reinserts keys
+ *
+ * @param[in] nthreads - number of reader threads
+ * @param[in] secs     - how long to run
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval 1 - failure
+ */
+static int
+bench_concurrent(int nthreads, int secs)
+{
+	pthread_t *tids;
+	reader_data *rds;
+	void *idx;
+	char phase[64];
+	double t;
+	double end;
+	long finds = 0;
+	long changes = 0;
+	int i;
+
+	if ((idx = pbs_idx_create(PBS_IDX_CONCURRENT, 0)) == NULL) {
+		fprintf(stderr, "pbs_idx_create failed\n");
+		return 1;
+	}
+	for (i = 0; i < num_keys; i++)
+		pbs_idx_insert(idx, keys[i], keys[i]);
+
+	tids = calloc(nthreads, sizeof(pthread_t));
+	rds = calloc(nthreads, sizeof(reader_data));
+	if (tids == NULL || rds == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	readers_done = 0;
+	t = now();
+	for (i = 0; i < nthreads; i++) {
+		rds[i].idx = idx;
+		rds[i].seed = i + 1;
+		if (pthread_create(&tids[i], NULL, reader, &rds[i]) != 0) {
+			fprintf(stderr, "pthread_create failed\n");
+			return 1;
+		}
+	}
+
+	/* keep the writer busy, as the server main loop would be */
+	end = t + secs;
+	for (i = 0; now() < end; i = (i + 1) % num_keys, changes += 2) {
+		pbs_idx_delete(idx, keys[i]);
+		pbs_idx_insert(idx, keys[i], keys[i]);
+	}
+	readers_done = 1;
+	for (i = 0; i < nthreads; i++) {
+		pthread_join(tids[i], NULL);
+		finds += rds[i].finds;
+	}
+	t = now() - t;
+
+	snprintf(phase, sizeof(phase), "find, %d threads", nthreads);
+	report("concurrent", phase, finds, t);
+	report("concurrent", "writer insert+delete", changes, t);
+
+	free(tids);
+	free(rds);
+	pbs_idx_destroy(idx);
+	return 0;
+}
+
+/**
+ * @brief
+ *      This is main function of pbs_idx_bench.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: failure
+ *
+ */
+int
+main(int argc, char *argv[])
+{
+	int c;
+	int nthreads = 4;
+	int secs = 5;
+	int i;
+
+	while ((c = getopt(argc, argv, "n:t:s:")) != -1)
+		switch (c) {
+			case 'n':
+				num_keys = atoi(optarg);
+				break;
+			case 't':
+				nthreads = atoi(optarg);
+				break;
+			case 's':
+				secs = atoi(optarg);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-n keys] [-t reader threads] [-s seconds]\n", argv[0]);
+				return 1;
+		}
+
+	if (num_keys <= 0 || nthreads <= 0 || secs <= 0) {
+		fprintf(stderr, "usage: %s [-n keys] [-t reader threads] [-s seconds]\n", argv[0]);
+		return 1;
+	}
+
+	if ((keys = malloc(num_keys * sizeof(char *))) == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (i = 0; i < num_keys; i++) {
+		char buf[64];
+
+		snprintf(buf, sizeof(buf), "%d.pbsserver", i);
+		if ((keys[i] = strdup(buf)) == NULL) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+	}
+	/* insert in a shuffled order, like job ids from several servers */
+	srand(1);
+	for (i = num_keys - 1; i > 0; i--) {
+		int j = rand() % (i + 1);
+		char *tmp = keys[i];
+
+		keys[i] = keys[j];
+		keys[j] = tmp;
+	}
+
+	if (bench_serial(0) || bench_serial(PBS_IDX_CONCURRENT))
+		return 1;
+	if (bench_concurrent(1, secs) || (nthreads > 1 && bench_concurrent(nthreads, secs)))
+		return 1;
+
+	return 0;
+}
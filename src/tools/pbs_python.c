@@ -143,6 +143,8 @@ extern 	enum vnode_sharing str_to_vnode_sharing(char *sharing_str);
  *
  * @param[in]	event_jobs_svrattrl	-	gets <attribute_name>=EVENT_JOBLIST_OBJECT data
  * 			            				Caution: svrattrl values stored in sorted order
+ * @param[in]	event_resvs_svrattrl	-	gets <attribute_name>=EVENT_RESVLIST_OBJECT data
+ * 			            				Caution: svrattrl values stored in sorted order
  * @param[in]	perf_label - passed on to hook_perf_stat* call.
  * @param[in]	perf_action - passed on to hook_perf_stat* call.
  *
@@ -170,7 +172,7 @@ pbs_python_populate_svrattrl_from_file(char *input_file,
 	pbs_list_head *job_succeeded_mom_list_svrattrl,
 	pbs_list_head *event_src_queue_svrattrl, pbs_list_head *event_aoe_svrattrl,
 	pbs_list_head *event_argv_svrattrl, pbs_list_head *event_jobs_svrattrl,
-	char *perf_label, char *perf_action)
+	pbs_list_head *event_resvs_svrattrl, char *perf_label, char *perf_action)
 {
 
 	char *attr_name;
@@ -192,6 +194,7 @@ pbs_python_populate_svrattrl_from_file(char *input_file,
 	int   vn_obj_len = strlen(EVENT_VNODELIST_OBJECT);
 	int   vn_fail_obj_len = strlen(EVENT_VNODELIST_FAIL_OBJECT);
 	int   job_obj_len = strlen(EVENT_JOBLIST_OBJECT);
+	int   resv_obj_len = strlen(EVENT_RESVLIST_OBJECT);
 	int   b_triple_quotes = 0;
 	int   e_triple_quotes = 0;
 	char  buf_data[STRBUF];
@@ -203,7 +206,7 @@ pbs_python_populate_svrattrl_from_file(char *input_file,
 		(event_argv_svrattrl == NULL) || (event_vnode_fail_svrattrl == NULL) ||
 		(job_failed_mom_list_svrattrl == NULL) ||
 		(job_succeeded_mom_list_svrattrl == NULL) ||
-		(event_jobs_svrattrl == NULL)) {
+		(event_jobs_svrattrl == NULL) || (event_resvs_svrattrl == NULL)) {
 		log_err(-1, __func__, "Bad input parameter!");
 		rc = -1;
 		goto populate_svrattrl_fail;
@@ -237,6 +240,7 @@ pbs_python_populate_svrattrl_from_file(char *input_file,
 	if (event_aoe_svrattrl) free_attrlist(event_aoe_svrattrl);
 	if (event_argv_svrattrl) free_attrlist(event_argv_svrattrl);
 	if (event_jobs_svrattrl) free_attrlist(event_jobs_svrattrl);
+	if (event_resvs_svrattrl) free_attrlist(event_resvs_svrattrl);
 
 
 	in_data_sz = STRBUF;
@@ -519,11 +523,18 @@ pbs_python_populate_svrattrl_from_file(char *input_file,
 					rc = add_to_svrattrl_list_sorted(event_vnode_svrattrl, name_str, resc_str, return_internal_value(attr_name, val_str), 0, NULL);
 				}
 
-			} else if (event_jobs_svrattrl && (strncmp(obj_name, EVENT_JOBLIST_OBJECT, job_obj_len) == 0)) {
+			} else if ((event_jobs_svrattrl &&
+				  (strncmp(obj_name, EVENT_JOBLIST_OBJECT, job_obj_len) == 0)) ||
+				  (event_resvs_svrattrl &&
+				  (strncmp(obj_name, EVENT_RESVLIST_OBJECT, resv_obj_len) == 0))) {
 
 				/* pbs.event().job_list[<jobid>]\0<attribute name>\0<resource name>\0<value>
 				 * where obj_name = pbs.event().job_list[<jobid>]
 				 *	  name_str = <attribute name>
+				 *     - or -
+				 * pbs.event().resv_list[<resvid>]\0<attribute name>\0<resource name>\0<value>
+				 * where obj_name = pbs.event().resv_list[<resvid>]
+				 *	  name_str = <attribute name>
 				 */
 
 				/* import here to look for the leftmost '[' (using strchr)
@@ -578,8 +589,13 @@ pbs_python_populate_svrattrl_from_file(char *input_file,
 					in_data[0] = '\0';
 					continue;
 				}
-				rc = add_to_svrattrl_list_sorted(event_jobs_svrattrl,
-					name_str, resc_str, val_str, 0, NULL);
+				if (strncmp(obj_name, EVENT_RESVLIST_OBJECT, resv_obj_len) == 0) {
+					rc = add_to_svrattrl_list_sorted(event_resvs_svrattrl,
+						name_str, resc_str, val_str, 0, NULL);
+				} else {
+					rc = add_to_svrattrl_list_sorted(event_jobs_svrattrl,
+						name_str, resc_str, val_str, 0, NULL);
+				}
 			} else if (event_src_queue_svrattrl && (strcmp(obj_name, EVENT_SRC_QUEUE_OBJECT) == 0)) {
 				rc = add_to_svrattrl_list(event_src_queue_svrattrl,
 					name_str, resc_str, val_str, 0, NULL);
@@ -628,6 +644,7 @@ populate_svrattrl_fail:
 	if (event_aoe_svrattrl) free_attrlist(event_aoe_svrattrl);
 	if (event_argv_svrattrl) free_attrlist(event_argv_svrattrl);
 	if (event_jobs_svrattrl) free_attrlist(event_jobs_svrattrl);
+	if (event_resvs_svrattrl) free_attrlist(event_resvs_svrattrl);
 
 	if ((fp != NULL) && (fp != stdin))
 		fclose(fp);
@@ -1615,7 +1632,7 @@ main(int argc, char *argv[], char *envp[])
 		struct python_script	*py_script = NULL;
 		pbs_list_head	default_list, event, event_job, event_job_o,
 				event_resv, event_vnode, event_src_queue, event_vnode_fail,
-				event_aoe, event_argv, event_jobs,
+				event_aoe, event_argv, event_jobs, event_resvs,
 				server, server_jobs, server_jobs_ids,
 				server_queues, server_queues_names,
 				server_resvs, server_resvs_resvids,
@@ -1833,13 +1850,14 @@ main(int argc, char *argv[], char *envp[])
 		CLEAR_HEAD(event_aoe);
 		CLEAR_HEAD(event_argv);
 		CLEAR_HEAD(event_jobs);
+		CLEAR_HEAD(event_resvs);
 
 		rc = pbs_python_populate_svrattrl_from_file(the_input,
 			&default_list,
 			&event, &event_job, &event_job_o, &event_resv,
 			&event_vnode, &event_vnode_fail, &job_failed_mom_list,
 			&job_succeeded_mom_list, &event_src_queue,
-			&event_aoe, &event_argv, &event_jobs,
+			&event_aoe, &event_argv, &event_jobs, &event_resvs,
 			perf_label, HOOK_PERF_LOAD_INPUT);
 		if (rc == -1) {
 			fprintf(stderr, "%s: failed to populate svrattrl \n", argv[0]);
@@ -2260,6 +2278,27 @@ main(int argc, char *argv[], char *envp[])
 						"Encountered an error while setting event");
 				}
 				break;
+			case HOOK_EVENT_PERIODIC:
+				req_params.vns_list = &event_vnode;
+				req_params.resv_list = &event_resvs;
+				rc = pbs_python_event_set(hook_event, req_user, req_host, &req_params, perf_label);
+
+				if (rc == -1) { /* internal server code failure */
+					log_event(PBSEVENT_DEBUG,
+						PBS_EVENTCLASS_HOOK, LOG_ERR,
+						hook_name,
+						"Encountered an error while setting event");
+				}
+
+				if ((svrattrl_e = find_svrattrl_list_entry(&event,
+					PY_EVENT_FREQ, NULL)) != NULL) {
+					if (pbs_python_event_set_attrval(PY_EVENT_FREQ,
+						svrattrl_e->al_value) == -1)
+						log_event(PBSEVENT_DEBUG,
+							PBS_EVENTCLASS_HOOK, LOG_ERR,
+							hook_name, "Failed to set event 'freq'.");
+				}
+				break;
 			default:
 				log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_HOOK, LOG_ERR,
 					hook_name, "Unexpected event");
@@ -2682,6 +2721,32 @@ main(int argc, char *argv[], char *envp[])
 						&event_jobs);
 				}
 				break;
+			case HOOK_EVENT_PERIODIC:
+				if (pbs_python_event_get_accept_flag() == FALSE) {
+					rej_msg = pbs_python_event_get_reject_msg();
+					fprintf(fp_out, "%s=True\n", EVENT_REJECT_OBJECT);
+					fprintf(fp_out, "%s=False\n", EVENT_ACCEPT_OBJECT);
+					if (rej_msg != NULL)
+						fprintf(fp_out, "%s=%s\n", EVENT_REJECT_MSG_OBJECT,
+							rej_msg);
+				} else {
+					fprintf(fp_out, "%s=True\n", EVENT_ACCEPT_OBJECT);
+					fprintf(fp_out, "%s=False\n", EVENT_REJECT_OBJECT);
+				}
+				/* show vnode_list changes whether or not accepted or */
+				/*  rejected */
+				free_attrlist(&event_vnode);
+				CLEAR_HEAD(event_vnode);
+				free_attrlist(&event_resvs);
+				CLEAR_HEAD(event_resvs);
+				req_params_out.vns_list = (pbs_list_head *)&event_vnode;
+				req_params_out.resv_list = (pbs_list_head *)&event_resvs;
+				pbs_python_event_to_request(hook_event,
+					&req_params_out, perf_label, perf_action);
+
+				fprint_svrattrl_list(fp_out, EVENT_VNODELIST_OBJECT,
+					&event_vnode);
+				break;
 			case HOOK_EVENT_EXECJOB_ATTACH:
 			case HOOK_EVENT_EXECJOB_RESIZE:
 
@@ -2737,6 +2802,8 @@ pbs_python_end:
 		CLEAR_HEAD(event_argv);
 		free_attrlist(&event_jobs);
 		CLEAR_HEAD(event_jobs);
+		free_attrlist(&event_resvs);
+		CLEAR_HEAD(event_resvs);
 		if (progname != NULL)
 			free(progname);
 		if (env_str != NULL)
@@ -0,0 +1,575 @@
+/*
+ * Copyright (C) 1994-2021 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of both the OpenPBS software ("OpenPBS")
+ * and the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * OpenPBS is free software. You can redistribute it and/or modify it under
+ * the terms of the GNU Affero General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * PBS Pro is commercially licensed software that shares a common core with
+ * the OpenPBS software.  For a copy of the commercial license terms and
+ * conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+ * Altair Legal Department.
+ *
+ * Altair's dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of OpenPBS and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair's trademarks, including but not limited to "PBS™",
+ * "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+ * subject to Altair's trademark licensing policies.
+ */
+
+/**
+ * @file pbs_tpp_bench.c
+ *
+ * @brief
+ *		pbs_tpp_bench.c - routing throughput benchmark of the TPP router
+ *
+ *	Runs a pbs_comm router in process on a localhost port and connects a
+ *	number of synthetic leaves to it over TCP. Each leaf registers many
+ *	addresses, as if it fronted a set of MoMs, and then sends TPP_DATA
+ *	packets to random addresses of the other leaves while a receiver thread
+ *	per leaf counts what the router delivered. The leaves speak the wire
+ *	protocol directly and authenticate with reserved ports, so this must
+ *	be run as root. The router must be given a host name that resolves to
+ *	a non loopback address, the leaves connect to it over the loopback.
+ *
+ * Functions included are:
+ * 	main()
+ * 	now()
+ * 	leaf_addr()
+ * 	write_all()
+ * 	leaf_connect()
+ * 	leaf_join()
+ * 	leaf_probe()
+ * 	sender()
+ * 	receiver()
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "pbs_internal.h"
+#include "auth.h"
+#include "avltree.h"
+#include "tpp_internal.h"
+
+#define BENCH_SEND_BUF	(64 * 1024)	/* packets are written in batches of this size */
+#define BENCH_RECV_BUF	(256 * 1024)
+#define BENCH_WINDOW	100000		/* max packets in flight through the router */
+
+/* a synthetic leaf */
+typedef struct {
+	int fd;			/* connection to the router */
+	int index;		/* leaf number */
+	tpp_addr_t *addrs;	/* addresses registered by the leaf */
+	long sent;		/* data packets sent */
+	long received;		/* data packets delivered to the leaf */
+	pthread_t send_tid;
+	pthread_t recv_tid;
+} bench_leaf;
+
+static bench_leaf *leaves;
+static int num_leaves = 64;
+static int num_addrs = 64;	/* addresses per leaf */
+static long num_msgs = 50000;	/* packets sent per leaf */
+static int payload = 64;	/* payload bytes per packet */
+static volatile long total_sent;
+static volatile long total_received;
+
+/**
+ * @brief
+ *	return the time in seconds from a monotonic clock
+ */
+static double
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief
+ *	make the j'th synthetic address of leaf i, a 10/8 address on the MoM
+ *	port, so every address in the run is distinct
+ *
+ * @param[in]  i    - leaf number
+ * @param[in]  j    - address number
+ * @param[out] addr - the address
+ */
+static void
+leaf_addr(int i, int j, tpp_addr_t *addr)
+{
+	memset(addr, 0, sizeof(tpp_addr_t));
+	addr->ip[0] = htonl(0x0a000000 | (i * num_addrs + j + 1));
+	addr->port = htons(15003);
+	addr->family = TPP_ADDR_FAMILY_IPV4;
+}
+
+/**
+ * @brief
+ *	write the whole buffer to the socket
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - failure
+ */
+static int
+write_all(int fd, char *buf, size_t len)
+{
+	while (len > 0) {
+		ssize_t rc = write(fd, buf, len);
+
+		if (rc == -1) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		buf += rc;
+		len -= rc;
+	}
+	return 0;
+}
+
+/**
+ * @brief
+ *	connect to the router from the next free reserved port
+ *
+ * @param[in]     port     - router port
+ * @param[in,out] resvport - next reserved port to try
+ *
+ * @return int
+ * @retval >=0 - socket
+ * @retval -1  - failure
+ */
+static int
+leaf_connect(int port, int *resvport)
+{
+	struct sockaddr_in in;
+	int fd;
+	int one = 1;
+
+	for (; *resvport >= 512; (*resvport)--) {
+		if ((fd = socket(AF_INET, SOCK_STREAM, 0)) == -1)
+			return -1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+		memset(&in, 0, sizeof(in));
+		in.sin_family = AF_INET;
+		in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		in.sin_port = htons(*resvport);
+		if (bind(fd, (struct sockaddr *) &in, sizeof(in)) == -1) {
+			close(fd);
+			if (errno == EACCES)
+				return -1;
+			continue;
+		}
+
+		in.sin_port = htons(port);
+		if (connect(fd, (struct sockaddr *) &in, sizeof(in)) == -1) {
+			close(fd);
+			continue;
+		}
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		(*resvport)--;
+		return fd;
+	}
+	return -1;
+}
+
+/**
+ * @brief
+ *	register all the addresses of a leaf with the router
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - failure
+ */
+static int
+leaf_join(bench_leaf *lf)
+{
+	tpp_join_pkt_hdr_t hdr;
+	struct iovec iov[2];
+	size_t len = sizeof(hdr) + num_addrs * sizeof(tpp_addr_t);
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.ntotlen = htonl(len);
+	hdr.type = TPP_CTL_JOIN;
+	hdr.node_type = TPP_LEAF_NODE;
+	hdr.hop = 1;
+	hdr.index = 0;
+	hdr.num_addrs = num_addrs;
+
+	iov[0].iov_base = &hdr;
+	iov[0].iov_len = sizeof(hdr);
+	iov[1].iov_base = lf->addrs;
+	iov[1].iov_len = num_addrs * sizeof(tpp_addr_t);
+	if (writev(lf->fd, iov, 2) != (ssize_t) len)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	fill in a data packet from leaf lf to the given address
+ *
+ * @param[out] buf  - packet buffer, at least sizeof(tpp_data_pkt_hdr_t) + payload
+ * @param[in]  lf   - sending leaf
+ * @param[in]  dest - destination address
+ *
+ * @return size of the packet
+ */
+static size_t
+build_data_pkt(char *buf, bench_leaf *lf, tpp_addr_t *dest)
+{
+	tpp_data_pkt_hdr_t *dhdr = (tpp_data_pkt_hdr_t *) buf;
+	size_t len = sizeof(tpp_data_pkt_hdr_t) + payload;
+
+	memset(dhdr, 0, sizeof(tpp_data_pkt_hdr_t));
+	dhdr->ntotlen = htonl(len);
+	dhdr->type = TPP_DATA;
+	dhdr->src_sd = htonl(lf->index);
+	dhdr->dest_sd = htonl(0);
+	dhdr->totlen = htonl(payload);
+	memcpy(&dhdr->src_addr, &lf->addrs[0], sizeof(tpp_addr_t));
+	memcpy(&dhdr->dest_addr, dest, sizeof(tpp_addr_t));
+	memset(buf + sizeof(tpp_data_pkt_hdr_t), 'x', payload);
+	return len;
+}
+
+/**
+ * @brief
+ *	read packets from the router until a data packet arrives, which shows
+ *	the router has processed the join of this leaf
+ *
+ * @return int
+ * @retval 0 - success
+ * @retval -1 - failure
+ */
+static int
+leaf_probe(bench_leaf *lf)
+{
+	char *buf;
+	size_t len;
+	int pkt_len;
+	unsigned char type;
+
+	if ((buf = malloc(sizeof(tpp_data_pkt_hdr_t) + payload)) == NULL)
+		return -1;
+	len = build_data_pkt(buf, lf, &lf->addrs[0]);
+	if (write_all(lf->fd, buf, len) == -1) {
+		free(buf);
+		return -1;
+	}
+	free(buf);
+
+	do {
+		if (recv(lf->fd, &pkt_len, sizeof(int), MSG_WAITALL) != sizeof(int))
+			return -1;
+		pkt_len = ntohl(pkt_len) - sizeof(int);
+		if (pkt_len <= 0 || (buf = malloc(pkt_len)) == NULL)
+			return -1;
+		if (recv(lf->fd, buf, pkt_len, MSG_WAITALL) != pkt_len) {
+			free(buf);
+			return -1;
+		}
+		type = buf[0];
+		free(buf);
+	} while (type != TPP_DATA);
+	return 0;
+}
+
+/**
+ * @brief
+ *	sender thread: send num_msgs data packets to random addresses of the
+ *	other leaves, keeping at most BENCH_WINDOW packets in flight overall
+ *
+ * @param[in] arg - the leaf
+ */
+static void *
+sender(void *arg)
+{
+	bench_leaf *lf = (bench_leaf *) arg;
+	unsigned int seed = lf->index + 1;
+	size_t pkt_len = sizeof(tpp_data_pkt_hdr_t) + payload;
+	char *buf;
+	size_t used = 0;
+
+	if ((buf = malloc(BENCH_SEND_BUF + pkt_len)) == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	while (lf->sent < num_msgs) {
+		int i = rand_r(&seed) % num_leaves;
+		int j = rand_r(&seed) % num_addrs;
+
+		if (num_leaves > 1 && i == lf->index)
+			i = (i + 1) % num_leaves;
+
+		used += build_data_pkt(buf + used, lf, &leaves[i].addrs[j]);
+		lf->sent++;
+
+		if (used >= BENCH_SEND_BUF || lf->sent == num_msgs) {
+			long batch = used / pkt_len;
+
+			while (__atomic_load_n(&total_sent, __ATOMIC_RELAXED) -
+			       __atomic_load_n(&total_received, __ATOMIC_RELAXED) > BENCH_WINDOW)
+				usleep(100);
+			__atomic_add_fetch(&total_sent, batch, __ATOMIC_RELAXED);
+			if (write_all(lf->fd, buf, used) == -1) {
+				perror("write");
+				exit(1);
+			}
+			used = 0;
+		}
+	}
+	free(buf);
+	return NULL;
+}
+
+/**
+ * @brief
+ *	receiver thread: count the data packets the router delivers to a leaf
+ *
+ * @param[in] arg - the leaf
+ */
+static void *
+receiver(void *arg)
+{
+	bench_leaf *lf = (bench_leaf *) arg;
+	char *buf;
+	size_t have = 0;
+
+	if ((buf = malloc(BENCH_RECV_BUF)) == NULL) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	for (;;) {
+		ssize_t rc;
+		size_t pos = 0;
+		long n = 0;
+
+		rc = recv(lf->fd, buf + have, BENCH_RECV_BUF - have, 0);
+		if (rc <= 0) {
+			if (rc == -1 && (errno == EINTR || errno == EAGAIN))
+				continue;
+			break;
+		}
+		have += rc;
+
+		while (have - pos >= sizeof(int)) {
+			int pkt_len;
+
+			memcpy(&pkt_len, buf + pos, sizeof(int));
+			pkt_len = ntohl(pkt_len);
+			if (pkt_len < (int) (sizeof(int) + 1) || pkt_len > BENCH_RECV_BUF) {
+				fprintf(stderr, "leaf %d: bad packet length %d\n", lf->index, pkt_len);
+				exit(1);
+			}
+			if (have - pos < (size_t) pkt_len)
+				break;
+			if ((unsigned char) buf[pos + sizeof(int)] == TPP_DATA)
+				n++;
+			pos += pkt_len;
+		}
+		memmove(buf, buf + pos, have - pos);
+		have -= pos;
+
+		if (n > 0) {
+			lf->received += n;
+			__atomic_add_fetch(&total_received, n, __ATOMIC_RELAXED);
+		}
+	}
+	free(buf);
+	return NULL;
+}
+
+/**
+ * @brief
+ *      This is main function of pbs_tpp_bench.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: failure
+ *
+ */
+int
+main(int argc, char *argv[])
+{
+	struct tpp_config conf;
+	char *supported[] = {AUTH_RESVPORT_NAME, NULL};
+	char host[PBS_MAXHOSTNAME + 1];
+	char nopath[] = "";
+	int port = 17101;
+	int nthreads = 4;
+	int resvport = 1023;
+	long received;
+	long last;
+	double t;
+	double last_change;
+	int c;
+	int i;
+	int j;
+
+	/* the router resolves its own name and ignores loopback addresses */
+	if (gethostname(host, sizeof(host)) == -1) {
+		perror("gethostname");
+		return 1;
+	}
+
+	while ((c = getopt(argc, argv, "H:t:l:a:m:s:p:")) != -1)
+		switch (c) {
+			case 'H':
+				snprintf(host, sizeof(host), "%s", optarg);
+				break;
+			case 't':
+				nthreads = atoi(optarg);
+				break;
+			case 'l':
+				num_leaves = atoi(optarg);
+				break;
+			case 'a':
+				num_addrs = atoi(optarg);
+				break;
+			case 'm':
+				num_msgs = atol(optarg);
+				break;
+			case 's':
+				payload = atoi(optarg);
+				break;
+			case 'p':
+				port = atoi(optarg);
+				break;
+			default:
+				goto usage;
+		}
+
+	if (nthreads < 2 || num_leaves <= 0 || num_leaves > 500 ||
+	    num_addrs <= 0 || num_addrs > 128 || num_msgs <= 0 || payload < 0 || port <= 0)
+		goto usage;
+
+	signal(SIGPIPE, SIG_IGN);
+
+	/* the router, as pbs_comm sets it up, with reserved port authentication */
+	memset(&pbs_conf, 0, sizeof(pbs_conf));
+	strcpy(pbs_conf.auth_method, AUTH_RESVPORT_NAME);
+	pbs_conf.supported_auth_methods = supported;
+	pbs_conf.pbs_exec_path = nopath;	/* no auth library is loaded for resvport */
+	pbs_conf.pbs_home_path = nopath;
+	memset(&conf, 0, sizeof(conf));
+	if (set_tpp_config(&pbs_conf, &conf, host, port, NULL) == -1) {
+		fprintf(stderr, "failed to set up tpp config\n");
+		return 1;
+	}
+	conf.node_type = TPP_ROUTER_NODE;
+	conf.numthreads = nthreads;
+	avl_set_maxthreads(nthreads + 1);
+	if (tpp_init_router(&conf) == -1) {
+		fprintf(stderr, "failed to start router on port %d\n", port);
+		return 1;
+	}
+
+	if ((leaves = calloc(num_leaves, sizeof(bench_leaf))) == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	t = now();
+	for (i = 0; i < num_leaves; i++) {
+		bench_leaf *lf = &leaves[i];
+
+		lf->index = i;
+		if ((lf->addrs = calloc(num_addrs, sizeof(tpp_addr_t))) == NULL) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+		for (j = 0; j < num_addrs; j++)
+			leaf_addr(i, j, &lf->addrs[j]);
+
+		if ((lf->fd = leaf_connect(port, &resvport)) == -1) {
+			fprintf(stderr, "leaf %d could not connect from a reserved port: %s\n", i, strerror(errno));
+			return 1;
+		}
+		if (leaf_join(lf) == -1 || leaf_probe(lf) == -1) {
+			fprintf(stderr, "leaf %d failed to join\n", i);
+			return 1;
+		}
+	}
+	printf("%d leaves with %d addresses each joined in %.3f s\n",
+	       num_leaves, num_addrs, now() - t);
+
+	for (i = 0; i < num_leaves; i++) {
+		if (pthread_create(&leaves[i].recv_tid, NULL, receiver, &leaves[i]) != 0) {
+			fprintf(stderr, "pthread_create failed\n");
+			return 1;
+		}
+	}
+	t = now();
+	for (i = 0; i < num_leaves; i++) {
+		if (pthread_create(&leaves[i].send_tid, NULL, sender, &leaves[i]) != 0) {
+			fprintf(stderr, "pthread_create failed\n");
+			return 1;
+		}
+	}
+	for (i = 0; i < num_leaves; i++)
+		pthread_join(leaves[i].send_tid, NULL);
+
+	/* wait for the router to deliver everything, or to stop making progress */
+	last = -1;
+	last_change = now();
+	while ((received = __atomic_load_n(&total_received, __ATOMIC_RELAXED)) < total_sent &&
+	       now() - last_change < 5) {
+		if (received != last) {
+			last = received;
+			last_change = now();
+		}
+		usleep(1000);
+	}
+	t = (received < total_sent ? last_change : now()) - t;
+
+	printf("router threads %d, leaves %d, addresses %d, payload %d bytes\n",
+	       nthreads, num_leaves, num_leaves * num_addrs, payload);
+	printf("%ld of %ld packets routed in %.3f s, %.0f packets/s, %.1f MB/s\n",
+	       received, total_sent, t, t > 0 ? received / t : 0,
+	       t > 0 ? received * (double) (sizeof(tpp_data_pkt_hdr_t) + payload) / t / 1e6 : 0);
+
+	for (i = 0; i < num_leaves; i++)
+		shutdown(leaves[i].fd, SHUT_RDWR);
+	return received == total_sent ? 0 : 1;
+
+usage:
+	fprintf(stderr, "usage: %s [-H router host] [-t router threads, at least 2] [-l leaves] [-a addresses per leaf]"
+		" [-m packets per leaf] [-s payload bytes] [-p port]\n", argv[0]);
+	return 1;
+}
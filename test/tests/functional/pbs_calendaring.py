@@ -228,3 +228,40 @@ class TestCalendaring(TestFunctional):
         est_time = job3[0]['estimated.start_time']
         est_time = time.mktime(time.strptime(est_time, '%c'))
         self.assertAlmostEqual(end_time, est_time, delta=1)
+
+    def test_topjobs_chain_on_end_events(self):
+        """
+        Test that top jobs which each start when the previous one ends are
+        calendared back to back.  The end and run events of each pair are at
+        the same time, and the end event has to be simulated first.
+        """
+        self.scheduler.set_sched_config({'strict_ordering': 'true all'})
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        a = {'backfill_depth': '10'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        a = {'opt_backfill_fuzzy': 'off'}
+        self.server.manager(MGR_CMD_SET, SCHED, a)
+
+        res_req = {'Resource_List.select': '1:ncpus=1',
+                   'Resource_List.walltime': 100}
+        j = Job(TEST_USER, attrs=res_req)
+        j.set_sleep_time(100)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for _ in range(5):
+            jids.append(self.server.submit(Job(TEST_USER, attrs=res_req)))
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+
+        starts = []
+        for j in jids:
+            self.server.expect(JOB, 'estimated.start_time', op=SET, id=j)
+            st = self.server.status(JOB, 'estimated.start_time', id=j)
+            est = st[0]['estimated.start_time']
+            starts.append(int(time.mktime(time.strptime(est, '%c'))))
+
+        for i in range(1, len(starts)):
+            self.assertEqual(starts[i], starts[i - 1] + 100)
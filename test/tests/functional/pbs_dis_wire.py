@@ -0,0 +1,125 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestDisWire(TestFunctional):
+    """
+    Test that the scheduler and server exchange objects correctly once
+    the scheduler connection has switched to the binary wire encoding
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        attr = {'type': 'long', 'flag': 'nh'}
+        self.server.manager(MGR_CMD_CREATE, RSC, attr, id='bigl')
+        attr = {'type': 'float', 'flag': 'nh'}
+        self.server.manager(MGR_CMD_CREATE, RSC, attr, id='fl')
+        self.scheduler.add_resource('bigl,fl')
+        a = {'resources_available.ncpus': 4,
+             'resources_available.bigl': 9000000000000000000,
+             'resources_available.fl': 2.5}
+        self.mom.create_vnodes(attrib=a, num=1)
+
+    def test_binary_negotiated(self):
+        """
+        The scheduler asks for the binary encoding when it registers and
+        the server switches the connection to it
+        """
+        t = time.time()
+        self.scheduler.restart()
+        self.server.log_match('switched to dis_wire_bin', starttime=t)
+
+    def test_values_round_trip(self):
+        """
+        Large and negative integers and long strings the scheduler reads
+        from the server must arrive intact, so the job it runs gets the
+        resources it asked for
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        big = 'x' * 100000
+        a = {'Resource_List.bigl': 8999999999999999999,
+             'Resource_List.ncpus': 3,
+             'Priority': -1000,
+             ATTR_v: 'BIGVAR=' + big}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'Resource_List.bigl': 8999999999999999999,
+                                 'Priority': -1000}, id=jid)
+        self.server.expect(NODE, {'resources_assigned.ncpus': 3,
+                                  'resources_assigned.bigl':
+                                  8999999999999999999},
+                           id=self.mom.shortname + '[0]')
+        self.scheduler.log_match(jid + ';Job run')
+
+    def test_float_round_trip(self):
+        """
+        Floating point values, zero among them, must reach the scheduler
+        intact so it places jobs by them
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for fl in ['0.0', '1.5', '0.0', '1.5']:
+            a = {'Resource_List.fl': fl, 'Resource_List.ncpus': 1}
+            jids.append(self.server.submit(Job(TEST_USER, attrs=a)))
+        self.scheduler.run_scheduling_cycle()
+        for jid in jids[:3]:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        # 0.0 + 1.5 + 0.0 leaves 1.0 of 2.5, too little for the last job
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jids[3])
+        self.server.expect(NODE, {'resources_assigned.fl': 1.5},
+                           id=self.mom.shortname + '[0]')
+
+    def test_reregister_after_restart(self):
+        """
+        A restarted scheduler registers again and keeps scheduling; a
+        restarted server starts its new connections in DIS
+        """
+        j = Job(TEST_USER, attrs={'Resource_List.ncpus': 1})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        self.scheduler.restart()
+        self.server.restart()
+        j = Job(TEST_USER, attrs={'Resource_List.ncpus': 1})
+        jid2 = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+        self.server.expect(SERVER, {'server_state': 'Active'})
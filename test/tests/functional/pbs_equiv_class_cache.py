@@ -0,0 +1,131 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+
+
+from tests.functional import *
+
+
+class TestEquivClassCache(TestFunctional):
+    """
+    Test that equivalence classes which could not run are carried over
+    to the next cycle while nothing they depend on changes
+    """
+
+    msg = 'could not run last cycle and nothing has changed'
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+        self.scheduler.set_sched_attr({'log_events': 2047})
+
+    def cycle(self):
+        """
+        Run a cycle and return its start time
+        """
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        self.scheduler.log_match('Leaving Scheduling Cycle', starttime=t)
+        return t
+
+    def test_ec_cache_resources(self):
+        """
+        Jobs which don't fit on the nodes are skipped with the same comment
+        until a node changes
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j1 = Job(TEST_USER, attrs={'Resource_List.ncpus': 1})
+        j1.set_sleep_time(1000)
+        jid1 = self.server.submit(j1)
+        a = {'Resource_List.ncpus': 1}
+        jids = [self.server.submit(Job(TEST_USER, attrs=a))
+                for _ in range(3)]
+
+        # j1 runs, so nothing can be carried over from this cycle
+        self.cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        comment = 'Not Running: Insufficient amount of resource: ncpus ' + \
+            '(R: 1 A: 0 T: 1)'
+        for jid in jids:
+            self.server.expect(JOB, {'comment': comment}, id=jid)
+
+        # the universe is the same, the second cycle's results are reused
+        self.cycle()
+        t = self.cycle()
+        self.scheduler.log_match(self.msg, starttime=t)
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'Q', 'comment': comment},
+                               id=jid)
+
+        # more ncpus on the node throws the cache away
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+        t = self.cycle()
+        self.scheduler.log_match(self.msg, starttime=t, existence=False,
+                                 max_attempts=2)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[0])
+
+    def test_ec_cache_limits(self):
+        """
+        Jobs over a run limit stay queued while the limit holds and run
+        once the running job is gone
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        a = {'max_run': '[u:PBS_GENERIC=1]'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 4},
+                            id=self.mom.shortname)
+        j1 = Job(TEST_USER)
+        j1.set_sleep_time(1000)
+        jid1 = self.server.submit(j1)
+        jid2 = self.server.submit(Job(TEST_USER))
+
+        self.cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.cycle()
+        t = self.cycle()
+        self.scheduler.log_match(self.msg, starttime=t)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid2)
+
+        self.server.delete(jid1, wait=True)
+        self.cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
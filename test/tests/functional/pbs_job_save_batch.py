@@ -0,0 +1,103 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestJobSaveBatch(TestFunctional):
+    """
+    Test that job changes written through the server's job save journal
+    reach the database
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def test_batched_saves_survive_kill(self):
+        """
+        Repeated changes to many jobs are all persisted, with the last
+        value winning, and survive an abrupt server restart
+        """
+        jids = [self.server.submit(Job(TEST_USER)) for _ in range(50)]
+        for i in range(3):
+            for jid in jids:
+                self.server.alterjob(jid, {'Account_Name': 'acct%d' % i})
+        for jid in jids[:10]:
+            self.server.holdjob(jid)
+        self.server.expect(JOB, {'job_state': 'H'}, id=jids[0])
+
+        self.server.stop('-KILL')
+        self.server.start()
+
+        for jid in jids:
+            self.server.expect(JOB, {'Account_Name': 'acct2'}, id=jid)
+        for jid in jids[:10]:
+            self.server.expect(JOB, {'job_state': 'H'}, id=jid)
+        for jid in jids[10:]:
+            self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+
+    def test_deleted_job_not_saved(self):
+        """
+        A job deleted while its save is pending is gone after a restart
+        and leaves no save error behind
+        """
+        jid = self.server.submit(Job(TEST_USER))
+        t = time.time()
+        self.server.alterjob(jid, {'Account_Name': 'gone'})
+        self.server.deljob(jid, wait=True)
+        self.server.restart()
+        self.server.expect(JOB, 'queue', op=UNSET, id=jid)
+        self.server.log_match('Failed to save job %s' % jid,
+                              starttime=t, existence=False,
+                              max_attempts=5)
+
+    def test_running_job_saved_before_sent(self):
+        """
+        A job sent to the MoM is recovered as running after the server
+        is killed right after the run
+        """
+        j = Job(TEST_USER)
+        j.set_sleep_time(1000)
+        jid = self.server.submit(j)
+        self.server.runjob(jid)
+        self.server.stop('-KILL')
+        self.server.start()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
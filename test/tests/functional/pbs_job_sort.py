@@ -0,0 +1,110 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+
+
+from tests.functional import *
+
+
+class TestJobSort(TestFunctional):
+    """
+    Test the order in which the scheduler considers jobs
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.mom.shortname)
+        self.scheduler.set_sched_config({'job_sort_key': '"ncpus HIGH"'})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def submit_jobs(self, ncpus):
+        """
+        Submit one job per entry of ncpus and return job id -> ncpus
+        """
+        jobs = {}
+        for n in ncpus:
+            a = {'Resource_List.ncpus': n}
+            jobs[self.server.submit(Job(TEST_USER, attrs=a))] = n
+        return jobs
+
+    def considered_order(self):
+        """
+        Run a cycle and return the job ids in the order considered
+        """
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        self.scheduler.log_match('Leaving Scheduling Cycle', starttime=t)
+        lines = self.scheduler.log_match('Considering job to run',
+                                         starttime=t, allmatch=True,
+                                         n='ALL')
+        return [l[1].split(';')[4] for l in lines]
+
+    def check_order(self, jobs, order):
+        """
+        Jobs must come in descending ncpus, ties in submission order
+        """
+        self.assertEqual(sorted(order), sorted(jobs))
+        for j1, j2 in zip(order, order[1:]):
+            self.assertGreaterEqual(jobs[j1], jobs[j2])
+            if jobs[j1] == jobs[j2]:
+                self.assertLess(int(j1.split('.')[0]),
+                                int(j2.split('.')[0]))
+
+    def test_sort_key_order(self):
+        """
+        Jobs are considered by job_sort_key, then in submission order
+        """
+        jobs = self.submit_jobs([2, 5, 1, 5, 3, 2])
+        self.check_order(jobs, self.considered_order())
+
+    def test_sort_key_order_threads(self):
+        """
+        A job list big enough to be keyed and sorted in parallel chunks
+        comes out in the same order as a small one
+        """
+        self.du.set_pbs_config(confs={'PBS_SCHED_THREADS': 4},
+                               append=True)
+        self.scheduler.restart()
+        jobs = self.submit_jobs([(i * 7) % 11 + 1 for i in range(2500)])
+        order = self.considered_order()
+        self.du.unset_pbs_config(confs=['PBS_SCHED_THREADS'])
+        self.scheduler.restart()
+        self.check_order(jobs, order)
@@ -72,3 +72,38 @@ class TestJobSortFormula(TestFunctional):
             self.assertEqual(job.split('.')[0], c.political_order[i])
 
         self.server.expect(JOB, {'job_state=R': 2})
+
+    def test_job_sort_formula_operators(self):
+        """
+        Test that a formula using builtins, conditionals, floor
+        division and modulo evaluates and sorts jobs the same way
+        Python would
+        """
+        a = {'resources_available.ncpus': 8}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_CREATE, RSC, {'type': 'float'}, id='foo')
+
+        formula = 'min(ncpus, 4) * 2 + (10 if foo > 1 else 0) - ' \
+                  '(-7 // 2) % 3 + foo / 4'
+        a = {'job_sort_formula': formula, 'scheduling': 'False'}
+        self.server.manager(MGR_CMD_SET, SERVER, a, runas=ROOT_USER)
+
+        jids = []
+        for ncpus, foo in [(1, 2), (3, 0), (2, 5)]:
+            j = Job(TEST_USER, attrs={'Resource_List.ncpus': ncpus,
+                                      'Resource_List.foo': foo})
+            jids.append(self.server.submit(j))
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        values = ['10.5', '4', '13.25']
+        for jid, val in zip(jids, values):
+            self.scheduler.log_match(jid + ';Formula Evaluation = ' + val)
+
+        c = self.scheduler.cycles(lastN=1)[0]
+        job_order = [jids[2], jids[0], jids[1]]
+        for i, job in enumerate(job_order):
+            self.assertEqual(job.split('.')[0], c.political_order[i])
+
+        self.server.expect(JOB, {'job_state=R': 3})
@@ -0,0 +1,104 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestLogAsync(TestFunctional):
+    """
+    Test daemon logging from a writer thread (PBS_LOG_ASYNC)
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.du.set_pbs_config(self.server.hostname,
+                               confs={'PBS_LOG_ASYNC': '1'})
+        self.server.restart()
+        self.scheduler.restart()
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047,
+                                                  'job_history_enable':
+                                                  'True'})
+
+    def tearDown(self):
+        self.du.unset_pbs_config(self.server.hostname,
+                                 confs=['PBS_LOG_ASYNC'])
+        self.server.restart()
+        self.scheduler.restart()
+        TestFunctional.tearDown(self)
+
+    def test_async_log_records(self):
+        """
+        Records logged by the server and scheduler in async mode, and the
+        accounting records of the server, all make it to the logs
+        """
+        a = {'Resource_List.select': '1:ncpus=1',
+             'Resource_List.walltime': 10}
+        j = Job(TEST_USER, attrs=a)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x',
+                           offset=1, max_attempts=60)
+        for m in [';enqueuing into workq', ';Job Run at request',
+                  ';Exit_status=0']:
+            self.server.log_match(jid + m)
+        self.scheduler.log_match(jid + ';Job run')
+        for t in ['Q', 'S', 'E']:
+            self.server.accounting_match(msg=';' + t + ';' + jid + ';',
+                                         id=jid)
+        self.server.log_match('log records dropped', existence=False,
+                              max_attempts=2)
+
+    def test_async_log_flushed_at_shutdown(self):
+        """
+        Records queued just before the server shuts down are written out
+        """
+        t = time.time()
+        self.server.stop()
+        self.server.log_match('Log closed', starttime=t)
+        self.server.start()
+
+    def test_async_log_reopen_on_hup(self):
+        """
+        Logging continues in async mode after the server reopens its log
+        """
+        self.server.signal('-HUP')
+        t = time.time()
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.log_match(jid + ';enqueuing into workq', starttime=t)
@@ -0,0 +1,124 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+
+from tests.functional import *
+
+
+class TestNodeEligibility(TestFunctional):
+    """
+    Test that node eligibility follows node state changes made while
+    the scheduler runs jobs within a single cycle
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 2}
+        self.mom.create_vnodes(attrib=a, num=4, sharednode=False)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.vn = [self.mom.shortname + '[' + str(i) + ']' for i in range(4)]
+
+    def submit_and_run(self, num, attrs):
+        """
+        Submit num jobs, run one cycle and return the vnodes of the
+        running jobs and the ids of the queued ones
+        """
+        jids = []
+        for _ in range(num):
+            jids.append(self.server.submit(Job(TEST_USER, attrs=attrs)))
+        self.scheduler.run_scheduling_cycle()
+
+        vnodes = []
+        queued = []
+        for jid in jids:
+            j = self.server.status(JOB, ['job_state', 'exec_vnode'], id=jid)
+            if j[0]['job_state'] == 'R':
+                vnodes += Job(TEST_USER).get_vnodes(j[0]['exec_vnode'])
+            else:
+                queued.append(jid)
+        return vnodes, queued
+
+    def test_excl_within_cycle(self):
+        """
+        Jobs asking for place=excl may not share a vnode with a job the
+        scheduler started earlier in the same cycle
+        """
+        a = {'Resource_List.select': '1:ncpus=1',
+             'Resource_List.place': 'excl'}
+        vnodes, queued = self.submit_and_run(6, a)
+        self.assertEqual(sorted(vnodes), sorted(self.vn))
+        self.assertEqual(len(queued), 2)
+
+    def test_node_max_running_within_cycle(self):
+        """
+        A vnode's max_running is honoured for jobs the scheduler started
+        earlier in the same cycle
+        """
+        for v in self.vn:
+            self.server.manager(MGR_CMD_SET, NODE, {'max_running': 1}, id=v)
+        a = {'Resource_List.select': '1:ncpus=1'}
+        vnodes, queued = self.submit_and_run(6, a)
+        self.assertEqual(sorted(vnodes), sorted(self.vn))
+        self.assertEqual(len(queued), 2)
+
+    def test_node_table_filter(self):
+        """
+        The node table decides eligibility for plain vnodes on its own,
+        hands vnodes with user/group run limits to the detailed check
+        and skips vnodes which are ineligible for the whole cycle
+        """
+        self.server.manager(MGR_CMD_SET, SCHED, {'log_events': 4095})
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            id=self.vn[0])
+        self.server.manager(MGR_CMD_SET, NODE, {'max_user_run': 1},
+                            id=self.vn[3])
+        num_nodes = len(self.server.status(NODE))
+
+        a = {'Resource_List.select': '1:ncpus=1'}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+
+        msg = '%s;Node table: %d nodes eligible, 1 checked in detail, ' \
+            '1 already ineligible' % (jid, num_nodes - 2)
+        self.scheduler.log_match(msg)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        j = self.server.status(JOB, ['exec_vnode'], id=jid)
+        vnodes = Job(TEST_USER).get_vnodes(j[0]['exec_vnode'])
+        self.assertNotIn(self.vn[0], vnodes)
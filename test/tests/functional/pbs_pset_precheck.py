@@ -0,0 +1,122 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+import re
+
+
+class TestPsetPrecheck(TestFunctional):
+    """
+    Test that the placement sets checked for fit on the worker threads
+    are checked a window at a time and give the same placement
+    """
+    num_vnodes = 150
+    big_vnode = 77
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_CREATE, RSC,
+                            {'type': 'string', 'flag': 'h'}, id='grp')
+        a = {'resources_available.ncpus': 1}
+        self.mom.create_vnodes(attrib=a, num=self.num_vnodes,
+                               sharednode=False, attrfunc=self.vnode_attrs,
+                               expect=False)
+        self.server.expect(NODE, {'state=free': (GE, self.num_vnodes)})
+        a = {'node_group_enable': 'True', 'node_group_key': 'grp',
+             'scheduling': 'False'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        self.scheduler.set_sched_attr({'log_events': 4095})
+        self.du.set_pbs_config(confs={'PBS_SCHED_THREADS': 2},
+                               append=True)
+        self.scheduler.restart()
+
+    def tearDown(self):
+        self.du.unset_pbs_config(confs=['PBS_SCHED_THREADS'])
+        self.scheduler.restart()
+        TestFunctional.tearDown(self)
+
+    def vnode_attrs(self, name, total, node_num, attribs):
+        """
+        Put every vnode in its own placement set and give one of them
+        an extra cpu
+        """
+        a = attribs.copy()
+        a['resources_available.grp'] = 'g' + str(node_num)
+        if node_num == self.big_vnode:
+            a['resources_available.ncpus'] = 2
+        return a
+
+    def prechecked(self, jid, starttime):
+        """
+        Return the number of placement sets prechecked for a job
+        """
+        msg = r'%s;Prechecked (\d+) of (\d+) placement sets' % jid
+        m = self.scheduler.log_match(msg, regexp=True, starttime=starttime)
+        r = re.search(msg, m[1])
+        self.assertEqual(int(r.group(2)), self.num_vnodes)
+        return int(r.group(1))
+
+    def test_precheck_stops_at_fit(self):
+        """
+        A job which fits in the first placement set only has the first
+        window of placement sets prechecked
+        """
+        a = {'Resource_List.select': '1:ncpus=1'}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        # 2 threads, MT_NP_CHUNK_SIZE placement sets each
+        self.assertEqual(self.prechecked(jid, t), 64)
+
+    def test_precheck_finds_late_fit(self):
+        """
+        A job which fits in only one placement set is put there, however
+        many windows it takes to get to it
+        """
+        big = self.mom.shortname + '[' + str(self.big_vnode) + ']'
+        a = {'Resource_List.select': '1:ncpus=2'}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'exec_vnode': '(' + big + ':ncpus=2)'},
+                           id=jid)
+        self.assertGreaterEqual(self.prechecked(jid, t), 64)
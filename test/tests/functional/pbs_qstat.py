@@ -157,3 +157,60 @@ class TestQstat(TestFunctional):
                                       % re.escape(self.mom.shortname),
                                       qstat_out), None, "The exec host does"
                             " not contain the task slot number")
+
+    def test_qstat_pages_all_jobs(self):
+        """
+        Test that qstat lists every job exactly once when the server
+        returns the listing in more than one page.
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'scheduling': 'False'})
+        njobs = 1100
+        j = Job(TEST_USER)
+        jids = [self.server.submit(j) for _ in range(njobs)]
+        qstat_cmd = os.path.join(self.server.pbs_conf['PBS_EXEC'],
+                                 'bin', 'qstat')
+        ret = self.du.run_cmd(self.server.hostname, cmd=[qstat_cmd])
+        self.assertEqual(ret['rc'], 0,
+                         'Qstat returned with non-zero exit status')
+        listed = [line.split()[0] for line in ret['out']
+                  if line and line[0].isdigit()]
+        self.assertEqual(len(listed), njobs)
+        self.assertEqual(len(set(listed)), njobs)
+        for jid in (jids[0], jids[-1]):
+            self.assertIn(jid.split('.')[0],
+                          [l.split('.')[0] for l in listed])
+        self.assertEqual(sum(1 for line in ret['out']
+                             if line.startswith('Job id')), 1)
+
+    def test_qstat_ft_subjobs_share_parent_attrs(self):
+        """
+        Test that every queued subjob reported from its parent's attributes
+        carries the parent's values, for managers and for the job owner,
+        and that repeating the status returns the same output.
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'scheduling': 'False'})
+        job_count = 20
+        j = Job(TEST_USER, attrs={ATTR_J: '1-' + str(job_count),
+                                  ATTR_N: 'sharedattrs',
+                                  'Resource_List.ncpus': 1})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+
+        qstat_cmd = os.path.join(self.server.pbs_conf['PBS_EXEC'],
+                                 'bin', 'qstat')
+        qstat_cmd_ft = [qstat_cmd, '-ft', str(jid)]
+        for user in (None, TEST_USER):
+            outs = []
+            for _ in range(2):
+                ret = self.du.run_cmd(self.server.hostname, cmd=qstat_cmd_ft,
+                                      runas=user)
+                self.assertEqual(ret['rc'], 0,
+                                 'Qstat returned with non-zero exit status')
+                outs.append('\n'.join(ret['out']))
+            self.assertEqual(outs[0], outs[1])
+            self.assertEqual(outs[0].count('Job_Name = sharedattrs'),
+                             job_count + 1)
+            self.assertEqual(outs[0].count('Resource_List.ncpus = 1'),
+                             job_count + 1)
@@ -0,0 +1,94 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestReplyThreads(TestFunctional):
+    """
+    Test status replies written out by the server reply threads
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.du.set_pbs_config(self.server.hostname,
+                               confs={'PBS_SERVER_REPLY_THREADS': '2'})
+        self.server.restart()
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'log_events': 2047, 'scheduling': 'False'})
+
+    def tearDown(self):
+        self.du.unset_pbs_config(self.server.hostname,
+                                 confs=['PBS_SERVER_REPLY_THREADS'])
+        self.server.restart()
+        TestFunctional.tearDown(self)
+
+    def test_stat_by_reply_threads(self):
+        """
+        Status of jobs, nodes and queues is the same whether or not the
+        reply is written by a reply thread, and the latency of the
+        requests is reported
+        """
+        self.server.log_match('2 reply threads started')
+        a = {'Resource_List.select': '1:ncpus=1'}
+        jids = [self.server.submit(Job(TEST_USER, attrs=a))
+                for _ in range(200)]
+        t = time.time()
+        jobs = self.server.status(JOB)
+        self.assertEqual(sorted(j['id'] for j in jobs), sorted(jids))
+        for j in jobs:
+            self.assertEqual(j['job_state'], 'Q')
+            self.assertEqual(j['Resource_List.select'], '1:ncpus=1')
+
+        jobs = self.server.status(JOB, id=jids[17])
+        self.assertEqual([j['id'] for j in jobs], [jids[17]])
+        nodes = self.server.status(NODE)
+        self.assertIn(self.mom.shortname, [n['id'] for n in nodes])
+        self.server.status(QUEUE)
+        self.server.select()
+
+        # the server is still answering other requests in between
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+
+        # 19 is PBS_BATCH_StatusJob, reported once a minute
+        self.server.log_match(r'Type 19: .* [1-9]\d* replies by threads',
+                              regexp=True, starttime=t,
+                              max_attempts=90, interval=1)
@@ -0,0 +1,170 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+import re
+
+
+class TestSchedNodeCache(TestFunctional):
+    """
+    Test that the scheduler's cross-cycle node cache picks up changes
+    made to vnodes between scheduling cycles
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 2}
+        self.mom.create_vnodes(attrib=a, num=4, sharednode=False)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.vn = [self.mom.shortname + '[' + str(i) + ']' for i in range(4)]
+
+    def test_resources_change(self):
+        """
+        Change resources_available on a vnode between cycles and make sure
+        the scheduler uses the new value
+        """
+        self.scheduler.run_scheduling_cycle()
+        a = {'resources_available.ncpus': 8}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.vn[0])
+
+        a = {'Resource_List.select': '1:ncpus=8'}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'exec_vnode': '(' + self.vn[0] + ':ncpus=8)'},
+                           id=jid)
+
+    def test_state_change(self):
+        """
+        Offline a vnode between cycles and make sure the scheduler does
+        not place a job on it
+        """
+        self.scheduler.run_scheduling_cycle()
+        for v in self.vn[1:]:
+            self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                                id=v)
+
+        a = {'Resource_List.select': '2:ncpus=2',
+             'Resource_List.place': 'scatter'}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid)
+
+        for v in self.vn[1:]:
+            self.server.manager(MGR_CMD_UNSET, NODE, 'state', id=v)
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+    def test_resource_defs_change(self):
+        """
+        Create a new custom resource after a cycle and make sure the
+        scheduler matches it on the vnode
+        """
+        self.scheduler.run_scheduling_cycle()
+        self.server.manager(MGR_CMD_CREATE, RSC,
+                            {'type': 'string', 'flag': 'h'}, id='color')
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.color': 'blue'},
+                            id=self.vn[2])
+        self.scheduler.add_resource('color')
+
+        a = {'Resource_List.select': '1:ncpus=1:color=blue'}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'exec_vnode': '(' + self.vn[2] + ':ncpus=1)'},
+                           id=jid)
+
+    def match_counts(self, msg, starttime):
+        """
+        Find the last '<hits> of <total> <msg>' log line since starttime
+        and return (hits, total)
+        """
+        m = self.scheduler.log_match(r'(\d+) of (\d+) ' + msg, regexp=True,
+                                     starttime=starttime)
+        r = re.search(r'(\d+) of (\d+) ' + msg, m[1])
+        return int(r.group(1)), int(r.group(2))
+
+    def test_node_sigs_reused(self):
+        """
+        Unchanged vnodes reuse the resource signature of the last cycle,
+        a changed vnode gets a new one, and jobs are placed the same way
+        """
+        self.scheduler.set_sched_attr({'log_events': 4095})
+        num_nodes = len(self.server.status(NODE))
+        self.scheduler.run_scheduling_cycle()
+
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        msg = 'node signatures reused from the last cycle'
+        self.assertEqual(self.match_counts(msg, t), (num_nodes, num_nodes))
+
+        a = {'resources_available.ncpus': 4}
+        self.server.manager(MGR_CMD_SET, NODE, a, id=self.vn[1])
+        a = {'Resource_List.select': '1:ncpus=4'}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+        self.assertEqual(self.match_counts(msg, t),
+                         (num_nodes - 1, num_nodes))
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'exec_vnode': '(' + self.vn[1] + ':ncpus=4)'},
+                           id=jid)
+
+    def test_buckets_found_by_signature(self):
+        """
+        Identical vnodes find their node bucket through their signature,
+        and bucket placement of an excl job is unchanged
+        """
+        self.scheduler.set_sched_attr({'log_events': 4095})
+        a = {'Resource_List.select': '4:ncpus=2',
+             'Resource_List.place': 'excl'}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        t = time.time()
+        self.scheduler.run_scheduling_cycle()
+
+        # every vnode after the first of the four identical ones
+        msg = 'nodes found their bucket by signature'
+        hits, _ = self.match_counts(msg, t)
+        self.assertGreaterEqual(hits, len(self.vn) - 1)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        j = self.server.status(JOB, ['exec_vnode'], id=jid)
+        vnodes = Job(TEST_USER).get_vnodes(j[0]['exec_vnode'])
+        self.assertEqual(sorted(vnodes), sorted(self.vn))
@@ -0,0 +1,134 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSchedResourceIndex(TestFunctional):
+    """
+    Test that vnodes and placement sets with resource lists long enough
+    to be indexed by resource definition match jobs as before
+    """
+    num_res = 20
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.res = ['r' + str(i) for i in range(self.num_res)]
+        for r in self.res:
+            self.server.manager(MGR_CMD_CREATE, RSC,
+                                {'type': 'long', 'flag': 'nh'}, id=r)
+            self.scheduler.add_resource(r, apply=False)
+        self.server.manager(MGR_CMD_CREATE, RSC,
+                            {'type': 'string', 'flag': 'h'}, id='color')
+        self.scheduler.add_resource('color')
+
+        a = {'resources_available.ncpus': 2}
+        for r in self.res:
+            a['resources_available.' + r] = 10
+        self.mom.create_vnodes(attrib=a, num=4, sharednode=False)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.vn = [self.mom.shortname + '[' + str(i) + ']' for i in range(4)]
+
+    def test_long_list_match(self):
+        """
+        Jobs asking for the first, the last and an unset resource of a
+        long vnode resource list go where a list walk would send them
+        """
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.r19': 100}, id=self.vn[2])
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.color': 'blue'},
+                            id=self.vn[3])
+
+        a = {'Resource_List.select': '1:ncpus=1:r19=50'}
+        jid1 = self.server.submit(Job(TEST_USER, attrs=a))
+        a = {'Resource_List.select': '1:ncpus=1:color=blue'}
+        jid2 = self.server.submit(Job(TEST_USER, attrs=a))
+        a = {'Resource_List.select': '4:ncpus=1:r0=10'}
+        jid3 = self.server.submit(Job(TEST_USER, attrs=a))
+        a = {'Resource_List.select': '1:ncpus=1:r19=101'}
+        jid4 = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'exec_vnode': '(' + self.vn[2] +
+                                 ':ncpus=1:r19=50)'}, id=jid1)
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'exec_vnode': '(' + self.vn[3] +
+                                 ':ncpus=1)'}, id=jid2)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid3)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid4)
+
+        # r0 is used up on every vnode, and only vn[0] and vn[1] have
+        # a cpu left
+        a = {'Resource_List.select': '1:ncpus=1:r0=1'}
+        jid5 = self.server.submit(Job(TEST_USER, attrs=a))
+        a = {'Resource_List.select': '1:ncpus=1:r19=10'}
+        jid6 = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid5)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid6)
+        j = self.server.status(JOB, ['exec_vnode'], id=jid6)
+        vnodes = Job(TEST_USER).get_vnodes(j[0]['exec_vnode'])
+        self.assertIn(vnodes[0], self.vn[:2])
+
+    def test_long_placement_set_totals(self):
+        """
+        Placement sets sum the long vnode lists into indexed totals.  A
+        job that fits only in one placement set must be put there.
+        """
+        self.server.manager(MGR_CMD_CREATE, RSC,
+                            {'type': 'string', 'flag': 'h'}, id='grp')
+        for i, v in enumerate(self.vn):
+            a = {'resources_available.grp': 'a' if i < 2 else 'b'}
+            if i >= 2:
+                a['resources_available.r7'] = 30
+            self.server.manager(MGR_CMD_SET, NODE, a, id=v)
+        a = {'node_group_enable': 'True', 'node_group_key': 'grp'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+        a = {'Resource_List.select': '2:ncpus=1:r7=25',
+             'Resource_List.place': 'scatter'}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        j = self.server.status(JOB, ['exec_vnode'], id=jid)
+        vnodes = Job(TEST_USER).get_vnodes(j[0]['exec_vnode'])
+        self.assertEqual(sorted(vnodes), sorted(self.vn[2:]))
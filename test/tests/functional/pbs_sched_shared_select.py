@@ -0,0 +1,120 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSchedSharedSelect(TestFunctional):
+    """
+    Test that the select specs a simulated universe shares with the real
+    one are left alone when the simulation runs or preempts jobs
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 2}
+        self.mom.create_vnodes(attrib=a, num=4, sharednode=False)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.vn = [self.mom.shortname + '[' + str(i) + ']' for i in range(4)]
+
+    def test_topjob_keeps_select(self):
+        """
+        Calendar a top job and make sure the simulated run neither changes
+        its select spec nor lets a later job backfill in its way
+        """
+        self.scheduler.set_sched_config({'strict_ordering': 'true all'})
+        self.server.manager(MGR_CMD_SET, SERVER, {'backfill_depth': 1})
+
+        a = {'Resource_List.select': '2:ncpus=2',
+             'Resource_List.walltime': 100}
+        jid1 = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+
+        a = {'Resource_List.select': '4:ncpus=2',
+             'Resource_List.walltime': 100}
+        jid2 = self.server.submit(Job(TEST_USER, attrs=a))
+        a = {'Resource_List.select': '1:ncpus=1',
+             'Resource_List.walltime': 500}
+        jid3 = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+
+        self.server.expect(JOB, {'job_state': 'Q',
+                                 'Resource_List.select': '4:ncpus=2'},
+                           id=jid2)
+        self.server.expect(JOB, 'estimated.start_time', op=SET, id=jid2)
+        self.server.expect(JOB, 'exec_vnode', op=UNSET, id=jid2)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid3)
+
+        self.server.delete(jid1, wait=True)
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+        j = self.server.status(JOB, ['exec_vnode'], id=jid2)
+        vnodes = Job(TEST_USER).get_vnodes(j[0]['exec_vnode'])
+        self.assertEqual(sorted(vnodes), sorted(self.vn))
+
+    def test_preempt_keeps_select(self):
+        """
+        Preempt a job and make sure the preemption simulation leaves the
+        preempted job's select spec alone so it resumes on its vnodes
+        """
+        a = {'queue_type': 'execution', 'started': 'True',
+             'enabled': 'True', 'priority': 200}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='expressq')
+
+        a = {'Resource_List.select': '4:ncpus=2'}
+        jid1 = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        j = self.server.status(JOB, ['exec_vnode'], id=jid1)
+        execvnode = j[0]['exec_vnode']
+
+        a = {'queue': 'expressq', 'Resource_List.select': '2:ncpus=2'}
+        jid2 = self.server.submit(Job(TEST_USER, attrs=a))
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+        self.server.expect(JOB, {'job_state': 'S',
+                                 'Resource_List.select': '4:ncpus=2'},
+                           id=jid1)
+
+        self.server.delete(jid2, wait=True)
+        self.scheduler.run_scheduling_cycle()
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'exec_vnode': execvnode}, id=jid1)
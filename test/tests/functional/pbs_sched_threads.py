@@ -0,0 +1,116 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSchedThreads(TestFunctional):
+    """
+    Test that a scheduling cycle run on several worker threads places
+    jobs the same way as a cycle run on one thread
+    """
+    num_vnodes = 2100
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 1}
+        self.mom.create_vnodes(attrib=a, num=self.num_vnodes,
+                               sharednode=False, expect=False)
+        self.server.expect(NODE, {'state=free': (GE, self.num_vnodes)})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+    def tearDown(self):
+        self.du.unset_pbs_config(confs=['PBS_SCHED_THREADS'])
+        self.scheduler.restart()
+        TestFunctional.tearDown(self)
+
+    def set_threads(self, num):
+        """
+        Restart the scheduler with num worker threads
+        """
+        self.du.set_pbs_config(confs={'PBS_SCHED_THREADS': num},
+                               append=True)
+        self.scheduler.restart()
+
+    def place_jobs(self):
+        """
+        Run one cycle over a fixed set of jobs and return the vnodes of
+        each job in submission order, then delete the jobs
+        """
+        selects = [('1000:ncpus=1', 'free'), ('600:ncpus=1', 'scatter'),
+                   ('1:ncpus=1', 'excl'), ('400:ncpus=1', 'free'),
+                   ('200:ncpus=1', 'free')]
+        jids = []
+        for sel, place in selects:
+            a = {'Resource_List.select': sel, 'Resource_List.place': place}
+            jids.append(self.server.submit(Job(TEST_USER, attrs=a)))
+        self.scheduler.run_scheduling_cycle()
+
+        placed = []
+        for jid in jids:
+            j = self.server.status(JOB, ['job_state', 'exec_vnode'], id=jid)
+            if j[0]['job_state'] == 'R':
+                placed.append(sorted(
+                    Job(TEST_USER).get_vnodes(j[0]['exec_vnode'])))
+            else:
+                placed.append(None)
+        self.server.delete(jids, wait=True)
+        return placed
+
+    def test_threads_place_like_one_thread(self):
+        """
+        Node queries, eligibility checks and the other chunked loops are
+        spread over the worker threads' deques once there are more than
+        MT_CHUNK_SIZE_MIN nodes.  The jobs must end up on the same vnodes
+        as with a single thread.
+        """
+        self.set_threads(1)
+        expected = self.place_jobs()
+        self.assertIsNone(expected[-1])
+        self.assertEqual(sum(len(p) for p in expected[:-1]), 2001)
+
+        self.scheduler.set_sched_attr({'log_events': 2047})
+        self.set_threads(4)
+        t = time.time()
+        placed = self.place_jobs()
+        self.scheduler.log_match('Launching 4 worker threads', starttime=t)
+        self.scheduler.log_match('calling query_node_info_chunk()',
+                                 starttime=t)
+        self.assertEqual(placed, expected)
@@ -0,0 +1,121 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestServerHelpers(TestFunctional):
+    """
+    Test the pre-forked server helper processes (PBS_SERVER_HELPERS)
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.du.set_pbs_config(self.server.hostname,
+                               confs={'PBS_SERVER_HELPERS': '2'})
+        t = time.time()
+        self.server.restart()
+        self.server.log_match('2 helper processes started', starttime=t)
+
+    def tearDown(self):
+        self.du.unset_pbs_config(self.server.hostname,
+                                 confs=['PBS_SERVER_HELPERS'])
+        self.server.restart()
+        TestFunctional.tearDown(self)
+
+    def test_mail_sent_by_helper(self):
+        """
+        Job mail is passed to the mailer by a helper process and the
+        server does not fork for it
+        """
+        mailfile = self.du.create_temp_file(body='')
+        mailer = self.du.create_temp_file(
+            body='#!/bin/sh\ncat >> %s\n' % mailfile)
+        self.du.chmod(path=mailer, mode=0o755)
+        self.du.chmod(path=mailfile, mode=0o666)
+        self.server.manager(MGR_CMD_SET, SERVER, {'mailer': mailer})
+        j = Job(TEST_USER, attrs={'Mail_Points': 'be'})
+        j.set_sleep_time(1)
+        t = time.time()
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, id=jid, extend='x',
+                           offset=1, max_attempts=60)
+        self.server.log_match('fork failed', starttime=t, existence=False,
+                              max_attempts=2)
+        for _ in range(30):
+            ret = self.du.cat(filename=mailfile)
+            out = '\n'.join(ret['out'])
+            if out.count('PBS Job Id: ' + jid) == 2:
+                break
+            time.sleep(1)
+        self.assertIn('Subject: PBS JOB ' + jid, out)
+        self.assertEqual(out.count('PBS Job Id: ' + jid), 2)
+
+    def test_periodic_hook_run_by_helper(self):
+        """
+        A server periodic hook is run through pbs_python by a helper
+        process and the vnode changes it makes are applied by the server
+        """
+        hook_body = """
+import pbs
+e = pbs.event()
+for vn in e.vnode_list.keys():
+    e.vnode_list[vn].comment = "set by periodic helper"
+e.accept()
+"""
+        t = time.time()
+        self.server.create_import_hook('helper_periodic',
+                                       {'event': 'periodic', 'freq': 5},
+                                       hook_body, overwrite=True)
+        self.server.log_match('periodic hook handed to a server helper',
+                              starttime=t, max_attempts=30)
+        self.server.expect(NODE, {'comment': 'set by periodic helper'},
+                           id=self.mom.shortname, max_attempts=30)
+
+    def test_helpers_disabled(self):
+        """
+        With PBS_SERVER_HELPERS unset, the default, no helpers are started
+        """
+        self.du.unset_pbs_config(self.server.hostname,
+                                 confs=['PBS_SERVER_HELPERS'])
+        t = time.time()
+        self.server.restart()
+        self.server.log_match('helper processes started', starttime=t,
+                              existence=False, max_attempts=2)
@@ -0,0 +1,121 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSparseJobAttrs(TestFunctional):
+    """
+    Test that job attributes held in sparse storage are reported, altered,
+    saved and recovered as before
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+
+    def test_unset_attrs_not_reported(self):
+        """
+        Attributes the job never had set are not shown by qstat -f,
+        the ones it has are
+        """
+        j = Job(TEST_USER, attrs={ATTR_N: 'sparse'})
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R', ATTR_N: 'sparse'},
+                           id=jid)
+        stat = self.server.status(JOB, id=jid)[0]
+        for a in ['depend', 'Account_Name', 'array_indices_submitted']:
+            self.assertNotIn(a, stat)
+        for a in ['Job_Owner', 'exec_host', 'queue', 'ctime', 'euser']:
+            self.assertIn(a, stat)
+
+    def test_qalter(self):
+        """
+        qalter sets an attribute the job did not have, a failed qalter
+        leaves the job's attributes unchanged
+        """
+        j = Job(TEST_USER)
+        j.set_sleep_time(1000)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jid = self.server.submit(j)
+        self.server.alterjob(jid, {ATTR_A: 'acct1', ATTR_p: '10'})
+        self.server.expect(JOB, {ATTR_A: 'acct1', ATTR_p: '10'}, id=jid)
+        with self.assertRaises(PbsAlterError):
+            self.server.alterjob(jid, {ATTR_p: '10', ATTR_l + '.ncpus': '8'})
+        self.server.expect(JOB, {ATTR_A: 'acct1', ATTR_p: '10',
+                                 'Resource_List.ncpus': '1'}, id=jid)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+    def test_recovery(self):
+        """
+        Attributes of queued and running jobs are recovered when the
+        server restarts, unset ones stay unset
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j1 = Job(TEST_USER, attrs={ATTR_N: 'queued', ATTR_A: 'acct1'})
+        jid1 = self.server.submit(j1)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j2 = Job(TEST_USER, attrs={ATTR_N: 'second', ATTR_l + '.ncpus': 2})
+        jid2 = self.server.submit(j2)
+        self.server.restart()
+        self.server.expect(JOB, {'job_state': 'R', ATTR_N: 'queued',
+                                 ATTR_A: 'acct1'}, id=jid1)
+        self.server.expect(JOB, {'job_state': 'Q', ATTR_N: 'second',
+                                 'Resource_List.ncpus': '2'}, id=jid2)
+        stat = self.server.status(JOB, id=jid2)[0]
+        self.assertNotIn('Account_Name', stat)
+        self.assertNotIn('exec_host', stat)
+
+    def test_history_job(self):
+        """
+        A finished job keeps its attributes in the job history
+        """
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'job_history_enable': 'True'})
+        j = Job(TEST_USER, attrs={ATTR_N: 'hist', ATTR_A: 'acct1'})
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F', ATTR_N: 'hist',
+                                 ATTR_A: 'acct1', 'Exit_status': 0},
+                           id=jid, extend='x', offset=1, max_attempts=60)
@@ -1038,3 +1038,28 @@ class TestEntityLimits(TestFunctional):
         self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
         self.server.expect(JOB, {'job_state': 'S'}, id=jid1)
         self.server.expect(JOB, {'job_state': 'Q'}, id=jid4)
+
+    def test_server_project_run_limits_many_projects(self):
+        """
+        Test that per project run limits hold for every project when
+        there are enough projects for the scheduler to index their counts
+        """
+        a = {'resources_available.ncpus': 40}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        a = {'max_run': '[p:PBS_GENERIC=1]', 'scheduling': 'False'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+        nprojects = 12
+        jids = []
+        for i in range(nprojects):
+            attr = {'Resource_List.select': '1:ncpus=1',
+                    ATTR_project: 'P%d' % i}
+            for _ in range(2):
+                jids.append(self.server.submit(Job(TEST_USER, attrs=attr)))
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state=R': nprojects})
+        self.server.expect(JOB, {'job_state=Q': nprojects})
+        for i in range(nprojects):
+            self.server.expect(JOB, {'job_state': 'R'}, id=jids[2 * i])
+            self.server.expect(JOB, {'job_state': 'Q'}, id=jids[2 * i + 1])
@@ -123,3 +123,33 @@ class Test_qorder(TestFunctional):
         self.logger.info(msg)
 
         self.assertEqual(firstconsidered, jid2)
+
+    def test_qorder_across_queues_keeps_rank_order(self):
+        """
+        Swap a job at the head of a queue with a job in another queue and
+        check that the job moved in is linked at the head of its new queue,
+        both before and after a server restart.
+        """
+        a = {'scheduling': 'false'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+        a = {'queue_type': 'e', 'enabled': '1', 'started': '1'}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='workq2')
+
+        jids = []
+        for _ in range(3):
+            jids.append(self.server.submit(Job(TEST_USER)))
+        jid4 = self.server.submit(Job(TEST_USER, {ATTR_queue: 'workq2'}))
+
+        rc = self.server.orderjob(jobid1=jids[0], jobid2=jid4)
+        self.assertEqual(rc, 0)
+
+        exp = [jid4, jids[1], jids[2]]
+        stat = self.server.status(JOB, 'queue')
+        workq = [j['id'] for j in stat if j['queue'] == 'workq']
+        self.assertEqual(workq, exp)
+
+        self.server.restart()
+        stat = self.server.status(JOB, 'queue')
+        workq = [j['id'] for j in stat if j['queue'] == 'workq']
+        self.assertEqual(workq, exp)
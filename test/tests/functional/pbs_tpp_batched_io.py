@@ -0,0 +1,77 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestTppBatchedIO(TestFunctional):
+    """
+    Test the TPP transport writing queued packets in batches
+    """
+
+    def test_burst_and_syscall_counts(self):
+        """
+        A burst of job starts over TPP is delivered intact, and the
+        syscall counts of the connection are logged when it goes away
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047})
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 50},
+                            id=self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for _ in range(50):
+            j = Job(TEST_USER, attrs={'Resource_List.select': '1:ncpus=1'})
+            j.set_sleep_time(1000)
+            jids.append(self.server.submit(j))
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        t = time.time()
+        self.comm.restart()
+        self.server.log_match(r'sent \d+ chunks in \d+ writes, received '
+                              r'\d+ packets in \d+ reads, -?\d+ syscalls '
+                              r'saved', regexp=True, starttime=t)
+
+        # the connection comes back and keeps working
+        self.server.expect(NODE, {'state': 'job-busy'},
+                           id=self.mom.shortname, max_attempts=60)
+        self.server.deljob(jids, wait=True)
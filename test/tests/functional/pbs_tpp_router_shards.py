@@ -0,0 +1,78 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2021 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of both the OpenPBS software ("OpenPBS")
+# and the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# OpenPBS is free software. You can redistribute it and/or modify it under
+# the terms of the GNU Affero General Public License as published by the
+# Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# OpenPBS is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Affero General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# PBS Pro is commercially licensed software that shares a common core with
+# the OpenPBS software.  For a copy of the commercial license terms and
+# conditions, go to: (http://www.pbspro.com/agreement.html) or contact the
+# Altair Legal Department.
+#
+# Altair's dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of OpenPBS and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair's trademarks, including but not limited to "PBS™",
+# "OpenPBS®", "PBS Professional®", and "PBS Pro™" and Altair's logos is
+# subject to Altair's trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestTppRouterShards(TestFunctional):
+    """
+    Test routing through pbs_comm while leaves join and leave, with the
+    cluster leaves index split into separately locked shards
+    """
+
+    def test_route_across_leaf_churn(self):
+        """
+        Jobs keep running and finishing while the MoM leaf reconnects to
+        pbs_comm over and over, and pbs_comm never loses track of the
+        leaf addresses it has registered
+        """
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 20},
+                            id=self.mom.shortname)
+        t = time.time()
+        for _ in range(5):
+            jids = []
+            for _ in range(20):
+                j = Job(TEST_USER,
+                        attrs={'Resource_List.select': '1:ncpus=1'})
+                j.set_sleep_time(1)
+                jids.append(self.server.submit(j))
+            self.mom.restart()
+            self.server.expect(NODE, {'state': 'free'},
+                               id=self.mom.shortname, max_attempts=60)
+            for jid in jids:
+                self.server.expect(JOB, 'queue', id=jid, op=UNSET,
+                                   max_attempts=120)
+
+        for msg in ['Failed to delete address',
+                    'Failed to add address',
+                    'Failed to clear pbs_comm from leaf']:
+            self.comm.log_match(msg, starttime=t, existence=False,
+                                max_attempts=1)